@@ -0,0 +1,32 @@
+# Reports the size of every SPIR-V binary before optimization (the .unoptimized.spv glslc wrote, when spirv-opt ran) and after.
+# Usage: cmake -DREPORT=<output file> -DROOT=<directory the names are relative to> -DSHADERS=<path|path|...> -P ShaderSizeReport.cmake
+
+string(REPLACE "|" ";" SHADERS "${SHADERS}")
+
+set(REPORT_TEXT "")
+set(TOTAL_BEFORE 0)
+set(TOTAL_AFTER 0)
+foreach(SHADER ${SHADERS})
+    file(SIZE ${SHADER} AFTER)
+    string(REGEX REPLACE "\\.spv$" ".unoptimized.spv" UNOPTIMIZED ${SHADER})
+    if(EXISTS ${UNOPTIMIZED})
+        file(SIZE ${UNOPTIMIZED} BEFORE)
+    else()
+        set(BEFORE ${AFTER})
+    endif()
+    math(EXPR TOTAL_BEFORE "${TOTAL_BEFORE} + ${BEFORE}")
+    math(EXPR TOTAL_AFTER "${TOTAL_AFTER} + ${AFTER}")
+
+    file(RELATIVE_PATH NAME ${ROOT} ${SHADER})
+    string(APPEND REPORT_TEXT "${NAME}: ${BEFORE} -> ${AFTER} bytes\n")
+endforeach()
+
+if(TOTAL_BEFORE GREATER 0)
+    math(EXPR PERCENT "${TOTAL_AFTER} * 100 / ${TOTAL_BEFORE}")
+else()
+    set(PERCENT 100)
+endif()
+string(APPEND REPORT_TEXT "Total: ${TOTAL_BEFORE} -> ${TOTAL_AFTER} bytes (${PERCENT}%)\n")
+
+file(WRITE ${REPORT} "${REPORT_TEXT}")
+message(STATUS "SPIR-V sizes (before -> after optimization):\n${REPORT_TEXT}")
@@ -0,0 +1,23 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "../include/lighting.glsl"
+
+// Lighting subpass of deferred shading: loops over all the lights once per pixel, reading the pixel's G-buffer texels
+// written by the previous subpass (on tilers, straight from tile memory)
+
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput gBufferAlbedo;
+layout(input_attachment_index = 1, set = 0, binding = 1) uniform subpassInput gBufferNormal;
+layout(input_attachment_index = 2, set = 0, binding = 2) uniform subpassInput gBufferPosition;
+
+layout(location = 0) out vec4 outColor;
+
+void main(){
+    vec3 normal = subpassLoad(gBufferNormal).xyz;
+    if (dot(normal, normal) == 0.0) {
+        // No cube drawn here: the G-buffer kept its clear value
+        outColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+    outColor = vec4(shade(subpassLoad(gBufferAlbedo).rgb, normal, subpassLoad(gBufferPosition).xyz), 1.0);
+}
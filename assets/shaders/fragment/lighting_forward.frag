@@ -0,0 +1,16 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "../include/lighting.glsl"
+
+// Forward shading: every fragment drawn loops over all the lights, including the fragments later hidden by a closer cube
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec3 inAlbedo;
+
+layout(location = 0) out vec4 outColor;
+
+void main(){
+    outColor = vec4(shade(inAlbedo, normalize(inNormal), inPosition), 1.0);
+}
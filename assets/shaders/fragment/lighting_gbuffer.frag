@@ -0,0 +1,17 @@
+#version 450
+
+// G-buffer subpass of deferred shading: only stores what the lighting subpass needs, no lighting
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec3 inAlbedo;
+
+layout(location = 0) out vec4 outAlbedo;
+layout(location = 1) out vec4 outNormal;
+layout(location = 2) out vec4 outPosition;
+
+void main(){
+    outAlbedo = vec4(inAlbedo, 1.0);
+    outNormal = vec4(normalize(inNormal), 0.0);
+    outPosition = vec4(inPosition, 1.0);
+}
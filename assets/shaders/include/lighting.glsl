@@ -0,0 +1,72 @@
+// Shared by the lighting benchmark shaders (see LightingBenchmark). The camera, the cubes and the lights are all generated
+// from indices, so the forward and the deferred paths draw exactly the same scene
+
+layout(push_constant) uniform PushConstants {
+    float aspectRatio;
+    float time;
+} pushConstants;
+
+// The number of lights, specialization constant 0, set by LightingBenchmark (64 if not specialized)
+layout(constant_id = 0) const uint LIGHT_COUNT = 64u;
+
+// The cubes stand on a CUBES_PER_ROW x CUBES_PER_ROW grid
+const uint CUBES_PER_ROW = 32u;
+const float CUBE_SPACING = 2.0;
+const float LIGHT_RADIUS = 6.0;
+
+// Uniformly distributed in [0, 1]
+float hash(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return float(x) / 4294967295.0;
+}
+
+// Clip space position of a world position, seen from a fixed camera looking down at the grid across its whole length
+// (so the cubes hide each other: overdraw)
+vec4 project(vec3 position) {
+    vec3 eye = vec3(0.0, 16.0, -40.0);
+    vec3 forward = normalize(-eye); // Towards the center of the grid
+    vec3 right = normalize(cross(vec3(0.0, 1.0, 0.0), forward));
+    vec3 up = cross(forward, right);
+    float focal = 1.0 / tan(radians(30.0)); // 60 degrees vertical field of view
+    float near = 0.1;
+    float far = 200.0;
+
+    vec3 view = position - eye;
+    view = vec3(dot(view, right), dot(view, up), dot(view, forward));
+    // Vulkan clip space: y points down, depth in [0, 1]
+    return vec4(view.x * focal / pushConstants.aspectRatio, -view.y * focal, (view.z - near) * far / (far - near), view.z);
+}
+
+struct PointLight {
+    vec3 position;
+    vec3 color;
+};
+
+// Lights circling the center of the grid at different distances, heights and speeds
+PointLight getLight(uint index) {
+    float angle = 6.2831853 * hash(4u * index) + pushConstants.time * (0.2 + 0.3 * hash(4u * index + 1u));
+    float distance = 2.0 + 28.0 * hash(4u * index + 2u);
+
+    PointLight light;
+    light.position = vec3(cos(angle) * distance, 0.5 + 5.0 * hash(4u * index + 3u), sin(angle) * distance);
+    light.color = 0.5 + 0.5 * cos(6.2831853 * (hash(7u * index + 5u) + vec3(0.0, 0.33, 0.67)));
+    return light;
+}
+
+// Diffuse lighting of a surface point by every light: the cost both paths are compared on
+vec3 shade(vec3 albedo, vec3 normal, vec3 position) {
+    vec3 color = 0.03 * albedo; // Ambient
+    for (uint i = 0u; i < LIGHT_COUNT; i++) {
+        PointLight light = getLight(i);
+        vec3 toLight = light.position - position;
+        float distance = length(toLight);
+        float attenuation = clamp(1.0 - distance / LIGHT_RADIUS, 0.0, 1.0);
+        attenuation *= attenuation;
+        color += albedo * light.color * attenuation * max(dot(normal, toLight / max(distance, 1e-4)), 0.0);
+    }
+    return color;
+}
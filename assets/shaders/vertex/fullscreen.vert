@@ -0,0 +1,8 @@
+#version 450
+
+// One triangle covering the whole viewport, without vertex buffers (draw 3 vertices)
+
+void main(){
+    vec2 uv = vec2(float((gl_VertexIndex << 1) & 2), float(gl_VertexIndex & 2));
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
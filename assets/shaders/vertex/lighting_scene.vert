@@ -0,0 +1,43 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "../include/lighting.glsl"
+
+// Draws CUBES_PER_ROW x CUBES_PER_ROW instanced cubes of random heights without vertex buffers: 36 vertices per cube,
+// generated from gl_VertexIndex, placed on the grid from gl_InstanceIndex
+
+layout(location = 0) out vec3 outPosition;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) out vec3 outAlbedo;
+
+const vec3 FACE_NORMALS[6] = vec3[](
+    vec3(1.0, 0.0, 0.0),
+    vec3(-1.0, 0.0, 0.0),
+    vec3(0.0, 1.0, 0.0),
+    vec3(0.0, -1.0, 0.0),
+    vec3(0.0, 0.0, 1.0),
+    vec3(0.0, 0.0, -1.0)
+);
+
+// Two triangles per face, counter-clockwise seen from outside the cube
+const uint FACE_CORNERS[6] = uint[](0u, 1u, 2u, 2u, 1u, 3u);
+
+void main(){
+    uint face = uint(gl_VertexIndex) / 6u;
+    uint corner = FACE_CORNERS[uint(gl_VertexIndex) % 6u];
+    vec3 normal = FACE_NORMALS[face];
+    vec3 tangent = (face < 2u) ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+    vec3 bitangent = cross(normal, tangent);
+    vec2 uv = vec2(float(corner & 1u), float(corner >> 1u)) * 2.0 - 1.0;
+    vec3 local = normal + uv.x * tangent + uv.y * bitangent; // In [-1, 1]^3
+
+    uint instance = uint(gl_InstanceIndex);
+    vec2 cell = vec2(float(instance % CUBES_PER_ROW), float(instance / CUBES_PER_ROW)) - 0.5 * float(CUBES_PER_ROW - 1u);
+    float height = 0.5 + 3.0 * hash(instance);
+    vec3 center = vec3(cell.x * CUBE_SPACING, height, cell.y * CUBE_SPACING); // Standing on y = 0
+
+    outPosition = center + local * vec3(0.6, height, 0.6);
+    outNormal = normal;
+    outAlbedo = vec3(0.4) + 0.6 * vec3(hash(3u * instance + 1u), hash(3u * instance + 2u), hash(3u * instance + 3u));
+    gl_Position = project(outPosition);
+}
@@ -7,7 +7,7 @@
 class App
 {
 public:
-    App();
+    App(const EngineConfig &engineConfig = EngineConfig{});
     ~App();
 
     void run(); // Starts the application
@@ -3,13 +3,66 @@
 
 #pragma once
 
+#include "core/renderer/VulkanFrameStats.hpp"
+#include "core/renderer/VulkanPipelineState.hpp"
+#include "core/renderer/VulkanSwapChain.hpp"
+#include "graphics/LightingBenchmark.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
 class WindowHandler;
 class VulkanRenderer;
+class ParticleSystem;
+class ShaderHotReloader;
+
+struct EngineConfig
+{
+    uint32_t m_width = 800;  // Window size in screen coordinates, or offscreen image size in pixels when headless
+    uint32_t m_height = 600;
+
+    // Render without a window into offscreen images, as fast as possible, then exit
+    bool m_headless = false;
+    uint32_t m_headlessFrameCount = 1000;
+    bool m_captureFrames = false; // Read every headless frame back to the host (e.g. for video encode or image diffing)
+
+    // Windowed only: latency/throughput/power trade-off of the presentation
+    VulkanPresentPolicy m_presentPolicy = VulkanPresentPolicy::THROUGHPUT;
+    bool m_framePacing = false;
+
+    // Simulate this many particles with a compute shader every frame on the async compute queue (0 = no compute work).
+    // The result is verified on the host at exit
+    uint32_t m_particleCount = 0;
+
+    // Draw a scene lit by this many point lights under the triangle (0 = not drawn), shaded forward or deferred.
+    // Headless runs report the average GPU time per frame, to compare both paths at the same light count
+    uint32_t m_benchmarkLightCount = 0;
+    LightingPath m_benchmarkLightingPath = LightingPath::DEFERRED;
+
+    // Pipeline cache file, relative to the working directory (empty: compile every pipeline on every launch)
+    std::string m_pipelineCachePath = "pipeline_cache.bin";
+    // Pipeline compilation threads (0 = one per hardware thread), and whether to compile every preset at startup
+    uint32_t m_pipelineWorkerCount = 0;
+    bool m_compilePipelinePresets = false;
+    // Set the states the device allows at record time instead of compiling a pipeline per variant
+    bool m_extendedDynamicState = true;
+    // Draw without render pass and framebuffer objects where the device supports dynamic rendering
+    bool m_dynamicRendering = true;
+    // Pipelines used this session, pre-warmed in the background on the next launch (empty: no pre-warm)
+    std::string m_pipelineManifestPath = "pipeline_manifest.bin";
+    // Every shader of the build in one file, written next to the loose .spv files (empty: load the loose files)
+    std::string m_shaderArchivePath = "assets/shaders.pack";
+    // Recompile the GLSL sources of the build when they are saved, and rebuild the pipelines using them while running
+    bool m_shaderHotReload = false;
+    // Pipeline state to draw with, selected after startup like a preset first used mid-session (basic if not set)
+    std::optional<VulkanPipelineState> m_drawPipelineState;
+};
 
 class Engine
 {
 public:
-    Engine();
+    Engine(const EngineConfig &config = EngineConfig{});
     ~Engine();
 
     void run();
@@ -17,9 +70,30 @@ public:
 private:
     void init();
     void mainLoop();
+    void headlessLoop();
+    void consumeCapturedFrames();
     void cleanup();
+    void reportFrameStats(const VulkanFrameStats &frameStats);
+    void onPresentConfigured(const VulkanPresentConfiguration &presentConfiguration);
+    void onPresent(const double presentIntervalMs);
+    void initParticles();
+    void verifyParticles();
+    void initShaderHotReload();
+    void reloadShaders();
 
+    EngineConfig m_config;
     WindowHandler *m_windowHandler;
     VulkanRenderer *m_renderer;
+    ParticleSystem *m_particleSystem;
+    ShaderHotReloader *m_shaderHotReloader;
     bool m_isRunning;
+
+    VulkanFrameStats m_accumulatedFrameStats;
+    uint32_t m_accumulatedFrameCount;
+
+    double m_accumulatedPresentIntervalMs;
+    double m_maxPresentIntervalMs;
+    uint32_t m_presentIntervalCount;
+
+    uint64_t m_capturedBytes;
 };
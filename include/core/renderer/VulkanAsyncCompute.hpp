@@ -0,0 +1,50 @@
+#pragma once
+
+#include "VulkanCommandPool.hpp"
+#include "VulkanSyncObjects.hpp"
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+class VulkanDevice;
+
+// Per frame-in-flight submission of compute work on the async compute queue (or on the graphics queue if the device has no
+// compute family without graphics). Each frame slot has its own command buffer, a semaphore signaled when the compute work
+// completes and a fence so the command buffer is not re-recorded while it executes.
+// The graphics submit of the same frame waits on the semaphore only at the stages that consume the compute results, so the
+// earlier graphics stages overlap with the compute work. Resources written by compute and read by graphics must be created
+// with VK_SHARING_MODE_CONCURRENT over getSharedQueueFamilies(), or be transferred with release/acquire barriers.
+class VulkanAsyncCompute
+{
+public:
+    VulkanAsyncCompute();
+    ~VulkanAsyncCompute();
+
+    void createAsyncCompute(const VulkanDevice &vulkanDevice, const uint32_t framesInFlight);
+    void cleanUp();
+
+    // Waits until the slot's previous compute work has completed, then returns its command buffer, ready to record
+    VkCommandBuffer beginFrame(const uint32_t frameIndex);
+    // Submits the slot's command buffer once the waits (e.g. graphics work producing the compute input) are signaled.
+    // The returned semaphore must be waited on by exactly one later submit, at graphicsWaitStageMask
+    VulkanSemaphoreWait submit(const uint32_t frameIndex, const std::vector<VulkanSemaphoreWait> &waits, const VkPipelineStageFlags graphicsWaitStageMask);
+
+    bool isCreated() const { return !m_commandBuffers.empty(); }
+    // True if the compute work runs on its own queue, in parallel with the graphics queue
+    bool isAsync() const { return m_computeFamily != m_graphicsFamily; }
+    uint32_t getQueueFamily() const { return m_computeFamily; }
+    // Queue families to list in the create info of CONCURRENT resources shared by compute and graphics
+    std::vector<uint32_t> getSharedQueueFamilies() const;
+
+private:
+    VkDevice m_device;
+    VkQueue m_computeQueue;
+    uint32_t m_computeFamily;
+    uint32_t m_graphicsFamily;
+
+    VulkanCommandPool m_commandPool;
+    std::vector<VkCommandBuffer> m_commandBuffers;
+    std::vector<VkSemaphore> m_computeFinishedSemaphores;
+    std::vector<VkFence> m_computeFences;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Kind of resource bound to a sub-allocation. Linear (buffers, linear images) and optimal (tiled images) resources
+// must not share a "page" of bufferImageGranularity bytes, otherwise they may alias on some GPUs.
+enum class VulkanAllocationType
+{
+    LINEAR,
+    OPTIMAL,
+    UNKNOWN // Treated as conflicting with everything
+};
+
+// Bookkeeping of the sub-allocations inside one VkDeviceMemory block, using TLSF (Two-Level Segregated Fit).
+// Free ranges are kept in lists segregated by size class: the first level is the power of two of the size, the second level
+// splits each power of two linearly. Two bitmaps tell which lists are non-empty, so finding a free range large enough is O(1).
+// Only offsets and sizes are managed here, no Vulkan call is made, so it can be exercised without a GPU.
+class VulkanBlockMetadata
+{
+public:
+    VulkanBlockMetadata(const VkDeviceSize size, const VkDeviceSize bufferImageGranularity = 1);
+
+    // Returns the offset of the sub-allocation, or nothing if no free range can hold it
+    std::optional<VkDeviceSize> allocate(const VkDeviceSize size, const VkDeviceSize alignment, const VulkanAllocationType type);
+    // offset must have been returned by allocate. Adjacent free ranges are merged back together
+    void free(const VkDeviceSize offset);
+
+    VkDeviceSize getSize() const { return m_size; }
+    VkDeviceSize getUsedBytes() const { return m_usedBytes; }
+    VkDeviceSize getFreeBytes() const { return m_size - m_usedBytes; }
+    uint32_t getAllocationCount() const { return static_cast<uint32_t>(m_usedNodes.size()); }
+    uint32_t getFreeRangeCount() const { return m_freeRangeCount; }
+    VkDeviceSize getLargestFreeRange() const;
+    bool isEmpty() const { return m_usedNodes.empty(); }
+
+    // Checks every invariant (ranges contiguous, no two adjacent free ranges, free lists and bitmaps consistent)
+    bool validate() const;
+
+private:
+    static constexpr uint32_t INVALID_NODE = UINT32_MAX;
+    static constexpr uint32_t SECOND_LEVEL_LOG2 = 5; // 32 lists per power of two
+    static constexpr uint32_t SECOND_LEVEL_COUNT = 1u << SECOND_LEVEL_LOG2;
+    static constexpr uint32_t SMALL_SIZE_LOG2 = 8; // Sizes below 256 bytes all go to first level 0, split linearly
+    static constexpr uint32_t FIRST_LEVEL_COUNT = 64 - SMALL_SIZE_LOG2 + 1;
+
+    struct Node
+    {
+        VkDeviceSize m_offset = 0;
+        VkDeviceSize m_size = 0;
+        uint32_t m_prevPhysical = INVALID_NODE; // Neighbours in memory order
+        uint32_t m_nextPhysical = INVALID_NODE;
+        uint32_t m_prevFree = INVALID_NODE; // Neighbours in the free list of the node's size class
+        uint32_t m_nextFree = INVALID_NODE;
+        bool m_isFree = true;
+        VulkanAllocationType m_type = VulkanAllocationType::UNKNOWN;
+    };
+
+    struct SizeClass
+    {
+        uint32_t m_firstLevel;
+        uint32_t m_secondLevel;
+    };
+
+    VkDeviceSize m_size;
+    VkDeviceSize m_bufferImageGranularity;
+    VkDeviceSize m_usedBytes;
+    uint32_t m_freeRangeCount;
+
+    // Node 0 always starts at offset 0: splitting and merging keep the lower node
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_unusedNodes;
+    std::unordered_map<VkDeviceSize, uint32_t> m_usedNodes; // Offset -> node
+
+    uint64_t m_firstLevelBitmap;
+    std::array<uint32_t, FIRST_LEVEL_COUNT> m_secondLevelBitmaps;
+    std::array<uint32_t, FIRST_LEVEL_COUNT * SECOND_LEVEL_COUNT> m_freeLists; // Head node of each size class
+
+    static SizeClass mapSize(const VkDeviceSize size);
+    static VkDeviceSize roundUpToSizeClass(const VkDeviceSize size);
+    static uint32_t classIndex(const SizeClass sizeClass) { return sizeClass.m_firstLevel * SECOND_LEVEL_COUNT + sizeClass.m_secondLevel; }
+    static bool typesConflict(const VulkanAllocationType first, const VulkanAllocationType second);
+
+    uint32_t createNode();
+    void releaseNode(const uint32_t nodeIndex);
+    void insertFree(const uint32_t nodeIndex);
+    void removeFree(const uint32_t nodeIndex);
+    uint32_t splitNode(const uint32_t nodeIndex, const VkDeviceSize firstSize);
+    void mergeWithNext(const uint32_t nodeIndex);
+
+    uint32_t findFreeNode(const uint32_t firstClass, const uint32_t lastClass, const VkDeviceSize size, const VkDeviceSize alignment,
+                          const VulkanAllocationType type, VkDeviceSize &offset) const;
+    std::optional<VkDeviceSize> findOffsetInNode(const uint32_t nodeIndex, const VkDeviceSize size, const VkDeviceSize alignment, const VulkanAllocationType type) const;
+    void allocateInNode(const uint32_t nodeIndex, const VkDeviceSize offset, const VkDeviceSize size, const VulkanAllocationType type);
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+class VulkanCommandPool
+{
+public:
+    VulkanCommandPool();
+    ~VulkanCommandPool();
+
+    // RESET_COMMAND_BUFFER allows command buffers to be re-recorded individually (needed for per-frame recording)
+    void createCommandPool(const VkDevice &device, const uint32_t queueFamilyIndex,
+                           const VkCommandPoolCreateFlags flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    std::vector<VkCommandBuffer> allocateCommandBuffers(const uint32_t count, const VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+    void cleanUp();
+
+    VkCommandPool getCommandPool() const { return m_commandPool; }
+
+private:
+    VkDevice m_device;
+    VkCommandPool m_commandPool;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+class Shader;
+
+class VulkanComputePipeline
+{
+public:
+    VulkanComputePipeline();
+    ~VulkanComputePipeline();
+
+    // The shader must have been created with a compute stage. The layout is owned by the caller (see VulkanPipelineLayoutCache)
+    void createPipeline(const VkDevice &device, const Shader &shader, const VkPipelineLayout &pipelineLayout,
+                        const VkPipelineCache pipelineCache = VK_NULL_HANDLE);
+    void cleanUp();
+
+    VkPipeline getPipeline() const { return m_computePipeline; };
+    VkPipelineLayout getPipelineLayout() const { return m_pipelineLayout; };
+
+private:
+    VkDevice m_device;
+    VkPipeline m_computePipeline;
+    VkPipelineLayout m_pipelineLayout;
+
+    void createComputePipeline(const Shader &shader, const VkPipelineCache pipelineCache);
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+// Defers the destruction of Vulkan objects that may still be referenced by frames in flight.
+// Each entry is tagged with the number of frames submitted when it was retired, and is destroyed once that many frames
+// have completed on the GPU. This replaces vkDeviceWaitIdle when replacing resources at runtime (e.g. swap chain recreation).
+class VulkanDeletionQueue
+{
+public:
+    VulkanDeletionQueue();
+    ~VulkanDeletionQueue();
+
+    void push(const uint64_t submittedFrameCount, std::function<void()> &&deleter);
+
+    // Runs the deleters of every entry whose frames have all completed
+    void flush(const uint64_t completedFrameCount);
+
+    // Runs every deleter (the device must be idle)
+    void flushAll();
+
+    bool isEmpty() const { return m_entries.empty(); }
+
+private:
+    struct Entry
+    {
+        uint64_t m_submittedFrameCount;
+        std::function<void()> m_deleter;
+    };
+
+    std::deque<Entry> m_entries; // Ordered by m_submittedFrameCount
+};
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "VulkanMemoryAllocator.hpp"
+#include "VulkanPipelineLayoutCache.hpp"
+#include "VulkanShaderModuleCache.hpp"
+
 #include <vulkan/vulkan.h>
 #include <optional>
 #include <vector>
@@ -8,12 +12,27 @@ struct QueueFamilyIndices
 {
     std::optional<uint32_t> m_graphicsFamily;
     std::optional<uint32_t> m_presentFamily;
-    bool isComplete()
+    // Transfer-only (DMA) family if the device has one, otherwise a transfer capable family without graphics. Optional
+    std::optional<uint32_t> m_transferFamily;
+    // Compute family without graphics (async compute), runs alongside the graphics queue. Optional
+    std::optional<uint32_t> m_computeFamily;
+    // Headless rendering has no surface to present to, so a present family is not required
+    bool isComplete(const bool requirePresent = true)
     {
-        return m_graphicsFamily.has_value() && m_presentFamily.has_value();
+        return m_graphicsFamily.has_value() && (m_presentFamily.has_value() || !requirePresent);
     }
 };
 
+// Pipeline states the device can set at record time (VK_EXT_extended_dynamic_state, 2 and 3). The extensions are optional:
+// they are enabled when supported, and only the features used by the renderer are checked
+struct VulkanExtendedDynamicStateSupport
+{
+    bool m_extendedDynamicState = false;  // Cull mode, front face, depth test/write/compare op
+    bool m_extendedDynamicState2 = false; // Depth bias enable, rasterizer discard enable, primitive restart enable
+    bool m_polygonMode = false;           // Polygon mode (extended dynamic state 3)
+};
+
+// If surface is VK_NULL_HANDLE (headless) present support is not queried
 QueueFamilyIndices findQueueFamilies(const VkPhysicalDevice &physicalDevice, const VkSurfaceKHR &surface);
 
 class VulkanValidationLayer;
@@ -31,14 +50,79 @@ public:
 
     VkPhysicalDevice getPhysicalDevice() const { return m_physicalDevice; }
     VkDevice getDevice() const { return m_device; }
+    const VkPhysicalDeviceProperties &getPhysicalDeviceProperties() const { return m_physicalDeviceProperties; }
+    const QueueFamilyIndices &getQueueFamilyIndices() const { return m_queueFamilyIndices; }
+    VkQueue getGraphicsQueue() const { return m_graphicsQueue; }
+    VkQueue getPresentQueue() const { return m_presentQueue; }
+    // Queue for uploads: the dedicated transfer queue if there is one, otherwise the graphics queue
+    VkQueue getTransferQueue() const { return m_transferQueue; }
+    uint32_t getTransferQueueFamily() const { return m_queueFamilyIndices.m_transferFamily.value_or(m_queueFamilyIndices.m_graphicsFamily.value()); }
+    bool hasDedicatedTransferQueue() const { return m_queueFamilyIndices.m_transferFamily.has_value(); }
+    // Queue for compute work: the async compute queue if there is one, otherwise the graphics queue
+    VkQueue getComputeQueue() const { return m_computeQueue; }
+    uint32_t getComputeQueueFamily() const { return m_queueFamilyIndices.m_computeFamily.value_or(m_queueFamilyIndices.m_graphicsFamily.value()); }
+    bool hasAsyncComputeQueue() const { return m_queueFamilyIndices.m_computeFamily.has_value(); }
+
+    // Vulkan 1.2 timeline semaphores (not available on 1.0/1.1 devices)
+    bool supportsTimelineSemaphores() const { return m_supportsTimelineSemaphores; }
+    const VulkanExtendedDynamicStateSupport &getExtendedDynamicStateSupport() const { return m_extendedDynamicStateSupport; }
+    // Line and point polygon modes (wireframe)
+    bool supportsFillModeNonSolid() const { return m_supportsFillModeNonSolid; }
+    // Optional shader stages, enabled when the device has them (see Shader and VulkanGraphicsPipeline)
+    bool supportsTessellationShader() const { return m_supportsTessellationShader; }
+    bool supportsGeometryShader() const { return m_supportsGeometryShader; }
+    // VK_EXT_mesh_shader: mesh shaders, and task shaders in front of them
+    bool supportsMeshShader() const { return m_supportsMeshShader; }
+    bool supportsTaskShader() const { return m_supportsTaskShader; }
+    // VK_KHR_dynamic_rendering: drawing into image views without render pass and framebuffer objects
+    bool supportsDynamicRendering() const { return m_supportsDynamicRendering; }
+
+    // True if the graphics queue can write timestamps (used to measure GPU frame time)
+    bool supportsGraphicsTimestamps() const;
+
+    // Find a memory type matching the resource requirements (typeFilter) and the desired properties
+    uint32_t findMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags properties) const;
+    // Same as above, but prefers a memory type that also has the preferred properties (e.g. HOST_CACHED for readback)
+    uint32_t findMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags required, const VkMemoryPropertyFlags preferred) const;
+    const VkPhysicalDeviceMemoryProperties &getMemoryProperties() const { return m_memoryProperties; }
+
+    // Sub-allocates buffer and image memory from large blocks. Available once the logical device is created
+    VulkanMemoryAllocator &getMemoryAllocator() { return m_memoryAllocator; }
+    const VulkanMemoryAllocator &getMemoryAllocator() const { return m_memoryAllocator; }
+    // One shader module per SPIR-V binary. Available once the logical device is created
+    VulkanShaderModuleCache &getShaderModuleCache() { return m_shaderModuleCache; }
+    const VulkanShaderModuleCache &getShaderModuleCache() const { return m_shaderModuleCache; }
+    // Pipeline layouts built from shader reflection, one per distinct interface
+    VulkanPipelineLayoutCache &getPipelineLayoutCache() { return m_pipelineLayoutCache; }
+    const VulkanPipelineLayoutCache &getPipelineLayoutCache() const { return m_pipelineLayoutCache; }
+
+    // Headless devices are created without a surface: no present queue and no swap chain extension
+    bool isHeadless() const { return m_headless; }
 
 private:
     VkDevice m_device;
     VkPhysicalDevice m_physicalDevice;
+    VkPhysicalDeviceProperties m_physicalDeviceProperties{};
+    VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+    bool m_headless;
+    bool m_supportsTimelineSemaphores;
+    bool m_supportsFillModeNonSolid;
+    bool m_supportsTessellationShader;
+    bool m_supportsGeometryShader;
+    bool m_supportsMeshShader;
+    bool m_supportsTaskShader;
+    bool m_supportsDynamicRendering;
+    VulkanExtendedDynamicStateSupport m_extendedDynamicStateSupport;
+    VulkanMemoryAllocator m_memoryAllocator;
+    VulkanShaderModuleCache m_shaderModuleCache;
+    VulkanPipelineLayoutCache m_pipelineLayoutCache;
 
     // Queue Family
+    QueueFamilyIndices m_queueFamilyIndices;
     VkQueue m_graphicsQueue;
     VkQueue m_presentQueue;
+    VkQueue m_transferQueue;
+    VkQueue m_computeQueue;
 
     const std::vector<const char *> m_deviceExtensions = {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME,
@@ -47,6 +131,11 @@ private:
 #endif
     };
 
+    // Supported optional extensions, enabled with the required ones
+    std::vector<const char *> m_optionalExtensions;
+
+    std::vector<const char *> getRequiredDeviceExtensions() const;
+    void queryOptionalFeatures();
     bool checkDeviceExtensionSupport(const VkPhysicalDevice &physicalDevice);
 
     int rateDeviceSuitability(const VkPhysicalDevice &device, const VkSurfaceKHR &surface);
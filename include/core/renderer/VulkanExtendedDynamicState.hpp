@@ -0,0 +1,48 @@
+#pragma once
+
+#include "VulkanPipelineState.hpp"
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+class VulkanDevice;
+
+// Leaves the fixed function states the device can set at record time (VK_EXT_extended_dynamic_state, 2 and 3) out of the
+// pipelines. States that only differ by cull mode, front face, depth test/write/compare op, depth bias/rasterizer discard/primitive
+// restart enables or polygon mode (e.g. the basic, shadow mapping, depth pre-pass and wireframe presets) then compile to a single
+// pipeline, and switching between them is a few vkCmdSet* calls instead of a pipeline bind.
+// Without the extensions (or when disabled) toPipelineState returns the state unchanged and record does nothing: every variant
+// is its own static pipeline, as before.
+class VulkanExtendedDynamicState
+{
+public:
+    VulkanExtendedDynamicState();
+    ~VulkanExtendedDynamicState();
+
+    void create(const VulkanDevice &vulkanDevice, const bool enable = true);
+
+    // The state to compile: the states set at record time are marked dynamic and reset to their default value
+    VulkanPipelineState toPipelineState(const VulkanPipelineState &state) const;
+    // Sets the states left dynamic by toPipelineState to the values of state. Call after binding the pipeline
+    void record(VkCommandBuffer commandBuffer, const VulkanPipelineState &state) const;
+
+    bool isEnabled() const { return m_dynamicStates != 0; }
+    // Bits of DYNAMIC_STATES set at record time
+    uint32_t getDynamicStates() const { return m_dynamicStates; }
+
+private:
+    uint32_t m_dynamicStates;
+
+    // Extension commands are not exported by the loader: they are fetched from the device
+    PFN_vkCmdSetCullModeEXT m_cmdSetCullMode;
+    PFN_vkCmdSetFrontFaceEXT m_cmdSetFrontFace;
+    PFN_vkCmdSetDepthTestEnableEXT m_cmdSetDepthTestEnable;
+    PFN_vkCmdSetDepthWriteEnableEXT m_cmdSetDepthWriteEnable;
+    PFN_vkCmdSetDepthCompareOpEXT m_cmdSetDepthCompareOp;
+    PFN_vkCmdSetDepthBiasEnableEXT m_cmdSetDepthBiasEnable;
+    PFN_vkCmdSetRasterizerDiscardEnableEXT m_cmdSetRasterizerDiscardEnable;
+    PFN_vkCmdSetPrimitiveRestartEnableEXT m_cmdSetPrimitiveRestartEnable;
+    PFN_vkCmdSetPolygonModeEXT m_cmdSetPolygonMode;
+
+    bool isDynamic(const VkDynamicState state) const { return (m_dynamicStates & dynamicStateBit(state)) != 0; }
+};
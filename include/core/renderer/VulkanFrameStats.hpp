@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+// Timings of a single frame, used to tell whether the application is CPU- or GPU-bound.
+// If the CPU spends most of the frame waiting (fence/acquire) the GPU is the bottleneck, otherwise the CPU is.
+struct VulkanFrameStats
+{
+    uint64_t m_frameNumber = 0;
+    double m_pacingWaitMs = 0.0;  // CPU blocked by frame pacing, before input was sampled (0 if pacing is disabled)
+    double m_fenceWaitMs = 0.0;   // CPU blocked waiting for the GPU to release the frame slot
+    double m_acquireWaitMs = 0.0; // CPU blocked acquiring a swap chain image
+    double m_cpuWorkMs = 0.0;     // CPU time spent recording, submitting and presenting
+    double m_gpuTimeMs = 0.0;     // GPU execution time of the frame's command buffer (0 if timestamps are unsupported)
+};
@@ -21,7 +21,10 @@ public:
     VkExtent2D getExtent() const { return m_extent; }
 
     // Framebuffer Resizing
-    void resize(VkRenderPass renderPass, const std::vector<VkImageView> &attachments, VkExtent2D newExtent, uint32_t layers = 1);
+    // The previous framebuffer may still be referenced by frames in flight, so it is not destroyed here: it is returned
+    // (VK_NULL_HANDLE if nothing changed) and the caller destroys it with destroyRetired once those frames have completed.
+    VkFramebuffer resize(VkRenderPass renderPass, const std::vector<VkImageView> &attachments, VkExtent2D newExtent, uint32_t layers = 1);
+    static void destroyRetired(VkDevice device, VkFramebuffer framebuffer);
 
     void cleanUp();
 
@@ -31,4 +34,5 @@ private:
     VkDevice m_device;
     VkFramebuffer m_framebuffer;
     VkExtent2D m_extent{};
+    std::vector<VkImageView> m_attachments;
 };
\ No newline at end of file
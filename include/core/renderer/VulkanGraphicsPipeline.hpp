@@ -4,17 +4,34 @@
 #include <vector>
 #include <memory>
 
-class VulkanGraphicsPipelineConfig;
+struct VulkanPipelineState;
 
 class Shader;
 
+// What a graphics pipeline draws into: a subpass of a render pass or, with dynamic rendering (VK_KHR_dynamic_rendering,
+// m_renderPass VK_NULL_HANDLE), the formats of the attachments bound by vkCmdBeginRendering
+struct VulkanPipelineTarget
+{
+    VkRenderPass m_renderPass = VK_NULL_HANDLE;
+    uint32_t m_subpass = 0;
+    // Dynamic rendering only
+    std::vector<VkFormat> m_colorFormats; // In the order of the fragment shader outputs
+    VkFormat m_depthFormat = VK_FORMAT_UNDEFINED;
+    VkFormat m_stencilFormat = VK_FORMAT_UNDEFINED;
+};
+
 class VulkanGraphicsPipeline
 {
 public:
     VulkanGraphicsPipeline();
     ~VulkanGraphicsPipeline();
 
-    void createPipeline(const VkDevice &device, const VulkanGraphicsPipelineConfig &configInfo, const Shader &shader, const VkRenderPass &renderPass, const uint32_t subpass = 0);
+    // The shader holds the stages: vertex and fragment, optionally tessellation (with a patch list state, see
+    // VulkanPipelinePresets::TESSELLATION) and geometry, or task and mesh. Throws std::runtime_error if they do not form a
+    // graphics pipeline. The layout is owned by the caller (see VulkanPipelineLayoutCache).
+    // viewportExtent is only used if the state's viewport and scissor are not dynamic
+    void createPipeline(const VkDevice &device, const VulkanPipelineState &state, const Shader &shader, const VkPipelineLayout &pipelineLayout,
+                        const VulkanPipelineTarget &target, const VkPipelineCache pipelineCache = VK_NULL_HANDLE, const VkExtent2D viewportExtent = {});
     void cleanUp();
 
     VkPipeline getPipeline() const { return m_graphicsPipeline; };
@@ -25,9 +42,9 @@ private:
     VkPipeline m_graphicsPipeline;
     VkPipelineLayout m_pipelineLayout;
 
-    std::vector<VkPipelineShaderStageCreateInfo> m_shaderStages;
+    std::vector<VkPipelineShaderStageCreateInfo> m_shaderStages; // Point into the shader: only used while creating the pipeline
 
-    void createPipelineLayout();
-    void createGraphicsPipeline(const VulkanGraphicsPipelineConfig &configInfo, const VkRenderPass &renderPass, const uint32_t subpass);
-    void setShaderStages(const Shader &shader);
+    void createGraphicsPipeline(const VulkanPipelineState &state, const VulkanPipelineTarget &target, const VkPipelineCache pipelineCache,
+                                const VkExtent2D viewportExtent);
+    void setShaderStages(const Shader &shader, const VulkanPipelineState &state);
 };
@@ -11,7 +11,8 @@ public:
     VulkanInstance();
     ~VulkanInstance();
 
-    void createInstance(const VulkanValidationLayer &vulkanValidationLayer);
+    // Headless instances do not enable any window-system (GLFW/surface) extensions
+    void createInstance(const VulkanValidationLayer &vulkanValidationLayer, const bool headless = false);
     void cleanUp();
 
     VkInstance getInstance() const { return m_instance; };
@@ -19,6 +20,6 @@ public:
 private:
     VkInstance m_instance;
 
-    std::vector<const char *> getRequiredGlfwExtensions(const bool isValidationLayersEnabled);
+    std::vector<const char *> getRequiredGlfwExtensions(const bool isValidationLayersEnabled, const bool headless);
     bool checkGlfwExtensionsSupport(const std::vector<const char *> &glfwRequiredExtensions);
 };
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "VulkanBlockMetadata.hpp"
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+class VulkanDevice;
+
+// One VkDeviceMemory, either a block shared by many sub-allocations or a dedicated allocation for a single large resource
+struct VulkanMemoryBlock
+{
+    VkDeviceMemory m_memory = VK_NULL_HANDLE;
+    VkDeviceSize m_size = 0;
+    uint32_t m_memoryTypeIndex = 0;
+    std::byte *m_mapped = nullptr;                  // Persistently mapped if the memory type is HOST_VISIBLE
+    std::unique_ptr<VulkanBlockMetadata> m_metadata; // nullptr for dedicated allocations
+};
+
+// A range of device memory handed out by VulkanMemoryAllocator. Bind with (m_memory, m_offset)
+struct VulkanAllocation
+{
+    VkDeviceMemory m_memory = VK_NULL_HANDLE;
+    VkDeviceSize m_offset = 0;
+    VkDeviceSize m_size = 0;
+    uint32_t m_memoryTypeIndex = 0;
+    std::byte *m_mapped = nullptr; // Already offset to the allocation, nullptr if the memory is not HOST_VISIBLE
+    VulkanMemoryBlock *m_block = nullptr;
+
+    bool isValid() const { return m_memory != VK_NULL_HANDLE; }
+};
+
+// Fragmentation and usage of the allocator, to tell when memory is wasted by free ranges too small to be reused
+// (a defragmentation pass would only pay off if m_fragmentation stays high)
+struct VulkanMemoryStats
+{
+    uint32_t m_blockCount = 0;
+    uint32_t m_dedicatedAllocationCount = 0;
+    uint32_t m_allocationCount = 0; // Sub-allocations inside blocks
+    VkDeviceSize m_blockBytes = 0;
+    VkDeviceSize m_usedBytes = 0;
+    VkDeviceSize m_dedicatedBytes = 0;
+    uint32_t m_freeRangeCount = 0;
+    VkDeviceSize m_largestFreeRange = 0;
+    double m_fragmentation = 0.0; // 1 - largest free range / free bytes: 0 = all free memory is contiguous
+};
+
+// Allocates device memory in large blocks per memory type and sub-allocates resources from them (TLSF, see VulkanBlockMetadata),
+// instead of one vkAllocateMemory per resource: drivers only guarantee maxMemoryAllocationCount (as low as 4096) allocations
+// and each one is expensive. Resources larger than half a block get a dedicated allocation.
+// Owned by VulkanDevice, created with the logical device and destroyed before it.
+class VulkanMemoryAllocator
+{
+public:
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+    VulkanMemoryAllocator();
+    ~VulkanMemoryAllocator();
+
+    void create(const VulkanDevice &vulkanDevice, const VkDeviceSize preferredBlockSize = DEFAULT_BLOCK_SIZE);
+    void cleanUp();
+
+    // The memory type is chosen from required | preferred, falling back to required only
+    VulkanAllocation allocate(const VkMemoryRequirements &memoryRequirements, const VkMemoryPropertyFlags required, const VkMemoryPropertyFlags preferred,
+                              const VulkanAllocationType type);
+    // Allocates and binds the memory of the resource
+    VulkanAllocation allocateForBuffer(VkBuffer buffer, const VkMemoryPropertyFlags required, const VkMemoryPropertyFlags preferred = 0);
+    VulkanAllocation allocateForImage(VkImage image, const VkImageTiling tiling, const VkMemoryPropertyFlags required, const VkMemoryPropertyFlags preferred = 0);
+    // Resets the allocation. The resource bound to it must already be destroyed (or no longer used by the GPU)
+    void free(VulkanAllocation &allocation);
+
+    // Non-coherent memory: make host writes visible to the device / device writes visible to the host.
+    // The range is relative to the allocation and expanded to nonCoherentAtomSize as required
+    void flush(const VulkanAllocation &allocation, const VkDeviceSize offset = 0, const VkDeviceSize size = VK_WHOLE_SIZE) const;
+    void invalidate(const VulkanAllocation &allocation, const VkDeviceSize offset = 0, const VkDeviceSize size = VK_WHOLE_SIZE) const;
+    bool isCoherent(const VulkanAllocation &allocation) const;
+    // Memory of TRANSIENT_ATTACHMENT images that tile-based GPUs keep in tile memory, if the device has such a memory type
+    bool isLazilyAllocated(const VulkanAllocation &allocation) const;
+
+    VulkanMemoryStats getStats() const;
+
+private:
+    VkDevice m_device;
+    const VulkanDevice *m_vulkanDevice;
+    VkPhysicalDeviceMemoryProperties m_memoryProperties;
+    VkDeviceSize m_bufferImageGranularity;
+    VkDeviceSize m_nonCoherentAtomSize;
+    uint32_t m_maxMemoryAllocationCount;
+    uint32_t m_memoryAllocationCount;
+    VkDeviceSize m_preferredBlockSize;
+
+    std::array<std::vector<std::unique_ptr<VulkanMemoryBlock>>, VK_MAX_MEMORY_TYPES> m_blocks;
+    std::vector<std::unique_ptr<VulkanMemoryBlock>> m_dedicatedBlocks;
+
+    VkDeviceSize getBlockSize(const uint32_t memoryTypeIndex) const;
+    bool isCoherentMemoryType(const uint32_t memoryTypeIndex) const;
+    bool isLazilyAllocatedMemoryType(const uint32_t memoryTypeIndex) const;
+    VkResult createBlock(const uint32_t memoryTypeIndex, const VkDeviceSize size, const bool dedicated, VulkanMemoryBlock *&block);
+    void destroyBlock(VulkanMemoryBlock &block);
+    VkMappedMemoryRange getMappedRange(const VulkanAllocation &allocation, const VkDeviceSize offset, const VkDeviceSize size) const;
+};
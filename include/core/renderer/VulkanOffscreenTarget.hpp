@@ -0,0 +1,38 @@
+#pragma once
+
+#include "VulkanMemoryAllocator.hpp"
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+class VulkanDevice;
+
+// Device-local color images used instead of swap chain images when rendering headless (no window, no surface).
+// One image per frame in flight so consecutive frames never write to the same image.
+class VulkanOffscreenTarget
+{
+public:
+    VulkanOffscreenTarget();
+    ~VulkanOffscreenTarget();
+
+    void createImages(VulkanDevice &vulkanDevice, const VkFormat format, const VkExtent2D extent, const uint32_t imageCount);
+    void cleanUp();
+
+    VkFormat getFormat() const { return m_format; }
+    VkExtent2D getExtent() const { return m_extent; }
+    const std::vector<VkImage> &getImages() const { return m_images; }
+    const std::vector<VkImageView> &getImageViews() const { return m_imageViews; }
+
+private:
+    VkDevice m_device;
+    VulkanMemoryAllocator *m_memoryAllocator;
+    VkFormat m_format;
+    VkExtent2D m_extent;
+
+    std::vector<VkImage> m_images;
+    std::vector<VulkanAllocation> m_imageAllocations;
+    std::vector<VkImageView> m_imageViews;
+
+    void createImage(const uint32_t index);
+    void createImageView(const uint32_t index);
+};
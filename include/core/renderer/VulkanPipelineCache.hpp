@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct VulkanPipelineCacheStats
+{
+    bool m_loadedFromDisk = false;  // Warm start: a valid cache for this device and driver was found
+    std::string m_rejectReason;     // Why the file on disk was not used (empty if loaded or absent)
+    size_t m_loadedBytes = 0;
+    size_t m_savedBytes = 0;
+    uint32_t m_mergedWorkerCaches = 0;
+};
+
+// VkPipelineCache persisted to disk between runs, so pipelines compiled once are not compiled again on the next launch.
+// The driver's cache data is only reused if its header matches this device (vendor ID, device ID and pipelineCacheUUID, which
+// changes with the driver version); a stale or corrupted file is ignored and overwritten.
+// Worker threads compiling pipelines use their own cache (no lock contention inside the driver) which is merged back here.
+// The file is written atomically: data goes to a temporary file which is renamed over the old one, so a crash while saving
+// never leaves a truncated cache behind.
+class VulkanPipelineCache
+{
+public:
+    VulkanPipelineCache();
+    ~VulkanPipelineCache();
+
+    // filePath may be empty: the cache then only lives for this run
+    void createPipelineCache(const VkDevice &device, const VkPhysicalDeviceProperties &physicalDeviceProperties, const std::string &filePath);
+    // Writes the cache back to its file (no-op without a file). Call at shutdown, once no pipeline is being created
+    void save();
+    void cleanUp();
+
+    VkPipelineCache getPipelineCache() const { return m_pipelineCache; }
+
+    // Thread-safe. Each worker thread gets its own cache, seeded with the main cache's data, and merges it back
+    // (which destroys it) when done. createWorkerCache throws std::runtime_error; a failed merge is reported and the
+    // worker cache dropped
+    VkPipelineCache createWorkerCache();
+    void mergeWorkerCache(VkPipelineCache workerCache);
+
+    const VulkanPipelineCacheStats &getStats() const { return m_stats; }
+
+    // FNV-1a (fnv1a64), used to detect damaged files
+    static uint64_t computeChecksum(const std::byte *data, const size_t size);
+
+private:
+    // Prepended to the driver's data to detect truncated or corrupted files, which drivers do not reliably reject
+    struct FileHeader
+    {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint64_t m_dataSize;
+        uint64_t m_checksum;
+    };
+
+    static constexpr uint32_t FILE_MAGIC = 0x43504B56; // "VKPC"
+    static constexpr uint32_t FILE_VERSION = 1;
+
+    VkDevice m_device;
+    VkPhysicalDeviceProperties m_physicalDeviceProperties;
+    std::string m_filePath;
+    VkPipelineCache m_pipelineCache;
+    std::mutex m_mutex;
+    VulkanPipelineCacheStats m_stats;
+
+    std::vector<std::byte> loadFile();
+    bool isCompatible(const std::vector<std::byte> &data);
+    VkPipelineCache createCache(const std::vector<std::byte> &initialData);
+};
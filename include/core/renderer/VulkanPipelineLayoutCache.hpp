@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct ShaderReflection;
+
+// A pipeline layout and the descriptor set layouts it was created from, owned by the pipeline layout cache
+struct VulkanPipelineLayout
+{
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSetLayout> m_setLayouts; // Indexed by set number. Sets no stage uses get an empty layout
+    std::optional<VkPushConstantRange> m_pushConstantRange;
+};
+
+struct VulkanPipelineLayoutCacheStats
+{
+    uint64_t m_requestCount = 0;
+    uint32_t m_setLayoutCount = 0;      // Distinct descriptor set layouts created
+    uint32_t m_pipelineLayoutCount = 0; // Distinct pipeline layouts created
+};
+
+// Builds pipeline layouts from shader reflection instead of hand-written layouts, and creates each distinct layout once.
+// Pipelines whose shaders declare the same interface get the same VkPipelineLayout, and identical sets the same
+// VkDescriptorSetLayout across pipeline layouts: descriptor sets bound for one pipeline stay valid for the next (pipeline
+// layout compatibility), so fewer sets are rebound between draws. The cache owns the layouts until cleanUp.
+// Thread-safe: the pipeline registry requests layouts from its worker threads.
+class VulkanPipelineLayoutCache
+{
+public:
+    VulkanPipelineLayoutCache();
+    ~VulkanPipelineLayoutCache();
+
+    void createCache(const VkDevice &device);
+    // Destroys every layout: no pipeline using them may remain
+    void cleanUp();
+
+    // The layout of a pipeline whose stages were merged into reflection. The reference stays valid until cleanUp.
+    // Throws std::runtime_error if a layout cannot be created (or the shader uses runtime descriptor arrays, not supported)
+    const VulkanPipelineLayout &getPipelineLayout(const ShaderReflection &reflection);
+
+    VulkanPipelineLayoutCacheStats getStats() const;
+
+private:
+    VkDevice m_device;
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, VkDescriptorSetLayout> m_setLayouts;      // Keyed by the serialized bindings
+    std::map<std::string, VulkanPipelineLayout> m_pipelineLayouts; // Keyed by the serialized bindings and push constant range
+    VulkanPipelineLayoutCacheStats m_stats;
+
+    VkDescriptorSetLayout getSetLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings);
+};
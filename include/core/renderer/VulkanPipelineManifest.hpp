@@ -0,0 +1,62 @@
+#pragma once
+
+#include "VulkanPipelineRegistry.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+struct VulkanPipelineManifestStats
+{
+    uint32_t m_loadedCount = 0;   // Pipelines used by the previous session
+    uint32_t m_recordedCount = 0; // Distinct pipelines requested by this session
+    std::string m_rejectReason;   // Why the file on disk was not used (empty if loaded or absent)
+};
+
+// The list of pipelines a session actually requested, saved at exit so the next launch can compile them in the background
+// before they are first drawn (see VulkanPipelineRegistry::prewarmPipeline). Together with the pipeline cache, this turns
+// the hitch of a pipeline's first use into background work.
+// Each entry holds what identifies a pipeline across runs: state, static viewport extent, subpass, shader stages and
+// specialization. Render pass handles are not persistent: loaded requests have no target, the renderer sets its own.
+// record() is not thread-safe: the pipeline registry calls it under its lock.
+class VulkanPipelineManifest
+{
+public:
+    VulkanPipelineManifest();
+    ~VulkanPipelineManifest();
+
+    // filePath may be empty: nothing is loaded nor saved
+    void load(const std::string &filePath);
+    // Writes the pipelines recorded this session (no-op without a file), atomically like the pipeline cache
+    void save();
+
+    void record(const VulkanPipelineRequest &request);
+
+    const std::vector<VulkanPipelineRequest> &getLoadedRequests() const { return m_loadedRequests; }
+    const VulkanPipelineManifestStats &getStats() const { return m_stats; }
+
+private:
+    struct FileHeader
+    {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint32_t m_entryCount;
+        uint32_t m_reserved;
+        uint64_t m_dataSize;
+        uint64_t m_checksum;
+    };
+
+    static constexpr uint32_t FILE_MAGIC = 0x4D504B56; // "VKPM"
+    static constexpr uint32_t FILE_VERSION = 3; // 2: entries end with the shader specialization, 3: any set of shader stages
+
+    std::string m_filePath;
+    std::vector<VulkanPipelineRequest> m_loadedRequests;
+    std::vector<std::string> m_recordedEntries;         // Serialized entries, in the order they were first requested
+    std::unordered_set<std::string> m_recordedEntrySet;
+    VulkanPipelineManifestStats m_stats;
+
+    static std::string serialize(const VulkanPipelineRequest &request);
+    static bool deserialize(const std::byte *&data, const std::byte *end, VulkanPipelineRequest &request);
+};
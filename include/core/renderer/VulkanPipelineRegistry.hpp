@@ -0,0 +1,136 @@
+#pragma once
+
+#include "VulkanGraphicsPipeline.hpp"
+#include "VulkanPipelineState.hpp"
+#include "graphics/Shader.hpp"
+
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class VulkanPipelineCache;
+class VulkanDevice;
+class VulkanPipelineLayoutCache;
+class VulkanPipelineManifest;
+class VulkanShaderModuleCache;
+
+// Everything that determines a graphics pipeline
+struct VulkanPipelineRequest
+{
+    VulkanPipelineState m_state;
+    VkExtent2D m_viewportExtent{}; // Only part of the pipeline if the state's viewport or scissor is not dynamic
+    std::vector<ShaderStageSource> m_shaderStages;
+    ShaderSpecialization m_specialization; // Permutation of the shaders: each distinct set of values is its own pipeline
+    VulkanPipelineTarget m_target; // Render pass and subpass, or attachment formats with dynamic rendering
+};
+
+// Resolves to the compiled pipeline (owned by the registry), or rethrows the compilation error on get()
+using VulkanPipelineHandle = std::shared_future<const VulkanGraphicsPipeline *>;
+
+struct VulkanPipelineRegistryStats
+{
+    uint32_t m_workerCount = 0;
+    uint64_t m_requestCount = 0;
+    uint64_t m_deduplicatedCount = 0; // Requests answered by an existing (or in progress) pipeline
+    uint64_t m_compiledCount = 0;
+    uint64_t m_failedCount = 0;
+    uint64_t m_prewarmCount = 0;      // Pre-warm requests that started a compilation
+    uint64_t m_prewarmHitCount = 0;   // Requests answered by a pipeline a pre-warm request had started
+    uint64_t m_rebuiltCount = 0;      // Pipelines recompiled because their shaders changed (hot reload)
+    double m_compileMs = 0.0;         // Summed over the workers: compare with the wall time to see the parallel speedup
+};
+
+// Compiles graphics pipelines on a pool of worker threads. Each request is reduced to a key holding every value that affects
+// the pipeline (fixed function state, shader stages and specialization, render pass and subpass or attachment formats): identical requests share one pipeline and are
+// compiled once. Requests never block, the caller waits on the returned handle only when it needs the pipeline.
+// Each worker compiles into its own pipeline cache (no contention in the driver), merged back into the main one at cleanUp.
+// Pre-warm requests (pipelines expected to be needed soon, e.g. from the manifest of the previous session) are only compiled
+// when no regular request is waiting; a regular request for a pre-warm pipeline still queued moves it to the regular queue.
+class VulkanPipelineRegistry
+{
+public:
+    VulkanPipelineRegistry();
+    ~VulkanPipelineRegistry();
+
+    // workerCount 0 uses one worker per hardware thread. Regular requests are recorded to the manifest, if there is one
+    // Shader modules and pipeline layouts come from the device's caches
+    void createRegistry(VulkanDevice &vulkanDevice, VulkanPipelineCache &pipelineCache, const uint32_t workerCount = 0,
+                        VulkanPipelineManifest *manifest = nullptr);
+    // Waits for the pending compilations, merges the worker caches and destroys every pipeline. The device must be idle
+    void cleanUp();
+
+    VulkanPipelineHandle requestPipeline(const VulkanPipelineRequest &request);
+    // Compiles the pipeline in the background, at low priority. Not recorded to the manifest
+    void prewarmPipeline(const VulkanPipelineRequest &request);
+    static bool isReady(const VulkanPipelineHandle &handle) { return handle.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+    // Blocks until every requested pipeline has been compiled
+    void waitIdle();
+
+    // Recompiles every pipeline using one of the shader files (hot reload). From now on their requests get the new pipelines;
+    // the previous ones are retired, still valid for the frames drawing with them, until releaseRetiredPipelines is called
+    // with the returned serial (or cleanUp)
+    uint64_t rebuildPipelines(const std::vector<std::string> &changedShaderPaths);
+    // Retires every pipeline, e.g. when the render passes they were created against are recreated: requests compile new ones.
+    // Release them with releaseRetiredPipelines and the returned serial
+    uint64_t retireAllPipelines();
+    // Destroys the pipelines retired by that rebuild. No frame in flight may use them any more
+    void releaseRetiredPipelines(const uint64_t retireSerial);
+
+    VulkanPipelineRegistryStats getStats() const;
+
+private:
+    struct Entry
+    {
+        VulkanPipelineRequest m_request;
+        std::unique_ptr<VulkanGraphicsPipeline> m_pipeline;
+        VulkanPipelineHandle m_handle;
+        bool m_isPrewarm = false;
+    };
+
+    struct RetiredPipeline
+    {
+        uint64_t m_retireSerial;
+        std::unique_ptr<VulkanGraphicsPipeline> m_pipeline;
+        VulkanPipelineHandle m_handle; // May still be compiling when retired
+    };
+
+    struct Job
+    {
+        const Entry *m_entry;
+        std::function<void(VkPipelineCache)> m_compile;
+    };
+
+    VkDevice m_device;
+    VulkanShaderModuleCache *m_shaderModuleCache;
+    VulkanPipelineLayoutCache *m_pipelineLayoutCache;
+    VulkanPipelineCache *m_pipelineCache;
+    VulkanPipelineManifest *m_manifest;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    std::condition_variable m_idle;
+    std::deque<Job> m_jobs;
+    std::deque<Job> m_prewarmJobs;
+    uint32_t m_activeJobCount;
+    bool m_isStopping;
+    std::vector<std::thread> m_workers;
+
+    std::unordered_map<std::string, Entry> m_entries; // Keyed by the serialized request
+    std::vector<RetiredPipeline> m_retiredPipelines;
+    uint64_t m_retireSerial;
+    VulkanPipelineRegistryStats m_stats;
+
+    void workerLoop(VkPipelineCache workerCache);
+    Entry &addEntry(std::string key, const VulkanPipelineRequest &request, std::deque<Job> &jobs);
+    static std::string makeKey(const VulkanPipelineRequest &request);
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+// Dynamic states a pipeline state can leave to the command buffer. Bit i of VulkanPipelineState::m_dynamicStates is DYNAMIC_STATES[i]
+inline constexpr VkDynamicState DYNAMIC_STATES[] = {
+    VK_DYNAMIC_STATE_VIEWPORT,
+    VK_DYNAMIC_STATE_SCISSOR,
+    VK_DYNAMIC_STATE_LINE_WIDTH,
+    VK_DYNAMIC_STATE_DEPTH_BIAS,
+    VK_DYNAMIC_STATE_BLEND_CONSTANTS,
+    VK_DYNAMIC_STATE_DEPTH_BOUNDS,
+    VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK,
+    VK_DYNAMIC_STATE_STENCIL_WRITE_MASK,
+    VK_DYNAMIC_STATE_STENCIL_REFERENCE,
+    // VK_EXT_extended_dynamic_state
+    VK_DYNAMIC_STATE_CULL_MODE_EXT,
+    VK_DYNAMIC_STATE_FRONT_FACE_EXT,
+    VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT,
+    VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT,
+    VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT,
+    // VK_EXT_extended_dynamic_state2
+    VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT,
+    VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT,
+    VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT,
+    // VK_EXT_extended_dynamic_state3
+    VK_DYNAMIC_STATE_POLYGON_MODE_EXT,
+};
+static_assert(std::size(DYNAMIC_STATES) <= 32);
+
+constexpr uint32_t dynamicStateBit(const VkDynamicState state)
+{
+    for (uint32_t i = 0; i < std::size(DYNAMIC_STATES); i++)
+    {
+        if (DYNAMIC_STATES[i] == state)
+        {
+            return 1u << i;
+        }
+    }
+    return 0;
+}
+
+// The fixed function state of a graphics pipeline, packed into 16 bytes of bitfields. Unlike the Vk*CreateInfo structures it
+// holds no pointers: it can be copied freely, compared, sorted and hashed, and used as (part of) a pipeline key.
+// Enumerations are stored as their Vulkan values (only the core values fit), booleans as 0/1. The default state is the basic
+// opaque pipeline; see VulkanPipelinePresets for the others. Expand it with VulkanPipelineStateCreateInfo to create a pipeline.
+// Not part of the state: vertex input (the shaders generate or fetch their vertices), line width (1.0, wide lines are not
+// enabled), depth bias factors (set them with vkCmdSetDepthBias), stencil and depth bounds tests (disabled).
+struct VulkanPipelineState
+{
+    static constexpr uint32_t MAX_COLOR_ATTACHMENTS = 8;
+
+    // Input assembly, rasterization, multisample and depth
+    uint32_t m_topology : 4 = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    uint32_t m_primitiveRestartEnable : 1 = 0;
+    uint32_t m_polygonMode : 2 = VK_POLYGON_MODE_FILL;
+    uint32_t m_cullMode : 2 = VK_CULL_MODE_BACK_BIT;
+    uint32_t m_frontFace : 1 = VK_FRONT_FACE_CLOCKWISE;
+    uint32_t m_depthClampEnable : 1 = 0;
+    uint32_t m_rasterizerDiscardEnable : 1 = 0;
+    uint32_t m_depthBiasEnable : 1 = 0;
+    uint32_t m_rasterizationSamples : 7 = VK_SAMPLE_COUNT_1_BIT;
+    uint32_t m_sampleShadingEnable : 1 = 0;
+    uint32_t m_alphaToCoverageEnable : 1 = 0;
+    uint32_t m_depthTestEnable : 1 = 1;
+    uint32_t m_depthWriteEnable : 1 = 1;
+    uint32_t m_depthCompareOp : 3 = VK_COMPARE_OP_LESS;
+    uint32_t m_reserved0 : 5 = 0;
+
+    // Color blend, the same for every color attachment
+    uint32_t m_blendEnable : 1 = 0;
+    uint32_t m_srcColorBlendFactor : 5 = VK_BLEND_FACTOR_ZERO;
+    uint32_t m_dstColorBlendFactor : 5 = VK_BLEND_FACTOR_ZERO;
+    uint32_t m_colorBlendOp : 3 = VK_BLEND_OP_ADD;
+    uint32_t m_srcAlphaBlendFactor : 5 = VK_BLEND_FACTOR_ZERO;
+    uint32_t m_dstAlphaBlendFactor : 5 = VK_BLEND_FACTOR_ZERO;
+    uint32_t m_alphaBlendOp : 3 = VK_BLEND_OP_ADD;
+    uint32_t m_colorWriteMask : 4 = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    uint32_t m_logicOpEnable : 1 = 0;
+
+    uint32_t m_logicOp : 4 = VK_LOGIC_OP_COPY;
+    uint32_t m_minSampleShadingPercent : 7 = 0;
+    uint32_t m_patchControlPoints : 6 = 0; // 0: no tessellation
+    uint32_t m_colorAttachmentCount : 4 = 1; // At most MAX_COLOR_ATTACHMENTS, checked by VulkanPipelineStateCreateInfo
+    uint32_t m_reserved1 : 11 = 0;
+
+    // Bits of DYNAMIC_STATES
+    uint32_t m_dynamicStates = dynamicStateBit(VK_DYNAMIC_STATE_VIEWPORT) | dynamicStateBit(VK_DYNAMIC_STATE_SCISSOR);
+
+    constexpr bool hasDynamicState(const VkDynamicState state) const { return (m_dynamicStates & dynamicStateBit(state)) != 0; }
+
+    // Member by member, in declaration order: cheap enough to sort draws by state
+    constexpr auto operator<=>(const VulkanPipelineState &) const = default;
+};
+
+// Every bit is a named member, so the bytes of equal states are equal: they can be hashed and used as a key as they are
+static_assert(sizeof(VulkanPipelineState) == 16);
+static_assert(VulkanPipelineState::MAX_COLOR_ATTACHMENTS < (1u << 4)); // Fits m_colorAttachmentCount
+static_assert(std::is_trivially_copyable_v<VulkanPipelineState>);
+static_assert(std::has_unique_object_representations_v<VulkanPipelineState>);
+
+template <>
+struct std::hash<VulkanPipelineState>
+{
+    size_t operator()(const VulkanPipelineState &state) const noexcept
+    {
+        uint64_t words[2];
+        std::memcpy(words, &state, sizeof(words));
+        return static_cast<size_t>(words[0] * 0x9E3779B97F4A7C15ull ^ (words[1] + 0x632BE59BD9B4E019ull + (words[0] << 6) + (words[0] >> 2)));
+    }
+};
+
+// The create infos of a pipeline state, ready to be plugged into a VkGraphicsPipelineCreateInfo. They point into this object,
+// so it can be neither copied nor moved: expand the state where the pipeline is created.
+// viewportExtent sets the viewport and scissor when they are not dynamic states.
+class VulkanPipelineStateCreateInfo
+{
+public:
+    explicit VulkanPipelineStateCreateInfo(const VulkanPipelineState &state, const VkExtent2D viewportExtent = {});
+    VulkanPipelineStateCreateInfo(const VulkanPipelineStateCreateInfo &) = delete;
+    VulkanPipelineStateCreateInfo &operator=(const VulkanPipelineStateCreateInfo &) = delete;
+
+    // Sets every fixed function state pointer of pipelineInfo (stages, layout and render pass are left to the caller)
+    void fill(VkGraphicsPipelineCreateInfo &pipelineInfo) const;
+
+private:
+    VkPipelineVertexInputStateCreateInfo m_vertexInputInfo{};
+    VkPipelineInputAssemblyStateCreateInfo m_inputAssemblyInfo{};
+    VkPipelineTessellationStateCreateInfo m_tessellationInfo{};
+    VkViewport m_viewport{};
+    VkRect2D m_scissor{};
+    VkPipelineViewportStateCreateInfo m_viewportInfo{};
+    VkPipelineRasterizationStateCreateInfo m_rasterizationInfo{};
+    VkPipelineMultisampleStateCreateInfo m_multisampleInfo{};
+    VkPipelineDepthStencilStateCreateInfo m_depthStencilInfo{};
+    VkPipelineColorBlendAttachmentState m_colorBlendAttachments[VulkanPipelineState::MAX_COLOR_ATTACHMENTS]{};
+    VkPipelineColorBlendStateCreateInfo m_colorBlendInfo{};
+    VkDynamicState m_dynamicStates[std::size(DYNAMIC_STATES)]{};
+    VkPipelineDynamicStateCreateInfo m_dynamicStateInfo{};
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "VulkanMemoryAllocator.hpp"
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+class VulkanDevice;
+
+// A rendered frame whose pixels are available on the host.
+// m_pixels points straight into persistently mapped memory (no copy) and stays valid until the frame is released.
+struct VulkanReadbackFrame
+{
+    uint64_t m_frameNumber = 0;
+    VkExtent2D m_extent{};
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    uint32_t m_rowPitch = 0; // Bytes per row (rows are tightly packed)
+    std::span<const std::byte> m_pixels;
+    uint32_t m_slot = 0;
+};
+
+// Ring of host-visible, persistently mapped buffers that offscreen frames are copied into with vkCmdCopyImageToBuffer.
+// A copy is retired once the frame that recorded it is known to be complete (its fence signaled), so the render loop never
+// waits on readback. If the consumer falls behind and no slot is free the frame is not captured and counted as dropped.
+class VulkanReadbackRing
+{
+public:
+    VulkanReadbackRing();
+    ~VulkanReadbackRing();
+
+    void createRing(VulkanDevice &vulkanDevice, const VkExtent2D extent, const VkFormat format, const uint32_t slotCount);
+    void cleanUp();
+
+    // Records the copy of image (in TRANSFER_SRC_OPTIMAL layout) into the next free slot. Returns false if the ring is full
+    bool recordCopy(VkCommandBuffer commandBuffer, VkImage image, const uint64_t frameNumber);
+
+    // Frames are completed in submission order: every pending copy up to completedFrameNumber becomes ready
+    void retire(const uint64_t completedFrameNumber);
+
+    // Oldest ready frame, or nothing. The slot stays reserved for the caller until releaseFrame
+    std::optional<VulkanReadbackFrame> acquireFrame();
+    void releaseFrame(const VulkanReadbackFrame &frame);
+
+    bool isCreated() const { return !m_slots.empty(); }
+    uint64_t getCapturedFrameCount() const { return m_capturedFrameCount; }
+    uint64_t getDroppedFrameCount() const { return m_droppedFrameCount; }
+
+private:
+    enum class SlotState
+    {
+        FREE,    // Can be written by the next frame
+        PENDING, // Copy recorded, the GPU may still be writing it
+        READY,   // Copy complete, waiting for the consumer
+        ACQUIRED // Handed out to the consumer
+    };
+
+    struct Slot
+    {
+        VkBuffer m_buffer = VK_NULL_HANDLE;
+        VulkanAllocation m_allocation; // Persistently mapped
+        SlotState m_state = SlotState::FREE;
+        uint64_t m_frameNumber = 0;
+    };
+
+    VkDevice m_device;
+    VulkanMemoryAllocator *m_memoryAllocator;
+    VkExtent2D m_extent;
+    VkFormat m_format;
+    VkDeviceSize m_frameSize;
+
+    std::vector<Slot> m_slots;
+    uint32_t m_nextSlot;
+
+    uint64_t m_capturedFrameCount;
+    uint64_t m_droppedFrameCount;
+
+    void createSlot(Slot &slot);
+    void invalidate(const Slot &slot) const;
+};
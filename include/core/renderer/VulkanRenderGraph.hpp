@@ -0,0 +1,350 @@
+#pragma once
+
+#include "VulkanMemoryAllocator.hpp"
+#include "VulkanRenderPass.hpp"
+#include "VulkanFramebuffer.hpp"
+#include "VulkanGraphicsPipeline.hpp"
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class VulkanDevice;
+class VulkanRenderGraph;
+
+// An image created by the render graph, whose contents only live within a frame (G-buffer, shadow map, post-processing
+// target). Its usage flags follow from the passes accessing it. An image only used as an attachment within one render pass
+// (depth buffer, multisampled color resolved in the same pass, G-buffer read as input attachments by the lighting subpass)
+// is never loaded nor stored: it is created TRANSIENT_ATTACHMENT in lazily allocated memory, which tile-based GPUs never
+// back with main memory
+struct VulkanRenderGraphImageDescription
+{
+    VkFormat m_format = VK_FORMAT_R8G8B8A8_UNORM;
+    VkExtent2D m_extent = {0, 0}; // {0, 0}: the render extent, following resizes
+    VkSampleCountFlagBits m_samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+// An image owned outside of the graph (swap chain image, offscreen target), set every frame with setImportedImage.
+// The first access of the frame waits for m_initialStageMask / m_initialAccessMask (e.g. the stage the image-available
+// semaphore is waited on), and the image is transitioned to m_finalLayout after the last pass
+struct VulkanRenderGraphImageImport
+{
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    VkImageLayout m_initialLayout = VK_IMAGE_LAYOUT_UNDEFINED; // UNDEFINED: the previous contents are discarded
+    VkPipelineStageFlags m_initialStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    VkAccessFlags m_initialAccessMask = 0;
+    VkImageLayout m_finalLayout = VK_IMAGE_LAYOUT_UNDEFINED; // UNDEFINED: left in the layout of its last access
+    VkPipelineStageFlags m_finalStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    VkAccessFlags m_finalAccessMask = 0;
+};
+
+// What a pass's record callback can look up: the resources of the current frame and, in a pass with attachments, the
+// render pass and subpass it is recorded in (already begun, as is the rendering of a pass using dynamic rendering)
+struct VulkanRenderGraphPassContext
+{
+    const VulkanRenderGraph *m_graph = nullptr;
+    VkRenderPass m_renderPass = VK_NULL_HANDLE; // VK_NULL_HANDLE in passes without attachments or using dynamic rendering
+    uint32_t m_subpass = 0;
+    VkExtent2D m_extent = {0, 0};               // Of the attachments, or the render extent
+
+    VkImage getImage(const std::string &name) const;
+    VkImageView getImageView(const std::string &name) const;
+    VkBuffer getBuffer(const std::string &name) const;
+};
+
+// A pass of the render graph: the resources it reads and writes, and the callback recording its commands.
+// Declarations return the pass, so they chain
+class VulkanRenderGraphPass
+{
+public:
+    using RecordCallback = std::function<void(VkCommandBuffer commandBuffer, const VulkanRenderGraphPassContext &context)>;
+
+    explicit VulkanRenderGraphPass(const std::string &name);
+
+    // Attachments: the pass is recorded inside a render pass created by the graph. LOAD keeps the previous contents (the
+    // pass then also reads the image); the store op is decided by the graph: STORE only if the contents are used later
+    VulkanRenderGraphPass &writeColor(const std::string &name, const VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                      const VkClearColorValue clearValue = {{0.0f, 0.0f, 0.0f, 1.0f}});
+    VulkanRenderGraphPass &writeDepth(const std::string &name, const VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                      const VkClearDepthStencilValue clearValue = {1.0f, 0});
+    // Depth tested against, not written
+    VulkanRenderGraphPass &readDepth(const std::string &name);
+    // Resolves source, a multisampled color attachment of this pass, into the single-sampled target at the end of the pass.
+    // source is then only stored if a later pass uses it
+    VulkanRenderGraphPass &resolveColor(const std::string &source, const std::string &target);
+    // Input attachment (subpassInput): the fragment shader reads the pixel it shades, written by the previous pass as a color
+    // or depth attachment. The pass is merged into the previous pass's render pass as its next subpass, so on tilers the
+    // image never leaves tile memory between the two
+    VulkanRenderGraphPass &readInput(const std::string &name);
+
+    // Sampled image
+    VulkanRenderGraphPass &readTexture(const std::string &name, const VkPipelineStageFlags stageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    // Storage image or storage buffer
+    VulkanRenderGraphPass &readStorage(const std::string &name, const VkPipelineStageFlags stageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VulkanRenderGraphPass &writeStorage(const std::string &name, const VkPipelineStageFlags stageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    // Copy source or destination, image or buffer
+    VulkanRenderGraphPass &readTransfer(const std::string &name);
+    VulkanRenderGraphPass &writeTransfer(const std::string &name);
+    // Buffer read by fixed-function stages or shaders: accessMask is VERTEX_ATTRIBUTE_READ, INDEX_READ, INDIRECT_COMMAND_READ,
+    // UNIFORM_READ or SHADER_READ, and gives the buffer its usage
+    VulkanRenderGraphPass &readBuffer(const std::string &name, const VkPipelineStageFlags stageMask, const VkAccessFlags accessMask);
+
+    // The pass has effects the graph cannot see (e.g. a copy to host memory): it is never culled
+    VulkanRenderGraphPass &setSideEffect();
+    VulkanRenderGraphPass &setRecord(const RecordCallback &record);
+
+    const std::string &getName() const { return m_name; }
+
+private:
+    friend class VulkanRenderGraph;
+
+    enum class AttachmentType
+    {
+        NONE,
+        COLOR,
+        DEPTH,
+        RESOLVE,
+        INPUT
+    };
+
+    struct Access
+    {
+        std::string m_resource;
+        VkPipelineStageFlags m_stageMask = 0;
+        VkAccessFlags m_accessMask = 0;
+        VkImageLayout m_layout = VK_IMAGE_LAYOUT_UNDEFINED; // Ignored for buffers
+        bool m_isRead = false;
+        bool m_isWrite = false;
+        VkImageUsageFlags m_imageUsage = 0;
+        VkBufferUsageFlags m_bufferUsage = 0;
+        AttachmentType m_attachmentType = AttachmentType::NONE;
+        VkAttachmentLoadOp m_loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        VkClearValue m_clearValue{};
+        std::string m_resolveSource; // Resolve attachments
+    };
+
+    std::string m_name;
+    std::vector<Access> m_accesses;
+    bool m_hasSideEffect;
+    RecordCallback m_record;
+
+    VulkanRenderGraphPass &addAccess(const Access &access);
+};
+
+// Per frame, once compiled
+struct VulkanRenderGraphStats
+{
+    uint32_t m_passCount = 0;
+    uint32_t m_culledPassCount = 0;      // Passes whose results nothing uses: never recorded
+    uint32_t m_renderPassCount = 0;
+    uint32_t m_mergedPassCount = 0;      // Passes recorded as a later subpass of another pass's render pass
+    uint32_t m_dynamicRenderingCount = 0; // Passes recorded with dynamic rendering instead: no render pass nor framebuffers
+    uint32_t m_barrierBatchCount = 0;    // vkCmdPipelineBarrier calls
+    uint32_t m_imageBarrierCount = 0;
+    uint32_t m_layoutTransitionCount = 0; // Image barriers changing the layout
+    uint32_t m_memoryBarrierCount = 0;   // Global memory barriers, covering the buffers
+    uint32_t m_transientImageCount = 0;
+    uint32_t m_transientBufferCount = 0;
+    VkDeviceSize m_transientBytes = 0; // Memory the transient resources would need without aliasing
+    VkDeviceSize m_aliasedBytes = 0;   // Memory they are given, lazily allocated memory excluded
+    uint32_t m_lazyImageCount = 0;     // TRANSIENT_ATTACHMENT images
+    VkDeviceSize m_lazyBytes = 0;      // Lazily allocated memory given to them (0 if the device has none: they then count as aliased)
+};
+
+// Objects replaced by a resize, which frames in flight may still use: destroy them with destroyRetired once they completed
+struct VulkanRenderGraphRetired
+{
+    std::vector<VkFramebuffer> m_framebuffers;
+    std::vector<VkImageView> m_imageViews;
+    std::vector<VkImage> m_images;
+    std::vector<VkBuffer> m_buffers;
+    std::vector<VulkanAllocation> m_allocations;
+};
+
+// The frame as a graph of passes declaring the images and buffers they read and write, instead of render passes,
+// framebuffers and barriers wired by hand. Compiling the graph:
+// - culls the passes whose results are never used (nothing imported or read by a kept pass depends on them),
+// - places the pipeline barriers and layout transitions from the declared accesses: one vkCmdPipelineBarrier before each
+//   pass that needs one, and none between reads in the same layout or for resources the pass does not touch,
+// - merges a pass reading input attachments into the render pass of the pass before it, as its next subpass: the
+//   dependencies between them become subpass dependencies, and their barriers one batch before the render pass,
+// - creates the transient resources and aliases them in shared memory: resources whose lifetimes (first to last pass
+//   using them) do not overlap are placed at the same memory offsets,
+// - with dynamic rendering (VK_KHR_dynamic_rendering), records the passes with attachments between vkCmdBeginRendering and
+//   vkCmdEndRendering: there is no render pass nor framebuffer to create, and none to recreate on resize. Passes merged as
+//   subpasses still share a render pass, which dynamic rendering cannot express.
+// The graph is declared and compiled once, then executed every frame; each pass is recorded in the order it was added.
+// Passes run on one queue. Transient resources are shared by the frames in flight: the first barrier of a resource waits
+// for the last accesses to its memory, which also covers the previous frame still executing on the queue.
+class VulkanRenderGraph
+{
+public:
+    VulkanRenderGraph();
+    ~VulkanRenderGraph();
+
+    // useDynamicRendering: only if the device supports it, otherwise every pass with attachments gets a render pass
+    void create(VulkanDevice &vulkanDevice, const bool useDynamicRendering = false);
+    // Destroys every object of the graph and forgets its declarations. The GPU must no longer use them
+    void cleanUp();
+
+    // Declarations, before compile. Names are unique across images and buffers
+    void createImage(const std::string &name, const VulkanRenderGraphImageDescription &description);
+    void createBuffer(const std::string &name, const VkDeviceSize size);
+    void importImage(const std::string &name, const VulkanRenderGraphImageImport &imageImport);
+    void importBuffer(const std::string &name, const VkPipelineStageFlags initialStageMask, const VkAccessFlags initialAccessMask);
+    // The reference stays valid until cleanUp
+    VulkanRenderGraphPass &addPass(const std::string &name);
+
+    // Throws std::runtime_error if a pass accesses an undeclared resource (or one twice), or reads a transient resource no
+    // earlier pass writes
+    void compile(const VkExtent2D renderExtent);
+    // Recreates the transient resources and framebuffers for a new render extent or new imported images (swap chain
+    // recreation). The previous ones are returned, to be destroyed once the frames using them have completed
+    VulkanRenderGraphRetired resize(const VkExtent2D renderExtent);
+    void destroyRetired(const VulkanRenderGraphRetired &retired);
+
+    // Every frame, before execute
+    void setImportedImage(const std::string &name, VkImage image, VkImageView imageView);
+    void setImportedBuffer(const std::string &name, VkBuffer buffer);
+    // Records the barriers and passes into commandBuffer, already begun
+    void execute(VkCommandBuffer commandBuffer);
+
+    // What the pipelines of a pass with attachments are created against: the render pass and subpass it is recorded in, or
+    // the formats of its attachments if it uses dynamic rendering. Throws if the pass was culled
+    VulkanPipelineTarget getPipelineTarget(const std::string &passName) const;
+    bool isCulled(const std::string &passName) const;
+    bool usesDynamicRendering() const { return m_useDynamicRendering; }
+
+    VkImage getImage(const std::string &name) const;
+    VkImageView getImageView(const std::string &name) const;
+    VkBuffer getBuffer(const std::string &name) const;
+
+    const VulkanRenderGraphStats &getStats() const { return m_stats; }
+
+private:
+    // What was last done to a resource during the frame, to derive the barrier its next access needs
+    struct ResourceState
+    {
+        VkImageLayout m_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags m_writeStageMask = 0;   // Last write (or layout transition)
+        VkAccessFlags m_writeAccessMask = 0;
+        VkPipelineStageFlags m_readStageMask = 0;    // Reads since that write
+        VkPipelineStageFlags m_visibleStageMask = 0; // Stages and accesses the write was made visible to
+        VkAccessFlags m_visibleAccessMask = 0;
+    };
+
+    struct Resource
+    {
+        std::string m_name;
+        bool m_isImage = true;
+        bool m_isImported = false;
+        VulkanRenderGraphImageDescription m_description; // Images
+        VulkanRenderGraphImageImport m_import;           // Imported images and buffers (initial stage and access)
+        VkDeviceSize m_bufferSize = 0;
+
+        // Compiled
+        VkImageUsageFlags m_imageUsage = 0;
+        VkBufferUsageFlags m_bufferUsage = 0;
+        int32_t m_firstPass = -1; // Index in m_compiledPasses, -1 if no kept pass uses the resource
+        int32_t m_lastPass = -1;
+        bool m_isLazy = false; // Only an attachment within one render pass: TRANSIENT_ATTACHMENT, in lazily allocated memory
+        VkMemoryRequirements m_memoryRequirements{};
+        bool m_isPlaced = false;
+        uint32_t m_memoryGroup = 0;
+        VkDeviceSize m_memoryOffset = 0;
+        ResourceState m_finalState;
+
+        VkImage m_image = VK_NULL_HANDLE;
+        VkImageView m_imageView = VK_NULL_HANDLE;
+        VkBuffer m_buffer = VK_NULL_HANDLE;
+    };
+
+    struct ImageBarrier
+    {
+        uint32_t m_resource = 0;
+        VkImageLayout m_oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout m_newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkAccessFlags m_srcAccessMask = 0;
+        VkAccessFlags m_dstAccessMask = 0;
+    };
+
+    // Every dependency of a pass, merged into one vkCmdPipelineBarrier
+    struct BarrierBatch
+    {
+        bool m_isNeeded = false;
+        VkPipelineStageFlags m_srcStageMask = 0;
+        VkPipelineStageFlags m_dstStageMask = 0;
+        std::vector<ImageBarrier> m_imageBarriers;
+        bool m_hasMemoryBarrier = false;
+        VkAccessFlags m_srcAccessMask = 0; // Of the memory barrier
+        VkAccessFlags m_dstAccessMask = 0;
+    };
+
+    // Passes merged into one render pass are consecutive: the first one (the leader) holds the barriers of all of them,
+    // the render pass and its framebuffers. A leader using dynamic rendering holds what vkCmdBeginRendering needs instead
+    struct CompiledPass
+    {
+        uint32_t m_pass = 0; // Index in m_passes
+        uint32_t m_leader = 0; // Index in m_compiledPasses of the first pass of its render pass (itself if not merged)
+        uint32_t m_subpass = 0;
+        uint32_t m_subpassCount = 1; // Leaders: passes in the render pass
+        BarrierBatch m_barriers;
+        VulkanRenderPass m_renderPass{VK_NULL_HANDLE}; // Leaders with attachments
+        std::vector<uint32_t> m_attachments;          // By subpass: colors, then depth, then resolves, then inputs, each once
+        std::vector<VkClearValue> m_clearValues;
+        std::map<std::vector<VkImageView>, VulkanFramebuffer> m_framebuffers; // Keyed by the attachment views
+        bool m_isDynamicRendering = false;
+        std::vector<VkAttachmentDescription> m_attachmentDescriptions; // Dynamic rendering: load/store ops and formats, by m_attachments
+        VulkanSubpass m_subpassDescription;                             // Dynamic rendering: the attachment references of the pass
+    };
+
+    // Transient resources sharing one allocation
+    struct MemoryGroup
+    {
+        bool m_isImage = true;
+        bool m_isLazy = false;
+        uint32_t m_memoryTypeBits = 0;
+        VkDeviceSize m_size = 0;
+        VkDeviceSize m_alignment = 1;
+        VulkanAllocation m_allocation;
+    };
+
+    VkDevice m_device;
+    VulkanMemoryAllocator *m_memoryAllocator;
+    VkExtent2D m_renderExtent;
+    bool m_isCompiled;
+    bool m_useDynamicRendering;
+    PFN_vkCmdBeginRenderingKHR m_cmdBeginRendering;
+    PFN_vkCmdEndRenderingKHR m_cmdEndRendering;
+
+    std::vector<std::unique_ptr<VulkanRenderGraphPass>> m_passes;
+    std::vector<Resource> m_resources;
+    std::map<std::string, uint32_t> m_resourceIndices;
+    std::vector<CompiledPass> m_compiledPasses;
+    std::vector<MemoryGroup> m_memoryGroups;
+    BarrierBatch m_finalBarriers; // To the final layouts of the imported images
+    VulkanRenderGraphStats m_stats;
+
+    void addResource(Resource &&resource);
+    uint32_t getResourceIndex(const std::string &name) const;
+    VkExtent2D getImageExtent(const Resource &resource) const;
+
+    void cullPasses();
+    void mergeSubpasses();
+    bool livesTogether(const Resource &a, const Resource &b) const;
+    void createTransientResources();
+    void placeInMemory(const uint32_t resourceIndex);
+    void computeBarriers();
+    void simulateAccesses(std::vector<ResourceState> &states, const bool recordBarriers);
+    void createRenderPasses();
+
+    const CompiledPass *findCompiledPass(const std::string &passName) const;
+    VkFramebuffer getFramebuffer(CompiledPass &compiledPass, const VkExtent2D extent);
+    void beginRendering(VkCommandBuffer commandBuffer, const CompiledPass &compiledPass, const VkExtent2D extent) const;
+    void recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch &barriers) const;
+    VulkanRenderGraphRetired retireResources();
+};
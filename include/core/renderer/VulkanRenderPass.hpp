@@ -1,5 +1,39 @@
+#pragma once
+
 #include <vulkan/vulkan.h>
 #include <stdexcept>
+#include <vector>
+
+// What a render pass does with an attachment's contents at its start and end. On tile-based GPUs (Apple Silicon, mobile)
+// LOAD copies the attachment from memory into tile memory and STORE writes it back: attachments whose contents are not used
+// after the render pass (depth, multisampled color once resolved) should be DONT_CARE, so they never leave tile memory
+struct VulkanAttachmentPolicy
+{
+    VkAttachmentLoadOp m_loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    VkAttachmentStoreOp m_storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+};
+
+// An attachment of a render pass whose layouts are managed outside of it (by the render graph's barriers): the attachment
+// is already in m_layout when the render pass begins and stays in it, so the render pass does no layout transition
+struct VulkanRenderPassAttachment
+{
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits m_samples = VK_SAMPLE_COUNT_1_BIT;
+    VkAttachmentLoadOp m_loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    VkAttachmentStoreOp m_storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    VkImageLayout m_layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+};
+
+// The attachments a subpass uses, by index in the render pass's attachments. m_resolveAttachments is empty, or holds one
+// reference per color attachment (VK_ATTACHMENT_UNUSED: not resolved). Input attachments are read by the fragment shader
+// (subpassInput) at the pixel it shades, from tile memory on tilers when an earlier subpass of the same render pass wrote them
+struct VulkanSubpass
+{
+    std::vector<VkAttachmentReference> m_colorAttachments;
+    std::vector<VkAttachmentReference> m_resolveAttachments;
+    std::vector<VkAttachmentReference> m_inputAttachments;
+    VkAttachmentReference m_depthAttachment{VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED};
+};
 
 class VulkanRenderPass
 {
@@ -7,10 +41,28 @@ public:
     VulkanRenderPass(const VkDevice &device);
     ~VulkanRenderPass();
 
+    // colorFinalLayout is PRESENT_SRC for swap chain images, offscreen targets use the layout of their next consumer (e.g. TRANSFER_SRC).
+    // With samples > 1 the color attachment is multisampled and resolved at the end of the subpass into a single-sampled
+    // attachment (the last one of the framebuffer), which gets colorFinalLayout and colorPolicy's store op: the multisampled
+    // attachment itself is never stored, so colorPolicy's load op can't be LOAD
     void createRenderPass(
         VkFormat colorFormat,
         VkFormat depthFormat = VK_FORMAT_UNDEFINED,
-        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
+        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT,
+        VkImageLayout colorFinalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        const VulkanAttachmentPolicy &colorPolicy = {},
+        const VulkanAttachmentPolicy &depthPolicy = {VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE});
+    // One subpass writing colorAttachments, with an optional depth attachment (read-only if its layout is). resolveAttachments
+    // is empty, or holds for each color attachment the attachment it is resolved into (m_format VK_FORMAT_UNDEFINED: none).
+    // Attachments are numbered colors first, then depth, then resolves
+    void createRenderPass(const std::vector<VulkanRenderPassAttachment> &colorAttachments, const VulkanRenderPassAttachment *depthAttachment = nullptr,
+                          const std::vector<VulkanRenderPassAttachment> &resolveAttachments = {});
+    // Any number of subpasses, recorded in order (vkCmdNextSubpass). The dependencies between them are derived from the
+    // attachments they share: a subpass using an attachment waits for the previous subpass writing it, and a subpass writing
+    // it (or changing its layout) for the subpasses reading it since, all by region so tilers keep the pixels on chip.
+    // Attachments a subpass does not use between two that do are preserved. No external dependency: the accesses before
+    // and after the render pass are ordered by barriers
+    void createRenderPass(const std::vector<VkAttachmentDescription> &attachments, const std::vector<VulkanSubpass> &subpasses);
 
     VkRenderPass getRenderPass() const { return m_renderPass; }
     void cleanUp();
@@ -19,6 +71,6 @@ private:
     VkDevice m_device;
     VkRenderPass m_renderPass;
 
-    VkAttachmentDescription createColorAttachment(VkFormat format, VkSampleCountFlagBits samples) const;
-    VkAttachmentDescription createDepthAttachment(VkFormat format, VkSampleCountFlagBits samples) const;
+    VkAttachmentDescription createColorAttachment(VkFormat format, VkSampleCountFlagBits samples, VkImageLayout finalLayout, const VulkanAttachmentPolicy &policy) const;
+    VkAttachmentDescription createDepthAttachment(VkFormat format, VkSampleCountFlagBits samples, const VulkanAttachmentPolicy &policy) const;
 };
\ No newline at end of file
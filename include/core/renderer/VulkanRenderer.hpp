@@ -4,37 +4,265 @@
 #include "VulkanDevice.hpp"
 #include "VulkanSwapChain.hpp"
 #include "VulkanGraphicsPipeline.hpp"
+#include "VulkanPipelineCache.hpp"
+#include "VulkanPipelineRegistry.hpp"
+#include "VulkanPipelineManifest.hpp"
+#include "VulkanExtendedDynamicState.hpp"
 #include "VulkanDebugMessenger.hpp"
 #include "VulkanSurface.hpp"
 #include "VulkanValidationLayer.hpp"
-#include "VulkanRenderPass.hpp"
-#include "VulkanFramebuffer.hpp";
+#include "VulkanRenderGraph.hpp"
+#include "VulkanOffscreenTarget.hpp"
+#include "VulkanReadbackRing.hpp"
+#include "VulkanCommandPool.hpp"
+#include "VulkanSyncObjects.hpp"
+#include "VulkanDeletionQueue.hpp"
+#include "VulkanUploadArena.hpp"
+#include "VulkanStagingUploader.hpp"
+#include "VulkanAsyncCompute.hpp"
+#include "VulkanFrameStats.hpp"
+#include "graphics/LightingBenchmark.hpp"
 
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
 #include <vector>
 
 class WindowHandler;
 
+struct VulkanRendererConfig
+{
+    // How many frames the CPU may record ahead of the GPU. 2 overlaps CPU and GPU work, 3 hides more jitter at the cost of latency
+    uint32_t m_maxFramesInFlight = 2;
+
+    // Headless mode renders into device-local offscreen images instead of a swap chain: no window, no surface, no vsync.
+    // Used on machines without a display (render farm, CI) and to benchmark on software implementations such as lavapipe.
+    bool m_headless = false;
+    VkExtent2D m_headlessExtent = {800, 600};
+    VkFormat m_headlessFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+    // Headless only: copy every frame into a ring of mapped buffers so the pixels can be consumed without stalling
+    bool m_enableReadback = false;
+    uint32_t m_readbackSlotCount = 4;
+
+    // Present mode and swap chain image count (ignored in headless mode)
+    VulkanPresentPolicy m_presentPolicy = VulkanPresentPolicy::THROUGHPUT;
+
+    // Frame pacing: waitForFramePacing() blocks until the GPU has finished the previous frame, so the caller samples input
+    // as late as possible instead of queueing it behind m_maxFramesInFlight frames (lower input-to-photon latency, less overlap)
+    bool m_enableFramePacing = false;
+
+    // File the pipeline cache is loaded from at startup and saved to at shutdown (empty: no persistence)
+    std::string m_pipelineCachePath;
+
+    // Pipeline compilation threads (0 = one per hardware thread)
+    uint32_t m_pipelineWorkerCount = 0;
+    // Also compile the pipeline presets at startup (in parallel), so later requests for them are ready immediately
+    bool m_compilePipelinePresets = false;
+    // Set cull mode, depth state, polygon mode... at record time when the device supports extended dynamic state, so the
+    // pipeline variants that only differ by them share one pipeline. Off: one static pipeline per variant
+    bool m_useExtendedDynamicState = true;
+    // Draw the passes with VK_KHR_dynamic_rendering when the device supports it: pipelines are created against attachment
+    // formats, and there are no render pass or framebuffer objects (nor framebuffers to recreate on resize). Passes merged
+    // as subpasses keep a render pass. Off: render passes and framebuffers everywhere
+    bool m_useDynamicRendering = true;
+
+    // File listing the pipelines requested this session, pre-warmed in the background by the next one (empty: no pre-warm)
+    std::string m_pipelineManifestPath;
+
+    // Archive the shaders are loaded from, falling back to the loose .spv files (empty or missing: loose files only)
+    std::string m_shaderArchivePath;
+
+    // Draw the lighting benchmark scene (see LightingBenchmark) with this many lights, before the main pass (0: not drawn)
+    uint32_t m_benchmarkLightCount = 0;
+    LightingPath m_benchmarkLightingPath = LightingPath::DEFERRED;
+};
+
+// How often drawing had to wait for a pipeline that was still compiling (a first-use hitch)
+struct VulkanPipelineUsageStats
+{
+    uint64_t m_pipelineSwitchCount = 0;
+    uint64_t m_notReadyDrawCount = 0; // Draws whose pipeline was not compiled yet when recorded
+    double m_notReadyWaitMs = 0.0;    // CPU blocked on those pipelines
+};
+
+// Instrumentation hook for the presentation: which configuration the swap chain ended up with (on creation and on every
+// recreation) and how long passed between two consecutive presents, measured on the CPU when vkQueuePresentKHR returns.
+struct VulkanPresentObserver
+{
+    std::function<void(const VulkanPresentConfiguration &)> m_onPresentConfigured;
+    std::function<void(uint64_t frameNumber, double presentIntervalMs)> m_onPresent;
+};
+
+// Compute work submitted every frame ahead of the graphics work (culling, particles, post-processing inputs).
+// m_record is called with the frame slot's compute command buffer, already begun, and records the dispatches.
+struct VulkanComputeWork
+{
+    std::function<void(VkCommandBuffer commandBuffer, uint32_t frameIndex)> m_record;
+    // Graphics stages that consume the compute results: they wait for the compute work, earlier stages overlap with it
+    VkPipelineStageFlags m_graphicsWaitStageMask = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+};
+
 class VulkanRenderer
 {
 public:
-    VulkanRenderer(WindowHandler *windowHandler);
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT_LIMIT = 3;
+
+    // windowHandler may be nullptr in headless mode
+    VulkanRenderer(WindowHandler *windowHandler, const VulkanRendererConfig &config = VulkanRendererConfig{});
     ~VulkanRenderer();
 
     void initVulkan();
+    void waitForFramePacing();
+    // Returns false if the window is minimized (zero sized framebuffer): nothing was drawn, and nothing can be until it is restored
+    bool drawFrame();
+    void waitIdle();
     void cleanup();
 
+    uint32_t getMaxFramesInFlight() const { return m_maxFramesInFlight; }
+    bool isHeadless() const { return m_headless; }
+    VkExtent2D getRenderExtent() const { return m_renderExtent; }
+    const VulkanRenderGraph &getRenderGraph() const { return m_vulkanRenderGraph; }
+    const LightingBenchmark &getLightingBenchmark() const { return m_lightingBenchmark; }
+
+    // Set before initVulkan to also be notified of the initial swap chain configuration
+    void setPresentObserver(const VulkanPresentObserver &observer) { m_presentObserver = observer; }
+
+    // Readback of offscreen frames (headless with readback enabled). Never blocks: returns nothing if no frame is ready yet.
+    // The frame's pixels stay valid until it is released, and its slot cannot be reused for capture until then.
+    std::optional<VulkanReadbackFrame> acquireReadbackFrame();
+    void releaseReadbackFrame(const VulkanReadbackFrame &frame);
+    const VulkanReadbackRing &getReadbackRing() const { return m_vulkanReadbackRing; }
+
+    // Compute work recorded and submitted on the compute queue by every drawFrame. Set after initVulkan
+    void setComputeWork(const VulkanComputeWork &computeWork) { m_computeWork = computeWork; }
+    const VulkanAsyncCompute &getAsyncCompute() const { return m_vulkanAsyncCompute; }
+
+    // For systems that create their own resources (e.g. compute pipelines and buffers). Available after initVulkan
+    VulkanDevice &getVulkanDevice() { return m_vulkanDevice; }
+
+    VulkanPipelineCache &getPipelineCache() { return m_vulkanPipelineCache; }
+    const VulkanPipelineCacheStats &getPipelineCacheStats() const { return m_vulkanPipelineCache.getStats(); }
+    // Time spent creating the renderer's pipelines in initVulkan: compare a cold start (no cache file) with a warm one
+    double getPipelineCreationMs() const { return m_pipelineCreationMs; }
+    VulkanPipelineRegistry &getPipelineRegistry() { return m_vulkanPipelineRegistry; }
+    const VulkanExtendedDynamicState &getExtendedDynamicState() const { return m_vulkanExtendedDynamicState; }
+    const VulkanPipelineManifestStats &getPipelineManifestStats() const { return m_pipelineManifest.getStats(); }
+    const VulkanPipelineUsageStats &getPipelineUsageStats() const { return m_pipelineUsageStats; }
+
+    // Draws with the pipeline of state from the next recorded frame. Never blocks here: the pipeline is requested now and
+    // waited for when the frame is recorded, if it is not compiled by then. A line or point polygon mode is drawn filled, with a
+    // warning, on a device without fillModeNonSolid. Call after initVulkan
+    void setGraphicsPipelineState(const VulkanPipelineState &requestedState);
+
+    // The shader files were rebuilt (shader hot reload): recompiles the pipelines using them in the background. The renderer
+    // keeps drawing with the previous pipeline until the new one is compiled, then switches at a frame boundary. Call between
+    // frames, after initVulkan
+    void reloadShaders(const std::vector<std::string> &changedShaderPaths);
+
+    VulkanMemoryStats getMemoryStats() const { return m_vulkanDevice.getMemoryAllocator().getStats(); }
+
+    // Per-frame upload memory for uniforms and dynamic data, reset when the frame slot is reused
+    VulkanUploadArena &getUploadArena() { return m_vulkanUploadArena; }
+    const VulkanUploadArena &getUploadArena() const { return m_vulkanUploadArena; }
+
+    // Uploads to device-local buffers and images on the transfer queue. Uploads requested before drawFrame are submitted and
+    // acquired by that frame
+    VulkanStagingUploader &getStagingUploader() { return m_vulkanStagingUploader; }
+    const VulkanStagingUploader &getStagingUploader() const { return m_vulkanStagingUploader; }
+
+    // Stats of the most recently completed frame. GPU time lags the CPU timings by m_maxFramesInFlight frames
+    const VulkanFrameStats &getLastFrameStats() const { return m_lastFrameStats; }
+
 private:
     WindowHandler *m_windowHandler;
 
     VulkanDebugMessenger m_vulkanDebugMessenger;
     VulkanDevice m_vulkanDevice;
-    VulkanGraphicsPipeline m_vulkanGraphicsPipeline;
+    VulkanPipelineCache m_vulkanPipelineCache;
+    VulkanPipelineRegistry m_vulkanPipelineRegistry;
+    const VulkanGraphicsPipeline *m_graphicsPipeline; // Owned by the registry
+    VulkanPipelineState m_graphicsPipelineState;      // Drawn with: the pipeline's dynamic states are set from it
+    VulkanPipelineRequest m_graphicsPipelineRequest;  // Shaders and target of the graphics pipeline
+    std::optional<VulkanPipelineHandle> m_pendingGraphicsPipeline;
+    VulkanPipelineState m_pendingGraphicsPipelineState;
+    std::optional<VulkanPipelineHandle> m_reloadedGraphicsPipeline; // Same state, rebuilt shaders: switched to once compiled
+    std::vector<uint64_t> m_pendingRetireSerials; // Shader reloads whose retired pipelines the renderer may still draw with
+    VulkanPipelineManifest m_pipelineManifest;
+    VulkanPipelineUsageStats m_pipelineUsageStats;
+    VulkanExtendedDynamicState m_vulkanExtendedDynamicState;
     VulkanInstance m_vulkanInstance;
     VulkanSurface m_vulkanSurface;
     VulkanSwapChain m_vulkanSwapChain;
     VulkanValidationLayer m_vulkanValidationLayer;
-    VulkanRenderPass m_vulkanRenderPass;
-    std::vector<VulkanFramebuffer> m_vulkanSwapChainFramebuffers;
+    VulkanRenderGraph m_vulkanRenderGraph; // The passes of a frame, with their render passes and framebuffers
+    LightingBenchmark m_lightingBenchmark;
+    VulkanOffscreenTarget m_vulkanOffscreenTarget;
+    VulkanReadbackRing m_vulkanReadbackRing;
+    VulkanCommandPool m_vulkanCommandPool;
+    VulkanSyncObjects m_vulkanSyncObjects;
+    VulkanDeletionQueue m_vulkanDeletionQueue; // Resources replaced at runtime, destroyed once the frames using them complete
+    VulkanUploadArena m_vulkanUploadArena;
+    VulkanStagingUploader m_vulkanStagingUploader;
+    VulkanAsyncCompute m_vulkanAsyncCompute;
+    VulkanComputeWork m_computeWork;
+
+    bool m_headless;
+    VkExtent2D m_headlessExtent;
+    VkFormat m_headlessFormat;
+    bool m_enableReadback;
+    uint32_t m_readbackSlotCount;
+    VkExtent2D m_renderExtent;
+    std::string m_pipelineCachePath;
+    uint32_t m_pipelineWorkerCount;
+    bool m_compilePipelinePresets;
+    bool m_useExtendedDynamicState;
+    bool m_useDynamicRendering;
+    std::string m_pipelineManifestPath;
+    std::string m_shaderArchivePath;
+    uint32_t m_benchmarkLightCount;
+    LightingPath m_benchmarkLightingPath;
+    double m_pipelineCreationMs;
+
+    // Frames in flight
+    uint32_t m_maxFramesInFlight;
+    uint32_t m_currentFrame;
+    uint64_t m_frameNumber;
+    std::vector<VkCommandBuffer> m_commandBuffers;
+    std::vector<VulkanSemaphoreWait> m_uploadWaits; // Semaphores the current frame's submit waits on (recorded with the command buffer)
+
+    // Frame number submitted with each frame slot's fence, used to know which frames the GPU has completed
+    std::vector<std::optional<uint64_t>> m_frameNumbersInFlight;
+    uint64_t m_completedFrameCount;
+
+    // Swap chain recreation (window resized, VK_ERROR_OUT_OF_DATE_KHR or VK_SUBOPTIMAL_KHR)
+    bool m_swapChainOutOfDate;
+
+    // Presentation policy and instrumentation
+    bool m_enableFramePacing;
+    double m_pendingPacingWaitMs;
+    VulkanPresentObserver m_presentObserver;
+    std::optional<std::chrono::steady_clock::time_point> m_lastPresentTime;
+
+    // GPU timing (two timestamps per frame slot)
+    VkQueryPool m_timestampQueryPool;
+    std::vector<bool> m_timestampsPending;
+    double m_timestampPeriodNs;
+    VulkanFrameStats m_lastFrameStats;
+
+    void createTimestampQueryPool();
+    void createRenderGraph(const VkFormat targetImageFormat);
+    void recordMainPass(VkCommandBuffer commandBuffer, const VkExtent2D renderExtent);
+    std::vector<VulkanPipelineHandle> requestPipelinePresets(const VulkanPipelineRequest &baseRequest);
+    void recordCommandBuffer(VkCommandBuffer commandBuffer, const uint32_t imageIndex);
+    void swapGraphicsPipeline(const VulkanPipelineHandle &handle, const VulkanPipelineState &state);
+    double readGpuFrameTime(const uint32_t frameIndex);
+    void retireFrame(const uint32_t frameIndex);
+    bool recreateSwapChain();
+    void rebuildForTargetFormat(const VkFormat targetImageFormat);
+    void pollCompletedFrames();
+    void notifyPresentConfigured();
 
 #ifdef NDEBUG
     const bool enableValidationLayers = false;
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "graphics/ShaderArchive.hpp"
+#include "graphics/ShaderReflection.hpp"
+
+#include <vulkan/vulkan.h>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// A shader module and its interface, reflected once when the module is created
+struct VulkanShaderModule
+{
+    VkShaderModule m_module = VK_NULL_HANDLE;
+    ShaderReflection m_reflection;
+};
+
+// Loading statistics of one shader file
+struct VulkanShaderLoadStats
+{
+    std::string m_path;
+    size_t m_mappedBytes = 0; // Size of the SPIR-V binary, as last loaded
+    uint32_t m_loadCount = 0;
+    uint32_t m_hitCount = 0;  // Loads answered by an existing module
+    bool m_isFromArchive = false;
+    double m_loadMs = 0.0;    // Summed over the loads: mapping, hashing and (on a miss) module creation
+};
+
+struct VulkanShaderModuleCacheStats
+{
+    uint32_t m_moduleCount = 0;
+    uint64_t m_hitCount = 0;
+    uint64_t m_missCount = 0;
+    uint64_t m_archiveLoadCount = 0; // Loads found in the shader archive instead of a file
+    uint64_t m_mappedBytes = 0;
+    double m_loadMs = 0.0;
+};
+
+// Creates the shader modules of the device, once per SPIR-V binary. Shader files are memory mapped and their words handed to
+// vkCreateShaderModule in place, without a copy. Modules are keyed by the content of the file (hash and size), not by its path:
+// a file loaded again, or the same binary under another path, reuses the existing module, and a file whose content changed gets
+// a new one. The cache owns the modules until cleanUp.
+// With a shader archive mounted, shaders are looked up in it first (no file opened, no hashing: the archive holds the hashes),
+// and only the ones it does not have are loaded from their files.
+// Thread-safe: the pipeline registry loads shaders from its worker threads.
+class VulkanShaderModuleCache
+{
+public:
+    VulkanShaderModuleCache();
+    ~VulkanShaderModuleCache();
+
+    void createCache(const VkDevice &device);
+    // Destroys every module (no pipeline may be created from them any more) and closes the archive
+    void cleanUp();
+
+    // Maps the shader archive (see ShaderArchive). Call it before loading any shader. Returns false if there is no valid archive
+    bool mountArchive(const std::string &archivePath);
+    const ShaderArchive &getArchive() const { return m_archive; }
+    // Loads filePath from its file from now on, even if the archive has it: the file was rebuilt after the archive was packed
+    // (shader hot reload). The new content gets a new module; modules of the previous content stay until cleanUp
+    void preferFile(const std::string &filePath);
+
+    // Throws std::runtime_error if the file cannot be read, is not SPIR-V, or the module cannot be created.
+    // The reference stays valid until cleanUp
+    const VulkanShaderModule &getShaderModule(const std::string &filePath);
+
+    VulkanShaderModuleCacheStats getStats() const;
+    // Sorted by path
+    std::vector<VulkanShaderLoadStats> getLoadStats() const;
+
+private:
+    struct ModuleKey
+    {
+        uint64_t m_hash;
+        size_t m_size;
+
+        auto operator<=>(const ModuleKey &) const = default;
+    };
+
+    VkDevice m_device;
+    ShaderArchive m_archive; // Read-only once mounted: looked up without the lock
+
+    mutable std::mutex m_mutex;
+    std::map<ModuleKey, VulkanShaderModule> m_modules;
+    std::map<std::string, VulkanShaderLoadStats> m_loadStats;
+    std::set<std::string> m_preferredFiles;
+    VulkanShaderModuleCacheStats m_stats;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "VulkanCommandPool.hpp"
+#include "VulkanMemoryAllocator.hpp"
+#include "VulkanSyncObjects.hpp"
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+class VulkanDevice;
+
+struct VulkanUploadStats
+{
+    uint64_t m_uploadCount = 0;
+    uint64_t m_uploadedBytes = 0;
+    uint64_t m_batchCount = 0;
+    uint64_t m_deferredUploadCount = 0; // Uploads refused because the staging ring was full (retry later)
+};
+
+// Batches buffer and image uploads through a ring of host-visible staging memory and copies them on the dedicated transfer queue.
+// Uploads are only recorded when requested and submitted together, once per frame, in a single vkQueueSubmit:
+//   1. upload*()                 copy the data into the staging ring and record the copy (never blocks)
+//   2. submit()                  submit the batch on the transfer queue, signaling a semaphore
+//   3. recordGraphicsAcquire()   record the ownership acquire barriers in the frame's command buffer and return the semaphore
+//                                waits to add to the graphics submit
+//   4. retire()                  reclaim the staging memory of batches the GPU has finished with
+// With a separate transfer family, EXCLUSIVE resources are released by the transfer queue and acquired by the graphics queue
+// (queue family ownership transfer). The semaphore is a timeline semaphore (one value per batch) on Vulkan 1.2 devices,
+// otherwise one binary semaphore per batch. A batch is retired once the graphics frame that waited on it has completed.
+class VulkanStagingUploader
+{
+public:
+    static constexpr VkDeviceSize DEFAULT_STAGING_SIZE = 32ull * 1024 * 1024;
+
+    VulkanStagingUploader();
+    ~VulkanStagingUploader();
+
+    void createUploader(VulkanDevice &vulkanDevice, const VkDeviceSize stagingSize = DEFAULT_STAGING_SIZE);
+    void cleanUp();
+
+    // Returns the ticket of the batch the upload is part of, or nothing if the staging ring is full (retry on a later frame).
+    // The destination must be usable as a transfer destination and not be used by the GPU until the upload is acquired.
+    std::optional<uint64_t> uploadBuffer(VkBuffer buffer, const VkDeviceSize bufferOffset, const void *data, const VkDeviceSize size,
+                                         const VkPipelineStageFlags dstStageMask, const VkAccessFlags dstAccessMask);
+    // Uploads mip 0 / layer 0 of a color image with tightly packed texels, and leaves it in finalLayout
+    std::optional<uint64_t> uploadImage(VkImage image, const VkFormat format, const VkExtent3D extent, const void *data, const VkDeviceSize size,
+                                        const VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                        const VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                        const VkAccessFlags dstAccessMask = VK_ACCESS_SHADER_READ_BIT);
+
+    void submit();
+    std::vector<VulkanSemaphoreWait> recordGraphicsAcquire(VkCommandBuffer graphicsCommandBuffer, const uint64_t frameNumber);
+    // completedFrameCount: number of graphics frames known to have completed
+    void retire(const uint64_t completedFrameCount);
+
+    // True once the frame that acquired the upload has completed
+    bool isUploadComplete(const uint64_t ticket) const { return ticket <= m_retiredTicket; }
+    bool isCreated() const { return m_stagingBuffer != VK_NULL_HANDLE; }
+    const VulkanUploadStats &getStats() const { return m_stats; }
+
+private:
+    struct Batch
+    {
+        uint64_t m_ticket = 0;
+        VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+        VkSemaphore m_semaphore = VK_NULL_HANDLE; // Binary semaphore mode only
+        VkDeviceSize m_stagingBytes = 0;         // Staging ring bytes used (alignment and wrap-around included)
+        std::vector<VkBufferMemoryBarrier> m_bufferAcquires;
+        std::vector<VkImageMemoryBarrier> m_imageAcquires;
+        VkPipelineStageFlags m_acquireStageMask = 0;
+        bool m_isAcquired = false;
+        std::optional<uint64_t> m_acquireFrameNumber; // Graphics frame that acquired (and waited on) the batch
+    };
+
+    VkDevice m_device;
+    VulkanMemoryAllocator *m_memoryAllocator;
+    VkQueue m_transferQueue;
+    uint32_t m_transferFamily;
+    uint32_t m_graphicsFamily;
+    bool m_useTimeline;
+
+    VulkanCommandPool m_commandPool;
+    std::vector<VkCommandBuffer> m_freeCommandBuffers;
+    std::vector<VkSemaphore> m_freeSemaphores;
+    VkSemaphore m_timelineSemaphore;
+
+    // Staging ring
+    VkBuffer m_stagingBuffer;
+    VulkanAllocation m_stagingAllocation;
+    VkDeviceSize m_stagingSize;
+    VkDeviceSize m_stagingHead;
+    VkDeviceSize m_stagingUsed;
+
+    std::optional<Batch> m_recordingBatch;
+    std::deque<Batch> m_submittedBatches;
+    uint64_t m_nextTicket;
+    uint64_t m_retiredTicket;
+    VulkanUploadStats m_stats;
+
+    bool transfersOwnership() const { return m_transferFamily != m_graphicsFamily; }
+    std::optional<VkDeviceSize> allocateStaging(const VkDeviceSize size, const VkDeviceSize alignment, VkDeviceSize &consumedBytes);
+    Batch &getRecordingBatch();
+    void recycleBatch(Batch &batch);
+};
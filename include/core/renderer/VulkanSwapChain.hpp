@@ -19,21 +19,59 @@ struct SwapChainSupportDetails
 
 SwapChainSupportDetails querySwapChainSupport(const VkPhysicalDevice &physicalDevice, const VkSurfaceKHR &surface);
 
+// Picks the present mode and the number of swap chain images together, since both decide latency, throughput and power usage
+enum class VulkanPresentPolicy
+{
+    LOW_LATENCY,  // MAILBOX (no tearing, newest frame wins), or FIFO with the shortest possible queue of images
+    THROUGHPUT,   // MAILBOX, or FIFO, with one extra image so the application rarely waits on the presentation engine
+    POWER_SAVING, // FIFO (vsync): never renders frames that will not be displayed
+    UNCAPPED      // IMMEDIATE (may tear): no vsync at all, for benchmarking
+};
+
+const char *presentPolicyToString(const VulkanPresentPolicy policy);
+
+// Configuration actually chosen for the swap chain (the requested policy may not be fully supported by the surface)
+struct VulkanPresentConfiguration
+{
+    VulkanPresentPolicy m_policy = VulkanPresentPolicy::THROUGHPUT;
+    VkPresentModeKHR m_presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    uint32_t m_imageCount = 0;
+    VkExtent2D m_extent{};
+};
+
+// A swap chain replaced by recreateSwapChain. It may still be in use by frames in flight, so it is destroyed later
+struct RetiredSwapChain
+{
+    VkSwapchainKHR m_swapChain = VK_NULL_HANDLE;
+    std::vector<VkImageView> m_imageViews;
+};
+
 class VulkanSwapChain
 {
 public:
     VulkanSwapChain();
     ~VulkanSwapChain();
 
-    void createSwapChain(const VkDevice &device, const VkPhysicalDevice &physicalDevice, const VkSurfaceKHR &surface, const int widthPx, const int heightPx);
+    // Used by the next createSwapChain/recreateSwapChain
+    void setPresentPolicy(const VulkanPresentPolicy policy) { m_presentPolicy = policy; }
+
+    void createSwapChain(const VkDevice &device, const VkPhysicalDevice &physicalDevice, const VkSurfaceKHR &surface, const int widthPx, const int heightPx,
+                         const VkSwapchainKHR oldSwapChain = VK_NULL_HANDLE);
     void createImageViews();
 
+    // Creates a new swap chain (and image views) passing the current one as oldSwapchain, so the presentation engine can reuse its resources.
+    // The previous swap chain is returned instead of destroyed; release it with destroyRetiredSwapChain once no frame in flight uses it.
+    RetiredSwapChain recreateSwapChain(const VkPhysicalDevice &physicalDevice, const VkSurfaceKHR &surface, const int widthPx, const int heightPx);
+    void destroyRetiredSwapChain(const RetiredSwapChain &retiredSwapChain);
+
     void cleanUp();
 
     VkSwapchainKHR getSwapChain() const { return m_swapChain; }
     VkExtent2D getSwapChainExtent() const { return m_swapChainExtent; }
     VkFormat getSwapChainFormat() const { return m_swapChainImageFormat; }
+    const std::vector<VkImage> &getSwapChainImages() const { return m_swapChainImages; }
     std::vector<VkImageView> getSwapChainImageViews() const { return m_swapChainImageViews; }
+    const VulkanPresentConfiguration &getPresentConfiguration() const { return m_presentConfiguration; }
 
 private:
     VkSwapchainKHR m_swapChain;
@@ -44,7 +82,11 @@ private:
     VkExtent2D m_swapChainExtent;
     std::vector<VkImageView> m_swapChainImageViews;
 
+    VulkanPresentPolicy m_presentPolicy;
+    VulkanPresentConfiguration m_presentConfiguration;
+
     VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &supportedFormats);
     VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &supportedPresentModes);
+    uint32_t chooseSwapImageCount(const VkSurfaceCapabilitiesKHR &capabilities, const VkPresentModeKHR presentMode);
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities, const int widthPx, const int heightPx);
 };
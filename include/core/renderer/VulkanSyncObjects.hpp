@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+// A semaphore a queue submit has to wait on, signaled by work on another queue (uploads, async compute)
+struct VulkanSemaphoreWait
+{
+    VkSemaphore m_semaphore = VK_NULL_HANDLE;
+    uint64_t m_value = 0;   // Timeline value (ignored for binary semaphores)
+    bool m_isTimeline = false;
+    VkPipelineStageFlags m_stageMask = 0;
+};
+
+// Synchronisation primitives of the frames in flight.
+// Semaphores order GPU work (acquire -> render -> present), fences let the CPU know when a frame slot can be reused.
+// The acquire semaphore and the fence belong to a frame slot. The render finished semaphore belongs to a swap chain image:
+// it is waited on by the present, which no fence tracks, so it can only be signaled again once that image is acquired again.
+class VulkanSyncObjects
+{
+public:
+    VulkanSyncObjects();
+    ~VulkanSyncObjects();
+
+    void createSyncObjects(const VkDevice &device, const uint32_t framesInFlight);
+    // One render finished semaphore per swap chain image. The previous semaphores are returned instead of destroyed: presents
+    // of the old swap chain may still wait on them. Release them with destroyRetiredSemaphores once no frame in flight uses them.
+    std::vector<VkSemaphore> recreateRenderFinishedSemaphores(const uint32_t swapChainImageCount);
+    void destroyRetiredSemaphores(const std::vector<VkSemaphore> &semaphores) const;
+    void cleanUp();
+
+    VkSemaphore getImageAvailableSemaphore(const uint32_t frameIndex) const { return m_imageAvailableSemaphores[frameIndex]; }
+    VkSemaphore getRenderFinishedSemaphore(const uint32_t imageIndex) const { return m_renderFinishedSemaphores[imageIndex]; }
+    VkFence getInFlightFence(const uint32_t frameIndex) const { return m_inFlightFences[frameIndex]; }
+
+private:
+    VkDevice m_device;
+
+    std::vector<VkSemaphore> m_imageAvailableSemaphores;
+    std::vector<VkSemaphore> m_renderFinishedSemaphores; // By swap chain image
+    std::vector<VkFence> m_inFlightFences;
+};
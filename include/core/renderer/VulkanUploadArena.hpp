@@ -0,0 +1,93 @@
+#pragma once
+
+#include "VulkanMemoryAllocator.hpp"
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class VulkanDevice;
+
+// A piece of the current frame's upload memory. Bind m_buffer at m_offset (e.g. as a dynamic uniform buffer offset,
+// vertex buffer offset or index buffer offset) and write the data through m_mapped.
+struct VulkanUploadAllocation
+{
+    VkBuffer m_buffer = VK_NULL_HANDLE;
+    VkDeviceSize m_offset = 0;
+    VkDeviceSize m_size = 0;
+    std::byte *m_mapped = nullptr;
+};
+
+struct VulkanUploadArenaStats
+{
+    VkDeviceSize m_usedBytes = 0;      // Used by the current frame so far
+    VkDeviceSize m_capacityBytes = 0;  // Of all the chunks of every frame in flight
+    VkDeviceSize m_highWaterMark = 0;  // Most bytes a single frame has used
+    uint64_t m_overflowCount = 0;      // Chunks chained because a frame did not fit in its chunks
+};
+
+// Per frame-in-flight linear (bump) allocator over persistently mapped, host-visible and coherent buffers.
+// Per-draw data (uniforms, push data, dynamic vertices) is written with a pointer bump: no map/unmap, no flush and no new
+// buffer per draw. Each frame slot owns its chunks, which are reset all at once by beginFrame when the slot's fence has signaled.
+// If a frame does not fit, another chunk is chained; the next time the slot begins, its chunks are merged into a single one
+// large enough for the high-water mark, so steady state is one chunk per frame.
+class VulkanUploadArena
+{
+public:
+    static constexpr VkDeviceSize DEFAULT_CHUNK_SIZE = 1024 * 1024;
+
+    VulkanUploadArena();
+    ~VulkanUploadArena();
+
+    void createArena(VulkanDevice &vulkanDevice, const uint32_t framesInFlight, const VkDeviceSize chunkSize = DEFAULT_CHUNK_SIZE,
+                     const VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    void cleanUp();
+
+    // Must only be called once the fence of frameIndex has signaled: the GPU is done reading the slot's previous data
+    void beginFrame(const uint32_t frameIndex);
+
+    // alignment 0 uses the largest of the device's uniform/storage buffer offset alignments
+    VulkanUploadAllocation allocate(const VkDeviceSize size, const VkDeviceSize alignment = 0);
+
+    template <typename T>
+    VulkanUploadAllocation upload(const T &data, const VkDeviceSize alignment = 0)
+    {
+        VulkanUploadAllocation allocation = allocate(sizeof(T), alignment);
+        std::memcpy(allocation.m_mapped, &data, sizeof(T));
+        return allocation;
+    }
+
+    bool isCreated() const { return !m_frames.empty(); }
+    const VulkanUploadArenaStats &getStats() const { return m_stats; }
+
+private:
+    struct Chunk
+    {
+        VkBuffer m_buffer = VK_NULL_HANDLE;
+        VulkanAllocation m_allocation;
+        VkDeviceSize m_size = 0;
+    };
+
+    struct Frame
+    {
+        std::vector<Chunk> m_chunks; // Chained in order, only the last one is being filled
+        VkDeviceSize m_head = 0;     // Bump pointer in the last chunk
+        VkDeviceSize m_usedBytes = 0;
+    };
+
+    VkDevice m_device;
+    VulkanMemoryAllocator *m_memoryAllocator;
+    VkBufferUsageFlags m_usage;
+    VkDeviceSize m_chunkSize;
+    VkDeviceSize m_defaultAlignment;
+
+    std::vector<Frame> m_frames;
+    uint32_t m_currentFrame;
+    VulkanUploadArenaStats m_stats;
+
+    Chunk createChunk(const VkDeviceSize size);
+    void destroyChunk(Chunk &chunk);
+};
@@ -17,6 +17,8 @@ public:
     void *GetMetalLayer();
 
     void pollEvents();
+    // Blocks until at least one event arrives (e.g. while minimized, instead of polling in a loop)
+    void waitEvents();
 
     bool shouldClose() const;
 
@@ -24,8 +26,15 @@ public:
 
     GLFWwindow *getWindow() const { return m_window; }
 
+    // Set when the framebuffer size changed since the last call to resetFramebufferResized
+    bool wasFramebufferResized() const { return m_framebufferResized; }
+    void resetFramebufferResized() { m_framebufferResized = false; }
+
 private:
+    static void framebufferResizeCallback(GLFWwindow *window, int width, int height);
+
     GLFWwindow *m_window;
+    bool m_framebufferResized;
     int m_width;  // in screen coordinates
     int m_height; // in screen coordinates
     const char *m_title;
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "core/renderer/VulkanGraphicsPipeline.hpp"
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+
+class VulkanDevice;
+class VulkanRenderGraph;
+struct VulkanRenderGraphPassContext;
+
+enum class LightingPath
+{
+    FORWARD, // One pass: each fragment drawn loops over the lights
+    DEFERRED // G-buffer subpass, then a lighting subpass looping over the lights once per pixel
+};
+
+const char *lightingPathToString(const LightingPath path);
+
+// A scene lit by many point lights, to compare the cost of forward and deferred shading. Both paths draw the same cubes
+// (CUBE_COUNT instances, overlapping on screen) and lights, generated in the shaders, so the GPU frame times compare the
+// shading alone. The deferred path writes albedo, normal and position to a G-buffer that the lighting pass reads as input
+// attachments: the render graph merges both passes into one render pass, and the G-buffer never leaves tile memory on tilers
+class LightingBenchmark
+{
+public:
+    static constexpr uint32_t CUBE_COUNT = 32 * 32; // CUBES_PER_ROW^2 in lighting.glsl
+
+    LightingBenchmark();
+    ~LightingBenchmark();
+
+    // Declares the images and passes drawing the lit scene into target, before the graph is compiled
+    void declarePasses(VulkanRenderGraph &graph, const std::string &target, const LightingPath path, const uint32_t lightCount);
+    // Creates the pipelines against the render passes (or attachment formats) of the compiled graph
+    void create(VulkanDevice &vulkanDevice, const VulkanRenderGraph &graph, const VkPipelineCache pipelineCache = VK_NULL_HANDLE);
+    void cleanUp();
+
+    // The G-buffer images were recreated (graph resize): points the lighting pass at the new ones. Frames in flight may still
+    // use the previous descriptor set, so its pool is returned, to be destroyed with destroyRetiredPool once they completed
+    VkDescriptorPool updateGBufferDescriptors(const VulkanRenderGraph &graph);
+    void destroyRetiredPool(VkDescriptorPool descriptorPool) const;
+
+    bool isEnabled() const { return m_lightCount > 0; }
+    LightingPath getPath() const { return m_path; }
+    uint32_t getLightCount() const { return m_lightCount; }
+
+private:
+    struct PushConstants
+    {
+        float m_aspectRatio;
+        float m_time;
+    };
+
+    VkDevice m_device;
+    LightingPath m_path;
+    uint32_t m_lightCount;
+    uint64_t m_frameCount; // The lights move with it, the same way in every run
+    float m_time;
+
+    VulkanGraphicsPipeline m_scenePipeline; // Forward shading, or the G-buffer subpass
+    VkShaderStageFlags m_scenePushConstantStages;
+    VulkanGraphicsPipeline m_lightingPipeline; // Deferred only
+    VkShaderStageFlags m_lightingPushConstantStages;
+
+    VkDescriptorSetLayout m_gBufferSetLayout; // Reflected from the shader
+    VkDescriptorPool m_descriptorPool;
+    VkDescriptorSet m_descriptorSet; // The G-buffer input attachments
+
+    void recordScene(VkCommandBuffer commandBuffer, const VulkanRenderGraphPassContext &context);
+    void recordLighting(VkCommandBuffer commandBuffer, const VulkanRenderGraphPassContext &context);
+};
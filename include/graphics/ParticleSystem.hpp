@@ -0,0 +1,56 @@
+#pragma once
+
+#include "core/renderer/VulkanComputePipeline.hpp"
+#include "core/renderer/VulkanMemoryAllocator.hpp"
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+class VulkanDevice;
+
+// Particles simulated by a compute shader, one step per frame on the (async) compute queue.
+// The particle buffer is only accessed by the compute queue. It is host visible so the result can be verified on the host,
+// which makes the compute path testable headlessly (e.g. on lavapipe).
+class ParticleSystem
+{
+public:
+    static constexpr float DELTA_TIME = 1.0f / 64.0f; // Power of two: the expected positions are exact in floating point
+
+    ParticleSystem();
+    ~ParticleSystem();
+
+    void create(VulkanDevice &vulkanDevice, const uint32_t particleCount, const VkPipelineCache pipelineCache = VK_NULL_HANDLE);
+    void cleanUp();
+
+    // Records one simulation step into a compute command buffer
+    void recordUpdate(VkCommandBuffer commandBuffer);
+
+    // Compares the particles with the expected positions after getStepCount() steps. The device must be idle
+    bool verify() const;
+    uint64_t getStepCount() const { return m_stepCount; }
+    uint32_t getParticleCount() const { return m_particleCount; }
+
+private:
+    struct PushConstants
+    {
+        float m_deltaTime;
+        uint32_t m_particleCount;
+        uint32_t m_initialize;
+    };
+
+    VkDevice m_device;
+    VulkanMemoryAllocator *m_memoryAllocator;
+    uint32_t m_particleCount;
+    uint64_t m_stepCount;
+
+    VkBuffer m_particleBuffer;
+    VulkanAllocation m_particleAllocation;
+
+    VkDescriptorSetLayout m_descriptorSetLayout; // Reflected from the shader
+    VkDescriptorPool m_descriptorPool;
+    VkDescriptorSet m_descriptorSet;
+    VulkanComputePipeline m_computePipeline;
+
+    void createParticleBuffer();
+    void createDescriptorSet();
+};
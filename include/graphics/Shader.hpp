@@ -1,25 +1,70 @@
 #pragma once
 
+#include "graphics/ShaderReflection.hpp"
+#include "graphics/ShaderSpecialization.hpp"
+
 #include <vulkan/vulkan.h>
 #include <string>
 #include <vector>
 
+class VulkanShaderModuleCache;
+
+// One stage of a pipeline: the SPIR-V file and the entry point to run (a file may hold several)
+struct ShaderStageSource
+{
+    VkShaderStageFlagBits m_stage = VK_SHADER_STAGE_VERTEX_BIT;
+    std::string m_filePath;
+    std::string m_entryPoint = "main";
+
+    bool operator==(const ShaderStageSource &) const = default;
+};
+
+// The shader modules of a pipeline, one per stage: vertex and fragment, with tessellation or geometry stages in between,
+// task and mesh stages instead of the vertex stages, or a single compute stage. They are owned by the shader module cache
+// of the device: a Shader is cheap to create, and shaders loading the same SPIR-V share one module.
+// The reflection of the stages is merged: it describes the interface of the whole pipeline (see VulkanPipelineLayoutCache)
+// A specialization selects one permutation of the modules: the stage infos point to it, so they are only valid while the
+// Shader lives (it cannot be copied)
 class Shader
 {
 public:
-    Shader(VkDevice device, const std::string &vertFilePath, const std::string &fragFilePath);
+    // Throws std::runtime_error if a stage is given twice or its file has no entry point for that stage
+    Shader(VulkanShaderModuleCache &shaderModuleCache, const std::vector<ShaderStageSource> &stages);
+    Shader(VulkanShaderModuleCache &shaderModuleCache, const std::string &vertFilePath, const std::string &fragFilePath);
+    // Compute shader (single stage)
+    Shader(VulkanShaderModuleCache &shaderModuleCache, const std::string &compFilePath);
     ~Shader();
+    Shader(const Shader &) = delete;
+    Shader &operator=(const Shader &) = delete;
 
-    VkPipelineShaderStageCreateInfo getVertexShaderStageInfo() const;
-    VkPipelineShaderStageCreateInfo getFragmentShaderStageInfo() const;
+    // Values of the specialization constants, shared by every stage (each stage only reads the constants it declares).
+    // Throws std::runtime_error if a constant is declared by no stage (see ShaderSpecialization::validate)
+    void setSpecialization(const ShaderSpecialization &specialization);
 
+    VkShaderStageFlags getStageFlags() const { return m_stageFlags; }
+    bool hasStage(const VkShaderStageFlagBits stage) const { return (m_stageFlags & stage) != 0; }
+    // Every stage, in pipeline order
+    std::vector<VkPipelineShaderStageCreateInfo> getStageInfos() const;
+    // Throws std::runtime_error if the shader has no such stage
+    VkPipelineShaderStageCreateInfo getStageInfo(const VkShaderStageFlagBits stage) const;
+    const ShaderReflection &getReflection() const { return m_reflection; }
+
+    // Releases the modules (the cache destroys them)
     void cleanUp();
 
 private:
-    VkDevice m_device;
-    VkShaderModule m_vertexShaderModule;
-    VkShaderModule m_fragmentShaderModule;
+    struct Stage
+    {
+        VkShaderStageFlagBits m_stage;
+        VkShaderModule m_module;
+        std::string m_entryPoint;
+    };
+
+    std::vector<Stage> m_stages; // In pipeline order
+    VkShaderStageFlags m_stageFlags;
+    ShaderReflection m_reflection;
+    ShaderSpecialization m_specialization;
+    VkSpecializationInfo m_specializationInfo;
 
-    VkShaderModule createShaderModule(const std::vector<char> &code);
-    std::vector<char> readFile(const std::string &filePath);
+    VkPipelineShaderStageCreateInfo makeStageInfo(const Stage &stage) const;
 };
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "utilities/io/MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A shader binary found in an archive. The data points into the mapped archive: valid until the archive is closed
+struct ShaderArchiveEntry
+{
+    std::string_view m_name;
+    const std::byte *m_data = nullptr;
+    size_t m_size = 0;
+    uint64_t m_contentHash = 0; // fnv1a64 of the data, computed when the archive was packed
+};
+
+// Every SPIR-V binary of the build in a single file, memory mapped once: loading a shader is a lookup in the index instead of
+// opening a file. The shaders are named after the path they are built to ("assets/shaders/vertex/simple_shader.vert.spv"),
+// so the archive is a drop-in replacement for the loose files. Packed at build time by tools/ShaderArchivePacker.
+// Layout: FileHeader, the index (IndexEntry, sorted by name hash then name, for a binary search), the names, then the
+// binaries, each aligned on PAYLOAD_ALIGNMENT bytes so they can be handed to the driver in place.
+// The index carries a compression method per entry for future use; only uncompressed binaries are read (a compressed binary
+// would have to be copied out of the mapping, losing the point of mapping it).
+class ShaderArchive
+{
+public:
+    // Binary to pack
+    struct Source
+    {
+        std::string m_name;
+        std::vector<std::byte> m_data;
+    };
+
+    ShaderArchive();
+    ~ShaderArchive();
+
+    // Returns false if the file does not exist or is not a valid archive (see getRejectReason)
+    bool open(const std::string &filePath);
+    void cleanUp();
+
+    // O(log n) lookup
+    std::optional<ShaderArchiveEntry> find(std::string_view name) const;
+
+    bool isOpen() const { return m_file != nullptr; }
+    uint32_t getEntryCount() const { return m_entryCount; }
+    size_t getSize() const { return m_file ? m_file->getSize() : 0; }
+    const std::string &getFilePath() const { return m_filePath; }
+    // Why the file was not opened (empty if opened or absent)
+    const std::string &getRejectReason() const { return m_rejectReason; }
+
+    // Throws std::runtime_error if a name is duplicated or the file cannot be written
+    static void write(const std::string &filePath, const std::vector<Source> &sources);
+
+private:
+    struct FileHeader
+    {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint32_t m_entryCount;
+        uint32_t m_payloadAlignment;
+        uint64_t m_namesOffset;   // The index follows the header
+        uint64_t m_namesSize;
+        uint64_t m_fileSize;
+        uint64_t m_indexChecksum; // fnv1a64 of the index and the names
+    };
+
+    struct IndexEntry
+    {
+        uint64_t m_nameHash;
+        uint32_t m_nameOffset; // From the start of the names
+        uint32_t m_nameSize;
+        uint64_t m_dataOffset; // From the start of the file
+        uint64_t m_dataSize;
+        uint64_t m_contentHash;
+        uint32_t m_compression;
+        uint32_t m_reserved;
+    };
+
+    enum Compression : uint32_t
+    {
+        COMPRESSION_NONE = 0,
+    };
+
+    static constexpr uint32_t FILE_MAGIC = 0x41534B56; // "VKSA"
+    static constexpr uint32_t FILE_VERSION = 1;
+    static constexpr uint32_t PAYLOAD_ALIGNMENT = 16;
+
+    std::unique_ptr<MappedFile> m_file;
+    std::string m_filePath;
+    std::string m_rejectReason;
+    const IndexEntry *m_index;
+    const char *m_names;
+    uint32_t m_entryCount;
+
+    bool validate();
+    std::string_view getName(const IndexEntry &entry) const { return std::string_view(m_names + entry.m_nameOffset, entry.m_nameSize); }
+};
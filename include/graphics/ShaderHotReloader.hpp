@@ -0,0 +1,62 @@
+#pragma once
+
+#include "utilities/io/FileWatcher.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ShaderHotReloadStats
+{
+    uint32_t m_compiledCount = 0;
+    uint32_t m_failedCount = 0;
+    double m_compileMs = 0.0;
+};
+
+// Recompiles the GLSL sources edited while the application runs, so a shader change shows up without a rebuild and a restart.
+// A background thread watches the source directory (see FileWatcher) and runs the compiler (glslc) on every changed shader,
+// writing the SPIR-V where the application loads it from. The render thread collects the recompiled binaries at a frame
+// boundary (takeCompiledShaders) and rebuilds the pipelines using them (see VulkanRenderer::reloadShaders).
+// A source that fails to compile is reported and its previous binary kept. Files pulled in with #include are tracked from
+// the depfiles glslc writes next to the binaries (by the build, then by every recompile): saving one recompiles every shader
+// including it. Only includes inside the source directory are watched.
+class ShaderHotReloader
+{
+public:
+    ShaderHotReloader();
+    ~ShaderHotReloader();
+
+    // sourceDirectory holds the GLSL sources, outputDirectory the SPIR-V tree mirroring it ("assets/shaders": the paths the
+    // shaders are loaded with). Throws std::runtime_error if the source directory cannot be watched
+    void start(const std::string &sourceDirectory, const std::string &outputDirectory, const std::string &compilerPath);
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    // The SPIR-V paths recompiled since the previous call, as the shaders load them
+    std::vector<std::string> takeCompiledShaders();
+    ShaderHotReloadStats getStats() const;
+
+private:
+    std::string m_sourceDirectory;
+    std::string m_outputDirectory;
+    std::string m_compilerPath;
+    FileWatcher m_fileWatcher; // Only used by the thread
+    std::map<std::string, std::set<std::string>> m_includingShaders; // Include -> shader sources using it. Only used by the thread
+
+    std::thread m_thread;
+    std::atomic<bool> m_isStopping;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::string> m_compiledShaders;
+    ShaderHotReloadStats m_stats;
+
+    void watchLoop();
+    void loadDependencies();
+    void updateDependencies(const std::string &sourcePath, const std::string &depfilePath);
+    void compile(const std::string &sourcePath);
+};
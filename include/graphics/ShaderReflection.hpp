@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// A descriptor the shader accesses (uniform/storage buffer, image, sampler...)
+struct ShaderResourceBinding
+{
+    uint32_t m_set = 0;
+    uint32_t m_binding = 0;
+    VkDescriptorType m_descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uint32_t m_descriptorCount = 1; // Array size, 0 for a runtime (unsized) array
+    VkShaderStageFlags m_stageFlags = 0;
+};
+
+struct ShaderVertexInput
+{
+    uint32_t m_location = 0;
+    VkFormat m_format = VK_FORMAT_UNDEFINED; // Undefined for types without a single vertex format (matrices, 64-bit)
+};
+
+struct ShaderSpecializationConstant
+{
+    uint32_t m_constantId = 0;
+    uint32_t m_size = 0; // Bytes of the value in VkSpecializationInfo data (booleans are VkBool32)
+    VkShaderStageFlags m_stageFlags = 0;
+};
+
+// The interface of a shader, read from its SPIR-V: the resources it binds, its push constant block, its vertex inputs and
+// its specialization constants. Enough to build the pipeline layout without writing it by hand.
+// The word stream is parsed directly (types, decorations and variables), no reflection library is needed. Every variable
+// declared in the module is reported, used or not.
+struct ShaderReflection
+{
+    VkShaderStageFlags m_stageFlags = 0;
+    std::vector<ShaderResourceBinding> m_bindings; // Sorted by set, then binding
+    std::optional<VkPushConstantRange> m_pushConstantRange;
+    std::vector<ShaderVertexInput> m_vertexInputs; // Vertex stage only, sorted by location
+    std::vector<ShaderSpecializationConstant> m_specializationConstants; // Sorted by constant id
+
+    // Throws std::runtime_error if the code is not valid SPIR-V
+    static ShaderReflection reflect(const uint32_t *code, const size_t wordCount);
+
+    // Combines the stages of a pipeline: a binding used by several stages is visible to all of them, and the push constant
+    // ranges become one range covering both. Throws std::runtime_error if the stages disagree on a binding
+    void merge(const ShaderReflection &other);
+};
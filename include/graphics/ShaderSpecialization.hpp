@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ShaderReflection;
+
+// The values of a shader's specialization constants (layout(constant_id = N) const ...), one permutation of a SPIR-V module.
+// The driver compiles the module with the constants folded in: branches on a feature toggle, loops over a light count or an
+// MSAA sample count are resolved at pipeline creation instead of on every invocation, and one binary serves every variant.
+// Every value is 32 bits (int, uint, float and bool, which Vulkan passes as VkBool32); 64-bit constants are not supported.
+// The values are kept sorted by constant id, so equal permutations compare (and serialize) equal.
+class ShaderSpecialization
+{
+public:
+    // Adds the constant, or replaces its value
+    ShaderSpecialization &set(const uint32_t constantId, const uint32_t value);
+    ShaderSpecialization &set(const uint32_t constantId, const int32_t value);
+    ShaderSpecialization &set(const uint32_t constantId, const float value);
+    ShaderSpecialization &set(const uint32_t constantId, const bool value);
+
+    bool isEmpty() const { return m_constantIds.empty(); }
+    const std::vector<uint32_t> &getConstantIds() const { return m_constantIds; }
+    // Raw bits of each value, in the order of getConstantIds()
+    const std::vector<uint32_t> &getData() const { return m_data; }
+
+    // Throws std::runtime_error if a constant is not declared by any stage of the reflection, or is not 32 bits.
+    // A constant id the shader does not declare is ignored by Vulkan: without this check a typo silently keeps the default
+    void validate(const ShaderReflection &reflection) const;
+
+    // Points into this object: valid while it is neither modified nor destroyed
+    VkSpecializationInfo getInfo() const;
+
+    // Appends the constant count, then each id and value, to a key or a file entry
+    void serialize(std::string &out) const;
+
+    // The map entries follow from the ids
+    bool operator==(const ShaderSpecialization &other) const { return m_constantIds == other.m_constantIds && m_data == other.m_data; }
+
+private:
+    std::vector<uint32_t> m_constantIds; // Sorted
+    std::vector<uint32_t> m_data;
+    std::vector<VkSpecializationMapEntry> m_mapEntries;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit FNV-1a: fast and dependency free, enough to detect damaged files and to key content (not cryptographic)
+inline uint64_t fnv1a64(const std::byte *data, const size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<uint64_t>(data[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
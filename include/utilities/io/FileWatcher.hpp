@@ -0,0 +1,39 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+// Reports the files written under a directory tree. On Linux the kernel notifies the writes (inotify): nothing is scanned and
+// waiting costs nothing. Elsewhere the modification times are polled.
+// A file is reported once it has been closed after writing, or moved into the tree (editors often save to a temporary file
+// and rename it over the original), so it is never reported half written.
+// Not thread-safe: one thread watches and waits.
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    // Watches every file under directory, including subdirectories created later. Throws std::runtime_error if it cannot.
+    // A subdirectory created later that cannot be watched (e.g. already removed) is reported on stderr and skipped
+    void watch(const std::string &directory);
+    void cleanUp();
+
+    // Waits up to timeoutMs for writes, then returns the paths written since the previous call, each once
+    std::vector<std::string> waitForChanges(const int timeoutMs);
+
+private:
+    std::string m_directory;
+    int m_inotifyDescriptor;
+    std::map<int, std::string> m_watchedDirectories; // inotify watch descriptor -> directory
+    std::map<std::string, std::filesystem::file_time_type> m_writeTimes; // Polling fallback
+
+    // Returns false if the directory cannot be watched
+    bool addDirectory(const std::string &directory);
+    std::vector<std::string> readEvents(const int timeoutMs);
+    std::vector<std::string> pollWriteTimes(const int timeoutMs, const bool reportNewFiles);
+};
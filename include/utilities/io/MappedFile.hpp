@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A whole file mapped read-only into memory. Nothing is copied: the OS pages the file in on first access and shares the pages
+// with its file cache. Where mapping is not available (or fails) the file is read into a buffer instead.
+// The data is 8 byte aligned (page aligned when mapped), so a SPIR-V binary can be used in place as uint32_t words.
+class MappedFile
+{
+public:
+    // Throws std::runtime_error if the file cannot be opened
+    explicit MappedFile(const std::string &filePath);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const std::byte *getData() const { return m_data; }
+    size_t getSize() const { return m_size; }
+    // False if the file was read into a buffer
+    bool isMapped() const { return m_isMapped; }
+
+private:
+    const std::byte *m_data;
+    size_t m_size;
+    bool m_isMapped;
+    std::vector<uint64_t> m_buffer; // Fallback copy, in words for the alignment
+
+    bool map(const std::string &filePath);
+    void read(const std::string &filePath);
+};
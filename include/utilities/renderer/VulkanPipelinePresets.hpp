@@ -0,0 +1,134 @@
+#pragma once
+
+#include "core/renderer/VulkanPipelineState.hpp"
+
+#include <stdexcept>
+
+// Pipeline states for common rendering techniques, built at compile time from the basic state.
+// Viewport and scissor are dynamic in all of them, so none depends on the render target extent.
+namespace VulkanPipelinePresets
+{
+    // Basic Pipeline Configuration. This is a minimal configuration for a basic graphics pipeline, suitable for rendering simple objects.
+    inline constexpr VulkanPipelineState BASIC{};
+
+    // Pipeline with Alpha Blending. This configuration is used when you need transparency and blending in your rendering.
+    inline constexpr VulkanPipelineState ALPHA_BLENDING = []
+    {
+        VulkanPipelineState state = BASIC;
+        state.m_blendEnable = VK_TRUE;
+        state.m_srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        state.m_dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        state.m_colorBlendOp = VK_BLEND_OP_ADD;
+        state.m_srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        state.m_dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        state.m_alphaBlendOp = VK_BLEND_OP_ADD;
+        return state;
+    }();
+
+    // Wireframe Rendering. Useful for debugging or for special visual effects where the object’s wireframe is desired.
+    // Needs the fillModeNonSolid device feature.
+    inline constexpr VulkanPipelineState WIREFRAME = []
+    {
+        VulkanPipelineState state = BASIC;
+        state.m_polygonMode = VK_POLYGON_MODE_LINE;
+        return state;
+    }();
+
+    // Multisampled Anti-Aliasing (MSAA). For higher-quality rendering with anti-aliasing. Needs a render pass with msaaSamples samples.
+    constexpr VulkanPipelineState msaa(const VkSampleCountFlagBits msaaSamples)
+    {
+        VulkanPipelineState state = BASIC;
+        state.m_rasterizationSamples = msaaSamples;
+        state.m_sampleShadingEnable = VK_TRUE;
+        state.m_minSampleShadingPercent = 20; // Optional, adjust based on performance needs
+        return state;
+    }
+
+    // Deferred Shading Pipeline. Used in more advanced rendering techniques, particularly in 3D graphics where lighting is calculated in a separate pass.
+    // No blending in the G-Buffer pass, depth test and write: the basic state.
+    inline constexpr VulkanPipelineState DEFERRED_SHADING = BASIC;
+
+    // The G-Buffer subpass of deferred shading, writing gBufferAttachmentCount color attachments (e.g. albedo, normal, position),
+    // at most MAX_COLOR_ATTACHMENTS.
+    constexpr VulkanPipelineState deferredGBuffer(const uint32_t gBufferAttachmentCount)
+    {
+        if (gBufferAttachmentCount > VulkanPipelineState::MAX_COLOR_ATTACHMENTS)
+        {
+            throw std::invalid_argument("deferredGBuffer: more G-Buffer attachments than VulkanPipelineState::MAX_COLOR_ATTACHMENTS");
+        }
+        VulkanPipelineState state = DEFERRED_SHADING;
+        state.m_colorAttachmentCount = gBufferAttachmentCount;
+        return state;
+    }
+
+    // The lighting subpass of deferred shading: a fullscreen triangle reading the G-Buffer as input attachments, so no depth and no culling.
+    inline constexpr VulkanPipelineState DEFERRED_LIGHTING = []
+    {
+        VulkanPipelineState state = BASIC;
+        state.m_cullMode = VK_CULL_MODE_NONE;
+        state.m_depthTestEnable = VK_FALSE;
+        state.m_depthWriteEnable = VK_FALSE;
+        return state;
+    }();
+
+    // Pipeline with Dynamic States. This allows for changing certain pipeline states at runtime without recreating the entire pipeline.
+    inline constexpr VulkanPipelineState DYNAMIC_STATE = []
+    {
+        VulkanPipelineState state = BASIC;
+        state.m_dynamicStates |= dynamicStateBit(VK_DYNAMIC_STATE_LINE_WIDTH);
+        return state;
+    }();
+
+    // Post Processing.
+    // For post-processing effects, which might not require depth testing or might use a different set of shader stages.
+    inline constexpr VulkanPipelineState POST_PROCESSING = []
+    {
+        VulkanPipelineState state = ALPHA_BLENDING;
+        state.m_depthTestEnable = VK_FALSE;
+        state.m_depthWriteEnable = VK_FALSE;
+        return state;
+    }();
+
+    // Shadow Mapping.
+    // Used in shadow mapping techniques where you render the scene from the light's perspective to generate a shadow map.
+    inline constexpr VulkanPipelineState SHADOW_MAPPING = []
+    {
+        VulkanPipelineState state = BASIC;
+        state.m_cullMode = VK_CULL_MODE_FRONT_BIT; // Cull front faces
+        state.m_depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+        return state;
+    }();
+
+    // HDR (High Dynamic Range).
+    // Render scenes in HDR, useful for post-processing passes where you tone-map the scene to SDR.
+    inline constexpr VulkanPipelineState HDR = []
+    {
+        VulkanPipelineState state = BASIC;
+        state.m_blendEnable = VK_TRUE;
+        state.m_srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        state.m_dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        state.m_colorBlendOp = VK_BLEND_OP_ADD;
+        return state;
+    }();
+
+    // Tessellation Pipeline Configuration
+    // Used when tessellation shaders are required, which are common in terrain rendering or other scenarios needing highly detailed surfaces.
+    // The shader stages must include tessellation control and evaluation shaders.
+    inline constexpr VulkanPipelineState TESSELLATION = []
+    {
+        VulkanPipelineState state = BASIC;
+        state.m_topology = VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+        state.m_patchControlPoints = 3; // Example: 3 control points for a triangle patch
+        return state;
+    }();
+
+    // Depth Pre-Pass
+    // This technique renders only the depth information in a first pass to improve performance in complex scenes with heavy overdraw.
+    inline constexpr VulkanPipelineState DEPTH_PRE_PASS = []
+    {
+        VulkanPipelineState state = BASIC;
+        state.m_cullMode = VK_CULL_MODE_NONE;
+        state.m_depthCompareOp = VK_COMPARE_OP_LESS;
+        return state;
+    }();
+}
@@ -1,6 +1,6 @@
 #include "app/App.hpp"
 
-App::App() {}
+App::App(const EngineConfig &engineConfig) : engine(engineConfig) {}
 
 App::~App()
 {
@@ -2,42 +2,286 @@
 
 #include "core/system/window/WindowHandler.hpp"
 #include "core/renderer/VulkanRenderer.hpp"
+#include "graphics/ParticleSystem.hpp"
+#include "graphics/ShaderHotReloader.hpp"
+#include "utilities/logging/Logger.hpp"
 
-Engine::Engine()
-    : m_isRunning(false), m_windowHandler(nullptr), m_renderer(nullptr) {}
+#include <vulkan/vk_enum_string_helper.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Set by the build: where the GLSL sources are, and the compiler that builds them
+#ifndef SHADER_SOURCE_DIR
+#define SHADER_SOURCE_DIR "assets/shaders"
+#endif
+#ifndef GLSLC_EXECUTABLE
+#define GLSLC_EXECUTABLE "glslc"
+#endif
+
+Engine::Engine(const EngineConfig &config)
+    : m_config(config), m_isRunning(false), m_windowHandler(nullptr), m_renderer(nullptr), m_particleSystem(nullptr), m_shaderHotReloader(nullptr), m_accumulatedFrameCount(0),
+      m_accumulatedPresentIntervalMs(0.0), m_maxPresentIntervalMs(0.0), m_presentIntervalCount(0), m_capturedBytes(0) {}
 
 Engine::~Engine() {}
 
 void Engine::run()
 {
     init();
-    mainLoop();
+    if (m_config.m_headless)
+    {
+        headlessLoop();
+    }
+    else
+    {
+        mainLoop();
+    }
     cleanup();
 }
 
 void Engine::init()
 {
-    // Initialize Window
-    m_windowHandler = new WindowHandler(800, 600, "Vulkan App");
-    m_windowHandler->init();
+    VulkanRendererConfig rendererConfig{};
 
-    // Check if Vulkan is supported (it is a check made in GLFW, it is done by WindownHandler to contain the GLFW code encapsulated)
-    if (!m_windowHandler->isVulkanSupported())
+    if (!m_config.m_headless)
     {
-        throw std::runtime_error("GLFW: Vulkan is not Supported\n");
+        // Initialize Window
+        m_windowHandler = new WindowHandler(static_cast<int>(m_config.m_width), static_cast<int>(m_config.m_height), "Vulkan App");
+        m_windowHandler->init();
+
+        // Check if Vulkan is supported (it is a check made in GLFW, it is done by WindownHandler to contain the GLFW code encapsulated)
+        if (!m_windowHandler->isVulkanSupported())
+        {
+            throw std::runtime_error("GLFW: Vulkan is not Supported\n");
+        }
+
+        rendererConfig.m_presentPolicy = m_config.m_presentPolicy;
+        rendererConfig.m_enableFramePacing = m_config.m_framePacing;
+    }
+    else
+    {
+        // No window: the renderer draws into offscreen images of the requested size
+        rendererConfig.m_headless = true;
+        rendererConfig.m_headlessExtent = {m_config.m_width, m_config.m_height};
+        rendererConfig.m_enableReadback = m_config.m_captureFrames;
     }
 
+    rendererConfig.m_pipelineCachePath = m_config.m_pipelineCachePath;
+    rendererConfig.m_pipelineWorkerCount = m_config.m_pipelineWorkerCount;
+    rendererConfig.m_compilePipelinePresets = m_config.m_compilePipelinePresets;
+    rendererConfig.m_useExtendedDynamicState = m_config.m_extendedDynamicState;
+    rendererConfig.m_useDynamicRendering = m_config.m_dynamicRendering;
+    rendererConfig.m_pipelineManifestPath = m_config.m_pipelineManifestPath;
+    rendererConfig.m_shaderArchivePath = m_config.m_shaderArchivePath;
+    rendererConfig.m_benchmarkLightCount = m_config.m_benchmarkLightCount;
+    rendererConfig.m_benchmarkLightingPath = m_config.m_benchmarkLightingPath;
+
     // Initialize Vulkan Renderer
-    m_renderer = new VulkanRenderer(m_windowHandler);
+    m_renderer = new VulkanRenderer(m_windowHandler, rendererConfig);
+
+    VulkanPresentObserver presentObserver{};
+    presentObserver.m_onPresentConfigured = [this](const VulkanPresentConfiguration &presentConfiguration)
+    {
+        onPresentConfigured(presentConfiguration);
+    };
+    presentObserver.m_onPresent = [this](uint64_t, double presentIntervalMs)
+    {
+        onPresent(presentIntervalMs);
+    };
+    m_renderer->setPresentObserver(presentObserver);
+
     m_renderer->initVulkan();
 
+    // Cold start: pipelines compiled from scratch. Warm start: the driver finds them in the cache loaded from disk
+    const VulkanPipelineCacheStats &pipelineCacheStats = m_renderer->getPipelineCacheStats();
+    std::ostringstream pipelineMessage;
+    pipelineMessage << "Pipeline cache: " << (pipelineCacheStats.m_loadedFromDisk ? "warm" : "cold") << " start";
+    if (pipelineCacheStats.m_loadedFromDisk)
+    {
+        pipelineMessage << " (" << pipelineCacheStats.m_loadedBytes / 1024 << " KiB loaded)";
+    }
+    else if (!pipelineCacheStats.m_rejectReason.empty())
+    {
+        pipelineMessage << " (cache file ignored: " << pipelineCacheStats.m_rejectReason << ")";
+    }
+    pipelineMessage << ", pipelines created in " << m_renderer->getPipelineCreationMs() << " ms";
+    Logger::getInstance().log(LogLevel::INFO, pipelineMessage.str());
+
+    // Summed compile time / wall time is the speedup of compiling on several threads
+    const VulkanPipelineRegistryStats registryStats = m_renderer->getPipelineRegistry().getStats();
+    std::ostringstream registryMessage;
+    registryMessage << "Pipeline registry: " << registryStats.m_compiledCount << " pipelines compiled on " << registryStats.m_workerCount
+                    << " workers (" << registryStats.m_deduplicatedCount << " duplicate requests shared), "
+                    << registryStats.m_compileMs << " ms of compilation in " << m_renderer->getPipelineCreationMs() << " ms";
+    Logger::getInstance().log(LogLevel::INFO, registryMessage.str());
+
+    const VulkanExtendedDynamicState &extendedDynamicState = m_renderer->getExtendedDynamicState();
+    std::ostringstream dynamicStateMessage;
+    dynamicStateMessage << "Extended dynamic state: ";
+    if (extendedDynamicState.isEnabled())
+    {
+        dynamicStateMessage << std::popcount(extendedDynamicState.getDynamicStates()) << " pipeline states set at record time";
+    }
+    else
+    {
+        dynamicStateMessage << (m_config.m_extendedDynamicState ? "not supported" : "disabled") << ", one pipeline per state variant";
+    }
+    Logger::getInstance().log(LogLevel::INFO, dynamicStateMessage.str());
+
+    std::ostringstream dynamicRenderingMessage;
+    dynamicRenderingMessage << "Dynamic rendering: ";
+    if (m_renderer->getRenderGraph().usesDynamicRendering())
+    {
+        dynamicRenderingMessage << "pipelines created against attachment formats, no render pass or framebuffer objects";
+    }
+    else
+    {
+        dynamicRenderingMessage << (m_config.m_dynamicRendering ? "not supported" : "disabled") << ", render passes and framebuffers";
+    }
+    Logger::getInstance().log(LogLevel::INFO, dynamicRenderingMessage.str());
+
+    const VulkanPipelineManifestStats &manifestStats = m_renderer->getPipelineManifestStats();
+    if (manifestStats.m_loadedCount > 0)
+    {
+        std::ostringstream manifestMessage;
+        manifestMessage << "Pipeline manifest: pre-warming " << manifestStats.m_loadedCount << " pipelines used by the previous session";
+        Logger::getInstance().log(LogLevel::INFO, manifestMessage.str());
+    }
+    else if (!manifestStats.m_rejectReason.empty())
+    {
+        Logger::getInstance().log(LogLevel::WARNING, "Pipeline manifest ignored: " + manifestStats.m_rejectReason);
+    }
+
+    const ShaderArchive &shaderArchive = m_renderer->getVulkanDevice().getShaderModuleCache().getArchive();
+    if (shaderArchive.isOpen())
+    {
+        std::ostringstream archiveMessage;
+        archiveMessage << "Shader archive: " << shaderArchive.getEntryCount() << " shaders (" << shaderArchive.getSize() / 1024
+                       << " KiB) mapped from " << shaderArchive.getFilePath();
+        Logger::getInstance().log(LogLevel::INFO, archiveMessage.str());
+    }
+    else if (!shaderArchive.getRejectReason().empty())
+    {
+        Logger::getInstance().log(LogLevel::WARNING, "Shader archive ignored, loading the shader files: " + shaderArchive.getRejectReason());
+    }
+
+    const LightingBenchmark &lightingBenchmark = m_renderer->getLightingBenchmark();
+    if (lightingBenchmark.isEnabled())
+    {
+        std::ostringstream benchmarkMessage;
+        benchmarkMessage << "Lighting benchmark: " << lightingBenchmark.getLightCount() << " lights over " << LightingBenchmark::CUBE_COUNT
+                         << " cubes, " << lightingPathToString(lightingBenchmark.getPath()) << " shading";
+        if (lightingBenchmark.getPath() == LightingPath::DEFERRED)
+        {
+            benchmarkMessage << " (G-buffer and lighting subpasses of one render pass)";
+        }
+        Logger::getInstance().log(LogLevel::INFO, benchmarkMessage.str());
+    }
+
+    if (m_config.m_drawPipelineState.has_value())
+    {
+        m_renderer->setGraphicsPipelineState(*m_config.m_drawPipelineState);
+    }
+
+    if (m_config.m_particleCount > 0)
+    {
+        initParticles();
+    }
+
+    if (m_config.m_shaderHotReload)
+    {
+        initShaderHotReload();
+    }
+
     m_isRunning = true;
 }
 
+void Engine::initParticles()
+{
+    m_particleSystem = new ParticleSystem();
+    m_particleSystem->create(m_renderer->getVulkanDevice(), m_config.m_particleCount, m_renderer->getPipelineCache().getPipelineCache());
+
+    VulkanComputeWork computeWork{};
+    computeWork.m_record = [this](VkCommandBuffer commandBuffer, uint32_t)
+    {
+        m_particleSystem->recordUpdate(commandBuffer);
+    };
+    m_renderer->setComputeWork(computeWork);
+
+    const VulkanAsyncCompute &asyncCompute = m_renderer->getAsyncCompute();
+    std::ostringstream message;
+    message << "Compute: " << m_config.m_particleCount << " particles on "
+            << (asyncCompute.isAsync() ? "the async compute queue (family " + std::to_string(asyncCompute.getQueueFamily()) + ")" : "the graphics queue");
+    Logger::getInstance().log(LogLevel::INFO, message.str());
+}
+
+// Checks the simulation against the expected positions: a wrong result means the compute work or its synchronisation is broken
+void Engine::verifyParticles()
+{
+    m_renderer->waitIdle();
+
+    const bool isValid = m_particleSystem->verify();
+    std::ostringstream message;
+    message << "Compute: " << m_particleSystem->getStepCount() << " simulation steps of " << m_particleSystem->getParticleCount()
+            << " particles " << (isValid ? "verified" : "do NOT match the expected positions");
+    Logger::getInstance().log(isValid ? LogLevel::INFO : LogLevel::ERROR, message.str());
+
+    m_particleSystem->cleanUp();
+    delete m_particleSystem;
+    m_particleSystem = nullptr;
+}
+
+void Engine::initShaderHotReload()
+{
+    m_shaderHotReloader = new ShaderHotReloader();
+    try
+    {
+        m_shaderHotReloader->start(SHADER_SOURCE_DIR, "assets/shaders", GLSLC_EXECUTABLE);
+    }
+    catch (const std::exception &exception)
+    {
+        // Only a development convenience: run without it
+        Logger::getInstance().log(LogLevel::WARNING, std::string("Shader hot reload disabled: ") + exception.what());
+        delete m_shaderHotReloader;
+        m_shaderHotReloader = nullptr;
+        return;
+    }
+    Logger::getInstance().log(LogLevel::INFO, std::string("Shader hot reload: watching ") + SHADER_SOURCE_DIR);
+}
+
+// Called between frames: the pipelines of the recompiled shaders are rebuilt in the background, and swapped in once compiled
+void Engine::reloadShaders()
+{
+    if (m_shaderHotReloader == nullptr)
+    {
+        return;
+    }
+    const std::vector<std::string> compiledShaders = m_shaderHotReloader->takeCompiledShaders();
+    if (compiledShaders.empty())
+    {
+        return;
+    }
+
+    m_renderer->reloadShaders(compiledShaders);
+    std::ostringstream message;
+    message << "Shader hot reload: rebuilding the pipelines of";
+    for (const std::string &path : compiledShaders)
+    {
+        message << " " << path;
+    }
+    Logger::getInstance().log(LogLevel::INFO, message.str());
+}
+
 void Engine::mainLoop()
 {
     while (m_isRunning)
     {
+        // With frame pacing this waits for the GPU before the events are polled, so the frame uses the freshest input
+        m_renderer->waitForFramePacing();
         m_windowHandler->pollEvents();
 
         if (m_windowHandler->shouldClose())
@@ -45,15 +289,234 @@ void Engine::mainLoop()
             m_isRunning = false;
         }
 
-        // m_renderer->drawFrame();
+        reloadShaders();
+        if (!m_renderer->drawFrame())
+        {
+            // Minimized: sleep until an event (restore, resize, close) instead of spinning on empty frames
+            m_windowHandler->waitEvents();
+            continue;
+        }
+        reportFrameStats(m_renderer->getLastFrameStats());
     }
+
+    // Frames may still be in flight when the loop exits
+    m_renderer->waitIdle();
+}
+
+// Renders a fixed number of frames back to back (no vsync, no window events) and reports the throughput
+void Engine::headlessLoop()
+{
+    const auto start = std::chrono::steady_clock::now();
+    double gpuTimeMs = 0.0;
+    uint32_t gpuTimedFrameCount = 0; // The first frames complete later, with no GPU time yet
+
+    for (uint32_t frame = 0; frame < m_config.m_headlessFrameCount && m_isRunning; frame++)
+    {
+        m_renderer->drawFrame();
+        const VulkanFrameStats &frameStats = m_renderer->getLastFrameStats();
+        reportFrameStats(frameStats);
+        if (frameStats.m_gpuTimeMs > 0.0)
+        {
+            gpuTimeMs += frameStats.m_gpuTimeMs;
+            gpuTimedFrameCount++;
+        }
+        consumeCapturedFrames();
+    }
+
+    m_renderer->waitIdle();
+    consumeCapturedFrames();
+
+    const double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::ostringstream message;
+    message << "Headless: rendered " << m_config.m_headlessFrameCount << " frames of "
+            << m_config.m_width << "x" << m_config.m_height << " in " << elapsedSeconds << " s ("
+            << (elapsedSeconds > 0.0 ? m_config.m_headlessFrameCount / elapsedSeconds : 0.0) << " frames/s)";
+    Logger::getInstance().log(LogLevel::INFO, message.str());
+
+    const LightingBenchmark &lightingBenchmark = m_renderer->getLightingBenchmark();
+    if (lightingBenchmark.isEnabled())
+    {
+        // Compare runs of both paths with the same light count and extent
+        std::ostringstream benchmarkMessage;
+        benchmarkMessage << "Lighting benchmark: " << lightingPathToString(lightingBenchmark.getPath()) << " shading of "
+                         << lightingBenchmark.getLightCount() << " lights, "
+                         << (gpuTimedFrameCount > 0 ? gpuTimeMs / gpuTimedFrameCount : 0.0) << " ms of GPU time per frame (avg over "
+                         << gpuTimedFrameCount << " frames)";
+        Logger::getInstance().log(LogLevel::INFO, benchmarkMessage.str());
+    }
+
+    if (m_config.m_captureFrames)
+    {
+        const VulkanReadbackRing &readbackRing = m_renderer->getReadbackRing();
+        std::ostringstream captureMessage;
+        captureMessage << "Headless: captured " << readbackRing.getCapturedFrameCount() << " frames ("
+                       << m_capturedBytes / (1024 * 1024) << " MiB), dropped " << readbackRing.getDroppedFrameCount();
+        Logger::getInstance().log(LogLevel::INFO, captureMessage.str());
+    }
+
+    const VulkanMemoryStats memoryStats = m_renderer->getMemoryStats();
+    std::ostringstream memoryMessage;
+    memoryMessage << "Headless: device memory " << memoryStats.m_usedBytes / 1024 << " KiB used in " << memoryStats.m_allocationCount
+                  << " sub-allocations over " << memoryStats.m_blockCount << " blocks (" << memoryStats.m_blockBytes / (1024 * 1024) << " MiB), "
+                  << memoryStats.m_dedicatedAllocationCount << " dedicated, fragmentation " << memoryStats.m_fragmentation;
+    Logger::getInstance().log(LogLevel::INFO, memoryMessage.str());
+
+    const VulkanUploadArenaStats &uploadStats = m_renderer->getUploadArena().getStats();
+    std::ostringstream uploadMessage;
+    uploadMessage << "Headless: upload arena high-water mark " << uploadStats.m_highWaterMark << " bytes per frame, capacity "
+                  << uploadStats.m_capacityBytes / 1024 << " KiB, " << uploadStats.m_overflowCount << " overflows";
+    Logger::getInstance().log(LogLevel::INFO, uploadMessage.str());
+}
+
+// Hands every frame that finished reading back to the consumer. The pixels are read in place from mapped memory, no copy is made.
+// This is where a video encoder or image diff would plug in; for now the frames are only accounted for.
+void Engine::consumeCapturedFrames()
+{
+    while (std::optional<VulkanReadbackFrame> frame = m_renderer->acquireReadbackFrame())
+    {
+        m_capturedBytes += frame->m_pixels.size();
+        m_renderer->releaseReadbackFrame(frame.value());
+    }
+}
+
+// Accumulates frame timings and logs the averages periodically so it is visible whether the CPU or the GPU is the bottleneck
+void Engine::reportFrameStats(const VulkanFrameStats &frameStats)
+{
+    constexpr uint32_t REPORT_INTERVAL_FRAMES = 1000;
+
+    m_accumulatedFrameStats.m_pacingWaitMs += frameStats.m_pacingWaitMs;
+    m_accumulatedFrameStats.m_fenceWaitMs += frameStats.m_fenceWaitMs;
+    m_accumulatedFrameStats.m_acquireWaitMs += frameStats.m_acquireWaitMs;
+    m_accumulatedFrameStats.m_cpuWorkMs += frameStats.m_cpuWorkMs;
+    m_accumulatedFrameStats.m_gpuTimeMs += frameStats.m_gpuTimeMs;
+    m_accumulatedFrameCount++;
+
+    if (m_accumulatedFrameCount < REPORT_INTERVAL_FRAMES)
+    {
+        return;
+    }
+
+    const double frameCount = static_cast<double>(m_accumulatedFrameCount);
+    const double cpuWaitMs = (m_accumulatedFrameStats.m_pacingWaitMs + m_accumulatedFrameStats.m_fenceWaitMs + m_accumulatedFrameStats.m_acquireWaitMs) / frameCount;
+    const double cpuWorkMs = m_accumulatedFrameStats.m_cpuWorkMs / frameCount;
+
+    std::ostringstream message;
+    message << "Frame " << frameStats.m_frameNumber << " (avg over " << m_accumulatedFrameCount << " frames): "
+            << "pacing wait " << m_accumulatedFrameStats.m_pacingWaitMs / frameCount << " ms, "
+            << "fence wait " << m_accumulatedFrameStats.m_fenceWaitMs / frameCount << " ms, "
+            << "acquire wait " << m_accumulatedFrameStats.m_acquireWaitMs / frameCount << " ms, "
+            << "cpu work " << cpuWorkMs << " ms, "
+            << "gpu " << m_accumulatedFrameStats.m_gpuTimeMs / frameCount << " ms -> "
+            << (cpuWaitMs > cpuWorkMs ? "GPU-bound" : "CPU-bound");
+    if (m_presentIntervalCount > 0)
+    {
+        message << ", present interval avg " << m_accumulatedPresentIntervalMs / m_presentIntervalCount
+                << " ms, max " << m_maxPresentIntervalMs << " ms";
+    }
+    Logger::getInstance().log(LogLevel::INFO, message.str());
+
+    m_accumulatedFrameStats = VulkanFrameStats{};
+    m_accumulatedFrameCount = 0;
+    m_accumulatedPresentIntervalMs = 0.0;
+    m_maxPresentIntervalMs = 0.0;
+    m_presentIntervalCount = 0;
+}
+
+void Engine::onPresentConfigured(const VulkanPresentConfiguration &presentConfiguration)
+{
+    std::ostringstream message;
+    message << "Present policy " << presentPolicyToString(presentConfiguration.m_policy) << ": "
+            << string_VkPresentModeKHR(presentConfiguration.m_presentMode) << ", "
+            << presentConfiguration.m_imageCount << " images of "
+            << presentConfiguration.m_extent.width << "x" << presentConfiguration.m_extent.height
+            << (m_config.m_framePacing ? ", frame pacing" : "");
+    Logger::getInstance().log(LogLevel::INFO, message.str());
+}
+
+// The maximum shows stutter (missed refreshes) that the average hides
+void Engine::onPresent(const double presentIntervalMs)
+{
+    m_accumulatedPresentIntervalMs += presentIntervalMs;
+    m_maxPresentIntervalMs = std::max(m_maxPresentIntervalMs, presentIntervalMs);
+    m_presentIntervalCount++;
 }
 
 void Engine::cleanup()
 {
+    if (m_shaderHotReloader != nullptr)
+    {
+        m_shaderHotReloader->stop();
+        const ShaderHotReloadStats reloadStats = m_shaderHotReloader->getStats();
+        std::ostringstream reloadMessage;
+        reloadMessage << "Shader hot reload: " << reloadStats.m_compiledCount << " shaders recompiled, " << reloadStats.m_failedCount
+                      << " failed, " << reloadStats.m_compileMs << " ms of compilation";
+        Logger::getInstance().log(LogLevel::INFO, reloadMessage.str());
+        delete m_shaderHotReloader;
+        m_shaderHotReloader = nullptr;
+    }
+
+    if (m_particleSystem != nullptr)
+    {
+        verifyParticles();
+    }
+
     if (m_renderer != nullptr)
     {
         m_renderer->cleanup();
+
+        // Draws that found their pipeline still compiling: with a manifest from a previous session this should be 0
+        const VulkanPipelineUsageStats &usageStats = m_renderer->getPipelineUsageStats();
+        const VulkanPipelineRegistryStats registryStats = m_renderer->getPipelineRegistry().getStats();
+        std::ostringstream usageMessage;
+        usageMessage << "Pipeline usage: " << usageStats.m_pipelineSwitchCount << " switches, " << usageStats.m_notReadyDrawCount
+                     << " draws waited " << usageStats.m_notReadyWaitMs << " ms for a pipeline still compiling, "
+                     << registryStats.m_prewarmHitCount << " requests served by pre-warmed pipelines";
+        Logger::getInstance().log(LogLevel::INFO, usageMessage.str());
+
+        // Hits are loads that found the module of an identical binary already created
+        const VulkanShaderModuleCache &shaderModuleCache = m_renderer->getVulkanDevice().getShaderModuleCache();
+        const VulkanShaderModuleCacheStats shaderStats = shaderModuleCache.getStats();
+        std::ostringstream shaderMessage;
+        shaderMessage << "Shader modules: " << shaderStats.m_missCount << " created, " << shaderStats.m_hitCount << " loads shared an existing module, "
+                      << shaderStats.m_archiveLoadCount << " loads from the archive, " << shaderStats.m_mappedBytes / 1024 << " KiB mapped in "
+                      << shaderStats.m_loadMs << " ms";
+        Logger::getInstance().log(LogLevel::INFO, shaderMessage.str());
+        for (const VulkanShaderLoadStats &loadStats : shaderModuleCache.getLoadStats())
+        {
+            std::ostringstream message;
+            message << "  " << loadStats.m_path << (loadStats.m_isFromArchive ? " (archive)" : "") << ": " << loadStats.m_mappedBytes << " bytes, "
+                    << loadStats.m_loadCount << " loads (" << loadStats.m_hitCount << " shared) in " << loadStats.m_loadMs << " ms";
+            Logger::getInstance().log(LogLevel::INFO, message.str());
+        }
+
+        // Layouts reflected from the shaders: pipelines with the same interface share one
+        const VulkanPipelineLayoutCacheStats layoutStats = m_renderer->getVulkanDevice().getPipelineLayoutCache().getStats();
+        std::ostringstream layoutMessage;
+        layoutMessage << "Pipeline layouts: " << layoutStats.m_pipelineLayoutCount << " created for " << layoutStats.m_requestCount << " pipelines, "
+                      << layoutStats.m_setLayoutCount << " descriptor set layouts";
+        Logger::getInstance().log(LogLevel::INFO, layoutMessage.str());
+
+        // Barriers recorded every frame, and what aliasing saved on the graph's transient resources
+        const VulkanRenderGraphStats &graphStats = m_renderer->getRenderGraph().getStats();
+        std::ostringstream graphMessage;
+        graphMessage << "Render graph: " << graphStats.m_passCount << " passes (" << graphStats.m_culledPassCount << " culled) in "
+                     << graphStats.m_renderPassCount << " render passes (" << graphStats.m_mergedPassCount << " passes merged as subpasses) and "
+                     << graphStats.m_dynamicRenderingCount << " with dynamic rendering, "
+                     << graphStats.m_barrierBatchCount << " barrier batches / " << graphStats.m_imageBarrierCount << " image barriers ("
+                     << graphStats.m_layoutTransitionCount << " layout transitions) per frame, transient memory "
+                     << graphStats.m_transientBytes / 1024 << " KiB aliased into " << graphStats.m_aliasedBytes / 1024 << " KiB, "
+                     << graphStats.m_lazyImageCount << " attachments never leaving tile memory (" << graphStats.m_lazyBytes / 1024
+                     << " KiB lazily allocated)";
+        Logger::getInstance().log(LogLevel::INFO, graphMessage.str());
+
+        const VulkanPipelineCacheStats &pipelineCacheStats = m_renderer->getPipelineCacheStats();
+        if (pipelineCacheStats.m_savedBytes > 0)
+        {
+            std::ostringstream message;
+            message << "Pipeline cache: saved " << pipelineCacheStats.m_savedBytes / 1024 << " KiB to " << m_config.m_pipelineCachePath;
+            Logger::getInstance().log(LogLevel::INFO, message.str());
+        }
+
         delete m_renderer;
         m_renderer = nullptr;
     }
@@ -0,0 +1,157 @@
+#include "core/renderer/VulkanAsyncCompute.hpp"
+
+#include "core/renderer/VulkanDevice.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+
+#include <stdexcept>
+#include <string>
+
+VulkanAsyncCompute::VulkanAsyncCompute() : m_device(VK_NULL_HANDLE), m_computeQueue(VK_NULL_HANDLE), m_computeFamily(0), m_graphicsFamily(0) {}
+
+VulkanAsyncCompute::~VulkanAsyncCompute() {}
+
+void VulkanAsyncCompute::createAsyncCompute(const VulkanDevice &vulkanDevice, const uint32_t framesInFlight)
+{
+    m_device = vulkanDevice.getDevice();
+    m_computeQueue = vulkanDevice.getComputeQueue();
+    m_computeFamily = vulkanDevice.getComputeQueueFamily();
+    m_graphicsFamily = vulkanDevice.getQueueFamilyIndices().m_graphicsFamily.value();
+
+    m_commandPool.createCommandPool(m_device, m_computeFamily);
+    m_commandBuffers = m_commandPool.allocateCommandBuffers(framesInFlight);
+
+    m_computeFinishedSemaphores.resize(framesInFlight, VK_NULL_HANDLE);
+    m_computeFences.resize(framesInFlight, VK_NULL_HANDLE);
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    // Fences are created signaled so the first wait on each frame slot returns immediately
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    for (uint32_t i = 0; i < framesInFlight; i++)
+    {
+        VkResult result = vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_computeFinishedSemaphores[i]);
+        if (result == VK_SUCCESS)
+        {
+            result = vkCreateFence(m_device, &fenceInfo, nullptr, &m_computeFences[i]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Failed to create async compute synchronization objects! VkResult: ") + string_VkResult(result));
+        }
+    }
+}
+
+VkCommandBuffer VulkanAsyncCompute::beginFrame(const uint32_t frameIndex)
+{
+    // The graphics frame that last used this slot waited on its compute semaphore, so this normally returns immediately
+    const VkFence fence = m_computeFences[frameIndex];
+    vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+
+    const VkCommandBuffer commandBuffer = m_commandBuffers[frameIndex];
+    vkResetCommandBuffer(commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to begin recording compute command buffer! VkResult: ") + string_VkResult(result));
+    }
+
+    return commandBuffer;
+}
+
+VulkanSemaphoreWait VulkanAsyncCompute::submit(const uint32_t frameIndex, const std::vector<VulkanSemaphoreWait> &waits, const VkPipelineStageFlags graphicsWaitStageMask)
+{
+    const VkCommandBuffer commandBuffer = m_commandBuffers[frameIndex];
+    const VkSemaphore computeFinishedSemaphore = m_computeFinishedSemaphores[frameIndex];
+    const VkFence fence = m_computeFences[frameIndex];
+
+    VkResult result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to record compute command buffer! VkResult: ") + string_VkResult(result));
+    }
+
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<VkPipelineStageFlags> waitStages;
+    std::vector<uint64_t> waitValues; // Only read for timeline semaphores
+    bool hasTimelineWait = false;
+    for (const VulkanSemaphoreWait &wait : waits)
+    {
+        waitSemaphores.push_back(wait.m_semaphore);
+        waitStages.push_back(wait.m_stageMask);
+        waitValues.push_back(wait.m_value);
+        hasTimelineWait = hasTimelineWait || wait.m_isTimeline;
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &computeFinishedSemaphore;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    if (hasTimelineWait)
+    {
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+        timelineInfo.pWaitSemaphoreValues = waitValues.data();
+        submitInfo.pNext = &timelineInfo;
+    }
+
+    vkResetFences(m_device, 1, &fence);
+    result = vkQueueSubmit(m_computeQueue, 1, &submitInfo, fence);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to submit compute command buffer! VkResult: ") + string_VkResult(result));
+    }
+
+    return VulkanSemaphoreWait{computeFinishedSemaphore, 0, false, graphicsWaitStageMask};
+}
+
+std::vector<uint32_t> VulkanAsyncCompute::getSharedQueueFamilies() const
+{
+    if (!isAsync())
+    {
+        return {m_graphicsFamily};
+    }
+    return {m_graphicsFamily, m_computeFamily};
+}
+
+// The device must be idle
+void VulkanAsyncCompute::cleanUp()
+{
+    for (VkSemaphore semaphore : m_computeFinishedSemaphores)
+    {
+        if (semaphore != VK_NULL_HANDLE)
+        {
+            vkDestroySemaphore(m_device, semaphore, nullptr);
+        }
+    }
+    m_computeFinishedSemaphores.clear();
+
+    for (VkFence fence : m_computeFences)
+    {
+        if (fence != VK_NULL_HANDLE)
+        {
+            vkDestroyFence(m_device, fence, nullptr);
+        }
+    }
+    m_computeFences.clear();
+
+    // Command buffers are freed together with their pool
+    m_commandBuffers.clear();
+    m_commandPool.cleanUp();
+}
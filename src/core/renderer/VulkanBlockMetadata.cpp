@@ -0,0 +1,466 @@
+#include "core/renderer/VulkanBlockMetadata.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace
+{
+    // Vulkan alignments and bufferImageGranularity are powers of two
+    VkDeviceSize alignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    VkDeviceSize alignDown(const VkDeviceSize value, const VkDeviceSize alignment)
+    {
+        return value & ~(alignment - 1);
+    }
+}
+
+VulkanBlockMetadata::VulkanBlockMetadata(const VkDeviceSize size, const VkDeviceSize bufferImageGranularity)
+    : m_size(size), m_bufferImageGranularity(std::max<VkDeviceSize>(bufferImageGranularity, 1)), m_usedBytes(0), m_freeRangeCount(0),
+      m_firstLevelBitmap(0)
+{
+    if (size == 0)
+    {
+        throw std::runtime_error("VulkanBlockMetadata: a memory block cannot be empty!");
+    }
+
+    m_secondLevelBitmaps.fill(0);
+    m_freeLists.fill(INVALID_NODE);
+
+    // The whole block starts as a single free range
+    const uint32_t nodeIndex = createNode();
+    m_nodes[nodeIndex].m_offset = 0;
+    m_nodes[nodeIndex].m_size = size;
+    insertFree(nodeIndex);
+}
+
+// First level: index of the power of two of the size. Second level: which of the SECOND_LEVEL_COUNT linear subdivisions
+// of that power of two the size falls in. Small sizes share the first level 0 so tiny classes are not wasted.
+VulkanBlockMetadata::SizeClass VulkanBlockMetadata::mapSize(const VkDeviceSize size)
+{
+    if (size < (VkDeviceSize(1) << SMALL_SIZE_LOG2))
+    {
+        return SizeClass{0, static_cast<uint32_t>(size >> (SMALL_SIZE_LOG2 - SECOND_LEVEL_LOG2))};
+    }
+
+    const uint32_t mostSignificantBit = static_cast<uint32_t>(std::bit_width(size)) - 1;
+    const uint32_t firstLevel = mostSignificantBit - SMALL_SIZE_LOG2 + 1;
+    const uint32_t secondLevel = static_cast<uint32_t>(size >> (mostSignificantBit - SECOND_LEVEL_LOG2)) ^ SECOND_LEVEL_COUNT;
+    return SizeClass{firstLevel, secondLevel};
+}
+
+// Rounds the size up to the start of the next size class, so every free range of the class it maps to is at least that large
+VkDeviceSize VulkanBlockMetadata::roundUpToSizeClass(const VkDeviceSize size)
+{
+    if (size < (VkDeviceSize(1) << SMALL_SIZE_LOG2))
+    {
+        return alignUp(size, VkDeviceSize(1) << (SMALL_SIZE_LOG2 - SECOND_LEVEL_LOG2));
+    }
+
+    const uint32_t mostSignificantBit = static_cast<uint32_t>(std::bit_width(size)) - 1;
+    return alignUp(size, VkDeviceSize(1) << (mostSignificantBit - SECOND_LEVEL_LOG2));
+}
+
+bool VulkanBlockMetadata::typesConflict(const VulkanAllocationType first, const VulkanAllocationType second)
+{
+    return first == VulkanAllocationType::UNKNOWN || second == VulkanAllocationType::UNKNOWN || first != second;
+}
+
+std::optional<VkDeviceSize> VulkanBlockMetadata::allocate(const VkDeviceSize size, const VkDeviceSize alignment, const VulkanAllocationType type)
+{
+    const VkDeviceSize requiredAlignment = std::max<VkDeviceSize>(alignment, 1);
+    if (size == 0 || size > m_size)
+    {
+        return std::nullopt;
+    }
+
+    constexpr uint32_t lastClass = FIRST_LEVEL_COUNT * SECOND_LEVEL_COUNT - 1;
+    const uint32_t sizeClass = classIndex(mapSize(size));
+
+    // Good fit: any free range in the classes above the request padded for alignment is large enough, so the first one
+    // found is almost always used (it can only be rejected by bufferImageGranularity conflicts)
+    const VkDeviceSize searchSize = roundUpToSizeClass(std::min(size + requiredAlignment - 1, m_size));
+    const uint32_t searchClass = std::min(classIndex(mapSize(searchSize)), lastClass);
+
+    VkDeviceSize offset = 0;
+    uint32_t nodeIndex = findFreeNode(searchClass, lastClass, size, requiredAlignment, type, offset);
+
+    // Ranges of the request's own size class may still fit if little or no padding is needed.
+    // Only that one list is checked, so a failing allocation stays cheap when the block is nearly full.
+    if (nodeIndex == INVALID_NODE && searchClass > sizeClass)
+    {
+        nodeIndex = findFreeNode(sizeClass, sizeClass, size, requiredAlignment, type, offset);
+    }
+
+    if (nodeIndex == INVALID_NODE)
+    {
+        return std::nullopt;
+    }
+
+    allocateInNode(nodeIndex, offset, size, type);
+    return offset;
+}
+
+// Looks through the free lists of the size classes [firstClass, lastClass], skipping empty lists with the bitmaps
+uint32_t VulkanBlockMetadata::findFreeNode(const uint32_t firstClass, const uint32_t lastClass, const VkDeviceSize size, const VkDeviceSize alignment,
+                                           const VulkanAllocationType type, VkDeviceSize &offset) const
+{
+    const uint32_t firstLevelBegin = firstClass / SECOND_LEVEL_COUNT;
+    const uint32_t firstLevelEnd = lastClass / SECOND_LEVEL_COUNT;
+
+    uint64_t firstLevelMap = m_firstLevelBitmap & (~uint64_t(0) << firstLevelBegin);
+    while (firstLevelMap != 0)
+    {
+        const uint32_t firstLevel = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+        firstLevelMap &= firstLevelMap - 1;
+        if (firstLevel > firstLevelEnd)
+        {
+            break;
+        }
+
+        uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel];
+        if (firstLevel == firstLevelBegin)
+        {
+            secondLevelMap &= ~0u << (firstClass % SECOND_LEVEL_COUNT);
+        }
+        if (firstLevel == firstLevelEnd && (lastClass % SECOND_LEVEL_COUNT) < SECOND_LEVEL_COUNT - 1)
+        {
+            secondLevelMap &= (2u << (lastClass % SECOND_LEVEL_COUNT)) - 1;
+        }
+
+        while (secondLevelMap != 0)
+        {
+            const uint32_t secondLevel = static_cast<uint32_t>(std::countr_zero(secondLevelMap));
+            secondLevelMap &= secondLevelMap - 1;
+
+            for (uint32_t nodeIndex = m_freeLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel]; nodeIndex != INVALID_NODE; nodeIndex = m_nodes[nodeIndex].m_nextFree)
+            {
+                if (std::optional<VkDeviceSize> nodeOffset = findOffsetInNode(nodeIndex, size, alignment, type))
+                {
+                    offset = nodeOffset.value();
+                    return nodeIndex;
+                }
+            }
+        }
+    }
+
+    return INVALID_NODE;
+}
+
+// Where the allocation would start inside the free node, honouring the alignment and bufferImageGranularity:
+// the allocation cannot share a granularity page with a conflicting allocation before or after it.
+std::optional<VkDeviceSize> VulkanBlockMetadata::findOffsetInNode(const uint32_t nodeIndex, const VkDeviceSize size, const VkDeviceSize alignment,
+                                                                  const VulkanAllocationType type) const
+{
+    const Node &node = m_nodes[nodeIndex];
+    if (node.m_size < size)
+    {
+        return std::nullopt;
+    }
+
+    VkDeviceSize offset = alignUp(node.m_offset, alignment);
+    const VkDeviceSize granularity = m_bufferImageGranularity;
+
+    if (granularity > 1)
+    {
+        for (uint32_t prev = node.m_prevPhysical;
+             prev != INVALID_NODE && alignDown(m_nodes[prev].m_offset + m_nodes[prev].m_size - 1, granularity) == alignDown(offset, granularity);
+             prev = m_nodes[prev].m_prevPhysical)
+        {
+            if (!m_nodes[prev].m_isFree && typesConflict(m_nodes[prev].m_type, type))
+            {
+                offset = alignUp(offset, granularity); // Start on the next page
+                break;
+            }
+        }
+    }
+
+    if (offset + size > node.m_offset + node.m_size)
+    {
+        return std::nullopt;
+    }
+
+    if (granularity > 1)
+    {
+        const VkDeviceSize lastPage = alignDown(offset + size - 1, granularity);
+        for (uint32_t next = node.m_nextPhysical;
+             next != INVALID_NODE && alignDown(m_nodes[next].m_offset, granularity) == lastPage;
+             next = m_nodes[next].m_nextPhysical)
+        {
+            if (!m_nodes[next].m_isFree && typesConflict(m_nodes[next].m_type, type))
+            {
+                return std::nullopt;
+            }
+        }
+    }
+
+    return offset;
+}
+
+// Splits the free node into [alignment padding][allocation][remainder]. Padding and remainder stay free.
+// The lower node is always kept, so node 0 keeps starting at offset 0.
+void VulkanBlockMetadata::allocateInNode(const uint32_t nodeIndex, const VkDeviceSize offset, const VkDeviceSize size, const VulkanAllocationType type)
+{
+    removeFree(nodeIndex);
+
+    uint32_t allocationIndex = nodeIndex;
+    if (offset > m_nodes[nodeIndex].m_offset)
+    {
+        allocationIndex = splitNode(nodeIndex, offset - m_nodes[nodeIndex].m_offset);
+        insertFree(nodeIndex);
+    }
+
+    if (m_nodes[allocationIndex].m_size > size)
+    {
+        const uint32_t remainderIndex = splitNode(allocationIndex, size);
+        insertFree(remainderIndex);
+    }
+
+    Node &allocation = m_nodes[allocationIndex];
+    allocation.m_isFree = false;
+    allocation.m_type = type;
+    m_usedNodes[offset] = allocationIndex;
+    m_usedBytes += size;
+}
+
+// Cuts the node in two after firstSize bytes and returns the new, upper node (free, not yet in a free list)
+uint32_t VulkanBlockMetadata::splitNode(const uint32_t nodeIndex, const VkDeviceSize firstSize)
+{
+    const uint32_t upperIndex = createNode(); // May reallocate m_nodes: index, do not hold references across it
+
+    Node &lower = m_nodes[nodeIndex];
+    Node &upper = m_nodes[upperIndex];
+    upper.m_offset = lower.m_offset + firstSize;
+    upper.m_size = lower.m_size - firstSize;
+    upper.m_prevPhysical = nodeIndex;
+    upper.m_nextPhysical = lower.m_nextPhysical;
+    if (lower.m_nextPhysical != INVALID_NODE)
+    {
+        m_nodes[lower.m_nextPhysical].m_prevPhysical = upperIndex;
+    }
+    lower.m_nextPhysical = upperIndex;
+    lower.m_size = firstSize;
+
+    return upperIndex;
+}
+
+void VulkanBlockMetadata::free(const VkDeviceSize offset)
+{
+    auto usedNode = m_usedNodes.find(offset);
+    if (usedNode == m_usedNodes.end())
+    {
+        throw std::runtime_error("VulkanBlockMetadata: freeing an offset that is not allocated!");
+    }
+    uint32_t nodeIndex = usedNode->second;
+    m_usedNodes.erase(usedNode);
+
+    m_usedBytes -= m_nodes[nodeIndex].m_size;
+    m_nodes[nodeIndex].m_isFree = true;
+    m_nodes[nodeIndex].m_type = VulkanAllocationType::UNKNOWN;
+
+    // Merge with the free neighbours, keeping the lower node
+    const uint32_t prev = m_nodes[nodeIndex].m_prevPhysical;
+    if (prev != INVALID_NODE && m_nodes[prev].m_isFree)
+    {
+        removeFree(prev);
+        mergeWithNext(prev);
+        nodeIndex = prev;
+    }
+
+    const uint32_t next = m_nodes[nodeIndex].m_nextPhysical;
+    if (next != INVALID_NODE && m_nodes[next].m_isFree)
+    {
+        removeFree(next);
+        mergeWithNext(nodeIndex);
+    }
+
+    insertFree(nodeIndex);
+}
+
+// Absorbs the next physical node (neither may be in a free list)
+void VulkanBlockMetadata::mergeWithNext(const uint32_t nodeIndex)
+{
+    Node &node = m_nodes[nodeIndex];
+    const uint32_t nextIndex = node.m_nextPhysical;
+    const Node &next = m_nodes[nextIndex];
+
+    node.m_size += next.m_size;
+    node.m_nextPhysical = next.m_nextPhysical;
+    if (next.m_nextPhysical != INVALID_NODE)
+    {
+        m_nodes[next.m_nextPhysical].m_prevPhysical = nodeIndex;
+    }
+    releaseNode(nextIndex);
+}
+
+VkDeviceSize VulkanBlockMetadata::getLargestFreeRange() const
+{
+    if (m_firstLevelBitmap == 0)
+    {
+        return 0;
+    }
+
+    // Every range of a size class is larger than every range of the classes below: only the highest non-empty list matters
+    const uint32_t firstLevel = 63 - static_cast<uint32_t>(std::countl_zero(m_firstLevelBitmap));
+    const uint32_t secondLevel = 31 - static_cast<uint32_t>(std::countl_zero(m_secondLevelBitmaps[firstLevel]));
+
+    VkDeviceSize largest = 0;
+    for (uint32_t nodeIndex = m_freeLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel]; nodeIndex != INVALID_NODE; nodeIndex = m_nodes[nodeIndex].m_nextFree)
+    {
+        largest = std::max(largest, m_nodes[nodeIndex].m_size);
+    }
+    return largest;
+}
+
+bool VulkanBlockMetadata::validate() const
+{
+    // Physical order: contiguous, covering the whole block, no two free neighbours
+    VkDeviceSize expectedOffset = 0;
+    VkDeviceSize usedBytes = 0;
+    uint32_t freeRangeCount = 0;
+    uint32_t usedRangeCount = 0;
+    bool previousIsFree = false;
+    for (uint32_t nodeIndex = 0; nodeIndex != INVALID_NODE; nodeIndex = m_nodes[nodeIndex].m_nextPhysical)
+    {
+        const Node &node = m_nodes[nodeIndex];
+        if (node.m_offset != expectedOffset || node.m_size == 0 || (node.m_isFree && previousIsFree))
+        {
+            return false;
+        }
+        if (node.m_nextPhysical != INVALID_NODE && m_nodes[node.m_nextPhysical].m_prevPhysical != nodeIndex)
+        {
+            return false;
+        }
+
+        if (node.m_isFree)
+        {
+            freeRangeCount++;
+        }
+        else
+        {
+            auto usedNode = m_usedNodes.find(node.m_offset);
+            if (usedNode == m_usedNodes.end() || usedNode->second != nodeIndex)
+            {
+                return false;
+            }
+            usedBytes += node.m_size;
+            usedRangeCount++;
+        }
+
+        expectedOffset += node.m_size;
+        previousIsFree = node.m_isFree;
+    }
+
+    if (expectedOffset != m_size || usedBytes != m_usedBytes || freeRangeCount != m_freeRangeCount || usedRangeCount != m_usedNodes.size())
+    {
+        return false;
+    }
+
+    // Free lists: every node free and in the right class, bitmaps set exactly for the non-empty lists
+    uint32_t listedFreeRangeCount = 0;
+    for (uint32_t firstLevel = 0; firstLevel < FIRST_LEVEL_COUNT; firstLevel++)
+    {
+        const bool firstLevelBit = (m_firstLevelBitmap >> firstLevel) & 1;
+        if (firstLevelBit != (m_secondLevelBitmaps[firstLevel] != 0))
+        {
+            return false;
+        }
+
+        for (uint32_t secondLevel = 0; secondLevel < SECOND_LEVEL_COUNT; secondLevel++)
+        {
+            const uint32_t head = m_freeLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel];
+            const bool secondLevelBit = (m_secondLevelBitmaps[firstLevel] >> secondLevel) & 1;
+            if (secondLevelBit != (head != INVALID_NODE))
+            {
+                return false;
+            }
+
+            for (uint32_t nodeIndex = head; nodeIndex != INVALID_NODE; nodeIndex = m_nodes[nodeIndex].m_nextFree)
+            {
+                const SizeClass sizeClass = mapSize(m_nodes[nodeIndex].m_size);
+                if (!m_nodes[nodeIndex].m_isFree || sizeClass.m_firstLevel != firstLevel || sizeClass.m_secondLevel != secondLevel)
+                {
+                    return false;
+                }
+                listedFreeRangeCount++;
+            }
+        }
+    }
+
+    return listedFreeRangeCount == m_freeRangeCount;
+}
+
+uint32_t VulkanBlockMetadata::createNode()
+{
+    if (!m_unusedNodes.empty())
+    {
+        const uint32_t nodeIndex = m_unusedNodes.back();
+        m_unusedNodes.pop_back();
+        m_nodes[nodeIndex] = Node{};
+        return nodeIndex;
+    }
+
+    m_nodes.emplace_back();
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+void VulkanBlockMetadata::releaseNode(const uint32_t nodeIndex)
+{
+    m_nodes[nodeIndex] = Node{};
+    m_unusedNodes.push_back(nodeIndex);
+}
+
+void VulkanBlockMetadata::insertFree(const uint32_t nodeIndex)
+{
+    const SizeClass sizeClass = mapSize(m_nodes[nodeIndex].m_size);
+    uint32_t &head = m_freeLists[classIndex(sizeClass)];
+
+    Node &node = m_nodes[nodeIndex];
+    node.m_isFree = true;
+    node.m_prevFree = INVALID_NODE;
+    node.m_nextFree = head;
+    if (head != INVALID_NODE)
+    {
+        m_nodes[head].m_prevFree = nodeIndex;
+    }
+    head = nodeIndex;
+
+    m_secondLevelBitmaps[sizeClass.m_firstLevel] |= 1u << sizeClass.m_secondLevel;
+    m_firstLevelBitmap |= uint64_t(1) << sizeClass.m_firstLevel;
+    m_freeRangeCount++;
+}
+
+void VulkanBlockMetadata::removeFree(const uint32_t nodeIndex)
+{
+    const SizeClass sizeClass = mapSize(m_nodes[nodeIndex].m_size);
+    uint32_t &head = m_freeLists[classIndex(sizeClass)];
+
+    Node &node = m_nodes[nodeIndex];
+    if (node.m_prevFree != INVALID_NODE)
+    {
+        m_nodes[node.m_prevFree].m_nextFree = node.m_nextFree;
+    }
+    else
+    {
+        head = node.m_nextFree;
+    }
+    if (node.m_nextFree != INVALID_NODE)
+    {
+        m_nodes[node.m_nextFree].m_prevFree = node.m_prevFree;
+    }
+    node.m_prevFree = INVALID_NODE;
+    node.m_nextFree = INVALID_NODE;
+
+    if (head == INVALID_NODE)
+    {
+        m_secondLevelBitmaps[sizeClass.m_firstLevel] &= ~(1u << sizeClass.m_secondLevel);
+        if (m_secondLevelBitmaps[sizeClass.m_firstLevel] == 0)
+        {
+            m_firstLevelBitmap &= ~(uint64_t(1) << sizeClass.m_firstLevel);
+        }
+    }
+    m_freeRangeCount--;
+}
@@ -0,0 +1,57 @@
+#include "core/renderer/VulkanCommandPool.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+#include <stdexcept>
+#include <string>
+
+VulkanCommandPool::VulkanCommandPool() : m_device(VK_NULL_HANDLE), m_commandPool(VK_NULL_HANDLE) {}
+
+VulkanCommandPool::~VulkanCommandPool() {}
+
+void VulkanCommandPool::createCommandPool(const VkDevice &device, const uint32_t queueFamilyIndex, const VkCommandPoolCreateFlags flags)
+{
+    m_device = device;
+
+    // Command buffers are executed by submitting them on one of the device queues.
+    // Each command pool can only allocate command buffers that are submitted on a single type of queue.
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = flags;
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+
+    VkResult result = vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_commandPool);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create command pool! VkResult: ") + string_VkResult(result));
+    }
+}
+
+std::vector<VkCommandBuffer> VulkanCommandPool::allocateCommandBuffers(const uint32_t count, const VkCommandBufferLevel level)
+{
+    // PRIMARY: Can be submitted to a queue for execution, but cannot be called from other command buffers.
+    // SECONDARY: Cannot be submitted directly, but can be called from primary command buffers.
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = m_commandPool;
+    allocInfo.level = level;
+    allocInfo.commandBufferCount = count;
+
+    std::vector<VkCommandBuffer> commandBuffers(count);
+    VkResult result = vkAllocateCommandBuffers(m_device, &allocInfo, commandBuffers.data());
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to allocate command buffers! VkResult: ") + string_VkResult(result));
+    }
+
+    return commandBuffers;
+}
+
+void VulkanCommandPool::cleanUp()
+{
+    // Command buffers are freed together with their pool
+    if (m_commandPool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+        m_commandPool = VK_NULL_HANDLE;
+    }
+}
@@ -0,0 +1,48 @@
+#include "core/renderer/VulkanComputePipeline.hpp"
+
+#include "graphics/Shader.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+
+#include <stdexcept>
+#include <string>
+
+VulkanComputePipeline::VulkanComputePipeline()
+    : m_device(VK_NULL_HANDLE), m_computePipeline(VK_NULL_HANDLE), m_pipelineLayout(VK_NULL_HANDLE) {}
+
+VulkanComputePipeline::~VulkanComputePipeline()
+{
+}
+
+void VulkanComputePipeline::createPipeline(const VkDevice &device, const Shader &shader, const VkPipelineLayout &pipelineLayout,
+                                           const VkPipelineCache pipelineCache)
+{
+    m_device = device;
+    m_pipelineLayout = pipelineLayout;
+    createComputePipeline(shader, pipelineCache);
+}
+
+void VulkanComputePipeline::createComputePipeline(const Shader &shader, const VkPipelineCache pipelineCache)
+{
+    // A compute pipeline is a single stage: no fixed function state and no render pass
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = shader.getStageInfo(VK_SHADER_STAGE_COMPUTE_BIT);
+    pipelineInfo.layout = m_pipelineLayout;
+
+    VkResult result = vkCreateComputePipelines(m_device, pipelineCache, 1, &pipelineInfo, nullptr, &m_computePipeline);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create compute pipeline! VkResult: ") + string_VkResult(result));
+    }
+}
+
+void VulkanComputePipeline::cleanUp()
+{
+    if (m_computePipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(m_device, m_computePipeline, nullptr);
+        m_computePipeline = VK_NULL_HANDLE;
+    }
+    m_pipelineLayout = VK_NULL_HANDLE; // Not owned
+}
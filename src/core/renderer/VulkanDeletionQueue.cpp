@@ -0,0 +1,33 @@
+#include "core/renderer/VulkanDeletionQueue.hpp"
+
+#include <utility>
+
+VulkanDeletionQueue::VulkanDeletionQueue() {}
+
+VulkanDeletionQueue::~VulkanDeletionQueue() {}
+
+void VulkanDeletionQueue::push(const uint64_t submittedFrameCount, std::function<void()> &&deleter)
+{
+    m_entries.push_back(Entry{submittedFrameCount, std::move(deleter)});
+}
+
+void VulkanDeletionQueue::flush(const uint64_t completedFrameCount)
+{
+    while (!m_entries.empty() && m_entries.front().m_submittedFrameCount <= completedFrameCount)
+    {
+        // Pop before running so a throwing deleter cannot be run twice
+        std::function<void()> deleter = std::move(m_entries.front().m_deleter);
+        m_entries.pop_front();
+        deleter();
+    }
+}
+
+void VulkanDeletionQueue::flushAll()
+{
+    while (!m_entries.empty())
+    {
+        std::function<void()> deleter = std::move(m_entries.front().m_deleter);
+        m_entries.pop_front();
+        deleter();
+    }
+}
@@ -5,9 +5,26 @@
 
 #include <vulkan/vk_enum_string_helper.h>
 
+#include <algorithm>
+#include <cstring>
 #include <set>
 #include <map>
 #include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    bool isDeviceExtensionSupported(const VkPhysicalDevice &physicalDevice, const char *extensionName)
+    {
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> extensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+
+        return std::any_of(extensions.begin(), extensions.end(),
+                           [extensionName](const VkExtensionProperties &extension) { return strcmp(extension.extensionName, extensionName) == 0; });
+    }
+}
 
 QueueFamilyIndices findQueueFamilies(const VkPhysicalDevice &physicalDevice, const VkSurfaceKHR &surface)
 {
@@ -20,38 +37,64 @@ QueueFamilyIndices findQueueFamilies(const VkPhysicalDevice &physicalDevice, con
     std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
     vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
 
-    int i = 0;
-    for (const auto &queueFamily : queueFamilies)
+    const bool headless = (surface == VK_NULL_HANDLE);
+
+    // Every family is looked at (no early exit) so a transfer family found after the graphics one is not missed
+    bool transferFamilyIsDedicated = false;
+    for (uint32_t i = 0; i < queueFamilyCount; i++)
     {
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        const VkQueueFamilyProperties &queueFamily = queueFamilies[i];
+
+        if ((queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !indices.m_graphicsFamily.has_value())
         {
             indices.m_graphicsFamily = i;
         }
 
-        VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
-        if (presentSupport)
+        if (!headless && !indices.m_presentFamily.has_value())
         {
-            indices.m_presentFamily = i;
+            VkBool32 presentSupport = false;
+            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+            if (presentSupport)
+            {
+                indices.m_presentFamily = i;
+            }
         }
 
-        if (indices.isComplete())
+        // Graphics and compute queues implicitly support transfers, but a family without graphics runs on the copy engines (DMA)
+        // in parallel with rendering. A transfer-only family is best, a compute + transfer family the fallback
+        const bool supportsTransfer = (queueFamily.queueFlags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT)) != 0;
+        const bool isTransferOnly = (queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0;
+        if (supportsTransfer && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !transferFamilyIsDedicated)
         {
-            break;
+            indices.m_transferFamily = i;
+            transferFamilyIsDedicated = isTransferOnly;
         }
 
-        i++;
+        // Async compute: a compute family without graphics executes in parallel with the graphics queue (e.g. culling or
+        // post-processing of one frame while the next one is rendered). The spec guarantees the graphics family supports compute
+        // when there is one with both, which is the fallback
+        if ((queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) &&
+            !indices.m_computeFamily.has_value())
+        {
+            indices.m_computeFamily = i;
+        }
     }
 
     return indices;
 }
 
-VulkanDevice::VulkanDevice() : m_device(VK_NULL_HANDLE) {}
+VulkanDevice::VulkanDevice()
+    : m_device(VK_NULL_HANDLE), m_physicalDevice(VK_NULL_HANDLE), m_headless(false), m_supportsTimelineSemaphores(false), m_supportsFillModeNonSolid(false),
+      m_supportsTessellationShader(false), m_supportsGeometryShader(false), m_supportsMeshShader(false), m_supportsTaskShader(false),
+      m_supportsDynamicRendering(false), m_graphicsQueue(VK_NULL_HANDLE), m_presentQueue(VK_NULL_HANDLE), m_transferQueue(VK_NULL_HANDLE),
+      m_computeQueue(VK_NULL_HANDLE) {}
 
 VulkanDevice::~VulkanDevice() {}
 
 void VulkanDevice::pickPhysicalDevice(const VkInstance &instance, const VkSurfaceKHR &surface)
 {
+    m_headless = (surface == VK_NULL_HANDLE);
+
     uint32_t physicalDeviceCount = 0;
     vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, nullptr);
     if (physicalDeviceCount == 0)
@@ -74,6 +117,9 @@ void VulkanDevice::pickPhysicalDevice(const VkInstance &instance, const VkSurfac
     if (candidates.rbegin()->first > 0)
     {
         m_physicalDevice = candidates.rbegin()->second;
+        vkGetPhysicalDeviceProperties(m_physicalDevice, &m_physicalDeviceProperties);
+        vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+        queryOptionalFeatures();
     }
     else
     {
@@ -83,10 +129,23 @@ void VulkanDevice::pickPhysicalDevice(const VkInstance &instance, const VkSurfac
 
 void VulkanDevice::createLogicalDevice(const VkSurfaceKHR &surface, const VulkanValidationLayer &vulkanValidationLayer)
 {
-    QueueFamilyIndices indices = findQueueFamilies(m_physicalDevice, surface);
+    m_queueFamilyIndices = findQueueFamilies(m_physicalDevice, surface);
+    const QueueFamilyIndices &indices = m_queueFamilyIndices;
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::set<uint32_t> uniqueQueueFamilies = {indices.m_graphicsFamily.value(), indices.m_presentFamily.value()};
+    std::set<uint32_t> uniqueQueueFamilies = {indices.m_graphicsFamily.value()};
+    if (indices.m_presentFamily.has_value())
+    {
+        uniqueQueueFamilies.insert(indices.m_presentFamily.value());
+    }
+    if (indices.m_transferFamily.has_value())
+    {
+        uniqueQueueFamilies.insert(indices.m_transferFamily.value());
+    }
+    if (indices.m_computeFamily.has_value())
+    {
+        uniqueQueueFamilies.insert(indices.m_computeFamily.value());
+    }
 
     // Priorities to queues to influence the scheduling of command buffer execution using floating point numbers between 0.0 and 1.0. Required
     float queuePriority = 1.0f;
@@ -102,6 +161,9 @@ void VulkanDevice::createLogicalDevice(const VkSurfaceKHR &surface, const Vulkan
     }
 
     VkPhysicalDeviceFeatures deviceFeatures{};
+    deviceFeatures.fillModeNonSolid = m_supportsFillModeNonSolid ? VK_TRUE : VK_FALSE;
+    deviceFeatures.tessellationShader = m_supportsTessellationShader ? VK_TRUE : VK_FALSE;
+    deviceFeatures.geometryShader = m_supportsGeometryShader ? VK_TRUE : VK_FALSE;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -111,8 +173,66 @@ void VulkanDevice::createLogicalDevice(const VkSurfaceKHR &surface, const Vulkan
 
     createInfo.pEnabledFeatures = &deviceFeatures;
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(m_deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = m_deviceExtensions.data();
+    // Features of newer versions and optional extensions are enabled by chaining their structures
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = m_supportsTimelineSemaphores ? VK_TRUE : VK_FALSE;
+    if (m_physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2)
+    {
+        vulkan12Features.pNext = const_cast<void *>(createInfo.pNext);
+        createInfo.pNext = &vulkan12Features;
+    }
+
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures{};
+    extendedDynamicStateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+    extendedDynamicStateFeatures.extendedDynamicState = VK_TRUE;
+    if (m_extendedDynamicStateSupport.m_extendedDynamicState)
+    {
+        extendedDynamicStateFeatures.pNext = const_cast<void *>(createInfo.pNext);
+        createInfo.pNext = &extendedDynamicStateFeatures;
+    }
+
+    VkPhysicalDeviceExtendedDynamicState2FeaturesEXT extendedDynamicState2Features{};
+    extendedDynamicState2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+    extendedDynamicState2Features.extendedDynamicState2 = VK_TRUE;
+    if (m_extendedDynamicStateSupport.m_extendedDynamicState2)
+    {
+        extendedDynamicState2Features.pNext = const_cast<void *>(createInfo.pNext);
+        createInfo.pNext = &extendedDynamicState2Features;
+    }
+
+    VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures{};
+    meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+    meshShaderFeatures.meshShader = VK_TRUE;
+    meshShaderFeatures.taskShader = m_supportsTaskShader ? VK_TRUE : VK_FALSE;
+    if (m_supportsMeshShader)
+    {
+        meshShaderFeatures.pNext = const_cast<void *>(createInfo.pNext);
+        createInfo.pNext = &meshShaderFeatures;
+    }
+
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extendedDynamicState3Features{};
+    extendedDynamicState3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+    extendedDynamicState3Features.extendedDynamicState3PolygonMode = VK_TRUE;
+    if (m_extendedDynamicStateSupport.m_polygonMode)
+    {
+        extendedDynamicState3Features.pNext = const_cast<void *>(createInfo.pNext);
+        createInfo.pNext = &extendedDynamicState3Features;
+    }
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+    if (m_supportsDynamicRendering)
+    {
+        dynamicRenderingFeatures.pNext = const_cast<void *>(createInfo.pNext);
+        createInfo.pNext = &dynamicRenderingFeatures;
+    }
+
+    std::vector<const char *> deviceExtensions = getRequiredDeviceExtensions();
+    deviceExtensions.insert(deviceExtensions.end(), m_optionalExtensions.begin(), m_optionalExtensions.end());
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
     // Previous implementations of Vulkan made a distinction between instance and device specific validation layers but this is not longer the case
     // Tthe following condition will be ignored in up-to-date implementations however it has been added to make compatible with older implementations
@@ -134,7 +254,134 @@ void VulkanDevice::createLogicalDevice(const VkSurfaceKHR &surface, const Vulkan
     }
 
     vkGetDeviceQueue(m_device, indices.m_graphicsFamily.value(), 0, &m_graphicsQueue);
-    vkGetDeviceQueue(m_device, indices.m_presentFamily.value(), 0, &m_presentQueue);
+    if (indices.m_presentFamily.has_value())
+    {
+        vkGetDeviceQueue(m_device, indices.m_presentFamily.value(), 0, &m_presentQueue);
+    }
+    m_transferQueue = m_graphicsQueue;
+    if (indices.m_transferFamily.has_value())
+    {
+        vkGetDeviceQueue(m_device, indices.m_transferFamily.value(), 0, &m_transferQueue);
+    }
+    // Without a transfer-only family, uploads and async compute share the same queue (both are submitted from the render thread)
+    m_computeQueue = m_graphicsQueue;
+    if (indices.m_computeFamily.has_value())
+    {
+        vkGetDeviceQueue(m_device, indices.m_computeFamily.value(), 0, &m_computeQueue);
+    }
+
+    m_memoryAllocator.create(*this);
+    m_shaderModuleCache.createCache(m_device);
+    m_pipelineLayoutCache.createCache(m_device);
+}
+
+void VulkanDevice::queryOptionalFeatures()
+{
+    VkPhysicalDeviceFeatures deviceFeatures;
+    vkGetPhysicalDeviceFeatures(m_physicalDevice, &deviceFeatures);
+    m_supportsFillModeNonSolid = (deviceFeatures.fillModeNonSolid == VK_TRUE);
+    m_supportsTessellationShader = (deviceFeatures.tessellationShader == VK_TRUE);
+    m_supportsGeometryShader = (deviceFeatures.geometryShader == VK_TRUE);
+
+    // Features of newer versions and extensions are queried through vkGetPhysicalDeviceFeatures2 (core since 1.1).
+    // Only the structures of supported extensions are chained
+    if (m_physicalDeviceProperties.apiVersion < VK_API_VERSION_1_1)
+    {
+        return;
+    }
+
+    VkPhysicalDeviceFeatures2 features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    if (m_physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2)
+    {
+        vulkan12Features.pNext = features2.pNext;
+        features2.pNext = &vulkan12Features;
+    }
+
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures{};
+    extendedDynamicStateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+    const bool hasExtendedDynamicState = isDeviceExtensionSupported(m_physicalDevice, VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+    if (hasExtendedDynamicState)
+    {
+        extendedDynamicStateFeatures.pNext = features2.pNext;
+        features2.pNext = &extendedDynamicStateFeatures;
+    }
+
+    VkPhysicalDeviceExtendedDynamicState2FeaturesEXT extendedDynamicState2Features{};
+    extendedDynamicState2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+    const bool hasExtendedDynamicState2 = isDeviceExtensionSupported(m_physicalDevice, VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+    if (hasExtendedDynamicState2)
+    {
+        extendedDynamicState2Features.pNext = features2.pNext;
+        features2.pNext = &extendedDynamicState2Features;
+    }
+
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extendedDynamicState3Features{};
+    extendedDynamicState3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+    const bool hasExtendedDynamicState3 = isDeviceExtensionSupported(m_physicalDevice, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+    if (hasExtendedDynamicState3)
+    {
+        extendedDynamicState3Features.pNext = features2.pNext;
+        features2.pNext = &extendedDynamicState3Features;
+    }
+
+    // Mesh shaders are compiled to SPIR-V 1.4: VK_KHR_spirv_1_4 is core since Vulkan 1.2
+    VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures{};
+    meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+    const bool hasMeshShader = m_physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2 &&
+                               isDeviceExtensionSupported(m_physicalDevice, VK_EXT_MESH_SHADER_EXTENSION_NAME);
+    if (hasMeshShader)
+    {
+        meshShaderFeatures.pNext = features2.pNext;
+        features2.pNext = &meshShaderFeatures;
+    }
+
+    // The extension depends on VK_KHR_depth_stencil_resolve and VK_KHR_create_renderpass2, core since Vulkan 1.2
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    const bool hasDynamicRendering = m_physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2 &&
+                                     isDeviceExtensionSupported(m_physicalDevice, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    if (hasDynamicRendering)
+    {
+        dynamicRenderingFeatures.pNext = features2.pNext;
+        features2.pNext = &dynamicRenderingFeatures;
+    }
+
+    vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features2);
+
+    m_supportsTimelineSemaphores = (vulkan12Features.timelineSemaphore == VK_TRUE);
+    m_extendedDynamicStateSupport.m_extendedDynamicState = (extendedDynamicStateFeatures.extendedDynamicState == VK_TRUE);
+    m_extendedDynamicStateSupport.m_extendedDynamicState2 = (extendedDynamicState2Features.extendedDynamicState2 == VK_TRUE);
+    // Setting the polygon mode to line or point at record time still needs fillModeNonSolid
+    m_extendedDynamicStateSupport.m_polygonMode = (extendedDynamicState3Features.extendedDynamicState3PolygonMode == VK_TRUE);
+    m_supportsMeshShader = (meshShaderFeatures.meshShader == VK_TRUE);
+    m_supportsTaskShader = m_supportsMeshShader && (meshShaderFeatures.taskShader == VK_TRUE);
+    m_supportsDynamicRendering = (dynamicRenderingFeatures.dynamicRendering == VK_TRUE);
+
+    m_optionalExtensions.clear();
+    if (m_extendedDynamicStateSupport.m_extendedDynamicState)
+    {
+        m_optionalExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+    }
+    if (m_extendedDynamicStateSupport.m_extendedDynamicState2)
+    {
+        m_optionalExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+    }
+    if (m_extendedDynamicStateSupport.m_polygonMode)
+    {
+        m_optionalExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+    }
+    if (m_supportsMeshShader)
+    {
+        m_optionalExtensions.push_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+    }
+    if (m_supportsDynamicRendering)
+    {
+        m_optionalExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    }
 }
 
 int VulkanDevice::rateDeviceSuitability(const VkPhysicalDevice &physicalDevice, const VkSurfaceKHR &surface)
@@ -153,7 +400,7 @@ int VulkanDevice::rateDeviceSuitability(const VkPhysicalDevice &physicalDevice,
     //    return 0;
     //}
     QueueFamilyIndices indices = findQueueFamilies(physicalDevice, surface);
-    if (!indices.isComplete())
+    if (!indices.isComplete(!m_headless))
     {
         return 0;
     }
@@ -164,10 +411,13 @@ int VulkanDevice::rateDeviceSuitability(const VkPhysicalDevice &physicalDevice,
         return 0;
     }
 
-    SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice, surface);
-    if (!swapChainSupport.isAdequate())
+    if (!m_headless)
     {
-        return 0;
+        SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice, surface);
+        if (!swapChainSupport.isAdequate())
+        {
+            return 0;
+        }
     }
 
     // Optional Features and Properties //
@@ -186,9 +436,76 @@ int VulkanDevice::rateDeviceSuitability(const VkPhysicalDevice &physicalDevice,
     // Maximum possible size of textures affects graphics quality
     score += deviceProperties.limits.maxImageDimension2D;
 
+    // Software implementations (e.g. lavapipe) still score above 0 so they can be used for headless testing
+    if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)
+    {
+        score = std::max(1, score / 2);
+    }
+
     return score;
 }
 
+bool VulkanDevice::supportsGraphicsTimestamps() const
+{
+    if (!m_queueFamilyIndices.m_graphicsFamily.has_value())
+    {
+        return false;
+    }
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    // timestampValidBits == 0 means the queue family does not support timestamps at all
+    const uint32_t graphicsFamily = m_queueFamilyIndices.m_graphicsFamily.value();
+    return m_physicalDeviceProperties.limits.timestampPeriod > 0.0f &&
+           queueFamilies[graphicsFamily].timestampValidBits > 0;
+}
+
+uint32_t VulkanDevice::findMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags properties) const
+{
+    // typeFilter is a bit field of the memory types that are suitable for the resource
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
+    {
+        if ((typeFilter & (1 << i)) && (m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+uint32_t VulkanDevice::findMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags required, const VkMemoryPropertyFlags preferred) const
+{
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
+    {
+        const VkMemoryPropertyFlags wanted = required | preferred;
+        if ((typeFilter & (1 << i)) && (m_memoryProperties.memoryTypes[i].propertyFlags & wanted) == wanted)
+        {
+            return i;
+        }
+    }
+
+    return findMemoryType(typeFilter, required);
+}
+
+std::vector<const char *> VulkanDevice::getRequiredDeviceExtensions() const
+{
+    std::vector<const char *> requiredExtensions;
+    for (const char *extension : m_deviceExtensions)
+    {
+        // Without a surface there is nothing to present to, the swap chain extension is not needed
+        if (m_headless && strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0)
+        {
+            continue;
+        }
+        requiredExtensions.push_back(extension);
+    }
+    return requiredExtensions;
+}
+
 bool VulkanDevice::checkDeviceExtensionSupport(const VkPhysicalDevice &physicalDevice)
 {
     uint32_t supportedDeviceExtensionCount;
@@ -203,7 +520,8 @@ bool VulkanDevice::checkDeviceExtensionSupport(const VkPhysicalDevice &physicalD
         std::cout << '\t' << extension.extensionName << '\n';
     }
 
-    std::set<std::string> requiredExtensions(m_deviceExtensions.begin(), m_deviceExtensions.end());
+    const std::vector<const char *> deviceExtensions = getRequiredDeviceExtensions();
+    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
     std::cout << "Required device extension: " << requiredExtensions.size() << "\n";
     for (const auto &extension : supportedDeviceExtensions)
     {
@@ -227,6 +545,9 @@ void VulkanDevice::cleanUp()
 {
     if (m_device != VK_NULL_HANDLE)
     {
+        m_pipelineLayoutCache.cleanUp();
+        m_shaderModuleCache.cleanUp();
+        m_memoryAllocator.cleanUp();
         vkDestroyDevice(m_device, nullptr);
         m_device = VK_NULL_HANDLE;
     }
@@ -0,0 +1,114 @@
+#include "core/renderer/VulkanExtendedDynamicState.hpp"
+
+#include "core/renderer/VulkanDevice.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    template <typename Function>
+    Function loadDeviceFunction(VkDevice device, const char *name)
+    {
+        Function function = reinterpret_cast<Function>(vkGetDeviceProcAddr(device, name));
+        if (function == nullptr)
+        {
+            throw std::runtime_error(std::string("Failed to load device function ") + name + "!");
+        }
+        return function;
+    }
+}
+
+VulkanExtendedDynamicState::VulkanExtendedDynamicState()
+    : m_dynamicStates(0), m_cmdSetCullMode(nullptr), m_cmdSetFrontFace(nullptr), m_cmdSetDepthTestEnable(nullptr),
+      m_cmdSetDepthWriteEnable(nullptr), m_cmdSetDepthCompareOp(nullptr), m_cmdSetDepthBiasEnable(nullptr),
+      m_cmdSetRasterizerDiscardEnable(nullptr), m_cmdSetPrimitiveRestartEnable(nullptr), m_cmdSetPolygonMode(nullptr) {}
+
+VulkanExtendedDynamicState::~VulkanExtendedDynamicState() {}
+
+void VulkanExtendedDynamicState::create(const VulkanDevice &vulkanDevice, const bool enable)
+{
+    m_dynamicStates = 0;
+    if (!enable)
+    {
+        return;
+    }
+
+    const VkDevice device = vulkanDevice.getDevice();
+    const VulkanExtendedDynamicStateSupport &support = vulkanDevice.getExtendedDynamicStateSupport();
+
+    if (support.m_extendedDynamicState)
+    {
+        m_cmdSetCullMode = loadDeviceFunction<PFN_vkCmdSetCullModeEXT>(device, "vkCmdSetCullModeEXT");
+        m_cmdSetFrontFace = loadDeviceFunction<PFN_vkCmdSetFrontFaceEXT>(device, "vkCmdSetFrontFaceEXT");
+        m_cmdSetDepthTestEnable = loadDeviceFunction<PFN_vkCmdSetDepthTestEnableEXT>(device, "vkCmdSetDepthTestEnableEXT");
+        m_cmdSetDepthWriteEnable = loadDeviceFunction<PFN_vkCmdSetDepthWriteEnableEXT>(device, "vkCmdSetDepthWriteEnableEXT");
+        m_cmdSetDepthCompareOp = loadDeviceFunction<PFN_vkCmdSetDepthCompareOpEXT>(device, "vkCmdSetDepthCompareOpEXT");
+        m_dynamicStates |= dynamicStateBit(VK_DYNAMIC_STATE_CULL_MODE_EXT) | dynamicStateBit(VK_DYNAMIC_STATE_FRONT_FACE_EXT) |
+                           dynamicStateBit(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT) | dynamicStateBit(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT) |
+                           dynamicStateBit(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT);
+    }
+    if (support.m_extendedDynamicState2)
+    {
+        m_cmdSetDepthBiasEnable = loadDeviceFunction<PFN_vkCmdSetDepthBiasEnableEXT>(device, "vkCmdSetDepthBiasEnableEXT");
+        m_cmdSetRasterizerDiscardEnable = loadDeviceFunction<PFN_vkCmdSetRasterizerDiscardEnableEXT>(device, "vkCmdSetRasterizerDiscardEnableEXT");
+        m_cmdSetPrimitiveRestartEnable = loadDeviceFunction<PFN_vkCmdSetPrimitiveRestartEnableEXT>(device, "vkCmdSetPrimitiveRestartEnableEXT");
+        m_dynamicStates |= dynamicStateBit(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT) | dynamicStateBit(VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT) |
+                           dynamicStateBit(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT);
+    }
+    if (support.m_polygonMode)
+    {
+        m_cmdSetPolygonMode = loadDeviceFunction<PFN_vkCmdSetPolygonModeEXT>(device, "vkCmdSetPolygonModeEXT");
+        m_dynamicStates |= dynamicStateBit(VK_DYNAMIC_STATE_POLYGON_MODE_EXT);
+    }
+}
+
+VulkanPipelineState VulkanExtendedDynamicState::toPipelineState(const VulkanPipelineState &state) const
+{
+    // Resetting the dynamic values makes the variants identical, so the pipeline registry compiles them once
+    const VulkanPipelineState defaults{};
+    VulkanPipelineState pipelineState = state;
+    pipelineState.m_dynamicStates |= m_dynamicStates;
+
+    if (isDynamic(VK_DYNAMIC_STATE_CULL_MODE_EXT))
+    {
+        pipelineState.m_cullMode = defaults.m_cullMode;
+        pipelineState.m_frontFace = defaults.m_frontFace;
+        pipelineState.m_depthTestEnable = defaults.m_depthTestEnable;
+        pipelineState.m_depthWriteEnable = defaults.m_depthWriteEnable;
+        pipelineState.m_depthCompareOp = defaults.m_depthCompareOp;
+    }
+    if (isDynamic(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT))
+    {
+        pipelineState.m_depthBiasEnable = defaults.m_depthBiasEnable;
+        pipelineState.m_rasterizerDiscardEnable = defaults.m_rasterizerDiscardEnable;
+        pipelineState.m_primitiveRestartEnable = defaults.m_primitiveRestartEnable;
+    }
+    if (isDynamic(VK_DYNAMIC_STATE_POLYGON_MODE_EXT))
+    {
+        pipelineState.m_polygonMode = defaults.m_polygonMode;
+    }
+    return pipelineState;
+}
+
+void VulkanExtendedDynamicState::record(VkCommandBuffer commandBuffer, const VulkanPipelineState &state) const
+{
+    if (isDynamic(VK_DYNAMIC_STATE_CULL_MODE_EXT))
+    {
+        m_cmdSetCullMode(commandBuffer, state.m_cullMode);
+        m_cmdSetFrontFace(commandBuffer, static_cast<VkFrontFace>(state.m_frontFace));
+        m_cmdSetDepthTestEnable(commandBuffer, state.m_depthTestEnable);
+        m_cmdSetDepthWriteEnable(commandBuffer, state.m_depthWriteEnable);
+        m_cmdSetDepthCompareOp(commandBuffer, static_cast<VkCompareOp>(state.m_depthCompareOp));
+    }
+    if (isDynamic(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT))
+    {
+        m_cmdSetDepthBiasEnable(commandBuffer, state.m_depthBiasEnable);
+        m_cmdSetRasterizerDiscardEnable(commandBuffer, state.m_rasterizerDiscardEnable);
+        m_cmdSetPrimitiveRestartEnable(commandBuffer, state.m_primitiveRestartEnable);
+    }
+    if (isDynamic(VK_DYNAMIC_STATE_POLYGON_MODE_EXT))
+    {
+        m_cmdSetPolygonMode(commandBuffer, static_cast<VkPolygonMode>(state.m_polygonMode));
+    }
+}
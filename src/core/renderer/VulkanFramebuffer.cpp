@@ -1,9 +1,12 @@
 #include "core/renderer/VulkanFramebuffer.hpp"
 
 #include <vulkan/vk_enum_string_helper.h>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 VulkanFramebuffer::VulkanFramebuffer(VkDevice device, VkRenderPass renderPass, const std::vector<VkImageView> &attachments, VkExtent2D extent, uint32_t layers)
-    : m_device(device), m_extent(extent), m_framebuffer(VK_NULL_HANDLE)
+    : m_device(device), m_extent(extent), m_framebuffer(VK_NULL_HANDLE), m_attachments(attachments)
 {
     createFramebuffer(renderPass, attachments, extent, layers);
 }
@@ -14,7 +17,7 @@ VulkanFramebuffer::~VulkanFramebuffer()
 
 // Move constructor
 VulkanFramebuffer::VulkanFramebuffer(VulkanFramebuffer &&other) noexcept
-    : m_device(other.m_device), m_framebuffer(other.m_framebuffer), m_extent(other.m_extent)
+    : m_device(other.m_device), m_framebuffer(other.m_framebuffer), m_extent(other.m_extent), m_attachments(std::move(other.m_attachments))
 {
     other.m_framebuffer = VK_NULL_HANDLE;
 }
@@ -28,6 +31,7 @@ VulkanFramebuffer &VulkanFramebuffer::operator=(VulkanFramebuffer &&other) noexc
         m_device = other.m_device;
         m_framebuffer = other.m_framebuffer;
         m_extent = other.m_extent;
+        m_attachments = std::move(other.m_attachments);
 
         other.m_framebuffer = VK_NULL_HANDLE;
     }
@@ -52,15 +56,27 @@ void VulkanFramebuffer::createFramebuffer(VkRenderPass renderPass, const std::ve
     }
 }
 
-void VulkanFramebuffer::resize(VkRenderPass renderPass, const std::vector<VkImageView> &attachments, VkExtent2D newExtent, uint32_t layers)
+VkFramebuffer VulkanFramebuffer::resize(VkRenderPass renderPass, const std::vector<VkImageView> &attachments, VkExtent2D newExtent, uint32_t layers)
 {
-    if (newExtent.width == m_extent.width && newExtent.height == m_extent.height)
+    if (newExtent.width == m_extent.width && newExtent.height == m_extent.height && attachments == m_attachments)
     {
-        return; // No need to resize if the extent hasn't changed
+        return VK_NULL_HANDLE; // No need to resize if neither the extent nor the attachments have changed
     }
-    cleanUp();
+
+    VkFramebuffer retiredFramebuffer = m_framebuffer;
+    m_framebuffer = VK_NULL_HANDLE;
     m_extent = newExtent;
+    m_attachments = attachments;
     createFramebuffer(renderPass, attachments, newExtent, layers);
+    return retiredFramebuffer;
+}
+
+void VulkanFramebuffer::destroyRetired(VkDevice device, VkFramebuffer framebuffer)
+{
+    if (framebuffer != VK_NULL_HANDLE)
+    {
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+    }
 }
 
 void VulkanFramebuffer::cleanUp()
@@ -68,5 +84,6 @@ void VulkanFramebuffer::cleanUp()
     if (m_framebuffer != VK_NULL_HANDLE)
     {
         vkDestroyFramebuffer(m_device, m_framebuffer, nullptr);
+        m_framebuffer = VK_NULL_HANDLE;
     }
 }
\ No newline at end of file
@@ -1,10 +1,13 @@
 #include "core/renderer/VulkanGraphicsPipeline.hpp"
 
 #include "graphics/Shader.hpp"
-#include "utilities/renderer/VulkanPipelineConfigFactory.hpp"
+#include "core/renderer/VulkanPipelineState.hpp"
 
 #include <vulkan/vk_enum_string_helper.h>
 
+#include <stdexcept>
+#include <string>
+
 VulkanGraphicsPipeline::VulkanGraphicsPipeline()
     : m_graphicsPipeline(VK_NULL_HANDLE), m_pipelineLayout(VK_NULL_HANDLE) {}
 
@@ -12,59 +15,95 @@ VulkanGraphicsPipeline::~VulkanGraphicsPipeline()
 {
 }
 
-void VulkanGraphicsPipeline::createPipeline(const VkDevice &device, const VulkanGraphicsPipelineConfig &configInfo, const Shader &shader, const VkRenderPass &renderPass, const uint32_t subpass)
+void VulkanGraphicsPipeline::createPipeline(const VkDevice &device, const VulkanPipelineState &state, const Shader &shader, const VkPipelineLayout &pipelineLayout,
+                                            const VulkanPipelineTarget &target, const VkPipelineCache pipelineCache, const VkExtent2D viewportExtent)
 {
     m_device = device;
-    createPipelineLayout();
-    setShaderStages(shader);
-    createGraphicsPipeline(configInfo, renderPass, subpass);
+    m_pipelineLayout = pipelineLayout;
+    setShaderStages(shader, state);
+    createGraphicsPipeline(state, target, pipelineCache, viewportExtent);
 }
 
-void VulkanGraphicsPipeline::createPipelineLayout()
+void VulkanGraphicsPipeline::createGraphicsPipeline(const VulkanPipelineState &state, const VulkanPipelineTarget &target,
+                                                    const VkPipelineCache pipelineCache, const VkExtent2D viewportExtent)
 {
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;            // Optional
-    pipelineLayoutInfo.pSetLayouts = nullptr;         // Optional
-    pipelineLayoutInfo.pushConstantRangeCount = 0;    // Optional
-    pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
+    // Expand the packed state into the fixed function create infos, which only live for this call
+    const VulkanPipelineStateCreateInfo stateInfo(state, viewportExtent);
 
-    VkResult result = vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout);
-    if (result != VK_SUCCESS)
-    {
-        throw std::runtime_error(std::string("Failed to create pipeline layout! VkResult: ") + string_VkResult(result));
-    }
-}
-
-void VulkanGraphicsPipeline::createGraphicsPipeline(const VulkanGraphicsPipelineConfig &configInfo, const VkRenderPass &renderPass, const uint32_t subpass)
-{
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipelineInfo.stageCount = static_cast<uint32_t>(m_shaderStages.size());
     pipelineInfo.pStages = m_shaderStages.data();
-    pipelineInfo.pVertexInputState = &configInfo.m_vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &configInfo.m_inputAssemblyInfo;
-    pipelineInfo.pViewportState = &configInfo.m_viewportInfo;
-    pipelineInfo.pRasterizationState = &configInfo.m_rasterizationInfo;
-    pipelineInfo.pMultisampleState = &configInfo.m_multisampleInfo;
-    pipelineInfo.pColorBlendState = &configInfo.m_colorBlendInfo;
-    pipelineInfo.pDepthStencilState = &configInfo.m_depthStencilInfo;
-    pipelineInfo.pDynamicState = &configInfo.m_dynamicStateInfo;
+    stateInfo.fill(pipelineInfo);
     pipelineInfo.layout = m_pipelineLayout;
-    pipelineInfo.renderPass = renderPass;
-    pipelineInfo.subpass = subpass;
+    pipelineInfo.renderPass = target.m_renderPass;
+    pipelineInfo.subpass = target.m_subpass;
 
-    VkResult result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline);
+    // Dynamic rendering: no render pass, the pipeline is compatible with any attachments of these formats
+    VkPipelineRenderingCreateInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    if (target.m_renderPass == VK_NULL_HANDLE)
+    {
+        if (target.m_colorFormats.size() != state.m_colorAttachmentCount)
+        {
+            throw std::runtime_error("Failed to create graphics pipeline: " + std::to_string(target.m_colorFormats.size()) +
+                                     " color attachment formats for a state with " + std::to_string(state.m_colorAttachmentCount) + " color attachments");
+        }
+        renderingInfo.colorAttachmentCount = static_cast<uint32_t>(target.m_colorFormats.size());
+        renderingInfo.pColorAttachmentFormats = target.m_colorFormats.data();
+        renderingInfo.depthAttachmentFormat = target.m_depthFormat;
+        renderingInfo.stencilAttachmentFormat = target.m_stencilFormat;
+        renderingInfo.pNext = pipelineInfo.pNext;
+        pipelineInfo.pNext = &renderingInfo;
+        pipelineInfo.subpass = 0;
+    }
+
+    // With a pipeline cache the driver skips the shader compilation of pipelines it has already compiled (this run or a previous one)
+    VkResult result = vkCreateGraphicsPipelines(m_device, pipelineCache, 1, &pipelineInfo, nullptr, &m_graphicsPipeline);
     if (result != VK_SUCCESS)
     {
         throw std::runtime_error(std::string("Failed to create graphics pipeline! VkResult: ") + string_VkResult(result));
     }
 }
 
-void VulkanGraphicsPipeline::setShaderStages(const Shader &shader)
+// Checks that the stages form a valid graphics pipeline with this state: the driver would otherwise fail (or crash) on them
+void VulkanGraphicsPipeline::setShaderStages(const Shader &shader, const VulkanPipelineState &state)
 {
-    m_shaderStages.push_back(shader.getVertexShaderStageInfo());
-    m_shaderStages.push_back(shader.getFragmentShaderStageInfo());
+    const bool hasTessellationControl = shader.hasStage(VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT);
+    const bool hasTessellationEvaluation = shader.hasStage(VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT);
+    if (shader.hasStage(VK_SHADER_STAGE_COMPUTE_BIT))
+    {
+        throw std::runtime_error("Failed to create graphics pipeline: a compute stage needs a compute pipeline");
+    }
+    if (shader.hasStage(VK_SHADER_STAGE_MESH_BIT_EXT))
+    {
+        // Mesh shading replaces the whole vertex processing: input assembly, vertex, tessellation and geometry stages
+        if (shader.hasStage(VK_SHADER_STAGE_VERTEX_BIT) || hasTessellationControl || hasTessellationEvaluation || shader.hasStage(VK_SHADER_STAGE_GEOMETRY_BIT))
+        {
+            throw std::runtime_error("Failed to create graphics pipeline: a mesh stage cannot be combined with vertex, tessellation or geometry stages");
+        }
+    }
+    else if (!shader.hasStage(VK_SHADER_STAGE_VERTEX_BIT))
+    {
+        throw std::runtime_error("Failed to create graphics pipeline: a vertex or a mesh stage is required");
+    }
+    else if (shader.hasStage(VK_SHADER_STAGE_TASK_BIT_EXT))
+    {
+        throw std::runtime_error("Failed to create graphics pipeline: a task stage needs a mesh stage");
+    }
+
+    if (hasTessellationControl != hasTessellationEvaluation)
+    {
+        throw std::runtime_error("Failed to create graphics pipeline: tessellation needs both a control and an evaluation stage");
+    }
+    const bool usesPatches = state.m_patchControlPoints > 0 && state.m_topology == VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+    if (hasTessellationControl != usesPatches)
+    {
+        throw std::runtime_error(hasTessellationControl ? "Failed to create graphics pipeline: tessellation stages need a patch list topology and patch control points"
+                                                        : "Failed to create graphics pipeline: a patch list topology needs tessellation stages");
+    }
+
+    m_shaderStages = shader.getStageInfos();
 }
 
 void VulkanGraphicsPipeline::cleanUp()
@@ -74,9 +113,6 @@ void VulkanGraphicsPipeline::cleanUp()
         vkDestroyPipeline(m_device, m_graphicsPipeline, nullptr);
         m_graphicsPipeline = VK_NULL_HANDLE;
     }
-    if (m_pipelineLayout != VK_NULL_HANDLE)
-    {
-        vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
-        m_pipelineLayout = VK_NULL_HANDLE;
-    }
+    m_pipelineLayout = VK_NULL_HANDLE; // Not owned
+    m_shaderStages.clear();
 }
\ No newline at end of file
@@ -6,18 +6,22 @@
 #define VK_USE_PLATFORM_MACOS_MVK
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+#if defined(__APPLE__)
 #define GLFW_EXPOSE_NATIVE_COCOA
 #include <GLFW/glfw3native.h>
+#endif
 
 #include <vulkan/vk_enum_string_helper.h>
 #include <vulkan/vulkan_metal.h> // Include for VK_EXT_metal_surface
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 VulkanInstance::VulkanInstance() : m_instance(VK_NULL_HANDLE) {}
 
 VulkanInstance::~VulkanInstance() {}
 
-void VulkanInstance::createInstance(const VulkanValidationLayer &vulkanValidationLayer)
+void VulkanInstance::createInstance(const VulkanValidationLayer &vulkanValidationLayer, const bool headless)
 {
     if (vulkanValidationLayer.isValidationLayersEnabled() && !vulkanValidationLayer.checkValidationLayersSupport())
     {
@@ -32,7 +36,9 @@ void VulkanInstance::createInstance(const VulkanValidationLayer &vulkanValidatio
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    // 1.2 for timeline semaphores. Devices that only support an older version are still usable (the effective version of a
+    // device is the lowest of the instance and device versions), features beyond 1.0 are then checked before use
+    appInfo.apiVersion = VK_API_VERSION_1_2;
 
     // Tells Vulkan driver which global extentions and validation layers we want to use (mandatory)
     VkInstanceCreateInfo createInfo{};
@@ -45,7 +51,7 @@ void VulkanInstance::createInstance(const VulkanValidationLayer &vulkanValidatio
     createInfo.flags |= VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
 #endif
 
-    std::vector<const char *> requiredExtensions = getRequiredGlfwExtensions(vulkanValidationLayer.isValidationLayersEnabled());
+    std::vector<const char *> requiredExtensions = getRequiredGlfwExtensions(vulkanValidationLayer.isValidationLayersEnabled(), headless);
     createInfo.enabledExtensionCount = (uint32_t)requiredExtensions.size();
     createInfo.ppEnabledExtensionNames = requiredExtensions.data();
 
@@ -72,15 +78,19 @@ void VulkanInstance::createInstance(const VulkanValidationLayer &vulkanValidatio
     }
 }
 
-std::vector<const char *> VulkanInstance::getRequiredGlfwExtensions(const bool isValidationLayersEnabled)
+std::vector<const char *> VulkanInstance::getRequiredGlfwExtensions(const bool isValidationLayersEnabled, const bool headless)
 {
-    uint32_t glfwExtensionCount = 0;
-    const char **glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    // Headless rendering never creates a surface, so GLFW (which may not even be initialized) is not queried
+    std::vector<const char *> requiredExtensions;
+    if (!headless)
+    {
+        uint32_t glfwExtensionCount = 0;
+        const char **glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        requiredExtensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     // Encountered VK_ERROR_INCOMPATIBLE_DRIVER from vkCreateInstance for MacOS with the latest MoltenVK sdk
     // Beginning with the 1.3.216 Vulkan SDK, the VK_KHR_PORTABILITY_subset extension is mandatory.
-    std::vector<const char *> requiredExtensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
-
 #if defined __APPLE__ && defined __arm64__
     requiredExtensions.emplace_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
     requiredExtensions.emplace_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
@@ -89,6 +99,10 @@ std::vector<const char *> VulkanInstance::getRequiredGlfwExtensions(const bool i
     if (isValidationLayersEnabled)
     {
         requiredExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+    }
+
+    if (isValidationLayersEnabled && !headless)
+    {
         // Adding KHR surface extension and MVK_MACOS_SURFACE_EXTENSION
         requiredExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);       // necessary for creating a Vulkan surface in a platform-independent way
         requiredExtensions.push_back(VK_EXT_METAL_SURFACE_EXTENSION_NAME); // modern and supported way to create a Vulkan surface on macOS, leveraging Metal for rendering.
@@ -0,0 +1,402 @@
+#include "core/renderer/VulkanMemoryAllocator.hpp"
+
+#include "core/renderer/VulkanDevice.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    VkDeviceSize alignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    VkDeviceSize alignDown(const VkDeviceSize value, const VkDeviceSize alignment)
+    {
+        return value & ~(alignment - 1);
+    }
+}
+
+VulkanMemoryAllocator::VulkanMemoryAllocator()
+    : m_device(VK_NULL_HANDLE), m_vulkanDevice(nullptr), m_memoryProperties{}, m_bufferImageGranularity(1), m_nonCoherentAtomSize(1),
+      m_maxMemoryAllocationCount(0), m_memoryAllocationCount(0), m_preferredBlockSize(DEFAULT_BLOCK_SIZE) {}
+
+VulkanMemoryAllocator::~VulkanMemoryAllocator() {}
+
+void VulkanMemoryAllocator::create(const VulkanDevice &vulkanDevice, const VkDeviceSize preferredBlockSize)
+{
+    m_device = vulkanDevice.getDevice();
+    m_vulkanDevice = &vulkanDevice;
+    m_memoryProperties = vulkanDevice.getMemoryProperties();
+
+    const VkPhysicalDeviceLimits &limits = vulkanDevice.getPhysicalDeviceProperties().limits;
+    m_bufferImageGranularity = limits.bufferImageGranularity;
+    m_nonCoherentAtomSize = limits.nonCoherentAtomSize;
+    m_maxMemoryAllocationCount = limits.maxMemoryAllocationCount;
+    m_preferredBlockSize = preferredBlockSize;
+}
+
+// Small heaps (e.g. the 256 MiB device-local + host-visible heap of discrete GPUs) get smaller blocks so one block cannot take all of it
+VkDeviceSize VulkanMemoryAllocator::getBlockSize(const uint32_t memoryTypeIndex) const
+{
+    constexpr VkDeviceSize SMALL_HEAP_MAX_SIZE = 1024ull * 1024 * 1024;
+
+    const uint32_t heapIndex = m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    const VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[heapIndex].size;
+    return heapSize <= SMALL_HEAP_MAX_SIZE ? std::min(m_preferredBlockSize, heapSize / 8) : m_preferredBlockSize;
+}
+
+VulkanAllocation VulkanMemoryAllocator::allocate(const VkMemoryRequirements &memoryRequirements, const VkMemoryPropertyFlags required,
+                                                 const VkMemoryPropertyFlags preferred, const VulkanAllocationType type)
+{
+    const uint32_t memoryTypeIndex = m_vulkanDevice->findMemoryType(memoryRequirements.memoryTypeBits, required, preferred);
+    const VkDeviceSize blockSize = getBlockSize(memoryTypeIndex);
+
+    VulkanAllocation allocation{};
+    allocation.m_memoryTypeIndex = memoryTypeIndex;
+    allocation.m_size = memoryRequirements.size;
+
+    // Too large to share a block with other resources. Lazily allocated memory is committed by the driver only as the
+    // attachment needs it (on tilers, never): a shared block would only reserve address space, so it is always dedicated
+    if (memoryRequirements.size > blockSize / 2 || isLazilyAllocatedMemoryType(memoryTypeIndex))
+    {
+        VulkanMemoryBlock *block = nullptr;
+        VkResult result = createBlock(memoryTypeIndex, memoryRequirements.size, true, block);
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Failed to allocate dedicated device memory! VkResult: ") + string_VkResult(result));
+        }
+
+        allocation.m_memory = block->m_memory;
+        allocation.m_mapped = block->m_mapped;
+        allocation.m_block = block;
+        return allocation;
+    }
+
+    // Sub-allocations of non-coherent memory are aligned to nonCoherentAtomSize, so flushing or invalidating one never
+    // touches the memory of its neighbours
+    VkDeviceSize alignment = memoryRequirements.alignment;
+    if (!isCoherentMemoryType(memoryTypeIndex))
+    {
+        alignment = std::max(alignment, m_nonCoherentAtomSize);
+    }
+
+    VulkanMemoryBlock *block = nullptr;
+    std::optional<VkDeviceSize> offset;
+    for (const std::unique_ptr<VulkanMemoryBlock> &existingBlock : m_blocks[memoryTypeIndex])
+    {
+        offset = existingBlock->m_metadata->allocate(memoryRequirements.size, alignment, type);
+        if (offset.has_value())
+        {
+            block = existingBlock.get();
+            break;
+        }
+    }
+
+    if (block == nullptr)
+    {
+        // No room left in the existing blocks: create a new one, halving its size while the device is out of memory
+        VkDeviceSize newBlockSize = blockSize;
+        VkResult result = createBlock(memoryTypeIndex, newBlockSize, false, block);
+        while ((result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY) && newBlockSize / 2 >= memoryRequirements.size)
+        {
+            newBlockSize /= 2;
+            result = createBlock(memoryTypeIndex, newBlockSize, false, block);
+        }
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Failed to allocate device memory block! VkResult: ") + string_VkResult(result));
+        }
+
+        offset = block->m_metadata->allocate(memoryRequirements.size, alignment, type);
+        if (!offset.has_value())
+        {
+            throw std::runtime_error("Failed to sub-allocate device memory from a new block!");
+        }
+    }
+
+    allocation.m_memory = block->m_memory;
+    allocation.m_offset = offset.value();
+    allocation.m_mapped = block->m_mapped != nullptr ? block->m_mapped + offset.value() : nullptr;
+    allocation.m_block = block;
+    return allocation;
+}
+
+VulkanAllocation VulkanMemoryAllocator::allocateForBuffer(VkBuffer buffer, const VkMemoryPropertyFlags required, const VkMemoryPropertyFlags preferred)
+{
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(m_device, buffer, &memoryRequirements);
+
+    VulkanAllocation allocation = allocate(memoryRequirements, required, preferred, VulkanAllocationType::LINEAR);
+
+    VkResult result = vkBindBufferMemory(m_device, buffer, allocation.m_memory, allocation.m_offset);
+    if (result != VK_SUCCESS)
+    {
+        free(allocation);
+        throw std::runtime_error(std::string("Failed to bind buffer memory! VkResult: ") + string_VkResult(result));
+    }
+    return allocation;
+}
+
+VulkanAllocation VulkanMemoryAllocator::allocateForImage(VkImage image, const VkImageTiling tiling, const VkMemoryPropertyFlags required,
+                                                         const VkMemoryPropertyFlags preferred)
+{
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(m_device, image, &memoryRequirements);
+
+    const VulkanAllocationType type = (tiling == VK_IMAGE_TILING_OPTIMAL) ? VulkanAllocationType::OPTIMAL : VulkanAllocationType::LINEAR;
+    VulkanAllocation allocation = allocate(memoryRequirements, required, preferred, type);
+
+    VkResult result = vkBindImageMemory(m_device, image, allocation.m_memory, allocation.m_offset);
+    if (result != VK_SUCCESS)
+    {
+        free(allocation);
+        throw std::runtime_error(std::string("Failed to bind image memory! VkResult: ") + string_VkResult(result));
+    }
+    return allocation;
+}
+
+void VulkanMemoryAllocator::free(VulkanAllocation &allocation)
+{
+    if (!allocation.isValid())
+    {
+        return;
+    }
+
+    VulkanMemoryBlock *block = allocation.m_block;
+    const VkDeviceSize offset = allocation.m_offset;
+    allocation = VulkanAllocation{};
+
+    if (block->m_metadata == nullptr)
+    {
+        auto dedicatedBlock = std::find_if(m_dedicatedBlocks.begin(), m_dedicatedBlocks.end(),
+                                           [block](const std::unique_ptr<VulkanMemoryBlock> &candidate)
+                                           {
+                                               return candidate.get() == block;
+                                           });
+        if (dedicatedBlock != m_dedicatedBlocks.end())
+        {
+            destroyBlock(**dedicatedBlock);
+            m_dedicatedBlocks.erase(dedicatedBlock);
+        }
+        return;
+    }
+
+    block->m_metadata->free(offset);
+    if (!block->m_metadata->isEmpty())
+    {
+        return;
+    }
+
+    // Keep one empty block per memory type, so a resource freed and recreated every frame does not reallocate a block each time
+    std::vector<std::unique_ptr<VulkanMemoryBlock>> &blocks = m_blocks[block->m_memoryTypeIndex];
+    const size_t emptyBlockCount = std::count_if(blocks.begin(), blocks.end(),
+                                                 [](const std::unique_ptr<VulkanMemoryBlock> &candidate)
+                                                 {
+                                                     return candidate->m_metadata->isEmpty();
+                                                 });
+    if (emptyBlockCount > 1)
+    {
+        auto emptyBlock = std::find_if(blocks.begin(), blocks.end(),
+                                       [block](const std::unique_ptr<VulkanMemoryBlock> &candidate)
+                                       {
+                                           return candidate.get() == block;
+                                       });
+        destroyBlock(**emptyBlock);
+        blocks.erase(emptyBlock);
+    }
+}
+
+VkResult VulkanMemoryAllocator::createBlock(const uint32_t memoryTypeIndex, const VkDeviceSize size, const bool dedicated, VulkanMemoryBlock *&block)
+{
+    if (m_memoryAllocationCount >= m_maxMemoryAllocationCount)
+    {
+        return VK_ERROR_TOO_MANY_OBJECTS;
+    }
+
+    auto newBlock = std::make_unique<VulkanMemoryBlock>();
+    newBlock->m_size = size;
+    newBlock->m_memoryTypeIndex = memoryTypeIndex;
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    VkResult result = vkAllocateMemory(m_device, &allocInfo, nullptr, &newBlock->m_memory);
+    if (result != VK_SUCCESS)
+    {
+        return result;
+    }
+    m_memoryAllocationCount++;
+
+    // Host visible memory is mapped once for the lifetime of the block: a VkDeviceMemory can only be mapped once at a time,
+    // so the sub-allocations could not map themselves individually
+    if (m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        void *mapped = nullptr;
+        result = vkMapMemory(m_device, newBlock->m_memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+        if (result != VK_SUCCESS)
+        {
+            destroyBlock(*newBlock);
+            return result;
+        }
+        newBlock->m_mapped = static_cast<std::byte *>(mapped);
+    }
+
+    block = newBlock.get();
+    if (dedicated)
+    {
+        m_dedicatedBlocks.push_back(std::move(newBlock));
+    }
+    else
+    {
+        newBlock->m_metadata = std::make_unique<VulkanBlockMetadata>(size, m_bufferImageGranularity);
+        m_blocks[memoryTypeIndex].push_back(std::move(newBlock));
+    }
+    return VK_SUCCESS;
+}
+
+void VulkanMemoryAllocator::destroyBlock(VulkanMemoryBlock &block)
+{
+    if (block.m_memory == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    if (block.m_mapped != nullptr)
+    {
+        vkUnmapMemory(m_device, block.m_memory);
+        block.m_mapped = nullptr;
+    }
+    vkFreeMemory(m_device, block.m_memory, nullptr);
+    block.m_memory = VK_NULL_HANDLE;
+    m_memoryAllocationCount--;
+}
+
+bool VulkanMemoryAllocator::isCoherentMemoryType(const uint32_t memoryTypeIndex) const
+{
+    return (m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+}
+
+bool VulkanMemoryAllocator::isCoherent(const VulkanAllocation &allocation) const
+{
+    return isCoherentMemoryType(allocation.m_memoryTypeIndex);
+}
+
+bool VulkanMemoryAllocator::isLazilyAllocatedMemoryType(const uint32_t memoryTypeIndex) const
+{
+    return (m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0;
+}
+
+bool VulkanMemoryAllocator::isLazilyAllocated(const VulkanAllocation &allocation) const
+{
+    return isLazilyAllocatedMemoryType(allocation.m_memoryTypeIndex);
+}
+
+// Flushed/invalidated ranges must start and end on multiples of nonCoherentAtomSize (or end at the end of the memory)
+VkMappedMemoryRange VulkanMemoryAllocator::getMappedRange(const VulkanAllocation &allocation, const VkDeviceSize offset, const VkDeviceSize size) const
+{
+    const VkDeviceSize start = allocation.m_offset + offset;
+    const VkDeviceSize end = (size == VK_WHOLE_SIZE) ? allocation.m_offset + allocation.m_size : start + size;
+
+    const VkDeviceSize alignedStart = alignDown(start, m_nonCoherentAtomSize);
+    const VkDeviceSize alignedEnd = std::min(alignUp(end, m_nonCoherentAtomSize), allocation.m_block->m_size);
+
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.m_memory;
+    range.offset = alignedStart;
+    range.size = alignedEnd - alignedStart;
+    return range;
+}
+
+void VulkanMemoryAllocator::flush(const VulkanAllocation &allocation, const VkDeviceSize offset, const VkDeviceSize size) const
+{
+    if (!allocation.isValid() || isCoherent(allocation))
+    {
+        return;
+    }
+
+    const VkMappedMemoryRange range = getMappedRange(allocation, offset, size);
+    VkResult result = vkFlushMappedMemoryRanges(m_device, 1, &range);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to flush mapped memory! VkResult: ") + string_VkResult(result));
+    }
+}
+
+void VulkanMemoryAllocator::invalidate(const VulkanAllocation &allocation, const VkDeviceSize offset, const VkDeviceSize size) const
+{
+    if (!allocation.isValid() || isCoherent(allocation))
+    {
+        return;
+    }
+
+    const VkMappedMemoryRange range = getMappedRange(allocation, offset, size);
+    VkResult result = vkInvalidateMappedMemoryRanges(m_device, 1, &range);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to invalidate mapped memory! VkResult: ") + string_VkResult(result));
+    }
+}
+
+VulkanMemoryStats VulkanMemoryAllocator::getStats() const
+{
+    VulkanMemoryStats stats{};
+    VkDeviceSize freeBytes = 0;
+
+    for (const std::vector<std::unique_ptr<VulkanMemoryBlock>> &blocks : m_blocks)
+    {
+        for (const std::unique_ptr<VulkanMemoryBlock> &block : blocks)
+        {
+            const VulkanBlockMetadata &metadata = *block->m_metadata;
+            stats.m_blockCount++;
+            stats.m_allocationCount += metadata.getAllocationCount();
+            stats.m_blockBytes += metadata.getSize();
+            stats.m_usedBytes += metadata.getUsedBytes();
+            stats.m_freeRangeCount += metadata.getFreeRangeCount();
+            stats.m_largestFreeRange = std::max(stats.m_largestFreeRange, metadata.getLargestFreeRange());
+            freeBytes += metadata.getFreeBytes();
+        }
+    }
+
+    for (const std::unique_ptr<VulkanMemoryBlock> &block : m_dedicatedBlocks)
+    {
+        stats.m_dedicatedAllocationCount++;
+        stats.m_dedicatedBytes += block->m_size;
+    }
+
+    stats.m_fragmentation = freeBytes > 0 ? 1.0 - static_cast<double>(stats.m_largestFreeRange) / static_cast<double>(freeBytes) : 0.0;
+    return stats;
+}
+
+void VulkanMemoryAllocator::cleanUp()
+{
+    const VulkanMemoryStats stats = getStats();
+    if (stats.m_allocationCount > 0 || stats.m_dedicatedAllocationCount > 0)
+    {
+        std::cerr << "VulkanMemoryAllocator: " << stats.m_allocationCount + stats.m_dedicatedAllocationCount
+                  << " allocations were not freed before destroying the allocator" << std::endl;
+    }
+
+    for (std::vector<std::unique_ptr<VulkanMemoryBlock>> &blocks : m_blocks)
+    {
+        for (std::unique_ptr<VulkanMemoryBlock> &block : blocks)
+        {
+            destroyBlock(*block);
+        }
+        blocks.clear();
+    }
+
+    for (std::unique_ptr<VulkanMemoryBlock> &block : m_dedicatedBlocks)
+    {
+        destroyBlock(*block);
+    }
+    m_dedicatedBlocks.clear();
+}
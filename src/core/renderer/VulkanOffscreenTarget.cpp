@@ -0,0 +1,116 @@
+#include "core/renderer/VulkanOffscreenTarget.hpp"
+
+#include "core/renderer/VulkanDevice.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+#include <stdexcept>
+#include <string>
+
+VulkanOffscreenTarget::VulkanOffscreenTarget()
+    : m_device(VK_NULL_HANDLE), m_memoryAllocator(nullptr), m_format(VK_FORMAT_UNDEFINED), m_extent{0, 0} {}
+
+VulkanOffscreenTarget::~VulkanOffscreenTarget() {}
+
+void VulkanOffscreenTarget::createImages(VulkanDevice &vulkanDevice, const VkFormat format, const VkExtent2D extent, const uint32_t imageCount)
+{
+    m_device = vulkanDevice.getDevice();
+    m_memoryAllocator = &vulkanDevice.getMemoryAllocator();
+    m_format = format;
+    m_extent = extent;
+
+    // The format has to be renderable with optimal tiling
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(vulkanDevice.getPhysicalDevice(), format, &formatProperties);
+    const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+    if ((formatProperties.optimalTilingFeatures & requiredFeatures) != requiredFeatures)
+    {
+        throw std::runtime_error(std::string("Offscreen format is not supported as color attachment: ") + string_VkFormat(format));
+    }
+
+    m_images.resize(imageCount, VK_NULL_HANDLE);
+    m_imageAllocations.resize(imageCount);
+    m_imageViews.resize(imageCount, VK_NULL_HANDLE);
+
+    for (uint32_t i = 0; i < imageCount; i++)
+    {
+        createImage(i);
+        createImageView(i);
+    }
+}
+
+void VulkanOffscreenTarget::createImage(const uint32_t index)
+{
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = m_format;
+    imageInfo.extent = {m_extent.width, m_extent.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    // Rendered into as a color attachment and copied out for readback
+    imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VkResult result = vkCreateImage(m_device, &imageInfo, nullptr, &m_images[index]);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create offscreen image! VkResult: ") + string_VkResult(result));
+    }
+
+    // Sub-allocated and bound by the device's memory allocator
+    m_imageAllocations[index] = m_memoryAllocator->allocateForImage(m_images[index], imageInfo.tiling, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+void VulkanOffscreenTarget::createImageView(const uint32_t index)
+{
+    VkImageViewCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    createInfo.image = m_images[index];
+    createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    createInfo.format = m_format;
+    createInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+    createInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+    createInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+    createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+    createInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    createInfo.subresourceRange.baseMipLevel = 0;
+    createInfo.subresourceRange.levelCount = 1;
+    createInfo.subresourceRange.baseArrayLayer = 0;
+    createInfo.subresourceRange.layerCount = 1;
+
+    VkResult result = vkCreateImageView(m_device, &createInfo, nullptr, &m_imageViews[index]);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create offscreen image view! VkResult: ") + string_VkResult(result));
+    }
+}
+
+void VulkanOffscreenTarget::cleanUp()
+{
+    for (VkImageView imageView : m_imageViews)
+    {
+        if (imageView != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(m_device, imageView, nullptr);
+        }
+    }
+    m_imageViews.clear();
+
+    for (VkImage image : m_images)
+    {
+        if (image != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_device, image, nullptr);
+        }
+    }
+    m_images.clear();
+
+    for (VulkanAllocation &allocation : m_imageAllocations)
+    {
+        m_memoryAllocator->free(allocation);
+    }
+    m_imageAllocations.clear();
+}
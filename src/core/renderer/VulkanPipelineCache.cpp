@@ -0,0 +1,247 @@
+#include "core/renderer/VulkanPipelineCache.hpp"
+
+#include "utilities/io/Checksum.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+VulkanPipelineCache::VulkanPipelineCache() : m_device(VK_NULL_HANDLE), m_physicalDeviceProperties{}, m_pipelineCache(VK_NULL_HANDLE) {}
+
+VulkanPipelineCache::~VulkanPipelineCache() {}
+
+void VulkanPipelineCache::createPipelineCache(const VkDevice &device, const VkPhysicalDeviceProperties &physicalDeviceProperties, const std::string &filePath)
+{
+    m_device = device;
+    m_physicalDeviceProperties = physicalDeviceProperties;
+    m_filePath = filePath;
+    m_stats = VulkanPipelineCacheStats{};
+
+    std::vector<std::byte> initialData;
+    if (!m_filePath.empty())
+    {
+        initialData = loadFile();
+        if (!initialData.empty() && !isCompatible(initialData))
+        {
+            initialData.clear();
+        }
+    }
+
+    m_pipelineCache = createCache(initialData);
+    if (m_pipelineCache == VK_NULL_HANDLE)
+    {
+        // The driver rejected data that looked valid: start from an empty cache
+        m_stats.m_rejectReason = "rejected by the driver";
+        initialData.clear();
+        m_pipelineCache = createCache(initialData);
+        if (m_pipelineCache == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("Failed to create pipeline cache!");
+        }
+    }
+
+    m_stats.m_loadedFromDisk = !initialData.empty();
+    m_stats.m_loadedBytes = initialData.size();
+}
+
+// Returns the driver's cache data stored in the file, or nothing if there is no file or it is damaged
+std::vector<std::byte> VulkanPipelineCache::loadFile()
+{
+    std::ifstream file(m_filePath, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        return {}; // Cold start: no cache yet
+    }
+
+    const size_t fileSize = static_cast<size_t>(file.tellg());
+    FileHeader header{};
+    if (fileSize < sizeof(FileHeader))
+    {
+        m_stats.m_rejectReason = "file too small";
+        return {};
+    }
+
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(&header), sizeof(FileHeader));
+    if (header.m_magic != FILE_MAGIC || header.m_version != FILE_VERSION)
+    {
+        m_stats.m_rejectReason = "unknown file format";
+        return {};
+    }
+    if (header.m_dataSize != fileSize - sizeof(FileHeader))
+    {
+        m_stats.m_rejectReason = "truncated file";
+        return {};
+    }
+
+    std::vector<std::byte> data(header.m_dataSize);
+    file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file || computeChecksum(data.data(), data.size()) != header.m_checksum)
+    {
+        m_stats.m_rejectReason = "checksum mismatch";
+        return {};
+    }
+
+    return data;
+}
+
+// The data starts with VkPipelineCacheHeaderVersionOne. It can only be reused by the same device with the same driver
+bool VulkanPipelineCache::isCompatible(const std::vector<std::byte> &data)
+{
+    VkPipelineCacheHeaderVersionOne header{};
+    if (data.size() < sizeof(header))
+    {
+        m_stats.m_rejectReason = "missing driver header";
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || header.headerSize < sizeof(header))
+    {
+        m_stats.m_rejectReason = "unknown driver header version";
+        return false;
+    }
+    if (header.vendorID != m_physicalDeviceProperties.vendorID || header.deviceID != m_physicalDeviceProperties.deviceID)
+    {
+        m_stats.m_rejectReason = "created by another device";
+        return false;
+    }
+    if (std::memcmp(header.pipelineCacheUUID, m_physicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        m_stats.m_rejectReason = "created by another driver version";
+        return false;
+    }
+    return true;
+}
+
+VkPipelineCache VulkanPipelineCache::createCache(const std::vector<std::byte> &initialData)
+{
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = initialData.size();
+    cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    VkResult result = vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &pipelineCache);
+    if (result != VK_SUCCESS)
+    {
+        return VK_NULL_HANDLE;
+    }
+    return pipelineCache;
+}
+
+// The worker cache starts as a copy of the main cache, so pipelines loaded from disk are still found by the worker
+VkPipelineCache VulkanPipelineCache::createWorkerCache()
+{
+    std::vector<std::byte> data;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t dataSize = 0;
+        if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr) == VK_SUCCESS)
+        {
+            data.resize(dataSize);
+            if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+            {
+                data.clear();
+            }
+            data.resize(std::min(data.size(), dataSize));
+        }
+    }
+
+    VkPipelineCache workerCache = createCache(data);
+    if (workerCache == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("Failed to create worker pipeline cache!");
+    }
+    return workerCache;
+}
+
+void VulkanPipelineCache::mergeWorkerCache(VkPipelineCache workerCache)
+{
+    // The destination cache must be externally synchronized
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    VkResult result = vkMergePipelineCaches(m_device, m_pipelineCache, 1, &workerCache);
+    vkDestroyPipelineCache(m_device, workerCache, nullptr);
+    if (result != VK_SUCCESS)
+    {
+        // Called from the worker threads as they exit: the pipelines it compiled are only missing from the saved file
+        std::cerr << "Failed to merge pipeline caches, dropping the worker cache! VkResult: " << string_VkResult(result) << std::endl;
+        return;
+    }
+    m_stats.m_mergedWorkerCaches++;
+}
+
+void VulkanPipelineCache::save()
+{
+    if (m_pipelineCache == VK_NULL_HANDLE || m_filePath.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    size_t dataSize = 0;
+    VkResult result = vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr);
+    std::vector<std::byte> data(dataSize);
+    if (result == VK_SUCCESS)
+    {
+        result = vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data.data());
+    }
+    if (result != VK_SUCCESS)
+    {
+        // Failing to save only costs a cold start next time, it must not abort the shutdown
+        std::cerr << "Failed to get pipeline cache data! VkResult: " << string_VkResult(result) << std::endl;
+        return;
+    }
+    data.resize(dataSize);
+
+    FileHeader header{};
+    header.m_magic = FILE_MAGIC;
+    header.m_version = FILE_VERSION;
+    header.m_dataSize = data.size();
+    header.m_checksum = computeChecksum(data.data(), data.size());
+
+    const std::string temporaryPath = m_filePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        file.flush();
+        if (!file)
+        {
+            std::cerr << "Failed to write pipeline cache file: " << temporaryPath << std::endl;
+            return;
+        }
+    }
+
+    // rename replaces the previous file atomically: readers see either the old or the new cache, never a partial one
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, m_filePath, error);
+    if (error)
+    {
+        std::cerr << "Failed to replace pipeline cache file " << m_filePath << ": " << error.message() << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return;
+    }
+    m_stats.m_savedBytes = data.size();
+}
+
+uint64_t VulkanPipelineCache::computeChecksum(const std::byte *data, const size_t size)
+{
+    return fnv1a64(data, size);
+}
+
+void VulkanPipelineCache::cleanUp()
+{
+    if (m_pipelineCache != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+        m_pipelineCache = VK_NULL_HANDLE;
+    }
+}
@@ -0,0 +1,156 @@
+#include "core/renderer/VulkanPipelineLayoutCache.hpp"
+
+#include "graphics/ShaderReflection.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    template <typename T>
+    void append(std::string &key, const T &value)
+    {
+        key.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    std::string makeSetKey(const std::vector<VkDescriptorSetLayoutBinding> &bindings)
+    {
+        std::string key;
+        for (const VkDescriptorSetLayoutBinding &binding : bindings)
+        {
+            append(key, binding.binding);
+            append(key, binding.descriptorType);
+            append(key, binding.descriptorCount);
+            append(key, binding.stageFlags);
+        }
+        return key;
+    }
+}
+
+VulkanPipelineLayoutCache::VulkanPipelineLayoutCache() : m_device(VK_NULL_HANDLE) {}
+
+VulkanPipelineLayoutCache::~VulkanPipelineLayoutCache()
+{
+    cleanUp();
+}
+
+void VulkanPipelineLayoutCache::createCache(const VkDevice &device)
+{
+    m_device = device;
+}
+
+void VulkanPipelineLayoutCache::cleanUp()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &[key, layout] : m_pipelineLayouts)
+    {
+        vkDestroyPipelineLayout(m_device, layout.m_pipelineLayout, nullptr);
+    }
+    m_pipelineLayouts.clear();
+    for (auto &[key, setLayout] : m_setLayouts)
+    {
+        vkDestroyDescriptorSetLayout(m_device, setLayout, nullptr);
+    }
+    m_setLayouts.clear();
+}
+
+const VulkanPipelineLayout &VulkanPipelineLayoutCache::getPipelineLayout(const ShaderReflection &reflection)
+{
+    // Bindings are sorted by set: split them into one list per set, sets without bindings included
+    std::vector<std::vector<VkDescriptorSetLayoutBinding>> sets;
+    for (const ShaderResourceBinding &resource : reflection.m_bindings)
+    {
+        if (resource.m_descriptorCount == 0)
+        {
+            throw std::runtime_error("Failed to create pipeline layout: set " + std::to_string(resource.m_set) + " binding " +
+                                     std::to_string(resource.m_binding) + " is a runtime descriptor array (not supported)");
+        }
+        sets.resize(std::max<size_t>(sets.size(), resource.m_set + 1));
+
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding = resource.m_binding;
+        binding.descriptorType = resource.m_descriptorType;
+        binding.descriptorCount = resource.m_descriptorCount;
+        binding.stageFlags = resource.m_stageFlags;
+        sets[resource.m_set].push_back(binding);
+    }
+
+    std::string key;
+    for (const std::vector<VkDescriptorSetLayoutBinding> &bindings : sets)
+    {
+        const std::string setKey = makeSetKey(bindings);
+        append(key, static_cast<uint32_t>(setKey.size()));
+        key.append(setKey);
+    }
+    if (reflection.m_pushConstantRange.has_value())
+    {
+        append(key, reflection.m_pushConstantRange->stageFlags);
+        append(key, reflection.m_pushConstantRange->offset);
+        append(key, reflection.m_pushConstantRange->size);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.m_requestCount++;
+    auto it = m_pipelineLayouts.find(key);
+    if (it != m_pipelineLayouts.end())
+    {
+        return it->second;
+    }
+
+    VulkanPipelineLayout layout{};
+    layout.m_pushConstantRange = reflection.m_pushConstantRange;
+    for (const std::vector<VkDescriptorSetLayoutBinding> &bindings : sets)
+    {
+        layout.m_setLayouts.push_back(getSetLayout(bindings));
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(layout.m_setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = layout.m_setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = layout.m_pushConstantRange.has_value() ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = layout.m_pushConstantRange.has_value() ? &*layout.m_pushConstantRange : nullptr;
+
+    VkResult result = vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &layout.m_pipelineLayout);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create pipeline layout! VkResult: ") + string_VkResult(result));
+    }
+
+    m_stats.m_pipelineLayoutCount++;
+    return m_pipelineLayouts.emplace(std::move(key), std::move(layout)).first->second;
+}
+
+// Called under the lock
+VkDescriptorSetLayout VulkanPipelineLayoutCache::getSetLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings)
+{
+    std::string key = makeSetKey(bindings);
+    auto it = m_setLayouts.find(key);
+    if (it != m_setLayouts.end())
+    {
+        return it->second;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkResult result = vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &setLayout);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create descriptor set layout! VkResult: ") + string_VkResult(result));
+    }
+
+    m_stats.m_setLayoutCount++;
+    m_setLayouts.emplace(std::move(key), setLayout);
+    return setLayout;
+}
+
+VulkanPipelineLayoutCacheStats VulkanPipelineLayoutCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,220 @@
+#include "core/renderer/VulkanPipelineManifest.hpp"
+
+#include "core/renderer/VulkanPipelineCache.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    constexpr uint32_t MAX_SHADER_STAGES = 8; // Every graphics and compute stage once
+
+    template <typename T>
+    void append(std::string &entry, const T &value)
+    {
+        entry.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    bool read(const std::byte *&data, const std::byte *end, T &value)
+    {
+        if (static_cast<size_t>(end - data) < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return true;
+    }
+
+    bool readString(const std::byte *&data, const std::byte *end, std::string &value)
+    {
+        uint32_t size = 0;
+        if (!read(data, end, size) || static_cast<size_t>(end - data) < size)
+        {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char *>(data), size);
+        data += size;
+        return true;
+    }
+}
+
+VulkanPipelineManifest::VulkanPipelineManifest() {}
+
+VulkanPipelineManifest::~VulkanPipelineManifest() {}
+
+void VulkanPipelineManifest::load(const std::string &filePath)
+{
+    m_filePath = filePath;
+    m_loadedRequests.clear();
+    m_stats = VulkanPipelineManifestStats{};
+    if (m_filePath.empty())
+    {
+        return;
+    }
+
+    std::ifstream file(m_filePath, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        return; // First launch: nothing to pre-warm
+    }
+
+    const size_t fileSize = static_cast<size_t>(file.tellg());
+    FileHeader header{};
+    if (fileSize < sizeof(FileHeader))
+    {
+        m_stats.m_rejectReason = "file too small";
+        return;
+    }
+
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(&header), sizeof(FileHeader));
+    if (header.m_magic != FILE_MAGIC || header.m_version != FILE_VERSION)
+    {
+        m_stats.m_rejectReason = "unknown file format";
+        return;
+    }
+    if (header.m_dataSize != fileSize - sizeof(FileHeader))
+    {
+        m_stats.m_rejectReason = "truncated file";
+        return;
+    }
+
+    std::vector<std::byte> data(header.m_dataSize);
+    file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file || VulkanPipelineCache::computeChecksum(data.data(), data.size()) != header.m_checksum)
+    {
+        m_stats.m_rejectReason = "checksum mismatch";
+        return;
+    }
+
+    const std::byte *cursor = data.data();
+    const std::byte *end = data.data() + data.size();
+    std::vector<VulkanPipelineRequest> requests(header.m_entryCount);
+    for (VulkanPipelineRequest &request : requests)
+    {
+        if (!deserialize(cursor, end, request))
+        {
+            m_stats.m_rejectReason = "damaged entry";
+            return;
+        }
+    }
+
+    m_loadedRequests = std::move(requests);
+    m_stats.m_loadedCount = static_cast<uint32_t>(m_loadedRequests.size());
+}
+
+void VulkanPipelineManifest::record(const VulkanPipelineRequest &request)
+{
+    std::string entry = serialize(request);
+    if (m_recordedEntrySet.insert(entry).second)
+    {
+        m_recordedEntries.push_back(std::move(entry));
+        m_stats.m_recordedCount++;
+    }
+}
+
+void VulkanPipelineManifest::save()
+{
+    if (m_filePath.empty())
+    {
+        return;
+    }
+
+    std::string data;
+    for (const std::string &entry : m_recordedEntries)
+    {
+        data.append(entry);
+    }
+
+    FileHeader header{};
+    header.m_magic = FILE_MAGIC;
+    header.m_version = FILE_VERSION;
+    header.m_entryCount = static_cast<uint32_t>(m_recordedEntries.size());
+    header.m_dataSize = data.size();
+    header.m_checksum = VulkanPipelineCache::computeChecksum(reinterpret_cast<const std::byte *>(data.data()), data.size());
+
+    const std::string temporaryPath = m_filePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        file.flush();
+        if (!file)
+        {
+            // Failing to save only costs the pre-warm of the next launch, it must not abort the shutdown
+            std::cerr << "Failed to write pipeline manifest file: " << temporaryPath << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, m_filePath, error);
+    if (error)
+    {
+        std::cerr << "Failed to replace pipeline manifest file " << m_filePath << ": " << error.message() << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+    }
+}
+
+std::string VulkanPipelineManifest::serialize(const VulkanPipelineRequest &request)
+{
+    std::string entry;
+    append(entry, request.m_state); // No padding: the state's bytes are its value
+    append(entry, request.m_viewportExtent.width);
+    append(entry, request.m_viewportExtent.height);
+    append(entry, request.m_target.m_subpass);
+    append(entry, static_cast<uint32_t>(request.m_shaderStages.size()));
+    for (const ShaderStageSource &stage : request.m_shaderStages)
+    {
+        append(entry, static_cast<uint32_t>(stage.m_stage));
+        for (const std::string *name : {&stage.m_filePath, &stage.m_entryPoint})
+        {
+            append(entry, static_cast<uint32_t>(name->size()));
+            entry.append(*name);
+        }
+    }
+    request.m_specialization.serialize(entry);
+    return entry;
+}
+
+bool VulkanPipelineManifest::deserialize(const std::byte *&data, const std::byte *end, VulkanPipelineRequest &request)
+{
+    uint32_t stageCount = 0;
+    if (!read(data, end, request.m_state) || !read(data, end, request.m_viewportExtent.width) ||
+        !read(data, end, request.m_viewportExtent.height) || !read(data, end, request.m_target.m_subpass) || !read(data, end, stageCount) ||
+        stageCount > MAX_SHADER_STAGES)
+    {
+        return false;
+    }
+    request.m_shaderStages.resize(stageCount);
+    for (ShaderStageSource &stage : request.m_shaderStages)
+    {
+        uint32_t stageBit = 0;
+        if (!read(data, end, stageBit) || !readString(data, end, stage.m_filePath) || !readString(data, end, stage.m_entryPoint))
+        {
+            return false;
+        }
+        stage.m_stage = static_cast<VkShaderStageFlagBits>(stageBit);
+    }
+
+    uint32_t constantCount = 0;
+    if (!read(data, end, constantCount))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < constantCount; i++)
+    {
+        uint32_t constantId = 0;
+        uint32_t value = 0;
+        if (!read(data, end, constantId) || !read(data, end, value))
+        {
+            return false;
+        }
+        request.m_specialization.set(constantId, value);
+    }
+    return true;
+}
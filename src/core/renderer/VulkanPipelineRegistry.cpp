@@ -0,0 +1,335 @@
+#include "core/renderer/VulkanPipelineRegistry.hpp"
+
+#include "core/renderer/VulkanDevice.hpp"
+#include "core/renderer/VulkanPipelineCache.hpp"
+#include "core/renderer/VulkanPipelineManifest.hpp"
+#include "graphics/Shader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+VulkanPipelineRegistry::VulkanPipelineRegistry()
+    : m_device(VK_NULL_HANDLE), m_shaderModuleCache(nullptr), m_pipelineLayoutCache(nullptr), m_pipelineCache(nullptr), m_manifest(nullptr), m_activeJobCount(0), m_isStopping(false), m_retireSerial(0) {}
+
+VulkanPipelineRegistry::~VulkanPipelineRegistry()
+{
+    cleanUp();
+}
+
+void VulkanPipelineRegistry::createRegistry(VulkanDevice &vulkanDevice, VulkanPipelineCache &pipelineCache, const uint32_t workerCount,
+                                            VulkanPipelineManifest *manifest)
+{
+    m_device = vulkanDevice.getDevice();
+    m_shaderModuleCache = &vulkanDevice.getShaderModuleCache();
+    m_pipelineLayoutCache = &vulkanDevice.getPipelineLayoutCache();
+    m_pipelineCache = &pipelineCache;
+    m_manifest = manifest;
+    m_isStopping = false;
+
+    const uint32_t count = (workerCount != 0) ? workerCount : std::max(1u, std::thread::hardware_concurrency());
+
+    // The worker caches are created here, where a failure reaches the caller, not inside the threads
+    std::vector<VkPipelineCache> workerCaches;
+    try
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            workerCaches.push_back(m_pipelineCache->createWorkerCache());
+        }
+    }
+    catch (...)
+    {
+        for (VkPipelineCache workerCache : workerCaches)
+        {
+            vkDestroyPipelineCache(m_device, workerCache, nullptr);
+        }
+        throw;
+    }
+
+    m_stats.m_workerCount = count;
+    for (VkPipelineCache workerCache : workerCaches)
+    {
+        m_workers.emplace_back(&VulkanPipelineRegistry::workerLoop, this, workerCache);
+    }
+}
+
+void VulkanPipelineRegistry::workerLoop(VkPipelineCache workerCache)
+{
+    while (true)
+    {
+        std::function<void(VkPipelineCache)> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobAvailable.wait(lock, [this]() { return m_isStopping || !m_jobs.empty() || !m_prewarmJobs.empty(); });
+            // Regular requests first: something is (or will soon be) waiting for them
+            std::deque<Job> &queue = !m_jobs.empty() ? m_jobs : m_prewarmJobs;
+            if (queue.empty())
+            {
+                break; // Stopping, and nothing left to compile
+            }
+            job = std::move(queue.front().m_compile);
+            queue.pop_front();
+            m_activeJobCount++;
+        }
+
+        job(workerCache);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_activeJobCount--;
+            if (m_jobs.empty() && m_prewarmJobs.empty() && m_activeJobCount == 0)
+            {
+                m_idle.notify_all();
+            }
+        }
+    }
+
+    m_pipelineCache->mergeWorkerCache(workerCache);
+}
+
+VulkanPipelineHandle VulkanPipelineRegistry::requestPipeline(const VulkanPipelineRequest &request)
+{
+    std::string key = makeKey(request);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.m_requestCount++;
+    if (m_manifest != nullptr)
+    {
+        m_manifest->record(request);
+    }
+
+    auto existing = m_entries.find(key);
+    if (existing == m_entries.end())
+    {
+        return addEntry(std::move(key), request, m_jobs).m_handle;
+    }
+
+    Entry &entry = existing->second;
+    m_stats.m_deduplicatedCount++;
+    if (entry.m_isPrewarm)
+    {
+        m_stats.m_prewarmHitCount++;
+        entry.m_isPrewarm = false;
+
+        // Still waiting behind other pre-warm jobs: it is needed now
+        auto queued = std::find_if(m_prewarmJobs.begin(), m_prewarmJobs.end(), [&entry](const Job &job) { return job.m_entry == &entry; });
+        if (queued != m_prewarmJobs.end())
+        {
+            m_jobs.push_back(std::move(*queued));
+            m_prewarmJobs.erase(queued);
+        }
+    }
+    return entry.m_handle;
+}
+
+void VulkanPipelineRegistry::prewarmPipeline(const VulkanPipelineRequest &request)
+{
+    std::string key = makeKey(request);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.find(key) != m_entries.end())
+    {
+        return;
+    }
+    addEntry(std::move(key), request, m_prewarmJobs).m_isPrewarm = true;
+    m_stats.m_prewarmCount++;
+}
+
+// m_mutex must be held. The entry (and the pipeline object) is created now so duplicate requests find it while it compiles
+VulkanPipelineRegistry::Entry &VulkanPipelineRegistry::addEntry(std::string key, const VulkanPipelineRequest &request, std::deque<Job> &jobs)
+{
+    Entry &entry = m_entries[std::move(key)];
+    entry.m_request = request;
+    entry.m_pipeline = std::make_unique<VulkanGraphicsPipeline>();
+
+    auto promise = std::make_shared<std::promise<const VulkanGraphicsPipeline *>>();
+    entry.m_handle = promise->get_future().share();
+
+    VulkanGraphicsPipeline *pipeline = entry.m_pipeline.get();
+    auto compile = [this, request, pipeline, promise](VkPipelineCache workerCache)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        bool succeeded = false;
+        try
+        {
+            // Loading the shader modules is part of the job: it also runs in parallel (pipelines sharing a shader share its module)
+            Shader shader(*m_shaderModuleCache, request.m_shaderStages);
+            shader.setSpecialization(request.m_specialization);
+            // The layout follows from the shaders' interface: pipelines with the same interface share it
+            const VulkanPipelineLayout &layout = m_pipelineLayoutCache->getPipelineLayout(shader.getReflection());
+            pipeline->createPipeline(m_device, request.m_state, shader, layout.m_pipelineLayout, request.m_target, workerCache, request.m_viewportExtent);
+            succeeded = true;
+            promise->set_value(pipeline);
+        }
+        catch (...)
+        {
+            promise->set_exception(std::current_exception());
+        }
+        const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> statsLock(m_mutex);
+        m_stats.m_compileMs += elapsedMs;
+        (succeeded ? m_stats.m_compiledCount : m_stats.m_failedCount)++;
+    };
+    jobs.push_back(Job{&entry, std::move(compile)});
+    m_jobAvailable.notify_one();
+
+    return entry;
+}
+
+uint64_t VulkanPipelineRegistry::rebuildPipelines(const std::vector<std::string> &changedShaderPaths)
+{
+    const auto usesChangedShader = [&changedShaderPaths](const VulkanPipelineRequest &request)
+    {
+        return std::any_of(request.m_shaderStages.begin(), request.m_shaderStages.end(), [&changedShaderPaths](const ShaderStageSource &stage)
+                           { return std::find(changedShaderPaths.begin(), changedShaderPaths.end(), stage.m_filePath) != changedShaderPaths.end(); });
+    };
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t retireSerial = ++m_retireSerial;
+
+    std::vector<std::string> keys;
+    for (const auto &[key, entry] : m_entries)
+    {
+        if (usesChangedShader(entry.m_request))
+        {
+            keys.push_back(key);
+        }
+    }
+
+    for (std::string &key : keys)
+    {
+        auto it = m_entries.find(key);
+        Entry &entry = it->second;
+
+        // A compilation of the previous shaders that has not started is dropped (its handle reports a broken promise)
+        for (std::deque<Job> *jobs : {&m_jobs, &m_prewarmJobs})
+        {
+            jobs->erase(std::remove_if(jobs->begin(), jobs->end(), [&entry](const Job &job) { return job.m_entry == &entry; }), jobs->end());
+        }
+        m_retiredPipelines.push_back(RetiredPipeline{retireSerial, std::move(entry.m_pipeline), entry.m_handle});
+
+        const VulkanPipelineRequest request = entry.m_request;
+        const bool isPrewarm = entry.m_isPrewarm;
+        m_entries.erase(it);
+        addEntry(std::move(key), request, isPrewarm ? m_prewarmJobs : m_jobs).m_isPrewarm = isPrewarm;
+        m_stats.m_rebuiltCount++;
+    }
+    return retireSerial;
+}
+
+uint64_t VulkanPipelineRegistry::retireAllPipelines()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t retireSerial = ++m_retireSerial;
+
+    // Compilations that have not started are dropped (their handles report a broken promise)
+    m_jobs.clear();
+    m_prewarmJobs.clear();
+    for (auto &[key, entry] : m_entries)
+    {
+        m_retiredPipelines.push_back(RetiredPipeline{retireSerial, std::move(entry.m_pipeline), entry.m_handle});
+    }
+    m_entries.clear();
+    return retireSerial;
+}
+
+void VulkanPipelineRegistry::releaseRetiredPipelines(const uint64_t retireSerial)
+{
+    std::vector<RetiredPipeline> released;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto firstReleased = std::stable_partition(m_retiredPipelines.begin(), m_retiredPipelines.end(), [retireSerial](const RetiredPipeline &retired)
+                                                   { return retired.m_retireSerial != retireSerial; });
+        std::move(firstReleased, m_retiredPipelines.end(), std::back_inserter(released));
+        m_retiredPipelines.erase(firstReleased, m_retiredPipelines.end());
+    }
+
+    for (RetiredPipeline &retired : released)
+    {
+        retired.m_handle.wait(); // A worker may still be creating it
+        retired.m_pipeline->cleanUp();
+    }
+}
+
+void VulkanPipelineRegistry::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_jobs.empty() && m_prewarmJobs.empty() && m_activeJobCount == 0; });
+}
+
+VulkanPipelineRegistryStats VulkanPipelineRegistry::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+// Every value that changes the compiled pipeline, in a fixed order
+std::string VulkanPipelineRegistry::makeKey(const VulkanPipelineRequest &request)
+{
+    std::string key;
+    const auto append = [&key](const auto &value)
+    {
+        key.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+
+    // The state has no padding or pointers: its bytes are the key
+    append(request.m_state);
+    if (!request.m_state.hasDynamicState(VK_DYNAMIC_STATE_VIEWPORT) || !request.m_state.hasDynamicState(VK_DYNAMIC_STATE_SCISSOR))
+    {
+        append(request.m_viewportExtent);
+    }
+    append(reinterpret_cast<uint64_t>(request.m_target.m_renderPass));
+    append(request.m_target.m_subpass);
+    append(static_cast<uint64_t>(request.m_target.m_colorFormats.size()));
+    for (const VkFormat format : request.m_target.m_colorFormats)
+    {
+        append(format);
+    }
+    append(request.m_target.m_depthFormat);
+    append(request.m_target.m_stencilFormat);
+
+    append(static_cast<uint64_t>(request.m_shaderStages.size()));
+    for (const ShaderStageSource &stage : request.m_shaderStages)
+    {
+        append(stage.m_stage);
+        for (const std::string *name : {&stage.m_filePath, &stage.m_entryPoint})
+        {
+            append(static_cast<uint64_t>(name->size()));
+            key.append(*name);
+        }
+    }
+    // Permutations of the same shaders are distinct pipelines; the same values requested twice are one
+    request.m_specialization.serialize(key);
+    return key;
+}
+
+void VulkanPipelineRegistry::cleanUp()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+        // Nothing waits for pre-warm pipelines that have not started compiling: drop them
+        m_prewarmJobs.clear();
+    }
+    m_jobAvailable.notify_all();
+
+    // Workers finish the queued jobs, then merge their pipeline caches
+    for (std::thread &worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+
+    for (auto &[key, entry] : m_entries)
+    {
+        entry.m_pipeline->cleanUp();
+    }
+    m_entries.clear();
+    for (RetiredPipeline &retired : m_retiredPipelines)
+    {
+        retired.m_pipeline->cleanUp();
+    }
+    m_retiredPipelines.clear();
+}
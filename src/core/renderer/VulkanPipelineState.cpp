@@ -0,0 +1,106 @@
+#include "core/renderer/VulkanPipelineState.hpp"
+
+#include <stdexcept>
+#include <string>
+
+VulkanPipelineStateCreateInfo::VulkanPipelineStateCreateInfo(const VulkanPipelineState &state, const VkExtent2D viewportExtent)
+{
+    // Vertex Input (none: the vertex shaders generate or pull their vertices)
+    m_vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    // Input Assembly
+    m_inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    m_inputAssemblyInfo.topology = static_cast<VkPrimitiveTopology>(state.m_topology);
+    m_inputAssemblyInfo.primitiveRestartEnable = state.m_primitiveRestartEnable;
+
+    // Tessellation
+    m_tessellationInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+    m_tessellationInfo.patchControlPoints = state.m_patchControlPoints;
+
+    // Viewport and Scissor (ignored by the driver when they are dynamic)
+    m_viewport.width = static_cast<float>(viewportExtent.width);
+    m_viewport.height = static_cast<float>(viewportExtent.height);
+    m_viewport.maxDepth = 1.0f;
+    m_scissor.extent = viewportExtent;
+
+    m_viewportInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    m_viewportInfo.viewportCount = 1;
+    m_viewportInfo.pViewports = state.hasDynamicState(VK_DYNAMIC_STATE_VIEWPORT) ? nullptr : &m_viewport;
+    m_viewportInfo.scissorCount = 1;
+    m_viewportInfo.pScissors = state.hasDynamicState(VK_DYNAMIC_STATE_SCISSOR) ? nullptr : &m_scissor;
+
+    // Rasterization
+    m_rasterizationInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    m_rasterizationInfo.depthClampEnable = state.m_depthClampEnable;
+    m_rasterizationInfo.rasterizerDiscardEnable = state.m_rasterizerDiscardEnable;
+    m_rasterizationInfo.polygonMode = static_cast<VkPolygonMode>(state.m_polygonMode);
+    m_rasterizationInfo.lineWidth = 1.0f;
+    m_rasterizationInfo.cullMode = state.m_cullMode;
+    m_rasterizationInfo.frontFace = static_cast<VkFrontFace>(state.m_frontFace);
+    m_rasterizationInfo.depthBiasEnable = state.m_depthBiasEnable;
+
+    // Multisample
+    m_multisampleInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    m_multisampleInfo.rasterizationSamples = static_cast<VkSampleCountFlagBits>(state.m_rasterizationSamples);
+    m_multisampleInfo.sampleShadingEnable = state.m_sampleShadingEnable;
+    m_multisampleInfo.minSampleShading = static_cast<float>(state.m_minSampleShadingPercent) / 100.0f;
+    m_multisampleInfo.alphaToCoverageEnable = state.m_alphaToCoverageEnable;
+
+    // Depth Stencil
+    m_depthStencilInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    m_depthStencilInfo.depthTestEnable = state.m_depthTestEnable;
+    m_depthStencilInfo.depthWriteEnable = state.m_depthWriteEnable;
+    m_depthStencilInfo.depthCompareOp = static_cast<VkCompareOp>(state.m_depthCompareOp);
+
+    // Color Blend
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.blendEnable = state.m_blendEnable;
+    colorBlendAttachment.srcColorBlendFactor = static_cast<VkBlendFactor>(state.m_srcColorBlendFactor);
+    colorBlendAttachment.dstColorBlendFactor = static_cast<VkBlendFactor>(state.m_dstColorBlendFactor);
+    colorBlendAttachment.colorBlendOp = static_cast<VkBlendOp>(state.m_colorBlendOp);
+    colorBlendAttachment.srcAlphaBlendFactor = static_cast<VkBlendFactor>(state.m_srcAlphaBlendFactor);
+    colorBlendAttachment.dstAlphaBlendFactor = static_cast<VkBlendFactor>(state.m_dstAlphaBlendFactor);
+    colorBlendAttachment.alphaBlendOp = static_cast<VkBlendOp>(state.m_alphaBlendOp);
+    colorBlendAttachment.colorWriteMask = state.m_colorWriteMask;
+    if (state.m_colorAttachmentCount > VulkanPipelineState::MAX_COLOR_ATTACHMENTS)
+    {
+        throw std::runtime_error("Pipeline state has " + std::to_string(state.m_colorAttachmentCount) + " color attachments, at most " +
+                                 std::to_string(VulkanPipelineState::MAX_COLOR_ATTACHMENTS) + " are supported!");
+    }
+    for (uint32_t i = 0; i < state.m_colorAttachmentCount; i++)
+    {
+        m_colorBlendAttachments[i] = colorBlendAttachment;
+    }
+
+    m_colorBlendInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    m_colorBlendInfo.logicOpEnable = state.m_logicOpEnable;
+    m_colorBlendInfo.logicOp = static_cast<VkLogicOp>(state.m_logicOp);
+    m_colorBlendInfo.attachmentCount = state.m_colorAttachmentCount;
+    m_colorBlendInfo.pAttachments = m_colorBlendAttachments;
+
+    // Dynamic State
+    uint32_t dynamicStateCount = 0;
+    for (uint32_t i = 0; i < std::size(DYNAMIC_STATES); i++)
+    {
+        if ((state.m_dynamicStates & (1u << i)) != 0)
+        {
+            m_dynamicStates[dynamicStateCount++] = DYNAMIC_STATES[i];
+        }
+    }
+    m_dynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    m_dynamicStateInfo.dynamicStateCount = dynamicStateCount;
+    m_dynamicStateInfo.pDynamicStates = m_dynamicStates;
+}
+
+void VulkanPipelineStateCreateInfo::fill(VkGraphicsPipelineCreateInfo &pipelineInfo) const
+{
+    pipelineInfo.pVertexInputState = &m_vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &m_inputAssemblyInfo;
+    pipelineInfo.pTessellationState = (m_tessellationInfo.patchControlPoints > 0) ? &m_tessellationInfo : nullptr;
+    pipelineInfo.pViewportState = &m_viewportInfo;
+    pipelineInfo.pRasterizationState = &m_rasterizationInfo;
+    pipelineInfo.pMultisampleState = &m_multisampleInfo;
+    pipelineInfo.pDepthStencilState = &m_depthStencilInfo;
+    pipelineInfo.pColorBlendState = &m_colorBlendInfo;
+    pipelineInfo.pDynamicState = (m_dynamicStateInfo.dynamicStateCount > 0) ? &m_dynamicStateInfo : nullptr;
+}
@@ -0,0 +1,172 @@
+#include "core/renderer/VulkanReadbackRing.hpp"
+
+#include "core/renderer/VulkanDevice.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+#include <vulkan/utility/vk_format_utils.h>
+
+#include <stdexcept>
+#include <string>
+
+VulkanReadbackRing::VulkanReadbackRing()
+    : m_device(VK_NULL_HANDLE), m_memoryAllocator(nullptr), m_extent{0, 0}, m_format(VK_FORMAT_UNDEFINED), m_frameSize(0),
+      m_nextSlot(0), m_capturedFrameCount(0), m_droppedFrameCount(0) {}
+
+VulkanReadbackRing::~VulkanReadbackRing() {}
+
+void VulkanReadbackRing::createRing(VulkanDevice &vulkanDevice, const VkExtent2D extent, const VkFormat format, const uint32_t slotCount)
+{
+    m_device = vulkanDevice.getDevice();
+    m_memoryAllocator = &vulkanDevice.getMemoryAllocator();
+    m_extent = extent;
+    m_format = format;
+    m_frameSize = static_cast<VkDeviceSize>(extent.width) * extent.height * vkuFormatElementSize(format);
+
+    m_slots.resize(slotCount);
+    for (Slot &slot : m_slots)
+    {
+        createSlot(slot);
+    }
+}
+
+void VulkanReadbackRing::createSlot(Slot &slot)
+{
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = m_frameSize;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkResult result = vkCreateBuffer(m_device, &bufferInfo, nullptr, &slot.m_buffer);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create readback buffer! VkResult: ") + string_VkResult(result));
+    }
+
+    // HOST_CACHED makes CPU reads of the mapped memory fast; uncached memory is very slow to read from.
+    // Host visible blocks are persistently mapped by the allocator
+    slot.m_allocation = m_memoryAllocator->allocateForBuffer(slot.m_buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+}
+
+bool VulkanReadbackRing::recordCopy(VkCommandBuffer commandBuffer, VkImage image, const uint64_t frameNumber)
+{
+    // Slots are normally used in order, but the consumer may hold on to a frame for a while, so look for any free slot
+    const uint32_t slotCount = static_cast<uint32_t>(m_slots.size());
+    uint32_t slotIndex = m_nextSlot;
+    while (m_slots[slotIndex].m_state != SlotState::FREE)
+    {
+        slotIndex = (slotIndex + 1) % slotCount;
+        if (slotIndex == m_nextSlot)
+        {
+            // The consumer has not caught up: skip this frame rather than stalling the render loop
+            m_droppedFrameCount++;
+            return false;
+        }
+    }
+    Slot &slot = m_slots[slotIndex];
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0; // Tightly packed
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {m_extent.width, m_extent.height, 1};
+
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.m_buffer, 1, &region);
+
+    // Make the transfer write visible to host reads once the frame's fence has signaled
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = slot.m_buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                         0, nullptr, 1, &barrier, 0, nullptr);
+
+    slot.m_state = SlotState::PENDING;
+    slot.m_frameNumber = frameNumber;
+    m_nextSlot = (slotIndex + 1) % slotCount;
+    return true;
+}
+
+void VulkanReadbackRing::retire(const uint64_t completedFrameNumber)
+{
+    for (Slot &slot : m_slots)
+    {
+        if (slot.m_state == SlotState::PENDING && slot.m_frameNumber <= completedFrameNumber)
+        {
+            invalidate(slot);
+            slot.m_state = SlotState::READY;
+            m_capturedFrameCount++;
+        }
+    }
+}
+
+std::optional<VulkanReadbackFrame> VulkanReadbackRing::acquireFrame()
+{
+    Slot *oldest = nullptr;
+    uint32_t oldestIndex = 0;
+    for (uint32_t i = 0; i < m_slots.size(); i++)
+    {
+        Slot &slot = m_slots[i];
+        if (slot.m_state == SlotState::READY && (oldest == nullptr || slot.m_frameNumber < oldest->m_frameNumber))
+        {
+            oldest = &slot;
+            oldestIndex = i;
+        }
+    }
+
+    if (oldest == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    oldest->m_state = SlotState::ACQUIRED;
+
+    VulkanReadbackFrame frame{};
+    frame.m_frameNumber = oldest->m_frameNumber;
+    frame.m_extent = m_extent;
+    frame.m_format = m_format;
+    frame.m_rowPitch = m_extent.width * vkuFormatElementSize(m_format);
+    frame.m_pixels = std::span<const std::byte>(oldest->m_allocation.m_mapped, static_cast<size_t>(m_frameSize));
+    frame.m_slot = oldestIndex;
+    return frame;
+}
+
+void VulkanReadbackRing::releaseFrame(const VulkanReadbackFrame &frame)
+{
+    Slot &slot = m_slots.at(frame.m_slot);
+    if (slot.m_state == SlotState::ACQUIRED && slot.m_frameNumber == frame.m_frameNumber)
+    {
+        slot.m_state = SlotState::FREE;
+    }
+}
+
+// Non-coherent memory must be invalidated before the host reads what the device wrote
+void VulkanReadbackRing::invalidate(const Slot &slot) const
+{
+    m_memoryAllocator->invalidate(slot.m_allocation, 0, m_frameSize);
+}
+
+void VulkanReadbackRing::cleanUp()
+{
+    for (Slot &slot : m_slots)
+    {
+        if (slot.m_buffer != VK_NULL_HANDLE)
+        {
+            vkDestroyBuffer(m_device, slot.m_buffer, nullptr);
+        }
+        m_memoryAllocator->free(slot.m_allocation);
+    }
+    m_slots.clear();
+    m_nextSlot = 0;
+}
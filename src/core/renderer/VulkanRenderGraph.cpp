@@ -0,0 +1,1441 @@
+#include "core/renderer/VulkanRenderGraph.hpp"
+
+#include "core/renderer/VulkanDevice.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+#include <algorithm>
+#include <optional>
+#include <set>
+#include <stdexcept>
+
+namespace
+{
+    constexpr VkAccessFlags WRITE_ACCESS_MASK = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
+                                                VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+    constexpr VkPipelineStageFlags DEPTH_TEST_STAGES = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+    bool isDepthFormat(const VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    VkImageAspectFlags getAspectMask(const VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return isDepthFormat(format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+        }
+    }
+
+    VkDeviceSize alignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    VkBufferUsageFlags getBufferUsage(const VkAccessFlags accessMask)
+    {
+        VkBufferUsageFlags usage = 0;
+        if (accessMask & VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT)
+        {
+            usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        }
+        if (accessMask & VK_ACCESS_INDEX_READ_BIT)
+        {
+            usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+        }
+        if (accessMask & VK_ACCESS_INDIRECT_COMMAND_READ_BIT)
+        {
+            usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+        }
+        if (accessMask & VK_ACCESS_UNIFORM_READ_BIT)
+        {
+            usage |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        }
+        if (accessMask & VK_ACCESS_SHADER_READ_BIT)
+        {
+            usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        }
+        return usage;
+    }
+}
+
+VkImage VulkanRenderGraphPassContext::getImage(const std::string &name) const
+{
+    return m_graph->getImage(name);
+}
+
+VkImageView VulkanRenderGraphPassContext::getImageView(const std::string &name) const
+{
+    return m_graph->getImageView(name);
+}
+
+VkBuffer VulkanRenderGraphPassContext::getBuffer(const std::string &name) const
+{
+    return m_graph->getBuffer(name);
+}
+
+VulkanRenderGraphPass::VulkanRenderGraphPass(const std::string &name) : m_name(name), m_hasSideEffect(false) {}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::addAccess(const Access &access)
+{
+    m_accesses.push_back(access);
+    return *this;
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::writeColor(const std::string &name, const VkAttachmentLoadOp loadOp, const VkClearColorValue clearValue)
+{
+    Access access{};
+    access.m_resource = name;
+    access.m_stageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    access.m_isRead = (loadOp == VK_ATTACHMENT_LOAD_OP_LOAD);
+    access.m_isWrite = true;
+    access.m_accessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (access.m_isRead ? VK_ACCESS_COLOR_ATTACHMENT_READ_BIT : 0);
+    access.m_layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    access.m_imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    access.m_attachmentType = AttachmentType::COLOR;
+    access.m_loadOp = loadOp;
+    access.m_clearValue.color = clearValue;
+    return addAccess(access);
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::writeDepth(const std::string &name, const VkAttachmentLoadOp loadOp, const VkClearDepthStencilValue clearValue)
+{
+    Access access{};
+    access.m_resource = name;
+    access.m_stageMask = DEPTH_TEST_STAGES;
+    access.m_accessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT; // The depth test reads
+    access.m_isRead = (loadOp == VK_ATTACHMENT_LOAD_OP_LOAD);
+    access.m_isWrite = true;
+    access.m_layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    access.m_imageUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    access.m_attachmentType = AttachmentType::DEPTH;
+    access.m_loadOp = loadOp;
+    access.m_clearValue.depthStencil = clearValue;
+    return addAccess(access);
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::readDepth(const std::string &name)
+{
+    Access access{};
+    access.m_resource = name;
+    access.m_stageMask = DEPTH_TEST_STAGES;
+    access.m_accessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+    access.m_isRead = true;
+    access.m_layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    access.m_imageUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    access.m_attachmentType = AttachmentType::DEPTH;
+    access.m_loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    return addAccess(access);
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::resolveColor(const std::string &source, const std::string &target)
+{
+    // The resolve writes every pixel of the target in the COLOR_ATTACHMENT_OUTPUT stage
+    Access access{};
+    access.m_resource = target;
+    access.m_stageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    access.m_accessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    access.m_isWrite = true;
+    access.m_layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    access.m_imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    access.m_attachmentType = AttachmentType::RESOLVE;
+    access.m_loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    access.m_resolveSource = source;
+    return addAccess(access);
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::readInput(const std::string &name)
+{
+    Access access{};
+    access.m_resource = name;
+    access.m_stageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    access.m_accessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+    access.m_isRead = true;
+    access.m_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; // DEPTH_STENCIL_READ_ONLY for a depth image, set at compile
+    access.m_imageUsage = VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    access.m_attachmentType = AttachmentType::INPUT;
+    access.m_loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    return addAccess(access);
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::readTexture(const std::string &name, const VkPipelineStageFlags stageMask)
+{
+    Access access{};
+    access.m_resource = name;
+    access.m_stageMask = stageMask;
+    access.m_accessMask = VK_ACCESS_SHADER_READ_BIT;
+    access.m_isRead = true;
+    access.m_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    access.m_imageUsage = VK_IMAGE_USAGE_SAMPLED_BIT;
+    return addAccess(access);
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::readStorage(const std::string &name, const VkPipelineStageFlags stageMask)
+{
+    Access access{};
+    access.m_resource = name;
+    access.m_stageMask = stageMask;
+    access.m_accessMask = VK_ACCESS_SHADER_READ_BIT;
+    access.m_isRead = true;
+    access.m_layout = VK_IMAGE_LAYOUT_GENERAL;
+    access.m_imageUsage = VK_IMAGE_USAGE_STORAGE_BIT;
+    access.m_bufferUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    return addAccess(access);
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::writeStorage(const std::string &name, const VkPipelineStageFlags stageMask)
+{
+    Access access{};
+    access.m_resource = name;
+    access.m_stageMask = stageMask;
+    access.m_accessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    access.m_isWrite = true;
+    access.m_layout = VK_IMAGE_LAYOUT_GENERAL;
+    access.m_imageUsage = VK_IMAGE_USAGE_STORAGE_BIT;
+    access.m_bufferUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    return addAccess(access);
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::readTransfer(const std::string &name)
+{
+    Access access{};
+    access.m_resource = name;
+    access.m_stageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    access.m_accessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    access.m_isRead = true;
+    access.m_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    access.m_imageUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    access.m_bufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    return addAccess(access);
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::writeTransfer(const std::string &name)
+{
+    Access access{};
+    access.m_resource = name;
+    access.m_stageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    access.m_accessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    access.m_isWrite = true;
+    access.m_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    access.m_imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    access.m_bufferUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    return addAccess(access);
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::readBuffer(const std::string &name, const VkPipelineStageFlags stageMask, const VkAccessFlags accessMask)
+{
+    Access access{};
+    access.m_resource = name;
+    access.m_stageMask = stageMask;
+    access.m_accessMask = accessMask;
+    access.m_isRead = true;
+    access.m_bufferUsage = getBufferUsage(accessMask);
+    return addAccess(access);
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::setSideEffect()
+{
+    m_hasSideEffect = true;
+    return *this;
+}
+
+VulkanRenderGraphPass &VulkanRenderGraphPass::setRecord(const RecordCallback &record)
+{
+    m_record = record;
+    return *this;
+}
+
+VulkanRenderGraph::VulkanRenderGraph()
+    : m_device(VK_NULL_HANDLE), m_memoryAllocator(nullptr), m_renderExtent{0, 0}, m_isCompiled(false), m_useDynamicRendering(false),
+      m_cmdBeginRendering(nullptr), m_cmdEndRendering(nullptr) {}
+
+VulkanRenderGraph::~VulkanRenderGraph()
+{
+    cleanUp();
+}
+
+void VulkanRenderGraph::create(VulkanDevice &vulkanDevice, const bool useDynamicRendering)
+{
+    m_device = vulkanDevice.getDevice();
+    m_memoryAllocator = &vulkanDevice.getMemoryAllocator();
+
+    // Extension commands are not exported by the loader: they are fetched from the device
+    m_useDynamicRendering = useDynamicRendering && vulkanDevice.supportsDynamicRendering();
+    if (m_useDynamicRendering)
+    {
+        m_cmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(m_device, "vkCmdBeginRenderingKHR"));
+        m_cmdEndRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(vkGetDeviceProcAddr(m_device, "vkCmdEndRenderingKHR"));
+        if (m_cmdBeginRendering == nullptr || m_cmdEndRendering == nullptr)
+        {
+            throw std::runtime_error(std::string("Failed to load device function ") +
+                                     (m_cmdBeginRendering == nullptr ? "vkCmdBeginRenderingKHR" : "vkCmdEndRenderingKHR") + "!");
+        }
+    }
+}
+
+void VulkanRenderGraph::cleanUp()
+{
+    if (m_isCompiled)
+    {
+        destroyRetired(retireResources());
+        for (CompiledPass &compiledPass : m_compiledPasses)
+        {
+            compiledPass.m_renderPass.cleanUp();
+        }
+    }
+    m_isCompiled = false;
+    m_compiledPasses.clear();
+    m_passes.clear();
+    m_resources.clear();
+    m_resourceIndices.clear();
+    m_finalBarriers = BarrierBatch{};
+    // The stats are kept, to be reported after shutdown
+}
+
+void VulkanRenderGraph::addResource(Resource &&resource)
+{
+    if (m_isCompiled)
+    {
+        throw std::runtime_error("Render graph: resources must be declared before compile (" + resource.m_name + ")");
+    }
+    if (!m_resourceIndices.emplace(resource.m_name, static_cast<uint32_t>(m_resources.size())).second)
+    {
+        throw std::runtime_error("Render graph: resource " + resource.m_name + " is declared twice");
+    }
+    m_resources.push_back(std::move(resource));
+}
+
+void VulkanRenderGraph::createImage(const std::string &name, const VulkanRenderGraphImageDescription &description)
+{
+    Resource resource{};
+    resource.m_name = name;
+    resource.m_description = description;
+    addResource(std::move(resource));
+}
+
+void VulkanRenderGraph::createBuffer(const std::string &name, const VkDeviceSize size)
+{
+    Resource resource{};
+    resource.m_name = name;
+    resource.m_isImage = false;
+    resource.m_bufferSize = size;
+    addResource(std::move(resource));
+}
+
+void VulkanRenderGraph::importImage(const std::string &name, const VulkanRenderGraphImageImport &imageImport)
+{
+    Resource resource{};
+    resource.m_name = name;
+    resource.m_isImported = true;
+    resource.m_import = imageImport;
+    resource.m_description.m_format = imageImport.m_format;
+    addResource(std::move(resource));
+}
+
+void VulkanRenderGraph::importBuffer(const std::string &name, const VkPipelineStageFlags initialStageMask, const VkAccessFlags initialAccessMask)
+{
+    Resource resource{};
+    resource.m_name = name;
+    resource.m_isImage = false;
+    resource.m_isImported = true;
+    resource.m_import.m_initialStageMask = initialStageMask;
+    resource.m_import.m_initialAccessMask = initialAccessMask;
+    addResource(std::move(resource));
+}
+
+VulkanRenderGraphPass &VulkanRenderGraph::addPass(const std::string &name)
+{
+    if (m_isCompiled)
+    {
+        throw std::runtime_error("Render graph: passes must be added before compile (" + name + ")");
+    }
+    m_passes.push_back(std::make_unique<VulkanRenderGraphPass>(name));
+    return *m_passes.back();
+}
+
+uint32_t VulkanRenderGraph::getResourceIndex(const std::string &name) const
+{
+    auto it = m_resourceIndices.find(name);
+    if (it == m_resourceIndices.end())
+    {
+        throw std::runtime_error("Render graph: unknown resource " + name);
+    }
+    return it->second;
+}
+
+VkExtent2D VulkanRenderGraph::getImageExtent(const Resource &resource) const
+{
+    const bool isRelative = resource.m_isImported || resource.m_description.m_extent.width == 0 || resource.m_description.m_extent.height == 0;
+    return isRelative ? m_renderExtent : resource.m_description.m_extent;
+}
+
+void VulkanRenderGraph::compile(const VkExtent2D renderExtent)
+{
+    if (m_isCompiled)
+    {
+        throw std::runtime_error("Render graph: already compiled");
+    }
+    m_renderExtent = renderExtent;
+
+    cullPasses();
+    mergeSubpasses();
+    createTransientResources();
+    computeBarriers();
+    createRenderPasses();
+    m_isCompiled = true;
+}
+
+// Walks the passes backwards from the ones with visible results (writing an imported resource, or with a side effect):
+// a pass is kept if a kept pass after it reads something it writes. Then validates the accesses of the kept passes and
+// computes the lifetimes and usage of the resources
+void VulkanRenderGraph::cullPasses()
+{
+    std::vector<bool> isKept(m_passes.size(), false);
+    std::set<uint32_t> neededResources; // Read by a kept pass later in the frame
+    for (size_t i = m_passes.size(); i-- > 0;)
+    {
+        const VulkanRenderGraphPass &pass = *m_passes[i];
+        bool kept = pass.m_hasSideEffect;
+        for (const VulkanRenderGraphPass::Access &access : pass.m_accesses)
+        {
+            const uint32_t resourceIndex = getResourceIndex(access.m_resource);
+            kept = kept || (access.m_isWrite && (m_resources[resourceIndex].m_isImported || neededResources.count(resourceIndex) > 0));
+        }
+        if (!kept)
+        {
+            continue;
+        }
+
+        isKept[i] = true;
+        for (const VulkanRenderGraphPass::Access &access : pass.m_accesses)
+        {
+            if (access.m_isWrite)
+            {
+                neededResources.erase(getResourceIndex(access.m_resource));
+            }
+        }
+        for (const VulkanRenderGraphPass::Access &access : pass.m_accesses)
+        {
+            if (access.m_isRead)
+            {
+                neededResources.insert(getResourceIndex(access.m_resource));
+            }
+        }
+    }
+
+    m_stats.m_passCount = static_cast<uint32_t>(m_passes.size());
+    m_stats.m_culledPassCount = 0;
+    for (uint32_t i = 0; i < m_passes.size(); i++)
+    {
+        if (!isKept[i])
+        {
+            m_stats.m_culledPassCount++;
+            continue;
+        }
+
+        const int32_t compiledIndex = static_cast<int32_t>(m_compiledPasses.size());
+        m_compiledPasses.emplace_back();
+        m_compiledPasses.back().m_pass = i;
+
+        std::set<uint32_t> accessedResources;
+        for (VulkanRenderGraphPass::Access &access : m_passes[i]->m_accesses)
+        {
+            const uint32_t resourceIndex = getResourceIndex(access.m_resource);
+            Resource &resource = m_resources[resourceIndex];
+            if (!accessedResources.insert(resourceIndex).second)
+            {
+                throw std::runtime_error("Render graph: pass " + m_passes[i]->m_name + " accesses " + resource.m_name + " twice");
+            }
+            if (resource.m_isImage && access.m_layout == VK_IMAGE_LAYOUT_UNDEFINED)
+            {
+                throw std::runtime_error("Render graph: pass " + m_passes[i]->m_name + " reads image " + resource.m_name + " as a buffer");
+            }
+            if (!resource.m_isImage && access.m_attachmentType != VulkanRenderGraphPass::AttachmentType::NONE)
+            {
+                throw std::runtime_error("Render graph: pass " + m_passes[i]->m_name + " uses buffer " + resource.m_name + " as an attachment");
+            }
+            if (access.m_attachmentType == VulkanRenderGraphPass::AttachmentType::INPUT && isDepthFormat(resource.m_description.m_format))
+            {
+                access.m_layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+            }
+            // Transient contents start undefined every frame
+            if (!resource.m_isImported && resource.m_firstPass < 0 && access.m_isRead)
+            {
+                throw std::runtime_error("Render graph: pass " + m_passes[i]->m_name + " reads " + resource.m_name + " before any pass writes it");
+            }
+
+            if (resource.m_firstPass < 0)
+            {
+                resource.m_firstPass = compiledIndex;
+            }
+            resource.m_lastPass = compiledIndex;
+            resource.m_imageUsage |= access.m_imageUsage;
+            resource.m_bufferUsage |= access.m_bufferUsage;
+        }
+    }
+}
+
+// A pass reading input attachments becomes the next subpass of the render pass of the pass kept before it. That render
+// pass must have every input as an attachment, and the passes must share no other resource: an access outside of the
+// attachments would need a barrier, which cannot be recorded between two subpasses
+void VulkanRenderGraph::mergeSubpasses()
+{
+    m_stats.m_mergedPassCount = 0;
+    std::map<uint32_t, bool> renderPassResources; // Accessed by the current render pass: true if only as attachments
+    std::set<uint32_t> renderPassAttachments;     // Its color, depth and resolve attachments
+    for (uint32_t i = 0; i < m_compiledPasses.size(); i++)
+    {
+        CompiledPass &compiledPass = m_compiledPasses[i];
+        const VulkanRenderGraphPass &pass = *m_passes[compiledPass.m_pass];
+        const bool readsInputs = std::any_of(pass.m_accesses.begin(), pass.m_accesses.end(), [](const VulkanRenderGraphPass::Access &access)
+                                             { return access.m_attachmentType == VulkanRenderGraphPass::AttachmentType::INPUT; });
+        if (!readsInputs)
+        {
+            compiledPass.m_leader = i;
+            compiledPass.m_subpass = 0;
+            compiledPass.m_subpassCount = 1;
+            renderPassResources.clear();
+            renderPassAttachments.clear();
+        }
+        else
+        {
+            const VkExtent2D extent = (i > 0 && !renderPassAttachments.empty()) ? getImageExtent(m_resources[*renderPassAttachments.begin()]) : m_renderExtent;
+            for (const VulkanRenderGraphPass::Access &access : pass.m_accesses)
+            {
+                const uint32_t resourceIndex = getResourceIndex(access.m_resource);
+                const auto it = renderPassResources.find(resourceIndex);
+                const bool isAttachment = access.m_attachmentType != VulkanRenderGraphPass::AttachmentType::NONE;
+                std::string reason;
+                if (access.m_attachmentType == VulkanRenderGraphPass::AttachmentType::INPUT && renderPassAttachments.count(resourceIndex) == 0)
+                {
+                    reason = access.m_resource + " is not an attachment of the pass before it";
+                }
+                else if (it != renderPassResources.end() && (!isAttachment || !it->second))
+                {
+                    reason = "both use " + access.m_resource + " outside of attachments";
+                }
+                else if (isAttachment && (getImageExtent(m_resources[resourceIndex]).width != extent.width ||
+                                          getImageExtent(m_resources[resourceIndex]).height != extent.height))
+                {
+                    reason = "the extent of " + access.m_resource + " differs from the attachments of the pass before it";
+                }
+                if (!reason.empty())
+                {
+                    throw std::runtime_error("Render graph: pass " + pass.m_name + " reads input attachments but cannot be merged into the render pass before it: " + reason);
+                }
+            }
+
+            CompiledPass &leader = m_compiledPasses[m_compiledPasses[i - 1].m_leader];
+            compiledPass.m_leader = m_compiledPasses[i - 1].m_leader;
+            compiledPass.m_subpass = leader.m_subpassCount++;
+            m_stats.m_mergedPassCount++;
+        }
+
+        for (const VulkanRenderGraphPass::Access &access : pass.m_accesses)
+        {
+            const uint32_t resourceIndex = getResourceIndex(access.m_resource);
+            const bool isAttachment = access.m_attachmentType != VulkanRenderGraphPass::AttachmentType::NONE;
+            const auto it = renderPassResources.emplace(resourceIndex, isAttachment).first;
+            it->second = it->second && isAttachment;
+            if (isAttachment && access.m_attachmentType != VulkanRenderGraphPass::AttachmentType::INPUT)
+            {
+                renderPassAttachments.insert(resourceIndex);
+            }
+        }
+    }
+}
+
+// Resources used by passes of the same render pass are attachments of its framebuffer at the same time, whichever subpasses use them
+bool VulkanRenderGraph::livesTogether(const Resource &a, const Resource &b) const
+{
+    const auto firstPass = [this](const Resource &resource) { return m_compiledPasses[resource.m_firstPass].m_leader; };
+    const auto lastPass = [this](const Resource &resource)
+    {
+        const uint32_t leader = m_compiledPasses[resource.m_lastPass].m_leader;
+        return leader + m_compiledPasses[leader].m_subpassCount - 1;
+    };
+    return firstPass(a) <= lastPass(b) && firstPass(b) <= lastPass(a);
+}
+
+void VulkanRenderGraph::createTransientResources()
+{
+    m_stats.m_transientImageCount = 0;
+    m_stats.m_transientBufferCount = 0;
+    m_stats.m_transientBytes = 0;
+    m_stats.m_aliasedBytes = 0;
+    m_stats.m_lazyImageCount = 0;
+    m_stats.m_lazyBytes = 0;
+
+    std::vector<uint32_t> transientResources;
+    for (uint32_t i = 0; i < m_resources.size(); i++)
+    {
+        Resource &resource = m_resources[i];
+        resource.m_isPlaced = false;
+        if (resource.m_isImported || resource.m_firstPass < 0)
+        {
+            continue; // Resources no kept pass uses are not created
+        }
+
+        if (resource.m_isImage)
+        {
+            // Never loaded nor stored: its contents only ever live in tile memory on tilers
+            constexpr VkImageUsageFlags ATTACHMENT_USAGE =
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+            const bool isInOneRenderPass = m_compiledPasses[resource.m_firstPass].m_leader == m_compiledPasses[resource.m_lastPass].m_leader;
+            resource.m_isLazy = isInOneRenderPass && (resource.m_imageUsage & ~ATTACHMENT_USAGE) == 0;
+
+            const VkExtent2D extent = getImageExtent(resource);
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = resource.m_description.m_format;
+            imageInfo.extent = {extent.width, extent.height, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = resource.m_description.m_samples;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = resource.m_imageUsage | (resource.m_isLazy ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : 0);
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            VkResult result = vkCreateImage(m_device, &imageInfo, nullptr, &resource.m_image);
+            if (result != VK_SUCCESS)
+            {
+                throw std::runtime_error(std::string("Failed to create render graph image! VkResult: ") + string_VkResult(result));
+            }
+            vkGetImageMemoryRequirements(m_device, resource.m_image, &resource.m_memoryRequirements);
+            m_stats.m_transientImageCount++;
+            m_stats.m_lazyImageCount += resource.m_isLazy ? 1 : 0;
+        }
+        else
+        {
+            VkBufferCreateInfo bufferInfo{};
+            bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            bufferInfo.size = resource.m_bufferSize;
+            bufferInfo.usage = resource.m_bufferUsage;
+            bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            VkResult result = vkCreateBuffer(m_device, &bufferInfo, nullptr, &resource.m_buffer);
+            if (result != VK_SUCCESS)
+            {
+                throw std::runtime_error(std::string("Failed to create render graph buffer! VkResult: ") + string_VkResult(result));
+            }
+            vkGetBufferMemoryRequirements(m_device, resource.m_buffer, &resource.m_memoryRequirements);
+            m_stats.m_transientBufferCount++;
+        }
+        m_stats.m_transientBytes += resource.m_memoryRequirements.size;
+        transientResources.push_back(i);
+    }
+
+    // Largest first: the small resources then fill the gaps left between the large ones
+    std::stable_sort(transientResources.begin(), transientResources.end(), [this](const uint32_t a, const uint32_t b)
+                     { return m_resources[a].m_memoryRequirements.size > m_resources[b].m_memoryRequirements.size; });
+    for (const uint32_t resourceIndex : transientResources)
+    {
+        placeInMemory(resourceIndex);
+    }
+
+    for (MemoryGroup &group : m_memoryGroups)
+    {
+        const VkMemoryRequirements requirements{group.m_size, group.m_alignment, group.m_memoryTypeBits};
+        const VkMemoryPropertyFlags preferred = group.m_isLazy ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0;
+        group.m_allocation = m_memoryAllocator->allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, preferred,
+                                                         group.m_isImage ? VulkanAllocationType::OPTIMAL : VulkanAllocationType::LINEAR);
+        if (m_memoryAllocator->isLazilyAllocated(group.m_allocation))
+        {
+            m_stats.m_lazyBytes += group.m_size;
+        }
+        else
+        {
+            m_stats.m_aliasedBytes += group.m_size;
+        }
+    }
+
+    for (const uint32_t resourceIndex : transientResources)
+    {
+        Resource &resource = m_resources[resourceIndex];
+        const VulkanAllocation &allocation = m_memoryGroups[resource.m_memoryGroup].m_allocation;
+        const VkDeviceSize offset = allocation.m_offset + resource.m_memoryOffset;
+        if (!resource.m_isImage)
+        {
+            VkResult result = vkBindBufferMemory(m_device, resource.m_buffer, allocation.m_memory, offset);
+            if (result != VK_SUCCESS)
+            {
+                throw std::runtime_error(std::string("Failed to bind render graph buffer memory! VkResult: ") + string_VkResult(result));
+            }
+            continue;
+        }
+
+        VkResult result = vkBindImageMemory(m_device, resource.m_image, allocation.m_memory, offset);
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Failed to bind render graph image memory! VkResult: ") + string_VkResult(result));
+        }
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = resource.m_image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = resource.m_description.m_format;
+        viewInfo.subresourceRange.aspectMask = getAspectMask(resource.m_description.m_format);
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        result = vkCreateImageView(m_device, &viewInfo, nullptr, &resource.m_imageView);
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Failed to create render graph image view! VkResult: ") + string_VkResult(result));
+        }
+    }
+}
+
+// Places the resource at the lowest offset of a compatible memory group where it overlaps no resource alive at the same
+// time. Images and buffers get separate groups, so linear and optimal resources never share a page (bufferImageGranularity),
+// and lazy images get their own, allocated from lazily allocated memory
+void VulkanRenderGraph::placeInMemory(const uint32_t resourceIndex)
+{
+    Resource &resource = m_resources[resourceIndex];
+    const VkMemoryRequirements &requirements = resource.m_memoryRequirements;
+
+    uint32_t groupIndex = 0;
+    while (groupIndex < m_memoryGroups.size() &&
+           (m_memoryGroups[groupIndex].m_isImage != resource.m_isImage || m_memoryGroups[groupIndex].m_isLazy != resource.m_isLazy ||
+            (m_memoryGroups[groupIndex].m_memoryTypeBits & requirements.memoryTypeBits) == 0))
+    {
+        groupIndex++;
+    }
+    if (groupIndex == m_memoryGroups.size())
+    {
+        MemoryGroup group{};
+        group.m_isImage = resource.m_isImage;
+        group.m_isLazy = resource.m_isLazy;
+        group.m_memoryTypeBits = requirements.memoryTypeBits;
+        m_memoryGroups.push_back(group);
+    }
+    MemoryGroup &group = m_memoryGroups[groupIndex];
+
+    // Memory ranges of the resources of the group whose lifetimes overlap this one, by offset
+    std::vector<std::pair<VkDeviceSize, VkDeviceSize>> occupiedRanges;
+    for (const Resource &other : m_resources)
+    {
+        const bool isPlaced = other.m_isPlaced && other.m_memoryGroup == groupIndex;
+        if (isPlaced && livesTogether(other, resource))
+        {
+            occupiedRanges.emplace_back(other.m_memoryOffset, other.m_memoryOffset + other.m_memoryRequirements.size);
+        }
+    }
+    std::sort(occupiedRanges.begin(), occupiedRanges.end());
+
+    VkDeviceSize offset = 0;
+    for (const auto &[start, end] : occupiedRanges)
+    {
+        if (alignUp(offset, requirements.alignment) + requirements.size <= start)
+        {
+            break;
+        }
+        offset = std::max(offset, end);
+    }
+    offset = alignUp(offset, requirements.alignment);
+
+    resource.m_isPlaced = true;
+    resource.m_memoryGroup = groupIndex;
+    resource.m_memoryOffset = offset;
+    group.m_memoryTypeBits &= requirements.memoryTypeBits;
+    group.m_alignment = std::max(group.m_alignment, requirements.alignment);
+    group.m_size = std::max(group.m_size, offset + requirements.size);
+}
+
+void VulkanRenderGraph::computeBarriers()
+{
+    // First run: the state each transient resource is left in at the end of the frame
+    std::vector<ResourceState> states(m_resources.size());
+    simulateAccesses(states, false);
+    for (size_t i = 0; i < m_resources.size(); i++)
+    {
+        m_resources[i].m_finalState = states[i];
+    }
+
+    // The frame starts from the imported states. A transient resource starts undefined, after the last accesses to its
+    // memory: those of the resources aliased with it earlier in the frame, and of itself and the resources aliased with it
+    // in the previous frame
+    for (size_t i = 0; i < m_resources.size(); i++)
+    {
+        const Resource &resource = m_resources[i];
+        states[i] = ResourceState{};
+        if (resource.m_isImported)
+        {
+            states[i].m_layout = resource.m_import.m_initialLayout;
+            states[i].m_writeStageMask = resource.m_import.m_initialStageMask;
+            states[i].m_writeAccessMask = resource.m_import.m_initialAccessMask;
+            continue;
+        }
+        if (resource.m_firstPass < 0)
+        {
+            continue;
+        }
+
+        for (const Resource &other : m_resources)
+        {
+            const bool sharesMemory = other.m_isPlaced && other.m_memoryGroup == resource.m_memoryGroup &&
+                                      other.m_memoryOffset < resource.m_memoryOffset + resource.m_memoryRequirements.size &&
+                                      resource.m_memoryOffset < other.m_memoryOffset + other.m_memoryRequirements.size;
+            if (sharesMemory)
+            {
+                states[i].m_writeStageMask |= other.m_finalState.m_writeStageMask | other.m_finalState.m_readStageMask;
+                states[i].m_writeAccessMask |= other.m_finalState.m_writeAccessMask;
+            }
+        }
+    }
+
+    // Second run: the barriers
+    simulateAccesses(states, true);
+
+    m_finalBarriers = BarrierBatch{};
+    for (size_t i = 0; i < m_resources.size(); i++)
+    {
+        const Resource &resource = m_resources[i];
+        const ResourceState &state = states[i];
+        if (!resource.m_isImported || !resource.m_isImage || resource.m_import.m_finalLayout == VK_IMAGE_LAYOUT_UNDEFINED ||
+            resource.m_import.m_finalLayout == state.m_layout)
+        {
+            continue;
+        }
+
+        ImageBarrier imageBarrier{};
+        imageBarrier.m_resource = static_cast<uint32_t>(i);
+        imageBarrier.m_oldLayout = state.m_layout;
+        imageBarrier.m_newLayout = resource.m_import.m_finalLayout;
+        imageBarrier.m_srcAccessMask = state.m_writeAccessMask;
+        imageBarrier.m_dstAccessMask = resource.m_import.m_finalAccessMask;
+        m_finalBarriers.m_isNeeded = true;
+        m_finalBarriers.m_srcStageMask |= state.m_writeStageMask | state.m_readStageMask;
+        m_finalBarriers.m_dstStageMask |= resource.m_import.m_finalStageMask;
+        m_finalBarriers.m_imageBarriers.push_back(imageBarrier);
+    }
+
+    m_stats.m_barrierBatchCount = 0;
+    m_stats.m_imageBarrierCount = 0;
+    m_stats.m_layoutTransitionCount = 0;
+    m_stats.m_memoryBarrierCount = 0;
+    std::vector<const BarrierBatch *> batches = {&m_finalBarriers};
+    for (const CompiledPass &compiledPass : m_compiledPasses)
+    {
+        batches.push_back(&compiledPass.m_barriers);
+    }
+    for (const BarrierBatch *batch : batches)
+    {
+        m_stats.m_barrierBatchCount += batch->m_isNeeded ? 1 : 0;
+        m_stats.m_imageBarrierCount += static_cast<uint32_t>(batch->m_imageBarriers.size());
+        m_stats.m_memoryBarrierCount += batch->m_hasMemoryBarrier ? 1 : 0;
+        for (const ImageBarrier &imageBarrier : batch->m_imageBarriers)
+        {
+            m_stats.m_layoutTransitionCount += (imageBarrier.m_oldLayout != imageBarrier.m_newLayout) ? 1 : 0;
+        }
+    }
+}
+
+// Replays the accesses of the kept passes from states. Each access waits only for what it conflicts with:
+// - a write (or a layout transition) waits for the previous write and every read since,
+// - a read waits for the previous write, unless an earlier barrier already made it visible to this stage and access,
+// - reads in the same layout never wait for each other.
+// The barriers of the passes of a render pass are all recorded before it begins. Accesses to a resource an earlier subpass
+// used are ordered by the subpass dependencies instead, which also transition the layout
+void VulkanRenderGraph::simulateAccesses(std::vector<ResourceState> &states, const bool recordBarriers)
+{
+    std::vector<BarrierBatch> batches(m_compiledPasses.size());
+    std::set<uint32_t> renderPassResources; // Used by the earlier subpasses of the current render pass
+    for (CompiledPass &compiledPass : m_compiledPasses)
+    {
+        if (compiledPass.m_subpass == 0)
+        {
+            renderPassResources.clear();
+        }
+        BarrierBatch &batch = batches[compiledPass.m_leader];
+        for (const VulkanRenderGraphPass::Access &access : m_passes[compiledPass.m_pass]->m_accesses)
+        {
+            const uint32_t resourceIndex = getResourceIndex(access.m_resource);
+            const bool isOrderedBySubpass = !renderPassResources.insert(resourceIndex).second;
+            const bool isImage = m_resources[resourceIndex].m_isImage;
+            ResourceState &state = states[resourceIndex];
+
+            const bool needsTransition = isImage && state.m_layout != access.m_layout;
+            const bool needsVisibility = state.m_writeStageMask != 0 && ((access.m_stageMask & ~state.m_visibleStageMask) != 0 ||
+                                                                         (access.m_accessMask & ~state.m_visibleAccessMask) != 0);
+            VkPipelineStageFlags srcStageMask = 0;
+            bool needsBarrier = false;
+            if (access.m_isWrite || needsTransition)
+            {
+                srcStageMask = state.m_writeStageMask | state.m_readStageMask;
+                needsBarrier = needsTransition || srcStageMask != 0;
+            }
+            else if (needsVisibility)
+            {
+                srcStageMask = state.m_writeStageMask;
+                needsBarrier = true;
+            }
+
+            if (needsBarrier && !isOrderedBySubpass)
+            {
+                batch.m_isNeeded = true;
+                batch.m_srcStageMask |= (srcStageMask != 0) ? srcStageMask : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+                batch.m_dstStageMask |= access.m_stageMask;
+                if (isImage)
+                {
+                    ImageBarrier imageBarrier{};
+                    imageBarrier.m_resource = resourceIndex;
+                    imageBarrier.m_oldLayout = state.m_layout;
+                    imageBarrier.m_newLayout = access.m_layout;
+                    imageBarrier.m_srcAccessMask = state.m_writeAccessMask;
+                    imageBarrier.m_dstAccessMask = access.m_accessMask;
+                    batch.m_imageBarriers.push_back(imageBarrier);
+                }
+                else if (state.m_writeAccessMask != 0)
+                {
+                    batch.m_hasMemoryBarrier = true;
+                    batch.m_srcAccessMask |= state.m_writeAccessMask;
+                    batch.m_dstAccessMask |= access.m_accessMask;
+                }
+            }
+
+            if (access.m_isWrite || needsTransition)
+            {
+                // A layout transition is a write: later accesses in other stages wait for it like for a write
+                state.m_layout = isImage ? access.m_layout : state.m_layout;
+                state.m_writeStageMask = access.m_stageMask;
+                state.m_writeAccessMask = access.m_accessMask & WRITE_ACCESS_MASK;
+                state.m_readStageMask = access.m_isWrite ? 0 : access.m_stageMask;
+                state.m_visibleStageMask = access.m_isWrite ? 0 : access.m_stageMask;
+                state.m_visibleAccessMask = access.m_isWrite ? 0 : access.m_accessMask;
+            }
+            else
+            {
+                state.m_readStageMask |= access.m_stageMask;
+                if (needsBarrier)
+                {
+                    state.m_visibleStageMask |= access.m_stageMask;
+                    state.m_visibleAccessMask |= access.m_accessMask;
+                }
+            }
+        }
+
+    }
+
+    if (recordBarriers)
+    {
+        for (size_t i = 0; i < m_compiledPasses.size(); i++)
+        {
+            m_compiledPasses[i].m_barriers = std::move(batches[i]);
+        }
+    }
+}
+
+// One render pass per leader with attachments, with a subpass per pass merged into it. The barriers already put each
+// attachment in the layout of its first use, the subpass dependencies move it to the layouts of the next subpasses, and it
+// is left in the layout of its last use. Contents are only stored if a later render pass accesses them or the image is imported.
+// With dynamic rendering, a leader without merged passes keeps the attachment descriptions for vkCmdBeginRendering instead
+void VulkanRenderGraph::createRenderPasses()
+{
+    m_stats.m_renderPassCount = 0;
+    m_stats.m_dynamicRenderingCount = 0;
+    for (uint32_t leaderIndex = 0; leaderIndex < m_compiledPasses.size(); leaderIndex += m_compiledPasses[leaderIndex].m_subpassCount)
+    {
+        CompiledPass &leader = m_compiledPasses[leaderIndex];
+        const int32_t lastIndex = static_cast<int32_t>(leaderIndex + leader.m_subpassCount - 1);
+
+        std::vector<VkAttachmentDescription> attachments;
+        std::vector<bool> isWritten;
+        std::map<uint32_t, uint32_t> attachmentIndices; // By resource
+        const auto useAttachment = [&](const VulkanRenderGraphPass::Access &access)
+        {
+            const uint32_t resourceIndex = getResourceIndex(access.m_resource);
+            const auto [it, isFirstUse] = attachmentIndices.emplace(resourceIndex, static_cast<uint32_t>(attachments.size()));
+            if (isFirstUse)
+            {
+                const Resource &resource = m_resources[resourceIndex];
+                const bool isDepth = isDepthFormat(resource.m_description.m_format);
+                VkAttachmentDescription description{};
+                description.format = resource.m_description.m_format;
+                description.samples = resource.m_isImported ? VK_SAMPLE_COUNT_1_BIT : resource.m_description.m_samples;
+                description.loadOp = access.m_loadOp;
+                description.stencilLoadOp = isDepth ? access.m_loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+                description.initialLayout = access.m_layout;
+                attachments.push_back(description);
+                isWritten.push_back(false);
+                leader.m_attachments.push_back(resourceIndex);
+                leader.m_clearValues.push_back(access.m_clearValue); // Resolves are not cleared: every pixel is resolved into
+            }
+            attachments[it->second].finalLayout = access.m_layout;
+            isWritten[it->second] = isWritten[it->second] || access.m_isWrite;
+            return VkAttachmentReference{it->second, access.m_layout};
+        };
+
+        std::vector<VulkanSubpass> subpasses;
+        for (int32_t compiledIndex = static_cast<int32_t>(leaderIndex); compiledIndex <= lastIndex; compiledIndex++)
+        {
+            const VulkanRenderGraphPass &pass = *m_passes[m_compiledPasses[compiledIndex].m_pass];
+            VulkanSubpass subpass{};
+            std::vector<uint32_t> colorResources;
+            const VulkanRenderGraphPass::Access *depthAccess = nullptr;
+            for (const VulkanRenderGraphPass::Access &access : pass.m_accesses)
+            {
+                if (access.m_attachmentType == VulkanRenderGraphPass::AttachmentType::COLOR)
+                {
+                    colorResources.push_back(getResourceIndex(access.m_resource));
+                    subpass.m_colorAttachments.push_back(useAttachment(access));
+                }
+                else if (access.m_attachmentType == VulkanRenderGraphPass::AttachmentType::DEPTH)
+                {
+                    if (depthAccess != nullptr)
+                    {
+                        throw std::runtime_error("Render graph: pass " + pass.m_name + " has two depth attachments");
+                    }
+                    depthAccess = &access;
+                }
+            }
+            if (depthAccess != nullptr)
+            {
+                subpass.m_depthAttachment = useAttachment(*depthAccess);
+            }
+
+            // Each resolve goes in the slot of the color attachment it resolves, the others stay unused
+            std::vector<const VulkanRenderGraphPass::Access *> resolveSlots(colorResources.size(), nullptr);
+            bool hasResolves = false;
+            for (const VulkanRenderGraphPass::Access &access : pass.m_accesses)
+            {
+                if (access.m_attachmentType != VulkanRenderGraphPass::AttachmentType::RESOLVE)
+                {
+                    continue;
+                }
+                const uint32_t sourceIndex = getResourceIndex(access.m_resolveSource);
+                const auto colorIt = std::find(colorResources.begin(), colorResources.end(), sourceIndex);
+                if (colorIt == colorResources.end())
+                {
+                    throw std::runtime_error("Render graph: pass " + pass.m_name + " resolves " + access.m_resolveSource + ", which is not one of its color attachments");
+                }
+                const size_t slot = static_cast<size_t>(colorIt - colorResources.begin());
+                const VkAttachmentDescription &source = attachments[subpass.m_colorAttachments[slot].attachment];
+                const Resource &target = m_resources[getResourceIndex(access.m_resource)];
+                const VkSampleCountFlagBits targetSamples = target.m_isImported ? VK_SAMPLE_COUNT_1_BIT : target.m_description.m_samples;
+                if (source.samples == VK_SAMPLE_COUNT_1_BIT || targetSamples != VK_SAMPLE_COUNT_1_BIT || source.format != target.m_description.m_format)
+                {
+                    throw std::runtime_error("Render graph: pass " + pass.m_name + " must resolve a multisampled image into a single-sampled one of the same format (" +
+                                             access.m_resource + ")");
+                }
+                if (resolveSlots[slot] != nullptr)
+                {
+                    throw std::runtime_error("Render graph: pass " + pass.m_name + " resolves " + access.m_resolveSource + " twice");
+                }
+                resolveSlots[slot] = &access;
+                hasResolves = true;
+            }
+            for (const VulkanRenderGraphPass::Access *resolveAccess : resolveSlots)
+            {
+                if (hasResolves)
+                {
+                    subpass.m_resolveAttachments.push_back((resolveAccess != nullptr) ? useAttachment(*resolveAccess)
+                                                                                        : VkAttachmentReference{VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED});
+                }
+            }
+
+            for (const VulkanRenderGraphPass::Access &access : pass.m_accesses)
+            {
+                if (access.m_attachmentType == VulkanRenderGraphPass::AttachmentType::INPUT)
+                {
+                    subpass.m_inputAttachments.push_back(useAttachment(access));
+                }
+            }
+            subpasses.push_back(subpass);
+        }
+
+        if (attachments.empty())
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < attachments.size(); i++)
+        {
+            // An attachment only read (a read-only depth attachment) keeps its contents: DONT_CARE could discard them
+            const Resource &resource = m_resources[leader.m_attachments[i]];
+            const bool isUsedLater = resource.m_isImported || resource.m_lastPass > lastIndex;
+            const VkAttachmentStoreOp storeOp = (isUsedLater || !isWritten[i]) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachments[i].storeOp = storeOp;
+            attachments[i].stencilStoreOp = isDepthFormat(attachments[i].format) ? storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        }
+
+        const VkExtent2D extent = getImageExtent(m_resources[leader.m_attachments.front()]);
+        for (const uint32_t resourceIndex : leader.m_attachments)
+        {
+            const VkExtent2D attachmentExtent = getImageExtent(m_resources[resourceIndex]);
+            if (attachmentExtent.width != extent.width || attachmentExtent.height != extent.height)
+            {
+                throw std::runtime_error("Render graph: the attachments of pass " + m_passes[leader.m_pass]->m_name + " differ in extent");
+            }
+        }
+
+        if (m_useDynamicRendering && leader.m_subpassCount == 1)
+        {
+            leader.m_isDynamicRendering = true;
+            leader.m_attachmentDescriptions = std::move(attachments);
+            leader.m_subpassDescription = std::move(subpasses.front());
+            m_stats.m_dynamicRenderingCount++;
+            continue;
+        }
+
+        leader.m_renderPass = VulkanRenderPass(m_device);
+        leader.m_renderPass.createRenderPass(attachments, subpasses);
+        m_stats.m_renderPassCount++;
+    }
+}
+
+void VulkanRenderGraph::setImportedImage(const std::string &name, VkImage image, VkImageView imageView)
+{
+    Resource &resource = m_resources[getResourceIndex(name)];
+    resource.m_image = image;
+    resource.m_imageView = imageView;
+}
+
+void VulkanRenderGraph::setImportedBuffer(const std::string &name, VkBuffer buffer)
+{
+    m_resources[getResourceIndex(name)].m_buffer = buffer;
+}
+
+VkFramebuffer VulkanRenderGraph::getFramebuffer(CompiledPass &compiledPass, const VkExtent2D extent)
+{
+    std::vector<VkImageView> attachmentViews;
+    for (const uint32_t resourceIndex : compiledPass.m_attachments)
+    {
+        attachmentViews.push_back(m_resources[resourceIndex].m_imageView);
+    }
+
+    auto it = compiledPass.m_framebuffers.find(attachmentViews);
+    if (it == compiledPass.m_framebuffers.end())
+    {
+        VulkanFramebuffer framebuffer(m_device, compiledPass.m_renderPass.getRenderPass(), attachmentViews, extent);
+        it = compiledPass.m_framebuffers.emplace(attachmentViews, std::move(framebuffer)).first;
+    }
+    return it->second.getFramebuffer();
+}
+
+// The attachments of a pass using dynamic rendering are bound here, with this frame's image views: there is no framebuffer
+void VulkanRenderGraph::beginRendering(VkCommandBuffer commandBuffer, const CompiledPass &compiledPass, const VkExtent2D extent) const
+{
+    const auto getAttachmentInfo = [this, &compiledPass](const VkAttachmentReference &reference)
+    {
+        const VkAttachmentDescription &description = compiledPass.m_attachmentDescriptions[reference.attachment];
+        VkRenderingAttachmentInfoKHR attachmentInfo{};
+        attachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        attachmentInfo.imageView = m_resources[compiledPass.m_attachments[reference.attachment]].m_imageView;
+        attachmentInfo.imageLayout = reference.layout;
+        attachmentInfo.resolveMode = VK_RESOLVE_MODE_NONE;
+        attachmentInfo.loadOp = description.loadOp;
+        attachmentInfo.storeOp = description.storeOp;
+        attachmentInfo.clearValue = compiledPass.m_clearValues[reference.attachment];
+        return attachmentInfo;
+    };
+
+    const VulkanSubpass &subpass = compiledPass.m_subpassDescription;
+    std::vector<VkRenderingAttachmentInfoKHR> colorAttachments;
+    colorAttachments.reserve(subpass.m_colorAttachments.size());
+    for (size_t i = 0; i < subpass.m_colorAttachments.size(); i++)
+    {
+        VkRenderingAttachmentInfoKHR attachmentInfo = getAttachmentInfo(subpass.m_colorAttachments[i]);
+        if (!subpass.m_resolveAttachments.empty() && subpass.m_resolveAttachments[i].attachment != VK_ATTACHMENT_UNUSED)
+        {
+            // Resolved at the end of the rendering, as a subpass resolve attachment would be (the average of the samples)
+            const VkAttachmentReference &resolve = subpass.m_resolveAttachments[i];
+            attachmentInfo.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+            attachmentInfo.resolveImageView = m_resources[compiledPass.m_attachments[resolve.attachment]].m_imageView;
+            attachmentInfo.resolveImageLayout = resolve.layout;
+        }
+        colorAttachments.push_back(attachmentInfo);
+    }
+
+    VkRenderingInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = extent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
+    renderingInfo.pColorAttachments = colorAttachments.data();
+
+    // Depth and stencil are separate attachments, of the same image view if the format has both
+    VkRenderingAttachmentInfoKHR depthAttachment{};
+    VkRenderingAttachmentInfoKHR stencilAttachment{};
+    if (subpass.m_depthAttachment.attachment != VK_ATTACHMENT_UNUSED)
+    {
+        depthAttachment = getAttachmentInfo(subpass.m_depthAttachment);
+        renderingInfo.pDepthAttachment = &depthAttachment;
+
+        const VkAttachmentDescription &description = compiledPass.m_attachmentDescriptions[subpass.m_depthAttachment.attachment];
+        if (getAspectMask(description.format) & VK_IMAGE_ASPECT_STENCIL_BIT)
+        {
+            stencilAttachment = depthAttachment;
+            stencilAttachment.loadOp = description.stencilLoadOp;
+            stencilAttachment.storeOp = description.stencilStoreOp;
+            renderingInfo.pStencilAttachment = &stencilAttachment;
+        }
+    }
+
+    m_cmdBeginRendering(commandBuffer, &renderingInfo);
+}
+
+void VulkanRenderGraph::execute(VkCommandBuffer commandBuffer)
+{
+    for (const Resource &resource : m_resources)
+    {
+        const bool isSet = resource.m_isImage ? resource.m_image != VK_NULL_HANDLE : resource.m_buffer != VK_NULL_HANDLE;
+        if (resource.m_isImported && resource.m_firstPass >= 0 && !isSet)
+        {
+            throw std::runtime_error("Render graph: imported resource " + resource.m_name + " was not set");
+        }
+    }
+
+    for (CompiledPass &compiledPass : m_compiledPasses)
+    {
+        CompiledPass &leader = m_compiledPasses[compiledPass.m_leader];
+        const VulkanRenderGraphPass &pass = *m_passes[compiledPass.m_pass];
+        VulkanRenderGraphPassContext context{};
+        context.m_graph = this;
+        context.m_renderPass = leader.m_renderPass.getRenderPass();
+        context.m_subpass = compiledPass.m_subpass;
+        context.m_extent = leader.m_attachments.empty() ? m_renderExtent : getImageExtent(m_resources[leader.m_attachments.front()]);
+
+        if (compiledPass.m_subpass > 0)
+        {
+            vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+        }
+        else
+        {
+            recordBarriers(commandBuffer, compiledPass.m_barriers);
+            if (compiledPass.m_isDynamicRendering)
+            {
+                beginRendering(commandBuffer, compiledPass, context.m_extent);
+            }
+            else if (context.m_renderPass != VK_NULL_HANDLE)
+            {
+                VkRenderPassBeginInfo renderPassInfo{};
+                renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+                renderPassInfo.renderPass = context.m_renderPass;
+                renderPassInfo.framebuffer = getFramebuffer(compiledPass, context.m_extent);
+                renderPassInfo.renderArea.offset = {0, 0};
+                renderPassInfo.renderArea.extent = context.m_extent;
+                renderPassInfo.clearValueCount = static_cast<uint32_t>(compiledPass.m_clearValues.size());
+                renderPassInfo.pClearValues = compiledPass.m_clearValues.data();
+                vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+            }
+        }
+
+        if (pass.m_record)
+        {
+            pass.m_record(commandBuffer, context);
+        }
+
+        if (leader.m_isDynamicRendering)
+        {
+            m_cmdEndRendering(commandBuffer);
+        }
+        else if (context.m_renderPass != VK_NULL_HANDLE && compiledPass.m_subpass + 1 == leader.m_subpassCount)
+        {
+            vkCmdEndRenderPass(commandBuffer);
+        }
+    }
+
+    recordBarriers(commandBuffer, m_finalBarriers);
+}
+
+void VulkanRenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch &barriers) const
+{
+    if (!barriers.m_isNeeded)
+    {
+        return;
+    }
+
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    imageBarriers.reserve(barriers.m_imageBarriers.size());
+    for (const ImageBarrier &imageBarrier : barriers.m_imageBarriers)
+    {
+        const Resource &resource = m_resources[imageBarrier.m_resource];
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = imageBarrier.m_srcAccessMask;
+        barrier.dstAccessMask = imageBarrier.m_dstAccessMask;
+        barrier.oldLayout = imageBarrier.m_oldLayout;
+        barrier.newLayout = imageBarrier.m_newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = resource.m_image;
+        barrier.subresourceRange.aspectMask = getAspectMask(resource.m_description.m_format);
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+        imageBarriers.push_back(barrier);
+    }
+
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = barriers.m_srcAccessMask;
+    memoryBarrier.dstAccessMask = barriers.m_dstAccessMask;
+
+    vkCmdPipelineBarrier(commandBuffer, barriers.m_srcStageMask, barriers.m_dstStageMask, 0, barriers.m_hasMemoryBarrier ? 1 : 0, &memoryBarrier, 0,
+                         nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
+
+VulkanRenderGraphRetired VulkanRenderGraph::retireResources()
+{
+    VulkanRenderGraphRetired retired;
+    for (CompiledPass &compiledPass : m_compiledPasses)
+    {
+        for (auto &[attachmentViews, framebuffer] : compiledPass.m_framebuffers)
+        {
+            retired.m_framebuffers.push_back(framebuffer.getFramebuffer());
+        }
+        compiledPass.m_framebuffers.clear(); // Destroyed with the retired objects: VulkanFramebuffer leaves it on destruction
+    }
+
+    for (Resource &resource : m_resources)
+    {
+        if (resource.m_isImported)
+        {
+            continue;
+        }
+        if (resource.m_imageView != VK_NULL_HANDLE)
+        {
+            retired.m_imageViews.push_back(resource.m_imageView);
+        }
+        if (resource.m_image != VK_NULL_HANDLE)
+        {
+            retired.m_images.push_back(resource.m_image);
+        }
+        if (resource.m_buffer != VK_NULL_HANDLE)
+        {
+            retired.m_buffers.push_back(resource.m_buffer);
+        }
+        resource.m_image = VK_NULL_HANDLE;
+        resource.m_imageView = VK_NULL_HANDLE;
+        resource.m_buffer = VK_NULL_HANDLE;
+    }
+
+    for (MemoryGroup &group : m_memoryGroups)
+    {
+        retired.m_allocations.push_back(group.m_allocation);
+    }
+    m_memoryGroups.clear();
+    return retired;
+}
+
+VulkanRenderGraphRetired VulkanRenderGraph::resize(const VkExtent2D renderExtent)
+{
+    VulkanRenderGraphRetired retired = retireResources();
+    m_renderExtent = renderExtent;
+    createTransientResources();
+    computeBarriers();
+    return retired;
+}
+
+void VulkanRenderGraph::destroyRetired(const VulkanRenderGraphRetired &retired)
+{
+    for (VkFramebuffer framebuffer : retired.m_framebuffers)
+    {
+        VulkanFramebuffer::destroyRetired(m_device, framebuffer);
+    }
+    for (VkImageView imageView : retired.m_imageViews)
+    {
+        vkDestroyImageView(m_device, imageView, nullptr);
+    }
+    for (VkImage image : retired.m_images)
+    {
+        vkDestroyImage(m_device, image, nullptr);
+    }
+    for (VkBuffer buffer : retired.m_buffers)
+    {
+        vkDestroyBuffer(m_device, buffer, nullptr);
+    }
+    for (VulkanAllocation allocation : retired.m_allocations)
+    {
+        m_memoryAllocator->free(allocation);
+    }
+}
+
+const VulkanRenderGraph::CompiledPass *VulkanRenderGraph::findCompiledPass(const std::string &passName) const
+{
+    for (const CompiledPass &compiledPass : m_compiledPasses)
+    {
+        if (m_passes[compiledPass.m_pass]->m_name == passName)
+        {
+            return &compiledPass;
+        }
+    }
+    return nullptr;
+}
+
+VulkanPipelineTarget VulkanRenderGraph::getPipelineTarget(const std::string &passName) const
+{
+    const CompiledPass *compiledPass = findCompiledPass(passName);
+    if (compiledPass == nullptr)
+    {
+        throw std::runtime_error("Render graph: pass " + passName + " does not exist or was culled");
+    }
+    const CompiledPass &leader = m_compiledPasses[compiledPass->m_leader];
+
+    VulkanPipelineTarget target{};
+    if (!leader.m_isDynamicRendering)
+    {
+        target.m_renderPass = leader.m_renderPass.getRenderPass();
+        target.m_subpass = compiledPass->m_subpass;
+        return target;
+    }
+
+    const VulkanSubpass &subpass = leader.m_subpassDescription;
+    for (const VkAttachmentReference &reference : subpass.m_colorAttachments)
+    {
+        target.m_colorFormats.push_back(leader.m_attachmentDescriptions[reference.attachment].format);
+    }
+    if (subpass.m_depthAttachment.attachment != VK_ATTACHMENT_UNUSED)
+    {
+        const VkFormat format = leader.m_attachmentDescriptions[subpass.m_depthAttachment.attachment].format;
+        target.m_depthFormat = format;
+        target.m_stencilFormat = (getAspectMask(format) & VK_IMAGE_ASPECT_STENCIL_BIT) ? format : VK_FORMAT_UNDEFINED;
+    }
+    return target;
+}
+
+bool VulkanRenderGraph::isCulled(const std::string &passName) const
+{
+    return findCompiledPass(passName) == nullptr;
+}
+
+VkImage VulkanRenderGraph::getImage(const std::string &name) const
+{
+    return m_resources[getResourceIndex(name)].m_image;
+}
+
+VkImageView VulkanRenderGraph::getImageView(const std::string &name) const
+{
+    return m_resources[getResourceIndex(name)].m_imageView;
+}
+
+VkBuffer VulkanRenderGraph::getBuffer(const std::string &name) const
+{
+    return m_resources[getResourceIndex(name)].m_buffer;
+}
@@ -2,8 +2,27 @@
 
 #include <vulkan/vk_enum_string_helper.h>
 
+#include <map>
+#include <string>
+#include <utility>
 #include <vector>
 
+namespace
+{
+    constexpr VkAccessFlags WRITE_ACCESS_MASK = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    constexpr VkPipelineStageFlags DEPTH_TEST_STAGES = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+    // How one subpass accesses one attachment
+    struct AttachmentUse
+    {
+        uint32_t m_subpass = 0;
+        VkPipelineStageFlags m_stageMask = 0;
+        VkAccessFlags m_accessMask = 0;
+        VkImageLayout m_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+}
+
 VulkanRenderPass::VulkanRenderPass(const VkDevice &device)
     : m_device(device), m_renderPass(VK_NULL_HANDLE) {}
 
@@ -11,22 +30,44 @@ VulkanRenderPass::~VulkanRenderPass()
 {
 }
 
-void VulkanRenderPass::createRenderPass(VkFormat colorFormat, VkFormat depthFormat, VkSampleCountFlagBits samples)
+void VulkanRenderPass::createRenderPass(VkFormat colorFormat, VkFormat depthFormat, VkSampleCountFlagBits samples, VkImageLayout colorFinalLayout,
+                                        const VulkanAttachmentPolicy &colorPolicy, const VulkanAttachmentPolicy &depthPolicy)
 {
+    const bool isMultisampled = (samples != VK_SAMPLE_COUNT_1_BIT);
+    if (isMultisampled && colorPolicy.m_loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+    {
+        throw std::runtime_error("Failed to create render pass! A multisampled color attachment is never stored, it can't be loaded");
+    }
+
     std::vector<VkAttachmentDescription> attachments;
 
-    // Create color attachment
-    VkAttachmentDescription colorAttachment = createColorAttachment(colorFormat, samples);
+    // Create color attachment. A multisampled one only lives until it is resolved, at the end of the subpass
+    VulkanAttachmentPolicy samplesPolicy = colorPolicy;
+    if (isMultisampled)
+    {
+        samplesPolicy.m_storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    }
+    VkAttachmentDescription colorAttachment = createColorAttachment(colorFormat, samples, isMultisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : colorFinalLayout, samplesPolicy);
     attachments.push_back(colorAttachment);
 
     // Create depth attachment if depthFormat is provided
     bool hasDepthAttachment = (depthFormat != VK_FORMAT_UNDEFINED);
     if (hasDepthAttachment)
     {
-        VkAttachmentDescription depthAttachment = createDepthAttachment(depthFormat, samples);
+        VkAttachmentDescription depthAttachment = createDepthAttachment(depthFormat, samples, depthPolicy);
         attachments.push_back(depthAttachment);
     }
 
+    // Create resolve attachment: the single-sampled image the samples are averaged into, the one stored
+    VkAttachmentReference resolveAttachmentRef{};
+    if (isMultisampled)
+    {
+        const VulkanAttachmentPolicy resolvePolicy{VK_ATTACHMENT_LOAD_OP_DONT_CARE, colorPolicy.m_storeOp}; // Every pixel is overwritten
+        resolveAttachmentRef.attachment = static_cast<uint32_t>(attachments.size());
+        resolveAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachments.push_back(createColorAttachment(colorFormat, VK_SAMPLE_COUNT_1_BIT, colorFinalLayout, resolvePolicy));
+    }
+
     // Subpass
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -43,11 +84,45 @@ void VulkanRenderPass::createRenderPass(VkFormat colorFormat, VkFormat depthForm
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
+    if (isMultisampled)
+    {
+        subpass.pResolveAttachments = &resolveAttachmentRef;
+    }
     if (hasDepthAttachment)
     {
         subpass.pDepthStencilAttachment = &depthAttachmentRef;
     }
 
+    // Subpass dependency
+    // The image layout transition at the start of the render pass must wait until the swap chain image has been acquired.
+    // The image-available semaphore is waited on at the COLOR_ATTACHMENT_OUTPUT stage, so the subpass waits on that same stage.
+    VkSubpassDependency dependency{};
+    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass = 0;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.srcAccessMask = 0;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    if (colorPolicy.m_loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+    {
+        dependency.dstAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+    }
+    if (colorFinalLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+    {
+        // Offscreen targets are reused without a semaphore: the previous copy out of the image must finish before it is overwritten
+        dependency.srcStageMask |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
+    if (hasDepthAttachment)
+    {
+        dependency.srcStageMask |= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependency.dstStageMask |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependency.dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        if (depthPolicy.m_loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+        {
+            dependency.dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+        }
+    }
+
     // Render pass info
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -55,6 +130,216 @@ void VulkanRenderPass::createRenderPass(VkFormat colorFormat, VkFormat depthForm
     renderPassInfo.pAttachments = attachments.data();
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 1;
+    renderPassInfo.pDependencies = &dependency;
+
+    VkResult result = vkCreateRenderPass(m_device, &renderPassInfo, nullptr, &m_renderPass);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create render pass! VkResult: ") + string_VkResult(result));
+    }
+}
+
+void VulkanRenderPass::createRenderPass(const std::vector<VulkanRenderPassAttachment> &colorAttachments, const VulkanRenderPassAttachment *depthAttachment,
+                                        const std::vector<VulkanRenderPassAttachment> &resolveAttachments)
+{
+    if (!resolveAttachments.empty() && resolveAttachments.size() != colorAttachments.size())
+    {
+        throw std::runtime_error("Failed to create render pass! There must be as many resolve attachments as color attachments");
+    }
+
+    std::vector<VkAttachmentDescription> attachments;
+    VulkanSubpass subpass{};
+    for (const VulkanRenderPassAttachment &colorAttachment : colorAttachments)
+    {
+        VkAttachmentDescription description{};
+        description.format = colorAttachment.m_format;
+        description.samples = colorAttachment.m_samples;
+        description.loadOp = colorAttachment.m_loadOp;
+        description.storeOp = colorAttachment.m_storeOp;
+        description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        description.initialLayout = colorAttachment.m_layout;
+        description.finalLayout = colorAttachment.m_layout;
+
+        subpass.m_colorAttachments.push_back(VkAttachmentReference{static_cast<uint32_t>(attachments.size()), colorAttachment.m_layout});
+        attachments.push_back(description);
+    }
+
+    if (depthAttachment != nullptr)
+    {
+        VkAttachmentDescription description{};
+        description.format = depthAttachment->m_format;
+        description.samples = depthAttachment->m_samples;
+        description.loadOp = depthAttachment->m_loadOp;
+        description.storeOp = depthAttachment->m_storeOp;
+        description.stencilLoadOp = depthAttachment->m_loadOp;
+        description.stencilStoreOp = depthAttachment->m_storeOp;
+        description.initialLayout = depthAttachment->m_layout;
+        description.finalLayout = depthAttachment->m_layout;
+
+        subpass.m_depthAttachment = VkAttachmentReference{static_cast<uint32_t>(attachments.size()), depthAttachment->m_layout};
+        attachments.push_back(description);
+    }
+
+    for (const VulkanRenderPassAttachment &resolveAttachment : resolveAttachments)
+    {
+        if (resolveAttachment.m_format == VK_FORMAT_UNDEFINED)
+        {
+            subpass.m_resolveAttachments.push_back(VkAttachmentReference{VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED});
+            continue;
+        }
+
+        VkAttachmentDescription description{};
+        description.format = resolveAttachment.m_format;
+        description.samples = resolveAttachment.m_samples;
+        description.loadOp = resolveAttachment.m_loadOp;
+        description.storeOp = resolveAttachment.m_storeOp;
+        description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        description.initialLayout = resolveAttachment.m_layout;
+        description.finalLayout = resolveAttachment.m_layout;
+
+        subpass.m_resolveAttachments.push_back(VkAttachmentReference{static_cast<uint32_t>(attachments.size()), resolveAttachment.m_layout});
+        attachments.push_back(description);
+    }
+
+    createRenderPass(attachments, {subpass});
+}
+
+void VulkanRenderPass::createRenderPass(const std::vector<VkAttachmentDescription> &attachments, const std::vector<VulkanSubpass> &subpasses)
+{
+    // The accesses of each subpass to each attachment, in subpass order
+    std::vector<std::vector<AttachmentUse>> attachmentUses(attachments.size());
+    for (uint32_t subpassIndex = 0; subpassIndex < subpasses.size(); subpassIndex++)
+    {
+        const VulkanSubpass &subpass = subpasses[subpassIndex];
+        if (!subpass.m_resolveAttachments.empty() && subpass.m_resolveAttachments.size() != subpass.m_colorAttachments.size())
+        {
+            throw std::runtime_error("Failed to create render pass! Subpass " + std::to_string(subpassIndex) +
+                                     " must have as many resolve attachments as color attachments");
+        }
+
+        const auto addUse = [&](const VkAttachmentReference &reference, const VkPipelineStageFlags stageMask, const VkAccessFlags accessMask)
+        {
+            if (reference.attachment == VK_ATTACHMENT_UNUSED)
+            {
+                return;
+            }
+            if (reference.attachment >= attachments.size())
+            {
+                throw std::runtime_error("Failed to create render pass! Subpass " + std::to_string(subpassIndex) + " references attachment " +
+                                         std::to_string(reference.attachment) + ", which does not exist");
+            }
+            std::vector<AttachmentUse> &uses = attachmentUses[reference.attachment];
+            if (uses.empty() || uses.back().m_subpass != subpassIndex)
+            {
+                uses.push_back(AttachmentUse{subpassIndex, 0, 0, reference.layout});
+            }
+            uses.back().m_stageMask |= stageMask;
+            uses.back().m_accessMask |= accessMask;
+        };
+
+        for (const VkAttachmentReference &reference : subpass.m_colorAttachments)
+        {
+            addUse(reference, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        }
+        for (const VkAttachmentReference &reference : subpass.m_resolveAttachments)
+        {
+            addUse(reference, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        }
+        const bool isDepthReadOnly = subpass.m_depthAttachment.layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL ||
+                                     subpass.m_depthAttachment.layout == VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL;
+        addUse(subpass.m_depthAttachment, DEPTH_TEST_STAGES,
+               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | (isDepthReadOnly ? 0 : VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT));
+        for (const VkAttachmentReference &reference : subpass.m_inputAttachments)
+        {
+            addUse(reference, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT);
+        }
+    }
+
+    // Merged per pair of subpasses
+    std::map<std::pair<uint32_t, uint32_t>, VkSubpassDependency> dependencies;
+    const auto addDependency = [&dependencies](const AttachmentUse &src, const AttachmentUse &dst)
+    {
+        VkSubpassDependency &dependency = dependencies[{src.m_subpass, dst.m_subpass}];
+        dependency.srcSubpass = src.m_subpass;
+        dependency.dstSubpass = dst.m_subpass;
+        dependency.srcStageMask |= src.m_stageMask;
+        dependency.srcAccessMask |= src.m_accessMask & WRITE_ACCESS_MASK; // Only writes need to be made available
+        dependency.dstStageMask |= dst.m_stageMask;
+        dependency.dstAccessMask |= dst.m_accessMask;
+        dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT; // Attachments are only accessed at the pixel being shaded
+    };
+
+    std::vector<std::vector<uint32_t>> preserveAttachments(subpasses.size());
+    for (uint32_t attachment = 0; attachment < attachmentUses.size(); attachment++)
+    {
+        const std::vector<AttachmentUse> &uses = attachmentUses[attachment];
+        const AttachmentUse *lastWrite = nullptr;
+        std::vector<const AttachmentUse *> readsSinceWrite;
+        for (size_t i = 0; i < uses.size(); i++)
+        {
+            const AttachmentUse &use = uses[i];
+            // A layout transition between two subpasses writes the attachment too
+            const bool isWrite = (use.m_accessMask & WRITE_ACCESS_MASK) != 0 || (i > 0 && use.m_layout != uses[i - 1].m_layout);
+            if (lastWrite != nullptr)
+            {
+                addDependency(*lastWrite, use);
+            }
+            if (!isWrite)
+            {
+                readsSinceWrite.push_back(&use);
+                continue;
+            }
+            for (const AttachmentUse *read : readsSinceWrite)
+            {
+                addDependency(*read, use);
+            }
+            readsSinceWrite.clear();
+            lastWrite = &use;
+        }
+
+        for (size_t i = 1; i < uses.size(); i++)
+        {
+            for (uint32_t subpassIndex = uses[i - 1].m_subpass + 1; subpassIndex < uses[i].m_subpass; subpassIndex++)
+            {
+                preserveAttachments[subpassIndex].push_back(attachment);
+            }
+        }
+    }
+
+    std::vector<VkSubpassDescription> subpassDescriptions;
+    for (uint32_t subpassIndex = 0; subpassIndex < subpasses.size(); subpassIndex++)
+    {
+        const VulkanSubpass &subpass = subpasses[subpassIndex];
+        VkSubpassDescription description{};
+        description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        description.inputAttachmentCount = static_cast<uint32_t>(subpass.m_inputAttachments.size());
+        description.pInputAttachments = subpass.m_inputAttachments.data();
+        description.colorAttachmentCount = static_cast<uint32_t>(subpass.m_colorAttachments.size());
+        description.pColorAttachments = subpass.m_colorAttachments.data();
+        description.pResolveAttachments = subpass.m_resolveAttachments.empty() ? nullptr : subpass.m_resolveAttachments.data();
+        description.pDepthStencilAttachment = (subpass.m_depthAttachment.attachment != VK_ATTACHMENT_UNUSED) ? &subpass.m_depthAttachment : nullptr;
+        description.preserveAttachmentCount = static_cast<uint32_t>(preserveAttachments[subpassIndex].size());
+        description.pPreserveAttachments = preserveAttachments[subpassIndex].data();
+        subpassDescriptions.push_back(description);
+    }
+
+    std::vector<VkSubpassDependency> subpassDependencies;
+    for (const auto &[subpassPair, dependency] : dependencies)
+    {
+        subpassDependencies.push_back(dependency);
+    }
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+    renderPassInfo.pAttachments = attachments.data();
+    renderPassInfo.subpassCount = static_cast<uint32_t>(subpassDescriptions.size());
+    renderPassInfo.pSubpasses = subpassDescriptions.data();
+    renderPassInfo.dependencyCount = static_cast<uint32_t>(subpassDependencies.size());
+    renderPassInfo.pDependencies = subpassDependencies.data();
 
     VkResult result = vkCreateRenderPass(m_device, &renderPassInfo, nullptr, &m_renderPass);
     if (result != VK_SUCCESS)
@@ -63,30 +348,31 @@ void VulkanRenderPass::createRenderPass(VkFormat colorFormat, VkFormat depthForm
     }
 }
 
-VkAttachmentDescription VulkanRenderPass::createColorAttachment(VkFormat format, VkSampleCountFlagBits samples) const
+VkAttachmentDescription VulkanRenderPass::createColorAttachment(VkFormat format, VkSampleCountFlagBits samples, VkImageLayout finalLayout,
+                                                                const VulkanAttachmentPolicy &policy) const
 {
     VkAttachmentDescription colorAttachment{};
     colorAttachment.format = format;
     colorAttachment.samples = samples;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;              // Clear the values to a constant at the start
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;            // Rendered contents will be stored in memory and can be read later
+    colorAttachment.loadOp = policy.m_loadOp;                          // CLEAR: cleared to a constant at the start, never read from memory
+    colorAttachment.storeOp = policy.m_storeOp;                        // STORE: rendered contents are written to memory and can be read later
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;   // Existing contents are undefined; we don't care about them
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; // Contents of the framebuffer will be undefined after the rendering operation
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // Images to be presented in the swap chain
+    colorAttachment.initialLayout = (policy.m_loadOp == VK_ATTACHMENT_LOAD_OP_LOAD) ? finalLayout : VK_IMAGE_LAYOUT_UNDEFINED; // UNDEFINED discards the contents
+    colorAttachment.finalLayout = finalLayout; // PRESENT_SRC for images to be presented in the swap chain
     return colorAttachment;
 }
 
-VkAttachmentDescription VulkanRenderPass::createDepthAttachment(VkFormat format, VkSampleCountFlagBits samples) const
+VkAttachmentDescription VulkanRenderPass::createDepthAttachment(VkFormat format, VkSampleCountFlagBits samples, const VulkanAttachmentPolicy &policy) const
 {
     VkAttachmentDescription depthAttachment{};
     depthAttachment.format = format;
     depthAttachment.samples = samples;
-    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.loadOp = policy.m_loadOp;
+    depthAttachment.storeOp = policy.m_storeOp;
+    depthAttachment.stencilLoadOp = policy.m_loadOp;
+    depthAttachment.stencilStoreOp = policy.m_storeOp;
+    depthAttachment.initialLayout = (policy.m_loadOp == VK_ATTACHMENT_LOAD_OP_LOAD) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
     depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
     return depthAttachment;
 }
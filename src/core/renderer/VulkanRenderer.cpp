@@ -1,11 +1,49 @@
 #include "core/renderer/VulkanRenderer.hpp"
 #include "core/system/window/WindowHandler.hpp"
 
-#include "utilities/renderer/VulkanPipelineConfigFactory.hpp"
-#include "graphics/Shader.hpp"
+#include "utilities/renderer/VulkanPipelinePresets.hpp"
 
-VulkanRenderer::VulkanRenderer(WindowHandler *windowHandler) : m_windowHandler(windowHandler), m_vulkanRenderPass(nullptr)
+#include <vulkan/vk_enum_string_helper.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Render graph names
+    const std::string BACKBUFFER = "Backbuffer";
+    const std::string MAIN_PASS = "Main";
+    const std::string READBACK_PASS = "Readback";
+
+    double elapsedMs(const Clock::time_point &start, const Clock::time_point &end)
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+}
+
+VulkanRenderer::VulkanRenderer(WindowHandler *windowHandler, const VulkanRendererConfig &config)
+    : m_windowHandler(windowHandler), m_graphicsPipeline(nullptr),
+      m_headless(config.m_headless), m_headlessExtent(config.m_headlessExtent), m_headlessFormat(config.m_headlessFormat),
+      m_enableReadback(config.m_headless && config.m_enableReadback), m_readbackSlotCount(std::max(config.m_readbackSlotCount, 1u)), m_renderExtent{0, 0},
+      m_pipelineCachePath(config.m_pipelineCachePath), m_pipelineWorkerCount(config.m_pipelineWorkerCount),
+      m_compilePipelinePresets(config.m_compilePipelinePresets), m_useExtendedDynamicState(config.m_useExtendedDynamicState),
+      m_useDynamicRendering(config.m_useDynamicRendering),
+      m_pipelineManifestPath(config.m_pipelineManifestPath), m_shaderArchivePath(config.m_shaderArchivePath),
+      m_benchmarkLightCount(config.m_benchmarkLightCount), m_benchmarkLightingPath(config.m_benchmarkLightingPath), m_pipelineCreationMs(0.0),
+      m_maxFramesInFlight(std::clamp(config.m_maxFramesInFlight, 1u, MAX_FRAMES_IN_FLIGHT_LIMIT)),
+      m_currentFrame(0), m_frameNumber(0), m_completedFrameCount(0), m_swapChainOutOfDate(false),
+      m_enableFramePacing(config.m_enableFramePacing), m_pendingPacingWaitMs(0.0),
+      m_timestampQueryPool(VK_NULL_HANDLE), m_timestampPeriodNs(0.0)
 {
+    if (!m_headless && m_windowHandler == nullptr)
+    {
+        throw std::runtime_error("VulkanRenderer: a window is required unless running headless!");
+    }
+    m_vulkanSwapChain.setPresentPolicy(config.m_presentPolicy);
 }
 
 VulkanRenderer::~VulkanRenderer()
@@ -16,14 +54,17 @@ VulkanRenderer::~VulkanRenderer()
 void VulkanRenderer::initVulkan()
 {
     // Create Instance
-    m_vulkanInstance.createInstance(m_vulkanValidationLayer);
+    m_vulkanInstance.createInstance(m_vulkanValidationLayer, m_headless);
     const VkInstance &instance = m_vulkanInstance.getInstance();
 
     // Set Up Debug Messenger
     m_vulkanDebugMessenger.setUp(instance);
 
-    // Create Surface
-    m_vulkanSurface.createMetalSurface(instance, m_windowHandler->GetMetalLayer());
+    // Create Surface (headless mode has nothing to present to, so the surface stays VK_NULL_HANDLE)
+    if (!m_headless)
+    {
+        m_vulkanSurface.createMetalSurface(instance, m_windowHandler->GetMetalLayer());
+    }
     const VkSurfaceKHR &surface = m_vulkanSurface.getSurface();
 
     // Pick Physical Device
@@ -33,54 +74,818 @@ void VulkanRenderer::initVulkan()
     m_vulkanDevice.createLogicalDevice(surface, m_vulkanValidationLayer);
     const VkDevice &device = m_vulkanDevice.getDevice();
 
-    // Create SwapChain
-    int widthPx, heightPx;
+    // Map the shader archive, before any shader is loaded
+    m_vulkanDevice.getShaderModuleCache().mountArchive(m_shaderArchivePath);
+
+    // Load the extended dynamic state commands, if the device supports them
+    m_vulkanExtendedDynamicState.create(m_vulkanDevice, m_useExtendedDynamicState);
+
+    // Create Pipeline Cache, warm if a cache from a previous run on this device and driver exists
+    m_vulkanPipelineCache.createPipelineCache(device, m_vulkanDevice.getPhysicalDeviceProperties(), m_pipelineCachePath);
+
+    // Create the images to render into: the swap chain images, or offscreen images in headless mode
+    VkFormat targetImageFormat;
+    if (!m_headless)
+    {
+        // Create SwapChain
+        int widthPx, heightPx;
+        m_windowHandler->GetWindowFramebufferSize(&widthPx, &heightPx);
+        m_vulkanSwapChain.createSwapChain(device, m_vulkanDevice.getPhysicalDevice(), surface, widthPx, heightPx);
+
+        // Create Image Views
+        m_vulkanSwapChain.createImageViews();
+        targetImageFormat = m_vulkanSwapChain.getSwapChainFormat();
+        m_renderExtent = m_vulkanSwapChain.getSwapChainExtent();
+        notifyPresentConfigured();
+    }
+    else
+    {
+        // Create Offscreen Images (one per frame in flight)
+        m_vulkanOffscreenTarget.createImages(m_vulkanDevice, m_headlessFormat, m_headlessExtent, m_maxFramesInFlight);
+        targetImageFormat = m_vulkanOffscreenTarget.getFormat();
+        m_renderExtent = m_vulkanOffscreenTarget.getExtent();
+
+        // Create Readback Ring
+        if (m_enableReadback)
+        {
+            m_vulkanReadbackRing.createRing(m_vulkanDevice, m_renderExtent, targetImageFormat, m_readbackSlotCount);
+        }
+    }
+
+    // Create Render Graph, with the render pass (or, with dynamic rendering, the attachment formats) the graphics pipelines are created against
+    createRenderGraph(targetImageFormat);
+    const VulkanPipelineTarget pipelineTarget = m_vulkanRenderGraph.getPipelineTarget(MAIN_PASS);
+
+    // Create Pipeline Registry, which compiles the pipelines on worker threads
+    // with the manifest of the pipelines the previous session used
+    m_pipelineManifest.load(m_pipelineManifestPath);
+    m_vulkanPipelineRegistry.createRegistry(m_vulkanDevice, m_vulkanPipelineCache, m_pipelineWorkerCount,
+                                            m_pipelineManifestPath.empty() ? nullptr : &m_pipelineManifest);
+
+    // Create Graphics Pipeline (and the presets, compiled in parallel with it)
+    const Clock::time_point pipelineStart = Clock::now();
+    m_graphicsPipelineState = VulkanPipelinePresets::BASIC;
+    VulkanPipelineRequest pipelineRequest{};
+    pipelineRequest.m_state = m_vulkanExtendedDynamicState.toPipelineState(m_graphicsPipelineState);
+    pipelineRequest.m_shaderStages = {
+        ShaderStageSource{VK_SHADER_STAGE_VERTEX_BIT, "assets/shaders/vertex/simple_shader.vert.spv"},
+        ShaderStageSource{VK_SHADER_STAGE_FRAGMENT_BIT, "assets/shaders/fragment/simple_shader.frag.spv"},
+    };
+    pipelineRequest.m_target = pipelineTarget;
+    m_graphicsPipelineRequest = pipelineRequest;
+    VulkanPipelineHandle graphicsPipeline = m_vulkanPipelineRegistry.requestPipeline(pipelineRequest);
+
+    std::vector<VulkanPipelineHandle> presetPipelines;
+    if (m_compilePipelinePresets)
+    {
+        presetPipelines = requestPipelinePresets(pipelineRequest);
+    }
+
+    // Pipelines the previous session used, compiled at low priority in the background: nothing waits for them here
+    for (VulkanPipelineRequest request : m_pipelineManifest.getLoadedRequests())
+    {
+        request.m_target = pipelineTarget;
+        m_vulkanPipelineRegistry.prewarmPipeline(request);
+    }
+
+    m_graphicsPipeline = graphicsPipeline.get();
+    for (const VulkanPipelineHandle &presetPipeline : presetPipelines)
+    {
+        presetPipeline.get(); // Rethrows if the preset failed to compile
+    }
+    m_pipelineCreationMs = elapsedMs(pipelineStart, Clock::now());
+
+    // Create the Lighting Benchmark pipelines, against the targets of its passes
+    if (m_lightingBenchmark.isEnabled())
+    {
+        m_lightingBenchmark.create(m_vulkanDevice, m_vulkanRenderGraph, m_vulkanPipelineCache.getPipelineCache());
+    }
+
+    // Create Command Pool and one Command Buffer per frame in flight
+    m_vulkanCommandPool.createCommandPool(device, m_vulkanDevice.getQueueFamilyIndices().m_graphicsFamily.value());
+    m_commandBuffers = m_vulkanCommandPool.allocateCommandBuffers(m_maxFramesInFlight);
+
+    // Create Sync Objects (semaphores and fences) per frame in flight, and the semaphores the presents wait on per swap chain image
+    m_vulkanSyncObjects.createSyncObjects(device, m_maxFramesInFlight);
+    if (!m_headless)
+    {
+        m_vulkanSyncObjects.recreateRenderFinishedSemaphores(static_cast<uint32_t>(m_vulkanSwapChain.getSwapChainImages().size()));
+    }
+    m_frameNumbersInFlight.assign(m_maxFramesInFlight, std::nullopt);
+
+    // Create Upload Arena (per frame in flight) for per-draw data
+    m_vulkanUploadArena.createArena(m_vulkanDevice, m_maxFramesInFlight);
+
+    // Create Staging Uploader on the transfer queue for device-local resources
+    m_vulkanStagingUploader.createUploader(m_vulkanDevice);
+
+    // Create Async Compute command buffers and semaphores per frame in flight
+    m_vulkanAsyncCompute.createAsyncCompute(m_vulkanDevice, m_maxFramesInFlight);
+
+    // Create Timestamp Queries to measure GPU frame time
+    createTimestampQueryPool();
+}
+
+// The frame as a render graph: the main pass draws into the backbuffer (the swap chain image, or the offscreen image in
+// headless mode), over the lighting benchmark scene if enabled, and, with readback, a copy pass reads it back. The graph
+// places the layout transitions and barriers between them; framebuffers are created by the graph the first time each
+// backbuffer image is drawn into
+void VulkanRenderer::createRenderGraph(const VkFormat targetImageFormat)
+{
+    m_vulkanRenderGraph.create(m_vulkanDevice, m_useDynamicRendering);
+
+    VulkanRenderGraphImageImport backbuffer{};
+    backbuffer.m_format = targetImageFormat;
+    if (!m_headless)
+    {
+        // The image-available semaphore is waited on at COLOR_ATTACHMENT_OUTPUT: the first write waits on that same stage
+        backbuffer.m_initialStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        backbuffer.m_finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    }
+    else
+    {
+        // Offscreen images are reused without a semaphore: the previous copy out of the image must finish before it is overwritten
+        backbuffer.m_initialStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
+    m_vulkanRenderGraph.importImage(BACKBUFFER, backbuffer);
+
+    VkAttachmentLoadOp mainLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    if (m_benchmarkLightCount > 0)
+    {
+        m_lightingBenchmark.declarePasses(m_vulkanRenderGraph, BACKBUFFER, m_benchmarkLightingPath, m_benchmarkLightCount);
+        mainLoadOp = VK_ATTACHMENT_LOAD_OP_LOAD; // Drawn over the lit scene
+    }
+
+    m_vulkanRenderGraph.addPass(MAIN_PASS)
+        .writeColor(BACKBUFFER, mainLoadOp, VkClearColorValue{{0.0f, 0.0f, 0.0f, 1.0f}})
+        .setRecord([this](VkCommandBuffer commandBuffer, const VulkanRenderGraphPassContext &context)
+                   { recordMainPass(commandBuffer, context.m_extent); });
+
+    if (m_enableReadback)
+    {
+        // Copies to host memory: a side effect the graph cannot see
+        m_vulkanRenderGraph.addPass(READBACK_PASS)
+            .readTransfer(BACKBUFFER)
+            .setSideEffect()
+            .setRecord([this](VkCommandBuffer commandBuffer, const VulkanRenderGraphPassContext &context)
+                       { m_vulkanReadbackRing.recordCopy(commandBuffer, context.getImage(BACKBUFFER), m_frameNumber); });
+    }
+
+    m_vulkanRenderGraph.compile(m_renderExtent);
+}
+
+// Requests every preset that is valid with the renderer's render pass and enabled device features
+// (MSAA needs a multisampled render pass, wireframe the fillModeNonSolid feature, tessellation tessellation shaders).
+// With extended dynamic state, presets that only differ by dynamic states are answered by the same pipeline
+std::vector<VulkanPipelineHandle> VulkanRenderer::requestPipelinePresets(const VulkanPipelineRequest &baseRequest)
+{
+    std::vector<VulkanPipelineState> presets = {
+        VulkanPipelinePresets::ALPHA_BLENDING,
+        VulkanPipelinePresets::DEFERRED_SHADING,
+        VulkanPipelinePresets::POST_PROCESSING,
+        VulkanPipelinePresets::DYNAMIC_STATE,
+        VulkanPipelinePresets::SHADOW_MAPPING,
+        VulkanPipelinePresets::HDR,
+        VulkanPipelinePresets::DEPTH_PRE_PASS,
+    };
+    if (m_vulkanDevice.supportsFillModeNonSolid())
+    {
+        presets.push_back(VulkanPipelinePresets::WIREFRAME);
+    }
+
+    std::vector<VulkanPipelineHandle> handles;
+    for (const VulkanPipelineState &preset : presets)
+    {
+        VulkanPipelineRequest request = baseRequest;
+        request.m_state = m_vulkanExtendedDynamicState.toPipelineState(preset);
+        handles.push_back(m_vulkanPipelineRegistry.requestPipeline(request));
+    }
+    return handles;
+}
+
+void VulkanRenderer::setGraphicsPipelineState(const VulkanPipelineState &requestedState)
+{
+    // Line and point modes need fillModeNonSolid, enabled only where supported: drawn filled instead of failing validation
+    VulkanPipelineState state = requestedState;
+    if (state.m_polygonMode != VK_POLYGON_MODE_FILL && !m_vulkanDevice.supportsFillModeNonSolid())
+    {
+        std::cerr << "The device does not support fillModeNonSolid, drawing filled polygons instead of "
+                  << string_VkPolygonMode(static_cast<VkPolygonMode>(state.m_polygonMode)) << std::endl;
+        state.m_polygonMode = VK_POLYGON_MODE_FILL;
+    }
+
+    VulkanPipelineRequest request = m_graphicsPipelineRequest;
+    request.m_state = m_vulkanExtendedDynamicState.toPipelineState(state);
+    m_pendingGraphicsPipeline = m_vulkanPipelineRegistry.requestPipeline(request);
+    m_pendingGraphicsPipelineState = state;
+    m_reloadedGraphicsPipeline.reset(); // The new state's pipeline is built from the current shaders too
+}
+
+void VulkanRenderer::reloadShaders(const std::vector<std::string> &changedShaderPaths)
+{
+    // The archive was packed from the previous binaries
+    for (const std::string &path : changedShaderPaths)
+    {
+        m_vulkanDevice.getShaderModuleCache().preferFile(path);
+    }
+    const uint64_t retireSerial = m_vulkanPipelineRegistry.rebuildPipelines(changedShaderPaths);
+
+    const bool usesChangedShader = std::any_of(m_graphicsPipelineRequest.m_shaderStages.begin(), m_graphicsPipelineRequest.m_shaderStages.end(),
+                                               [&changedShaderPaths](const ShaderStageSource &stage)
+                                               { return std::find(changedShaderPaths.begin(), changedShaderPaths.end(), stage.m_filePath) != changedShaderPaths.end(); });
+    if (!usesChangedShader)
+    {
+        // The retired pipelines are not drawn with: gone once the frames already submitted complete
+        m_vulkanDeletionQueue.push(m_frameNumber, [this, retireSerial]() { m_vulkanPipelineRegistry.releaseRetiredPipelines(retireSerial); });
+        return;
+    }
+
+    // Request the rebuilt pipeline of the state drawn with (or about to be): the handles held so far are the retired pipelines
+    VulkanPipelineRequest request = m_graphicsPipelineRequest;
+    if (m_pendingGraphicsPipeline.has_value())
+    {
+        request.m_state = m_vulkanExtendedDynamicState.toPipelineState(m_pendingGraphicsPipelineState);
+        m_pendingGraphicsPipeline = m_vulkanPipelineRegistry.requestPipeline(request);
+    }
+    else
+    {
+        request.m_state = m_vulkanExtendedDynamicState.toPipelineState(m_graphicsPipelineState);
+        m_reloadedGraphicsPipeline = m_vulkanPipelineRegistry.requestPipeline(request);
+    }
+    m_pendingRetireSerials.push_back(retireSerial);
+}
+
+// Draws with the pipeline of handle from the frame being recorded. After a shader reload, the pipelines it retired are
+// released once the frames already submitted, the last ones drawing with them, complete
+void VulkanRenderer::swapGraphicsPipeline(const VulkanPipelineHandle &handle, const VulkanPipelineState &state)
+{
+    if (m_pendingRetireSerials.empty())
+    {
+        m_graphicsPipeline = handle.get();
+        m_graphicsPipelineState = state;
+        return;
+    }
+
+    try
+    {
+        m_graphicsPipeline = handle.get();
+        m_graphicsPipelineState = state;
+    }
+    catch (const std::exception &exception)
+    {
+        // The reloaded shaders do not build a pipeline: keep drawing with the previous one (destroyed with the registry)
+        std::cerr << "Shader reload: failed to rebuild the graphics pipeline, keeping the previous one: " << exception.what() << std::endl;
+        m_pendingRetireSerials.clear();
+        return;
+    }
+    for (const uint64_t retireSerial : m_pendingRetireSerials)
+    {
+        m_vulkanDeletionQueue.push(m_frameNumber, [this, retireSerial]() { m_vulkanPipelineRegistry.releaseRetiredPipelines(retireSerial); });
+    }
+    m_pendingRetireSerials.clear();
+}
+
+void VulkanRenderer::createTimestampQueryPool()
+{
+    if (!m_vulkanDevice.supportsGraphicsTimestamps())
+    {
+        return;
+    }
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = 2 * m_maxFramesInFlight; // Begin and end timestamp per frame slot
+
+    VkResult result = vkCreateQueryPool(m_vulkanDevice.getDevice(), &queryPoolInfo, nullptr, &m_timestampQueryPool);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create timestamp query pool! VkResult: ") + string_VkResult(result));
+    }
+
+    m_timestampPeriodNs = m_vulkanDevice.getPhysicalDeviceProperties().limits.timestampPeriod;
+    m_timestampsPending.assign(m_maxFramesInFlight, false);
+}
+
+void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, const uint32_t imageIndex)
+{
+    // A new pipeline state was selected: switch to its pipeline, waiting for it if it is still compiling. That wait is the
+    // first-use hitch the manifest pre-warm avoids on the next launch
+    if (m_pendingGraphicsPipeline.has_value())
+    {
+        if (!VulkanPipelineRegistry::isReady(*m_pendingGraphicsPipeline))
+        {
+            const Clock::time_point waitStart = Clock::now();
+            m_pendingGraphicsPipeline->wait();
+            m_pipelineUsageStats.m_notReadyDrawCount++;
+            m_pipelineUsageStats.m_notReadyWaitMs += elapsedMs(waitStart, Clock::now());
+        }
+        swapGraphicsPipeline(*m_pendingGraphicsPipeline, m_pendingGraphicsPipelineState);
+        m_pendingGraphicsPipeline.reset();
+        m_pipelineUsageStats.m_pipelineSwitchCount++;
+    }
+    // Shaders were reloaded: keep drawing with the previous pipeline until the rebuilt one is compiled, never wait for it
+    else if (m_reloadedGraphicsPipeline.has_value() && VulkanPipelineRegistry::isReady(*m_reloadedGraphicsPipeline))
+    {
+        swapGraphicsPipeline(*m_reloadedGraphicsPipeline, m_graphicsPipelineState);
+        m_reloadedGraphicsPipeline.reset();
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; // Re-recorded every frame
+
+    VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to begin recording command buffer! VkResult: ") + string_VkResult(result));
+    }
+
+    const uint32_t firstQuery = 2 * m_currentFrame;
+    if (m_timestampQueryPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(commandBuffer, m_timestampQueryPool, firstQuery, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampQueryPool, firstQuery);
+    }
+
+    // Take ownership of the resources uploaded since the previous frame, before anything can use them
+    m_uploadWaits = m_vulkanStagingUploader.recordGraphicsAcquire(commandBuffer, m_frameNumber);
+
+    // The image drawn into this frame, then the passes of the graph with their barriers
+    if (m_headless)
+    {
+        m_vulkanRenderGraph.setImportedImage(BACKBUFFER, m_vulkanOffscreenTarget.getImages()[imageIndex], m_vulkanOffscreenTarget.getImageViews()[imageIndex]);
+    }
+    else
+    {
+        m_vulkanRenderGraph.setImportedImage(BACKBUFFER, m_vulkanSwapChain.getSwapChainImages()[imageIndex], m_vulkanSwapChain.getSwapChainImageViews()[imageIndex]);
+    }
+    m_vulkanRenderGraph.execute(commandBuffer);
+
+    if (m_timestampQueryPool != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampQueryPool, firstQuery + 1);
+    }
+
+    result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to record command buffer! VkResult: ") + string_VkResult(result));
+    }
+}
+
+// Recorded inside the main pass's render pass, begun by the render graph
+void VulkanRenderer::recordMainPass(VkCommandBuffer commandBuffer, const VkExtent2D renderExtent)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline->getPipeline());
+    m_vulkanExtendedDynamicState.record(commandBuffer, m_graphicsPipelineState);
+
+    // Viewport and scissor are dynamic states in the basic pipeline config, so they have to be set before drawing
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(renderExtent.width);
+    viewport.height = static_cast<float>(renderExtent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = renderExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+}
+
+// Must only be called once the in-flight fence of frameIndex has signaled, so the queries are guaranteed to be available
+double VulkanRenderer::readGpuFrameTime(const uint32_t frameIndex)
+{
+    if (m_timestampQueryPool == VK_NULL_HANDLE || !m_timestampsPending[frameIndex])
+    {
+        return 0.0;
+    }
+    m_timestampsPending[frameIndex] = false;
+
+    uint64_t timestamps[2] = {};
+    VkResult result = vkGetQueryPoolResults(m_vulkanDevice.getDevice(), m_timestampQueryPool, 2 * frameIndex, 2,
+                                            sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS)
+    {
+        return 0.0;
+    }
+
+    return static_cast<double>(timestamps[1] - timestamps[0]) * m_timestampPeriodNs / 1.0e6;
+}
+
+// Called once the fence of frameIndex is known to be signaled: the frame submitted with it (and every earlier one) is complete
+void VulkanRenderer::retireFrame(const uint32_t frameIndex)
+{
+    if (!m_frameNumbersInFlight[frameIndex].has_value())
+    {
+        return;
+    }
+
+    const uint64_t completedFrameNumber = m_frameNumbersInFlight[frameIndex].value();
+    m_frameNumbersInFlight[frameIndex].reset();
+    m_completedFrameCount = std::max(m_completedFrameCount, completedFrameNumber + 1);
+
+    m_vulkanDeletionQueue.flush(m_completedFrameCount);
+    m_vulkanStagingUploader.retire(m_completedFrameCount);
+
+    if (m_vulkanReadbackRing.isCreated())
+    {
+        m_vulkanReadbackRing.retire(completedFrameNumber);
+    }
+}
+
+// Non-blocking check of every frame in flight, so readbacks become available as soon as the GPU is done with them
+void VulkanRenderer::pollCompletedFrames()
+{
+    for (uint32_t i = 0; i < m_maxFramesInFlight; i++)
+    {
+        if (m_frameNumbersInFlight[i].has_value() &&
+            vkGetFenceStatus(m_vulkanDevice.getDevice(), m_vulkanSyncObjects.getInFlightFence(i)) == VK_SUCCESS)
+        {
+            retireFrame(i);
+        }
+    }
+}
+
+// Recreates the swap chain and everything that depends on its images, without waiting for the device to be idle.
+// The pipeline uses dynamic viewport/scissor and the graph's render passes only depend on the image formats, so both are kept
+// unless the surface format changed; with dynamic rendering, the passes have no framebuffers to recreate either.
+// Returns false if the window is minimized (zero sized framebuffer): there is nothing to render to until it is restored.
+bool VulkanRenderer::recreateSwapChain()
+{
+    int widthPx = 0, heightPx = 0;
     m_windowHandler->GetWindowFramebufferSize(&widthPx, &heightPx);
-    m_vulkanSwapChain.createSwapChain(device, m_vulkanDevice.getPhysicalDevice(), surface, widthPx, heightPx);
+    if (widthPx == 0 || heightPx == 0)
+    {
+        return false;
+    }
+    m_windowHandler->resetFramebufferResized();
+
+    const VkFormat previousFormat = m_vulkanSwapChain.getSwapChainFormat();
+
+    // The old swap chain is handed over as oldSwapchain and kept alive until the frames that used it have completed
+    RetiredSwapChain retiredSwapChain = m_vulkanSwapChain.recreateSwapChain(m_vulkanDevice.getPhysicalDevice(), m_vulkanSurface.getSurface(), widthPx, heightPx);
+
+    m_renderExtent = m_vulkanSwapChain.getSwapChainExtent();
+
+    VulkanRenderGraphRetired retiredGraph{};
+    VkDescriptorPool retiredGBufferPool = VK_NULL_HANDLE;
+    if (m_vulkanSwapChain.getSwapChainFormat() != previousFormat)
+    {
+        // E.g. the window moved to a monitor preferring another format: the render passes and pipelines no longer match
+        rebuildForTargetFormat(m_vulkanSwapChain.getSwapChainFormat());
+    }
+    else
+    {
+        // The graph's framebuffers (if any) reference the old image views, and its transient images have the old extent
+        retiredGraph = m_vulkanRenderGraph.resize(m_renderExtent);
+        // The lighting benchmark's G-buffer descriptors point at the old transient images
+        retiredGBufferPool = m_lightingBenchmark.updateGBufferDescriptors(m_vulkanRenderGraph);
+    }
+    // The image count may have changed, and presents of the old swap chain may still wait on its semaphores
+    const std::vector<VkSemaphore> retiredSemaphores =
+        m_vulkanSyncObjects.recreateRenderFinishedSemaphores(static_cast<uint32_t>(m_vulkanSwapChain.getSwapChainImages().size()));
+
+    // Frames submitted so far may still reference the retired objects: destroy them once all of them have completed
+    m_vulkanDeletionQueue.push(
+        m_frameNumber,
+        [this, retiredSwapChain, retiredGraph, retiredGBufferPool, retiredSemaphores]()
+        {
+            m_vulkanSyncObjects.destroyRetiredSemaphores(retiredSemaphores);
+            m_lightingBenchmark.destroyRetiredPool(retiredGBufferPool);
+            m_vulkanRenderGraph.destroyRetired(retiredGraph);
+            m_vulkanSwapChain.destroyRetiredSwapChain(retiredSwapChain);
+        });
+    m_vulkanDeletionQueue.flush(m_completedFrameCount);
+
+    m_swapChainOutOfDate = false;
+    m_lastPresentTime.reset(); // The gap caused by the recreation is not a present interval
+    notifyPresentConfigured();
+    return true;
+}
+
+// Recreates the render graph for images of another format, and every pipeline created against its render passes (or formats).
+// Format changes are rare: the device is waited for, so the previous graph and pipelines can be destroyed right away
+void VulkanRenderer::rebuildForTargetFormat(const VkFormat targetImageFormat)
+{
+    waitIdle();
+
+    m_lightingBenchmark.cleanUp();
+    m_vulkanRenderGraph.cleanUp();
+    createRenderGraph(targetImageFormat);
+    const VulkanPipelineTarget pipelineTarget = m_vulkanRenderGraph.getPipelineTarget(MAIN_PASS);
+
+    // A new render pass may get the handle of a destroyed one: no pipeline keyed by the previous ones may be returned.
+    // Pipelines retired by a shader reload and still waiting for the swap are not drawn with any more either
+    m_vulkanPipelineRegistry.releaseRetiredPipelines(m_vulkanPipelineRegistry.retireAllPipelines());
+    for (const uint64_t retireSerial : m_pendingRetireSerials)
+    {
+        m_vulkanPipelineRegistry.releaseRetiredPipelines(retireSerial);
+    }
+    m_pendingRetireSerials.clear();
+
+    // The state about to be drawn with, if a change is pending, is the one rebuilt
+    if (m_pendingGraphicsPipeline.has_value())
+    {
+        m_graphicsPipelineState = m_pendingGraphicsPipelineState;
+    }
+    m_pendingGraphicsPipeline.reset();
+    m_reloadedGraphicsPipeline.reset();
+
+    m_graphicsPipelineRequest.m_target = pipelineTarget;
+    VulkanPipelineRequest request = m_graphicsPipelineRequest;
+    request.m_state = m_vulkanExtendedDynamicState.toPipelineState(m_graphicsPipelineState);
+    m_graphicsPipeline = m_vulkanPipelineRegistry.requestPipeline(request).get();
+    if (m_compilePipelinePresets)
+    {
+        requestPipelinePresets(request);
+    }
+
+    if (m_lightingBenchmark.isEnabled())
+    {
+        m_lightingBenchmark.create(m_vulkanDevice, m_vulkanRenderGraph, m_vulkanPipelineCache.getPipelineCache());
+    }
+}
+
+void VulkanRenderer::notifyPresentConfigured()
+{
+    if (m_presentObserver.m_onPresentConfigured)
+    {
+        m_presentObserver.m_onPresentConfigured(m_vulkanSwapChain.getPresentConfiguration());
+    }
+}
+
+// Frame pacing: blocks until the GPU has finished the most recently submitted frame, not just the one that last used the
+// next frame slot. Call it right before sampling input: the next frame is then built from input that is at most one frame old.
+// Waiting here instead of in drawFrame is the latest point possible, since the swap chain image cannot be acquired before the
+// frame slot's semaphores are free again.
+void VulkanRenderer::waitForFramePacing()
+{
+    if (!m_enableFramePacing || m_frameNumber == 0)
+    {
+        return;
+    }
 
-    // Create Image Views
-    m_vulkanSwapChain.createImageViews();
-    const std::vector<VkImageView> &swapChainImageViews = m_vulkanSwapChain.getSwapChainImageViews();
-    const VkFormat &swapChainImageFormat = m_vulkanSwapChain.getSwapChainFormat();
-    const VkExtent2D &swapChainExtent = m_vulkanSwapChain.getSwapChainExtent();
+    const uint32_t previousFrame = (m_currentFrame + m_maxFramesInFlight - 1) % m_maxFramesInFlight;
+    if (!m_frameNumbersInFlight[previousFrame].has_value())
+    {
+        return; // Already retired
+    }
+
+    const VkFence previousFence = m_vulkanSyncObjects.getInFlightFence(previousFrame);
+    const Clock::time_point waitStart = Clock::now();
+    vkWaitForFences(m_vulkanDevice.getDevice(), 1, &previousFence, VK_TRUE, UINT64_MAX);
+    m_pendingPacingWaitMs += elapsedMs(waitStart, Clock::now());
+}
+
+std::optional<VulkanReadbackFrame> VulkanRenderer::acquireReadbackFrame()
+{
+    if (!m_vulkanReadbackRing.isCreated())
+    {
+        return std::nullopt;
+    }
+
+    pollCompletedFrames();
+    return m_vulkanReadbackRing.acquireFrame();
+}
 
-    // Create Render Pass
-    m_vulkanRenderPass = VulkanRenderPass(device);
-    m_vulkanRenderPass.createRenderPass(swapChainImageFormat);
-    const VkRenderPass &renderPass = m_vulkanRenderPass.getRenderPass();
+void VulkanRenderer::releaseReadbackFrame(const VulkanReadbackFrame &frame)
+{
+    m_vulkanReadbackRing.releaseFrame(frame);
+}
 
-    // Create Graphics Pipeline
-    VulkanGraphicsPipelineConfig pipelineConfigInfo{};
-    VulkanPipelineConfigFactory::basicPipelineConfig(pipelineConfigInfo, swapChainExtent);
-    const std::string vertFilePath = "assets/shaders/vertex/simple_shader.vert.spv";
-    const std::string fragFilePath = "assets/shaders/fragment/simple_shader.frag.spv";
-    Shader shader(device, vertFilePath, fragFilePath);
-    m_vulkanGraphicsPipeline.createPipeline(device, pipelineConfigInfo, shader, renderPass);
+bool VulkanRenderer::drawFrame()
+{
+    const VkDevice device = m_vulkanDevice.getDevice();
+    const VkSemaphore imageAvailableSemaphore = m_vulkanSyncObjects.getImageAvailableSemaphore(m_currentFrame);
+    const VkFence inFlightFence = m_vulkanSyncObjects.getInFlightFence(m_currentFrame);
+    const VkCommandBuffer commandBuffer = m_commandBuffers[m_currentFrame];
 
-    // Create Framebuffers for swapChain
-    m_vulkanSwapChainFramebuffers.reserve(swapChainImageViews.size());
-    uint32_t layers = 1;
+    // Recreate the swap chain before using it if it no longer matches the window
+    if (!m_headless && (m_swapChainOutOfDate || m_windowHandler->wasFramebufferResized()))
+    {
+        if (!recreateSwapChain())
+        {
+            return false; // Window minimized: nothing to draw into
+        }
+    }
+
+    VulkanFrameStats frameStats{};
+    frameStats.m_frameNumber = m_frameNumber;
+    frameStats.m_pacingWaitMs = m_pendingPacingWaitMs;
+    m_pendingPacingWaitMs = 0.0;
 
-    for (const auto &imageView : swapChainImageViews)
+    // Wait until the GPU has finished the frame that last used this slot.
+    // With N frames in flight this only blocks when the CPU is N frames ahead of the GPU.
+    const Clock::time_point frameStart = Clock::now();
+    vkWaitForFences(device, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
+    const Clock::time_point fenceSignaled = Clock::now();
+    frameStats.m_fenceWaitMs = elapsedMs(frameStart, fenceSignaled);
+    frameStats.m_gpuTimeMs = readGpuFrameTime(m_currentFrame);
+    retireFrame(m_currentFrame);
+    m_vulkanUploadArena.beginFrame(m_currentFrame); // The GPU no longer reads this slot's upload memory
+
+    // Acquire an image from the swap chain. The semaphore is signaled once the presentation engine releases it.
+    // Headless mode owns its offscreen images: each frame slot renders into its own image, nothing to acquire.
+    uint32_t imageIndex = m_currentFrame;
+    if (!m_headless)
     {
-        m_vulkanSwapChainFramebuffers.emplace_back(VulkanFramebuffer(device, renderPass, std::vector<VkImageView>{imageView}, swapChainExtent, layers));
+        VkResult result = vkAcquireNextImageKHR(device, m_vulkanSwapChain.getSwapChain(), UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            // The swap chain can no longer be used for rendering. Nothing was submitted, so the fence is still signaled
+            m_swapChainOutOfDate = true;
+            return true; // Recreated by the next call
+        }
+        else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) // Suboptimal still presents correctly, recreate after presenting
+        {
+            throw std::runtime_error(std::string("Failed to acquire swap chain image! VkResult: ") + string_VkResult(result));
+        }
+    }
+    const Clock::time_point imageAcquired = Clock::now();
+    frameStats.m_acquireWaitMs = elapsedMs(fenceSignaled, imageAcquired);
+    // Per image, not per frame slot: the previous present of this image has released it, since it was acquired again
+    const VkSemaphore renderFinishedSemaphore = m_headless ? VK_NULL_HANDLE : m_vulkanSyncObjects.getRenderFinishedSemaphore(imageIndex);
+
+    // Only reset the fence once we are sure work will be submitted with it
+    vkResetFences(device, 1, &inFlightFence);
+
+    // Uploads requested since the previous frame go to the transfer queue in one batch, ahead of the frame that uses them
+    m_vulkanStagingUploader.submit();
+
+    // Compute work is submitted before the graphics work is recorded, so the compute queue starts on it as early as possible
+    std::optional<VulkanSemaphoreWait> computeWait;
+    if (m_computeWork.m_record)
+    {
+        const VkCommandBuffer computeCommandBuffer = m_vulkanAsyncCompute.beginFrame(m_currentFrame);
+        m_computeWork.m_record(computeCommandBuffer, m_currentFrame);
+        computeWait = m_vulkanAsyncCompute.submit(m_currentFrame, {}, m_computeWork.m_graphicsWaitStageMask);
+    }
+
+    vkResetCommandBuffer(commandBuffer, 0);
+    recordCommandBuffer(commandBuffer, imageIndex);
+
+    // Wait with writing colors to the image until it is available, and with using uploaded or computed resources until they are written
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<VkPipelineStageFlags> waitStages;
+    std::vector<uint64_t> waitValues; // Only read for timeline semaphores
+    bool hasTimelineWait = false;
+    if (!m_headless)
+    {
+        waitSemaphores.push_back(imageAvailableSemaphore);
+        waitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        waitValues.push_back(0);
+    }
+    for (const VulkanSemaphoreWait &wait : m_uploadWaits)
+    {
+        waitSemaphores.push_back(wait.m_semaphore);
+        waitStages.push_back(wait.m_stageMask);
+        waitValues.push_back(wait.m_value);
+        hasTimelineWait = hasTimelineWait || wait.m_isTimeline;
+    }
+    if (computeWait.has_value())
+    {
+        waitSemaphores.push_back(computeWait->m_semaphore);
+        waitStages.push_back(computeWait->m_stageMask);
+        waitValues.push_back(0);
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
+    if (!m_headless)
+    {
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &renderFinishedSemaphore;
+    }
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    if (hasTimelineWait)
+    {
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+        timelineInfo.pWaitSemaphoreValues = waitValues.data();
+        submitInfo.pNext = &timelineInfo;
+    }
+
+    VkResult result = vkQueueSubmit(m_vulkanDevice.getGraphicsQueue(), 1, &submitInfo, inFlightFence);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to submit draw command buffer! VkResult: ") + string_VkResult(result));
+    }
+    if (m_timestampQueryPool != VK_NULL_HANDLE)
+    {
+        m_timestampsPending[m_currentFrame] = true;
+    }
+    m_frameNumbersInFlight[m_currentFrame] = m_frameNumber;
+
+    // Hand the image back to the swap chain once rendering has finished
+    if (!m_headless)
+    {
+        VkSwapchainKHR swapChain = m_vulkanSwapChain.getSwapChain();
+
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &renderFinishedSemaphore;
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &swapChain;
+        presentInfo.pImageIndices = &imageIndex;
+
+        result = vkQueuePresentKHR(m_vulkanDevice.getPresentQueue(), &presentInfo);
+
+        // Present interval as seen by the CPU: with FIFO it converges to the refresh period once the queue of images is full
+        const Clock::time_point presentTime = Clock::now();
+        if (m_lastPresentTime.has_value() && m_presentObserver.m_onPresent)
+        {
+            m_presentObserver.m_onPresent(m_frameNumber, elapsedMs(m_lastPresentTime.value(), presentTime));
+        }
+        m_lastPresentTime = presentTime;
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+        {
+            m_swapChainOutOfDate = true;
+        }
+        else if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Failed to present swap chain image! VkResult: ") + string_VkResult(result));
+        }
+    }
+
+    frameStats.m_cpuWorkMs = elapsedMs(imageAcquired, Clock::now());
+    m_lastFrameStats = frameStats;
+
+    // No vkQueueWaitIdle here: the next frame records into its own command buffer while the GPU executes this one
+    m_currentFrame = (m_currentFrame + 1) % m_maxFramesInFlight;
+    m_frameNumber++;
+    return true;
+}
+
+// Wait for the logical device to finish operations before destroying resources still in use by in-flight frames
+void VulkanRenderer::waitIdle()
+{
+    if (m_vulkanDevice.getDevice() != VK_NULL_HANDLE)
+    {
+        vkDeviceWaitIdle(m_vulkanDevice.getDevice());
     }
 }
 
 // Vulkan components clean up
 void VulkanRenderer::cleanup()
 {
-    for (VulkanFramebuffer &framebuffer : m_vulkanSwapChainFramebuffers)
+    waitIdle();
+
+    if (m_timestampQueryPool != VK_NULL_HANDLE)
     {
-        framebuffer.cleanUp();
+        vkDestroyQueryPool(m_vulkanDevice.getDevice(), m_timestampQueryPool, nullptr);
+        m_timestampQueryPool = VK_NULL_HANDLE;
     }
-    m_vulkanSwapChainFramebuffers.clear();
 
-    m_vulkanSwapChain.cleanUp();
+    m_vulkanDeletionQueue.flushAll();
+
+    m_vulkanSyncObjects.cleanUp();
+
+    m_vulkanUploadArena.cleanUp();
+
+    m_vulkanStagingUploader.cleanUp();
+
+    m_vulkanAsyncCompute.cleanUp();
+    m_computeWork = VulkanComputeWork{};
 
-    m_vulkanGraphicsPipeline.cleanUp();
+    m_commandBuffers.clear();
+    m_vulkanCommandPool.cleanUp();
 
-    m_vulkanRenderPass.cleanUp();
+    // Stops the pipeline workers, which merge their caches, and destroys the pipelines
+    m_vulkanPipelineRegistry.cleanUp();
+    m_graphicsPipeline = nullptr;
+    m_pendingGraphicsPipeline.reset();
+    m_reloadedGraphicsPipeline.reset();
+    m_pendingRetireSerials.clear();
+    m_pipelineManifest.save();
+
+    // Every pipeline has been created by now: persist what the driver compiled for the next run
+    m_vulkanPipelineCache.save();
+    m_vulkanPipelineCache.cleanUp();
+
+    m_lightingBenchmark.cleanUp();
+
+    // The workers are stopped: no pipeline is being created against the graph's render passes anymore
+    m_vulkanRenderGraph.cleanUp();
+
+    m_vulkanReadbackRing.cleanUp();
+
+    m_vulkanOffscreenTarget.cleanUp();
+
+    m_vulkanSwapChain.cleanUp();
 
     m_vulkanDevice.cleanUp();
 
@@ -92,4 +897,4 @@ void VulkanRenderer::cleanup()
     }
 
     m_vulkanInstance.cleanUp();
-}
\ No newline at end of file
+}
@@ -0,0 +1,147 @@
+#include "core/renderer/VulkanShaderModuleCache.hpp"
+
+#include "utilities/io/Checksum.hpp"
+#include "utilities/io/MappedFile.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+
+namespace
+{
+    constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+}
+
+VulkanShaderModuleCache::VulkanShaderModuleCache() : m_device(VK_NULL_HANDLE) {}
+
+VulkanShaderModuleCache::~VulkanShaderModuleCache()
+{
+    cleanUp();
+}
+
+void VulkanShaderModuleCache::createCache(const VkDevice &device)
+{
+    m_device = device;
+}
+
+void VulkanShaderModuleCache::cleanUp()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &[key, shaderModule] : m_modules)
+    {
+        vkDestroyShaderModule(m_device, shaderModule.m_module, nullptr);
+    }
+    m_modules.clear();
+    m_stats.m_moduleCount = 0;
+    // The load statistics are kept: they can be reported after the device is gone
+    m_archive.cleanUp();
+}
+
+bool VulkanShaderModuleCache::mountArchive(const std::string &archivePath)
+{
+    return m_archive.open(archivePath);
+}
+
+void VulkanShaderModuleCache::preferFile(const std::string &filePath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_preferredFiles.insert(filePath);
+}
+
+const VulkanShaderModule &VulkanShaderModuleCache::getShaderModule(const std::string &filePath)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    // Mapping and hashing run outside the lock, so workers loading different shaders only wait on each other for module creation
+    std::optional<MappedFile> file;
+    ModuleKey key{};
+    const std::byte *data = nullptr;
+    bool useArchive = m_archive.isOpen();
+    if (useArchive)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        useArchive = (m_preferredFiles.count(filePath) == 0);
+    }
+    const std::optional<ShaderArchiveEntry> archiveEntry = useArchive ? m_archive.find(filePath) : std::nullopt;
+    if (archiveEntry.has_value())
+    {
+        data = archiveEntry->m_data;
+        key = {archiveEntry->m_contentHash, archiveEntry->m_size};
+    }
+    else
+    {
+        file.emplace(filePath);
+        data = file->getData();
+        key = {fnv1a64(data, file->getSize()), file->getSize()};
+    }
+
+    const uint32_t *code = reinterpret_cast<const uint32_t *>(data);
+    if (key.m_size < sizeof(uint32_t) || key.m_size % sizeof(uint32_t) != 0 || code[0] != SPIRV_MAGIC)
+    {
+        throw std::runtime_error("Failed to load shader: " + filePath + " is not a SPIR-V binary");
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Creating the module under the lock: two workers missing on the same binary must not both create it
+    auto [it, isMiss] = m_modules.try_emplace(key);
+    if (isMiss)
+    {
+        try
+        {
+            it->second.m_reflection = ShaderReflection::reflect(code, key.m_size / sizeof(uint32_t));
+        }
+        catch (...)
+        {
+            m_modules.erase(it);
+            throw;
+        }
+
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = key.m_size;
+        createInfo.pCode = code; // Straight from the mapping
+
+        VkResult result = vkCreateShaderModule(m_device, &createInfo, nullptr, &it->second.m_module);
+        if (result != VK_SUCCESS)
+        {
+            m_modules.erase(it);
+            throw std::runtime_error(std::string("Failed to create shader module! VkResult: ") + string_VkResult(result));
+        }
+    }
+
+    const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    VulkanShaderLoadStats &loadStats = m_loadStats[filePath];
+    loadStats.m_path = filePath;
+    loadStats.m_mappedBytes = key.m_size;
+    loadStats.m_isFromArchive = archiveEntry.has_value();
+    loadStats.m_loadCount++;
+    loadStats.m_hitCount += isMiss ? 0 : 1;
+    loadStats.m_loadMs += elapsedMs;
+
+    (isMiss ? m_stats.m_missCount : m_stats.m_hitCount)++;
+    m_stats.m_archiveLoadCount += archiveEntry.has_value() ? 1 : 0;
+    m_stats.m_mappedBytes += key.m_size;
+    m_stats.m_loadMs += elapsedMs;
+    m_stats.m_moduleCount = static_cast<uint32_t>(m_modules.size());
+
+    return it->second;
+}
+
+VulkanShaderModuleCacheStats VulkanShaderModuleCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::vector<VulkanShaderLoadStats> VulkanShaderModuleCache::getLoadStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<VulkanShaderLoadStats> loadStats;
+    loadStats.reserve(m_loadStats.size());
+    for (const auto &[path, stats] : m_loadStats)
+    {
+        loadStats.push_back(stats);
+    }
+    return loadStats;
+}
@@ -0,0 +1,471 @@
+#include "core/renderer/VulkanStagingUploader.hpp"
+
+#include "core/renderer/VulkanDevice.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+#include <vulkan/utility/vk_format_utils.h>
+
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    VkDeviceSize alignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+    {
+        return ((value + alignment - 1) / alignment) * alignment;
+    }
+
+    VkSemaphore createSemaphore(VkDevice device, const void *pNext)
+    {
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = pNext;
+
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+        VkResult result = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore);
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Failed to create upload semaphore! VkResult: ") + string_VkResult(result));
+        }
+        return semaphore;
+    }
+}
+
+VulkanStagingUploader::VulkanStagingUploader()
+    : m_device(VK_NULL_HANDLE), m_memoryAllocator(nullptr), m_transferQueue(VK_NULL_HANDLE), m_transferFamily(0), m_graphicsFamily(0),
+      m_useTimeline(false), m_timelineSemaphore(VK_NULL_HANDLE), m_stagingBuffer(VK_NULL_HANDLE), m_stagingSize(0), m_stagingHead(0),
+      m_stagingUsed(0), m_nextTicket(1), m_retiredTicket(0) {}
+
+VulkanStagingUploader::~VulkanStagingUploader() {}
+
+void VulkanStagingUploader::createUploader(VulkanDevice &vulkanDevice, const VkDeviceSize stagingSize)
+{
+    m_device = vulkanDevice.getDevice();
+    m_memoryAllocator = &vulkanDevice.getMemoryAllocator();
+    m_transferQueue = vulkanDevice.getTransferQueue();
+    m_transferFamily = vulkanDevice.getTransferQueueFamily();
+    m_graphicsFamily = vulkanDevice.getQueueFamilyIndices().m_graphicsFamily.value();
+    m_useTimeline = vulkanDevice.supportsTimelineSemaphores();
+
+    // Command buffers are short lived (one per batch) and recycled individually
+    m_commandPool.createCommandPool(m_device, m_transferFamily, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+
+    // A single timeline semaphore replaces a semaphore and a fence per batch: batch N signals value N
+    if (m_useTimeline)
+    {
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+        m_timelineSemaphore = createSemaphore(m_device, &typeInfo);
+    }
+
+    // Staging ring, persistently mapped and coherent so the CPU writes never need a flush
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = stagingSize;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkResult result = vkCreateBuffer(m_device, &bufferInfo, nullptr, &m_stagingBuffer);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create staging buffer! VkResult: ") + string_VkResult(result));
+    }
+    m_stagingAllocation = m_memoryAllocator->allocateForBuffer(m_stagingBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    m_stagingSize = stagingSize;
+    m_stagingHead = 0;
+    m_stagingUsed = 0;
+    m_nextTicket = 1;
+    m_retiredTicket = 0;
+}
+
+// Ring allocation: the range wraps to the start of the buffer when it does not fit before the end (the skipped tail counts as used
+// until its batch retires). consumedBytes is what the batch has to give back when it retires.
+std::optional<VkDeviceSize> VulkanStagingUploader::allocateStaging(const VkDeviceSize size, const VkDeviceSize alignment, VkDeviceSize &consumedBytes)
+{
+    if (m_stagingUsed == 0)
+    {
+        m_stagingHead = 0;
+    }
+
+    // The free range starts at the head and wraps around up to the oldest range still in use
+    const VkDeviceSize freeBytes = m_stagingSize - m_stagingUsed;
+    VkDeviceSize offset = alignUp(m_stagingHead, alignment);
+    if (offset + size > m_stagingSize)
+    {
+        offset = 0; // Wrap
+    }
+
+    consumedBytes = (offset >= m_stagingHead) ? (offset + size - m_stagingHead) : (m_stagingSize - m_stagingHead + offset + size);
+    if (consumedBytes > freeBytes)
+    {
+        return std::nullopt;
+    }
+
+    m_stagingHead = (offset + size) % m_stagingSize;
+    m_stagingUsed += consumedBytes;
+    return offset;
+}
+
+VulkanStagingUploader::Batch &VulkanStagingUploader::getRecordingBatch()
+{
+    if (m_recordingBatch.has_value())
+    {
+        return m_recordingBatch.value();
+    }
+
+    Batch batch{};
+    batch.m_ticket = m_nextTicket++;
+
+    if (m_freeCommandBuffers.empty())
+    {
+        m_freeCommandBuffers = m_commandPool.allocateCommandBuffers(1);
+    }
+    batch.m_commandBuffer = m_freeCommandBuffers.back();
+    m_freeCommandBuffers.pop_back();
+
+    if (!m_useTimeline)
+    {
+        if (m_freeSemaphores.empty())
+        {
+            m_freeSemaphores.push_back(createSemaphore(m_device, nullptr));
+        }
+        batch.m_semaphore = m_freeSemaphores.back();
+        m_freeSemaphores.pop_back();
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VkResult result = vkBeginCommandBuffer(batch.m_commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to begin recording upload command buffer! VkResult: ") + string_VkResult(result));
+    }
+
+    m_recordingBatch = std::move(batch);
+    return m_recordingBatch.value();
+}
+
+std::optional<uint64_t> VulkanStagingUploader::uploadBuffer(VkBuffer buffer, const VkDeviceSize bufferOffset, const void *data, const VkDeviceSize size,
+                                                            const VkPipelineStageFlags dstStageMask, const VkAccessFlags dstAccessMask)
+{
+    if (size == 0 || size > m_stagingSize)
+    {
+        throw std::runtime_error("Upload size must be non-zero and fit in the staging buffer!");
+    }
+
+    VkDeviceSize consumedBytes = 0;
+    const std::optional<VkDeviceSize> stagingOffset = allocateStaging(size, 16, consumedBytes);
+    if (!stagingOffset.has_value())
+    {
+        m_stats.m_deferredUploadCount++;
+        return std::nullopt;
+    }
+    std::memcpy(m_stagingAllocation.m_mapped + stagingOffset.value(), data, size);
+
+    Batch &batch = getRecordingBatch();
+    batch.m_stagingBytes += consumedBytes;
+
+    VkBufferCopy region{};
+    region.srcOffset = stagingOffset.value();
+    region.dstOffset = bufferOffset;
+    region.size = size;
+    vkCmdCopyBuffer(batch.m_commandBuffer, m_stagingBuffer, buffer, 1, &region);
+
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.buffer = buffer;
+    barrier.offset = bufferOffset;
+    barrier.size = size;
+
+    if (transfersOwnership())
+    {
+        // Release on the transfer queue. The destination access is ignored here, it is made visible by the acquire barrier
+        barrier.srcQueueFamilyIndex = m_transferFamily;
+        barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(batch.m_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+        // Matching acquire, recorded by the graphics queue
+        VkBufferMemoryBarrier acquire = barrier;
+        acquire.srcAccessMask = 0;
+        acquire.dstAccessMask = dstAccessMask;
+        batch.m_bufferAcquires.push_back(acquire);
+    }
+    else
+    {
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstAccessMask = dstAccessMask;
+        vkCmdPipelineBarrier(batch.m_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+    batch.m_acquireStageMask |= dstStageMask;
+
+    m_stats.m_uploadCount++;
+    m_stats.m_uploadedBytes += size;
+    return batch.m_ticket;
+}
+
+std::optional<uint64_t> VulkanStagingUploader::uploadImage(VkImage image, const VkFormat format, const VkExtent3D extent, const void *data, const VkDeviceSize size,
+                                                           const VkImageLayout finalLayout, const VkPipelineStageFlags dstStageMask, const VkAccessFlags dstAccessMask)
+{
+    if (size == 0 || size > m_stagingSize)
+    {
+        throw std::runtime_error("Upload size must be non-zero and fit in the staging buffer!");
+    }
+
+    // vkCmdCopyBufferToImage requires the buffer offset to be a multiple of the texel size and of 4
+    const VkDeviceSize alignment = std::lcm(static_cast<VkDeviceSize>(vkuFormatElementSize(format)), VkDeviceSize(4));
+    VkDeviceSize consumedBytes = 0;
+    const std::optional<VkDeviceSize> stagingOffset = allocateStaging(size, alignment, consumedBytes);
+    if (!stagingOffset.has_value())
+    {
+        m_stats.m_deferredUploadCount++;
+        return std::nullopt;
+    }
+    std::memcpy(m_stagingAllocation.m_mapped + stagingOffset.value(), data, size);
+
+    Batch &batch = getRecordingBatch();
+    batch.m_stagingBytes += consumedBytes;
+
+    // The previous content is discarded: transition from UNDEFINED to be written by the copy
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(batch.m_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = stagingOffset.value();
+    region.bufferRowLength = 0; // Tightly packed
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = extent;
+    vkCmdCopyBufferToImage(batch.m_commandBuffer, m_stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    // Transition to the final layout. With an ownership transfer, the release and the acquire must both specify the same layouts
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = finalLayout;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    if (transfersOwnership())
+    {
+        barrier.srcQueueFamilyIndex = m_transferFamily;
+        barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(batch.m_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkImageMemoryBarrier acquire = barrier;
+        acquire.srcAccessMask = 0;
+        acquire.dstAccessMask = dstAccessMask;
+        batch.m_imageAcquires.push_back(acquire);
+    }
+    else
+    {
+        barrier.dstAccessMask = dstAccessMask;
+        vkCmdPipelineBarrier(batch.m_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+    batch.m_acquireStageMask |= dstStageMask;
+
+    m_stats.m_uploadCount++;
+    m_stats.m_uploadedBytes += size;
+    return batch.m_ticket;
+}
+
+// Submits every upload recorded since the last call in a single batch. Does nothing if there is nothing to upload
+void VulkanStagingUploader::submit()
+{
+    if (!m_recordingBatch.has_value())
+    {
+        return;
+    }
+
+    Batch batch = std::move(m_recordingBatch.value());
+    m_recordingBatch.reset();
+
+    VkResult result = vkEndCommandBuffer(batch.m_commandBuffer);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to record upload command buffer! VkResult: ") + string_VkResult(result));
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.m_commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    if (m_useTimeline)
+    {
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &batch.m_ticket;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.pSignalSemaphores = &m_timelineSemaphore;
+    }
+    else
+    {
+        submitInfo.pSignalSemaphores = &batch.m_semaphore;
+    }
+
+    // No fence: the batch is known to be complete once the graphics frame that waited on its semaphore has completed
+    result = vkQueueSubmit(m_transferQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to submit upload command buffer! VkResult: ") + string_VkResult(result));
+    }
+
+    m_stats.m_batchCount++;
+    m_submittedBatches.push_back(std::move(batch));
+}
+
+// Acquires the batches submitted since the previous frame: the ownership acquire barriers are recorded at the start of the
+// graphics command buffer, and the returned semaphores must be waited on by the submit of that command buffer
+std::vector<VulkanSemaphoreWait> VulkanStagingUploader::recordGraphicsAcquire(VkCommandBuffer graphicsCommandBuffer, const uint64_t frameNumber)
+{
+    std::vector<VulkanSemaphoreWait> waits;
+    std::vector<VkBufferMemoryBarrier> bufferAcquires;
+    std::vector<VkImageMemoryBarrier> imageAcquires;
+    VkPipelineStageFlags stageMask = 0;
+    uint64_t lastTicket = 0;
+
+    for (Batch &batch : m_submittedBatches)
+    {
+        if (batch.m_isAcquired)
+        {
+            continue;
+        }
+        batch.m_isAcquired = true;
+        batch.m_acquireFrameNumber = frameNumber;
+
+        bufferAcquires.insert(bufferAcquires.end(), batch.m_bufferAcquires.begin(), batch.m_bufferAcquires.end());
+        imageAcquires.insert(imageAcquires.end(), batch.m_imageAcquires.begin(), batch.m_imageAcquires.end());
+        stageMask |= batch.m_acquireStageMask;
+        lastTicket = batch.m_ticket;
+
+        if (!m_useTimeline)
+        {
+            waits.push_back(VulkanSemaphoreWait{batch.m_semaphore, 0, false, batch.m_acquireStageMask});
+        }
+    }
+
+    // Batches are signaled in order: waiting for the last value covers every earlier batch
+    if (m_useTimeline && lastTicket != 0)
+    {
+        waits.push_back(VulkanSemaphoreWait{m_timelineSemaphore, lastTicket, true, stageMask});
+    }
+
+    // The semaphore wait covers the stages in stageMask, so the acquire only has to be ordered after them
+    if (!bufferAcquires.empty() || !imageAcquires.empty())
+    {
+        vkCmdPipelineBarrier(graphicsCommandBuffer, stageMask, stageMask, 0, 0, nullptr,
+                             static_cast<uint32_t>(bufferAcquires.size()), bufferAcquires.data(),
+                             static_cast<uint32_t>(imageAcquires.size()), imageAcquires.data());
+    }
+
+    return waits;
+}
+
+void VulkanStagingUploader::retire(const uint64_t completedFrameCount)
+{
+    // The graphics frame that acquired a batch waited on its semaphore: once that frame has completed, so has the copy
+    while (!m_submittedBatches.empty())
+    {
+        Batch &batch = m_submittedBatches.front();
+        if (!batch.m_acquireFrameNumber.has_value() || batch.m_acquireFrameNumber.value() >= completedFrameCount)
+        {
+            break;
+        }
+
+        m_stagingUsed -= batch.m_stagingBytes;
+        m_retiredTicket = batch.m_ticket;
+        recycleBatch(batch);
+        m_submittedBatches.pop_front();
+    }
+}
+
+void VulkanStagingUploader::recycleBatch(Batch &batch)
+{
+    vkResetCommandBuffer(batch.m_commandBuffer, 0);
+    m_freeCommandBuffers.push_back(batch.m_commandBuffer);
+    batch.m_commandBuffer = VK_NULL_HANDLE;
+
+    // A binary semaphore is unsignaled again once its wait has completed, it can be signaled by another batch
+    if (batch.m_semaphore != VK_NULL_HANDLE)
+    {
+        m_freeSemaphores.push_back(batch.m_semaphore);
+        batch.m_semaphore = VK_NULL_HANDLE;
+    }
+}
+
+// The device must be idle
+void VulkanStagingUploader::cleanUp()
+{
+    if (m_device == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    if (m_recordingBatch.has_value() && m_recordingBatch->m_semaphore != VK_NULL_HANDLE)
+    {
+        m_freeSemaphores.push_back(m_recordingBatch->m_semaphore);
+    }
+    m_recordingBatch.reset();
+    for (Batch &batch : m_submittedBatches)
+    {
+        if (batch.m_semaphore != VK_NULL_HANDLE)
+        {
+            m_freeSemaphores.push_back(batch.m_semaphore);
+        }
+    }
+    m_submittedBatches.clear();
+
+    for (VkSemaphore semaphore : m_freeSemaphores)
+    {
+        vkDestroySemaphore(m_device, semaphore, nullptr);
+    }
+    m_freeSemaphores.clear();
+
+    if (m_timelineSemaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(m_device, m_timelineSemaphore, nullptr);
+        m_timelineSemaphore = VK_NULL_HANDLE;
+    }
+
+    // Command buffers are freed together with their pool
+    m_freeCommandBuffers.clear();
+    m_commandPool.cleanUp();
+
+    if (m_stagingBuffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(m_device, m_stagingBuffer, nullptr);
+        m_stagingBuffer = VK_NULL_HANDLE;
+    }
+    m_memoryAllocator->free(m_stagingAllocation);
+
+    m_stagingHead = 0;
+    m_stagingUsed = 0;
+    m_device = VK_NULL_HANDLE;
+}
@@ -4,7 +4,10 @@
 #include "core/system/window/WindowHandler.hpp"
 
 #include <vulkan/vk_enum_string_helper.h>
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
+#include <utility>
 
 SwapChainSupportDetails querySwapChainSupport(const VkPhysicalDevice &physicalDevice, const VkSurfaceKHR &surface)
 {
@@ -35,11 +38,28 @@ SwapChainSupportDetails querySwapChainSupport(const VkPhysicalDevice &physicalDe
     return details;
 }
 
-VulkanSwapChain::VulkanSwapChain() : m_swapChain(VK_NULL_HANDLE) {}
+const char *presentPolicyToString(const VulkanPresentPolicy policy)
+{
+    switch (policy)
+    {
+    case VulkanPresentPolicy::LOW_LATENCY:
+        return "low-latency";
+    case VulkanPresentPolicy::THROUGHPUT:
+        return "throughput";
+    case VulkanPresentPolicy::POWER_SAVING:
+        return "power-saving";
+    case VulkanPresentPolicy::UNCAPPED:
+        return "uncapped";
+    }
+    return "unknown";
+}
+
+VulkanSwapChain::VulkanSwapChain() : m_swapChain(VK_NULL_HANDLE), m_device(VK_NULL_HANDLE), m_presentPolicy(VulkanPresentPolicy::THROUGHPUT) {}
 
 VulkanSwapChain::~VulkanSwapChain() {}
 
-void VulkanSwapChain::createSwapChain(const VkDevice &device, const VkPhysicalDevice &physicalDevice, const VkSurfaceKHR &surface, const int widthPx, const int heightPx)
+void VulkanSwapChain::createSwapChain(const VkDevice &device, const VkPhysicalDevice &physicalDevice, const VkSurfaceKHR &surface, const int widthPx, const int heightPx,
+                                      const VkSwapchainKHR oldSwapChain)
 {
     SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice, surface);
 
@@ -47,21 +67,7 @@ void VulkanSwapChain::createSwapChain(const VkDevice &device, const VkPhysicalDe
     VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.m_presentModes);
     VkExtent2D extent = chooseSwapExtent(swapChainSupport.m_capabilities, widthPx, heightPx);
 
-    // How many images we would like to have in the swap chain.
-    // Sticking to this minimum means that we may sometimes have to wait on the driver to complete internal operations
-    // before we can acquire another image to render to.
-    // Therefore it is recommended to request at least one more image than the minimum but not exceeding the maximum number of images
-    // If maximum number of images is 0, it means that there is not limit
-    uint32_t imageCount;
-    if (swapChainSupport.m_capabilities.maxImageCount == 0 ||
-        swapChainSupport.m_capabilities.minImageCount + 1 < swapChainSupport.m_capabilities.maxImageCount)
-    {
-        imageCount = swapChainSupport.m_capabilities.minImageCount + 1;
-    }
-    else
-    {
-        imageCount = swapChainSupport.m_capabilities.maxImageCount;
-    }
+    uint32_t imageCount = chooseSwapImageCount(swapChainSupport.m_capabilities, presentMode);
 
     VkSwapchainCreateInfoKHR createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -99,7 +105,9 @@ void VulkanSwapChain::createSwapChain(const VkDevice &device, const VkPhysicalDe
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE; // we don't care about the color of pixels that are obscured, for example because another window is in front of them.
 
-    createInfo.oldSwapchain = VK_NULL_HANDLE; // If the swap chain becomes invalid or unoptimized while your application is running, for example because the window was resized
+    // If the swap chain becomes invalid or unoptimized while your application is running, for example because the window was resized,
+    // the new swap chain is created with a reference to the old one so in-flight presentation can complete and resources can be reused
+    createInfo.oldSwapchain = oldSwapChain;
 
     VkResult result = vkCreateSwapchainKHR(device, &createInfo, nullptr, &m_swapChain);
     if (result != VK_SUCCESS)
@@ -114,6 +122,11 @@ void VulkanSwapChain::createSwapChain(const VkDevice &device, const VkPhysicalDe
 
     m_swapChainImageFormat = surfaceFormat.format;
     m_swapChainExtent = extent;
+
+    m_presentConfiguration.m_policy = m_presentPolicy;
+    m_presentConfiguration.m_presentMode = presentMode;
+    m_presentConfiguration.m_imageCount = imageCount;
+    m_presentConfiguration.m_extent = extent;
 }
 
 VkSurfaceFormatKHR VulkanSwapChain::chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &supportedFormats)
@@ -134,25 +147,70 @@ VkSurfaceFormatKHR VulkanSwapChain::chooseSwapSurfaceFormat(const std::vector<Vk
 }
 
 // Present Mode is the most important setting for the swap chain, because it represents the actual conditions for showing images to the screen.
+// - VK_PRESENT_MODE_IMMEDIATE_KHR: images are transferred to the screen right away, which may result in tearing.
+// - VK_PRESENT_MODE_FIFO_KHR: the display takes images from a queue on vertical blank, the application waits if the queue is full (vsync).
+// - VK_PRESENT_MODE_MAILBOX_KHR: like FIFO, but instead of blocking when the queue is full the queued images are replaced with newer ones.
+//   This renders frames as fast as possible while still avoiding tearing, with fewer latency issues than standard vsync ("triple buffering").
+// On mobile devices, where energy usage is more important, FIFO might be used instead of MAILBOX.
 VkPresentModeKHR VulkanSwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &supportedPresentModes)
 {
+    std::vector<VkPresentModeKHR> preferredPresentModes;
+    switch (m_presentPolicy)
+    {
+    case VulkanPresentPolicy::LOW_LATENCY:
+    case VulkanPresentPolicy::THROUGHPUT:
+        preferredPresentModes = {VK_PRESENT_MODE_MAILBOX_KHR};
+        break;
+    case VulkanPresentPolicy::POWER_SAVING:
+        break;
+    case VulkanPresentPolicy::UNCAPPED:
+        preferredPresentModes = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+        break;
+    }
 
-    for (const auto &supportedPresentMode : supportedPresentModes)
+    for (const VkPresentModeKHR preferredPresentMode : preferredPresentModes)
     {
-        // VK_PRESENT_MODE_MAILBOX_KHR is similar to VK_PRESENT_MODE_FIFO_KHR however instead of blocking the application when the queue is full,
-        // the images that are already queued are simply replaced with the newer ones.
-        // This mode can be used to render frames as fast as possible while still avoiding tearing, resulting in fewer latency issues than standard vertical sync.
-        // This is commonly known as "triple buffering".
-        // On mobile devices, where energy usage is more important, VK_PRESENT_MODE_FIFO_KHR might be used instead of VK_PRESENT_MODE_MAILBOX_KHR.
-        if (supportedPresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+        for (const auto &supportedPresentMode : supportedPresentModes)
         {
-            return supportedPresentMode;
+            if (supportedPresentMode == preferredPresentMode)
+            {
+                return supportedPresentMode;
+            }
         }
     }
 
     return VK_PRESENT_MODE_FIFO_KHR; // The only present mode guaranteed to be available
 }
 
+// How many images we would like to have in the swap chain.
+// Sticking to the minimum means that we may sometimes have to wait on the driver to complete internal operations
+// before we can acquire another image to render to, but every extra image queued for FIFO presentation adds a frame of latency.
+uint32_t VulkanSwapChain::chooseSwapImageCount(const VkSurfaceCapabilitiesKHR &capabilities, const VkPresentModeKHR presentMode)
+{
+    uint32_t imageCount = capabilities.minImageCount + 1;
+    switch (m_presentPolicy)
+    {
+    case VulkanPresentPolicy::LOW_LATENCY:
+        // MAILBOX needs a spare image to replace, FIFO is fastest with the shortest queue
+        imageCount = (presentMode == VK_PRESENT_MODE_MAILBOX_KHR) ? std::max(capabilities.minImageCount + 1, 3u) : capabilities.minImageCount;
+        break;
+    case VulkanPresentPolicy::THROUGHPUT:
+    case VulkanPresentPolicy::UNCAPPED:
+        imageCount = capabilities.minImageCount + 1;
+        break;
+    case VulkanPresentPolicy::POWER_SAVING:
+        imageCount = capabilities.minImageCount;
+        break;
+    }
+
+    // If maximum number of images is 0, it means that there is not limit
+    if (capabilities.maxImageCount != 0)
+    {
+        imageCount = std::min(imageCount, capabilities.maxImageCount);
+    }
+    return imageCount;
+}
+
 // The swap extent is the resolution of the swap chain images
 VkExtent2D VulkanSwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities, const int widthPx, const int heightPx)
 {
@@ -217,6 +275,42 @@ void VulkanSwapChain::createImageViews()
     }
 }
 
+RetiredSwapChain VulkanSwapChain::recreateSwapChain(const VkPhysicalDevice &physicalDevice, const VkSurfaceKHR &surface, const int widthPx, const int heightPx)
+{
+    RetiredSwapChain retiredSwapChain{};
+    retiredSwapChain.m_swapChain = m_swapChain;
+    retiredSwapChain.m_imageViews = std::move(m_swapChainImageViews);
+    m_swapChainImageViews.clear();
+
+    try
+    {
+        createSwapChain(m_device, physicalDevice, surface, widthPx, heightPx, retiredSwapChain.m_swapChain);
+    }
+    catch (...)
+    {
+        // Keep ownership of the previous swap chain consistent if the new one could not be created
+        m_swapChain = retiredSwapChain.m_swapChain;
+        m_swapChainImageViews = std::move(retiredSwapChain.m_imageViews);
+        throw;
+    }
+    createImageViews();
+
+    return retiredSwapChain;
+}
+
+void VulkanSwapChain::destroyRetiredSwapChain(const RetiredSwapChain &retiredSwapChain)
+{
+    for (VkImageView imageView : retiredSwapChain.m_imageViews)
+    {
+        vkDestroyImageView(m_device, imageView, nullptr);
+    }
+
+    if (retiredSwapChain.m_swapChain != VK_NULL_HANDLE)
+    {
+        vkDestroySwapchainKHR(m_device, retiredSwapChain.m_swapChain, nullptr);
+    }
+}
+
 void VulkanSwapChain::cleanUp()
 {
     for (auto imageView : m_swapChainImageViews)
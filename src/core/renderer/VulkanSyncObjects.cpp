@@ -0,0 +1,92 @@
+#include "core/renderer/VulkanSyncObjects.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+#include <stdexcept>
+#include <string>
+
+VulkanSyncObjects::VulkanSyncObjects() : m_device(VK_NULL_HANDLE) {}
+
+VulkanSyncObjects::~VulkanSyncObjects() {}
+
+void VulkanSyncObjects::createSyncObjects(const VkDevice &device, const uint32_t framesInFlight)
+{
+    m_device = device;
+
+    m_imageAvailableSemaphores.resize(framesInFlight, VK_NULL_HANDLE);
+    m_inFlightFences.resize(framesInFlight, VK_NULL_HANDLE);
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    // Fences are created signaled so the first wait on each frame slot returns immediately
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    for (uint32_t i = 0; i < framesInFlight; i++)
+    {
+        VkResult result = vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_imageAvailableSemaphores[i]);
+        if (result == VK_SUCCESS)
+        {
+            result = vkCreateFence(m_device, &fenceInfo, nullptr, &m_inFlightFences[i]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Failed to create synchronization objects for a frame! VkResult: ") + string_VkResult(result));
+        }
+    }
+}
+
+std::vector<VkSemaphore> VulkanSyncObjects::recreateRenderFinishedSemaphores(const uint32_t swapChainImageCount)
+{
+    std::vector<VkSemaphore> retiredSemaphores = std::move(m_renderFinishedSemaphores);
+    m_renderFinishedSemaphores.assign(swapChainImageCount, VK_NULL_HANDLE);
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (uint32_t i = 0; i < swapChainImageCount; i++)
+    {
+        const VkResult result = vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_renderFinishedSemaphores[i]);
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Failed to create render finished semaphore for a swap chain image! VkResult: ") + string_VkResult(result));
+        }
+    }
+    return retiredSemaphores;
+}
+
+void VulkanSyncObjects::destroyRetiredSemaphores(const std::vector<VkSemaphore> &semaphores) const
+{
+    for (VkSemaphore semaphore : semaphores)
+    {
+        if (semaphore != VK_NULL_HANDLE)
+        {
+            vkDestroySemaphore(m_device, semaphore, nullptr);
+        }
+    }
+}
+
+void VulkanSyncObjects::cleanUp()
+{
+    for (VkSemaphore semaphore : m_imageAvailableSemaphores)
+    {
+        if (semaphore != VK_NULL_HANDLE)
+        {
+            vkDestroySemaphore(m_device, semaphore, nullptr);
+        }
+    }
+    m_imageAvailableSemaphores.clear();
+
+    destroyRetiredSemaphores(m_renderFinishedSemaphores);
+    m_renderFinishedSemaphores.clear();
+
+    for (VkFence fence : m_inFlightFences)
+    {
+        if (fence != VK_NULL_HANDLE)
+        {
+            vkDestroyFence(m_device, fence, nullptr);
+        }
+    }
+    m_inFlightFences.clear();
+}
@@ -0,0 +1,142 @@
+#include "core/renderer/VulkanUploadArena.hpp"
+
+#include "core/renderer/VulkanDevice.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    VkDeviceSize alignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+    {
+        return ((value + alignment - 1) / alignment) * alignment;
+    }
+}
+
+VulkanUploadArena::VulkanUploadArena()
+    : m_device(VK_NULL_HANDLE), m_memoryAllocator(nullptr), m_usage(0), m_chunkSize(DEFAULT_CHUNK_SIZE), m_defaultAlignment(1), m_currentFrame(0) {}
+
+VulkanUploadArena::~VulkanUploadArena() {}
+
+void VulkanUploadArena::createArena(VulkanDevice &vulkanDevice, const uint32_t framesInFlight, const VkDeviceSize chunkSize, const VkBufferUsageFlags usage)
+{
+    m_device = vulkanDevice.getDevice();
+    m_memoryAllocator = &vulkanDevice.getMemoryAllocator();
+    m_usage = usage;
+    m_chunkSize = chunkSize;
+
+    const VkPhysicalDeviceLimits &limits = vulkanDevice.getPhysicalDeviceProperties().limits;
+    m_defaultAlignment = std::max({limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment, VkDeviceSize(16)});
+
+    m_frames.resize(framesInFlight);
+    for (Frame &frame : m_frames)
+    {
+        frame.m_chunks.push_back(createChunk(m_chunkSize));
+    }
+    m_currentFrame = 0;
+}
+
+VulkanUploadArena::Chunk VulkanUploadArena::createChunk(const VkDeviceSize size)
+{
+    Chunk chunk{};
+    chunk.m_size = size;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = m_usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkResult result = vkCreateBuffer(m_device, &bufferInfo, nullptr, &chunk.m_buffer);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create upload arena buffer! VkResult: ") + string_VkResult(result));
+    }
+
+    // Coherent so writes never need a flush. DEVICE_LOCAL is preferred: where the device exposes host-visible VRAM (resizable BAR
+    // or the 256 MiB window of discrete GPUs) the GPU reads the data without going over PCIe
+    chunk.m_allocation = m_memoryAllocator->allocateForBuffer(chunk.m_buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    m_stats.m_capacityBytes += size;
+    return chunk;
+}
+
+void VulkanUploadArena::destroyChunk(Chunk &chunk)
+{
+    if (chunk.m_buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(m_device, chunk.m_buffer, nullptr);
+        chunk.m_buffer = VK_NULL_HANDLE;
+    }
+    m_memoryAllocator->free(chunk.m_allocation);
+    m_stats.m_capacityBytes -= chunk.m_size;
+}
+
+void VulkanUploadArena::beginFrame(const uint32_t frameIndex)
+{
+    m_currentFrame = frameIndex;
+    Frame &frame = m_frames[frameIndex];
+
+    // The slot overflowed last time: replace its chained chunks by a single one that fits the whole frame
+    if (frame.m_chunks.size() > 1)
+    {
+        const VkDeviceSize mergedSize = alignUp(std::max(frame.m_usedBytes, m_stats.m_highWaterMark), m_chunkSize);
+        for (Chunk &chunk : frame.m_chunks)
+        {
+            destroyChunk(chunk);
+        }
+        frame.m_chunks.clear();
+        frame.m_chunks.push_back(createChunk(mergedSize));
+    }
+
+    frame.m_head = 0;
+    frame.m_usedBytes = 0;
+    m_stats.m_usedBytes = 0;
+}
+
+VulkanUploadAllocation VulkanUploadArena::allocate(const VkDeviceSize size, const VkDeviceSize alignment)
+{
+    Frame &frame = m_frames[m_currentFrame];
+    const VkDeviceSize requiredAlignment = (alignment != 0) ? alignment : m_defaultAlignment;
+
+    VkDeviceSize offset = alignUp(frame.m_head, requiredAlignment);
+    if (offset + size > frame.m_chunks.back().m_size)
+    {
+        // Overflow: chain another chunk for the rest of this frame, at least as large as the request
+        frame.m_chunks.push_back(createChunk(std::max(m_chunkSize, alignUp(size, m_chunkSize))));
+        m_stats.m_overflowCount++;
+        frame.m_head = 0;
+        offset = 0;
+    }
+
+    const Chunk &chunk = frame.m_chunks.back();
+    frame.m_usedBytes += (offset + size) - frame.m_head; // Alignment padding included
+    frame.m_head = offset + size;
+
+    m_stats.m_usedBytes = frame.m_usedBytes;
+    m_stats.m_highWaterMark = std::max(m_stats.m_highWaterMark, frame.m_usedBytes);
+
+    VulkanUploadAllocation allocation{};
+    allocation.m_buffer = chunk.m_buffer;
+    allocation.m_offset = offset;
+    allocation.m_size = size;
+    allocation.m_mapped = chunk.m_allocation.m_mapped + offset;
+    return allocation;
+}
+
+void VulkanUploadArena::cleanUp()
+{
+    for (Frame &frame : m_frames)
+    {
+        for (Chunk &chunk : frame.m_chunks)
+        {
+            destroyChunk(chunk);
+        }
+    }
+    m_frames.clear();
+    m_currentFrame = 0;
+}
@@ -1,5 +1,6 @@
 #include "core/renderer/VulkanValidationLayer.hpp"
 
+#include <cstring>
 #include <iostream>
 
 VulkanValidationLayer::VulkanValidationLayer() {}
@@ -5,13 +5,15 @@
 #define VK_USE_PLATFORM_MACOS_MVK
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+#if defined(__APPLE__)
 #define GLFW_EXPOSE_NATIVE_COCOA
 #include <GLFW/glfw3native.h>
+#endif
 
 #include <stdexcept>
 
 WindowHandler::WindowHandler(const int width, const int height, const char *title)
-    : m_width(width), m_height(height), m_title(title), m_window(nullptr) {}
+    : m_width(width), m_height(height), m_title(title), m_window(nullptr), m_framebufferResized(false) {}
 
 WindowHandler::~WindowHandler() {}
 
@@ -25,8 +27,8 @@ void WindowHandler::init()
 
     // No OpenGL context
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    // Don't allow to resize window
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+    // Allow to resize window (the renderer recreates the swap chain when the framebuffer size changes)
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
     // Create window
     m_window = glfwCreateWindow(m_width, m_height, "Vulkan", nullptr, nullptr);
@@ -34,6 +36,16 @@ void WindowHandler::init()
     {
         throw std::runtime_error("Failed to create GLFW Window\n");
     }
+
+    // GLFW callbacks are plain functions, so the handler is stored in the window to reach it from the callback
+    glfwSetWindowUserPointer(m_window, this);
+    glfwSetFramebufferSizeCallback(m_window, framebufferResizeCallback);
+}
+
+void WindowHandler::framebufferResizeCallback(GLFWwindow *window, [[maybe_unused]] int width, [[maybe_unused]] int height)
+{
+    WindowHandler *windowHandler = static_cast<WindowHandler *>(glfwGetWindowUserPointer(window));
+    windowHandler->m_framebufferResized = true;
 }
 
 void WindowHandler::GetWindowFramebufferSize(int *width, int *height)
@@ -43,6 +55,9 @@ void WindowHandler::GetWindowFramebufferSize(int *width, int *height)
 
 void *WindowHandler::GetMetalLayer()
 {
+#if !defined(__APPLE__)
+    throw std::runtime_error("Metal layers are only available on macOS, use headless mode on this platform!");
+#else
     // Retrieve the Cocoa window handle (NSWindow*)
     void *windowHandle = glfwGetCocoaWindow(m_window);
     if (!m_window)
@@ -58,6 +73,7 @@ void *WindowHandler::GetMetalLayer()
     }
 
     return getMetalLayerFromView(viewHandle);
+#endif
 }
 
 void WindowHandler::pollEvents()
@@ -65,6 +81,11 @@ void WindowHandler::pollEvents()
     glfwPollEvents();
 }
 
+void WindowHandler::waitEvents()
+{
+    glfwWaitEvents();
+}
+
 bool WindowHandler::shouldClose() const
 {
     return glfwWindowShouldClose(m_window);
@@ -0,0 +1,269 @@
+#include "graphics/LightingBenchmark.hpp"
+
+#include "core/renderer/VulkanDevice.hpp"
+#include "core/renderer/VulkanRenderGraph.hpp"
+#include "graphics/Shader.hpp"
+#include "utilities/renderer/VulkanPipelinePresets.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    constexpr uint32_t LIGHT_COUNT_CONSTANT_ID = 0; // LIGHT_COUNT in lighting.glsl
+    constexpr uint32_t CUBE_VERTEX_COUNT = 36;
+    constexpr float TIME_STEP = 1.0f / 60.0f; // Per frame
+
+    // Render graph names
+    const std::string FORWARD_PASS = "ForwardLighting";
+    const std::string GBUFFER_PASS = "GBuffer";
+    const std::string LIGHTING_PASS = "DeferredLighting";
+    const std::string SCENE_DEPTH = "SceneDepth";
+
+    struct GBufferImage
+    {
+        const char *m_name;
+        VkFormat m_format;
+    };
+
+    // In the order of the input attachment indices of lighting_deferred.frag (and of the outputs of lighting_gbuffer.frag)
+    constexpr GBufferImage GBUFFER_IMAGES[] = {
+        {"GBufferAlbedo", VK_FORMAT_R8G8B8A8_UNORM},
+        {"GBufferNormal", VK_FORMAT_R16G16B16A16_SFLOAT},
+        {"GBufferPosition", VK_FORMAT_R16G16B16A16_SFLOAT},
+    };
+    constexpr uint32_t GBUFFER_IMAGE_COUNT = sizeof(GBUFFER_IMAGES) / sizeof(GBUFFER_IMAGES[0]);
+
+    void setViewportAndScissor(VkCommandBuffer commandBuffer, const VkExtent2D extent)
+    {
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(extent.width);
+        viewport.height = static_cast<float>(extent.height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+        VkRect2D scissor{};
+        scissor.offset = {0, 0};
+        scissor.extent = extent;
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    }
+
+    VkShaderStageFlags getPushConstantStages(const VulkanPipelineLayout &layout, const uint32_t size, const std::string &shaderName)
+    {
+        if (!layout.m_pushConstantRange.has_value() || layout.m_pushConstantRange->size != size)
+        {
+            throw std::runtime_error(shaderName + " does not match LightingBenchmark: expected " + std::to_string(size) + " bytes of push constants");
+        }
+        return layout.m_pushConstantRange->stageFlags;
+    }
+}
+
+const char *lightingPathToString(const LightingPath path)
+{
+    switch (path)
+    {
+    case LightingPath::FORWARD:
+        return "forward";
+    case LightingPath::DEFERRED:
+        return "deferred";
+    }
+    return "unknown";
+}
+
+LightingBenchmark::LightingBenchmark()
+    : m_device(VK_NULL_HANDLE), m_path(LightingPath::DEFERRED), m_lightCount(0), m_frameCount(0), m_time(0.0f),
+      m_scenePushConstantStages(0), m_lightingPushConstantStages(0),
+      m_gBufferSetLayout(VK_NULL_HANDLE), m_descriptorPool(VK_NULL_HANDLE), m_descriptorSet(VK_NULL_HANDLE) {}
+
+LightingBenchmark::~LightingBenchmark() {}
+
+void LightingBenchmark::declarePasses(VulkanRenderGraph &graph, const std::string &target, const LightingPath path, const uint32_t lightCount)
+{
+    m_path = path;
+    m_lightCount = lightCount;
+
+    graph.createImage(SCENE_DEPTH, VulkanRenderGraphImageDescription{VK_FORMAT_D32_SFLOAT});
+
+    if (m_path == LightingPath::FORWARD)
+    {
+        graph.addPass(FORWARD_PASS)
+            .writeColor(target)
+            .writeDepth(SCENE_DEPTH)
+            .setRecord([this](VkCommandBuffer commandBuffer, const VulkanRenderGraphPassContext &context)
+                       { recordScene(commandBuffer, context); });
+        return;
+    }
+
+    VulkanRenderGraphPass &gBufferPass = graph.addPass(GBUFFER_PASS);
+    VulkanRenderGraphPass &lightingPass = graph.addPass(LIGHTING_PASS);
+    for (const GBufferImage &image : GBUFFER_IMAGES)
+    {
+        graph.createImage(image.m_name, VulkanRenderGraphImageDescription{image.m_format});
+        gBufferPass.writeColor(image.m_name, VK_ATTACHMENT_LOAD_OP_CLEAR, VkClearColorValue{{0.0f, 0.0f, 0.0f, 0.0f}});
+        // Read as input attachments: the lighting pass becomes the second subpass of the G-buffer pass's render pass
+        lightingPass.readInput(image.m_name);
+    }
+    gBufferPass.writeDepth(SCENE_DEPTH)
+        .setRecord([this](VkCommandBuffer commandBuffer, const VulkanRenderGraphPassContext &context)
+                   { recordScene(commandBuffer, context); });
+    lightingPass.writeColor(target)
+        .setRecord([this](VkCommandBuffer commandBuffer, const VulkanRenderGraphPassContext &context)
+                   { recordLighting(commandBuffer, context); });
+}
+
+void LightingBenchmark::create(VulkanDevice &vulkanDevice, const VulkanRenderGraph &graph, const VkPipelineCache pipelineCache)
+{
+    m_device = vulkanDevice.getDevice();
+    m_frameCount = 0;
+    m_time = 0.0f;
+
+    // The light count is a specialization constant: the shading loops have a constant trip count
+    const ShaderSpecialization specialization = ShaderSpecialization().set(LIGHT_COUNT_CONSTANT_ID, m_lightCount);
+    const bool isDeferred = (m_path == LightingPath::DEFERRED);
+
+    const std::string sceneFragmentShader = isDeferred ? "assets/shaders/fragment/lighting_gbuffer.frag.spv" : "assets/shaders/fragment/lighting_forward.frag.spv";
+    Shader sceneShader(vulkanDevice.getShaderModuleCache(), "assets/shaders/vertex/lighting_scene.vert.spv", sceneFragmentShader);
+    sceneShader.setSpecialization(specialization);
+    const VulkanPipelineLayout &sceneLayout = vulkanDevice.getPipelineLayoutCache().getPipelineLayout(sceneShader.getReflection());
+    m_scenePushConstantStages = getPushConstantStages(sceneLayout, sizeof(PushConstants), sceneFragmentShader);
+
+    const std::string &scenePass = isDeferred ? GBUFFER_PASS : FORWARD_PASS;
+    const VulkanPipelineState sceneState = isDeferred ? VulkanPipelinePresets::deferredGBuffer(GBUFFER_IMAGE_COUNT) : VulkanPipelinePresets::BASIC;
+    m_scenePipeline.createPipeline(m_device, sceneState, sceneShader, sceneLayout.m_pipelineLayout, graph.getPipelineTarget(scenePass), pipelineCache);
+    if (!isDeferred)
+    {
+        return;
+    }
+
+    Shader lightingShader(vulkanDevice.getShaderModuleCache(), "assets/shaders/vertex/fullscreen.vert.spv", "assets/shaders/fragment/lighting_deferred.frag.spv");
+    lightingShader.setSpecialization(specialization);
+    const VulkanPipelineLayout &lightingLayout = vulkanDevice.getPipelineLayoutCache().getPipelineLayout(lightingShader.getReflection());
+    if (lightingLayout.m_setLayouts.size() != 1)
+    {
+        throw std::runtime_error("lighting_deferred.frag does not match LightingBenchmark: expected one descriptor set");
+    }
+    m_gBufferSetLayout = lightingLayout.m_setLayouts[0];
+    m_lightingPushConstantStages = getPushConstantStages(lightingLayout, sizeof(PushConstants), "lighting_deferred.frag");
+
+    m_lightingPipeline.createPipeline(m_device, VulkanPipelinePresets::DEFERRED_LIGHTING, lightingShader, lightingLayout.m_pipelineLayout,
+                                      graph.getPipelineTarget(LIGHTING_PASS), pipelineCache);
+
+    updateGBufferDescriptors(graph);
+}
+
+void LightingBenchmark::cleanUp()
+{
+    m_lightingPipeline.cleanUp();
+    m_scenePipeline.cleanUp();
+
+    if (m_descriptorPool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr); // Frees the set
+        m_descriptorPool = VK_NULL_HANDLE;
+        m_descriptorSet = VK_NULL_HANDLE;
+    }
+    m_gBufferSetLayout = VK_NULL_HANDLE; // Owned by the pipeline layout cache
+}
+
+VkDescriptorPool LightingBenchmark::updateGBufferDescriptors(const VulkanRenderGraph &graph)
+{
+    if (m_path != LightingPath::DEFERRED || m_gBufferSetLayout == VK_NULL_HANDLE)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    // A new pool per update: the previous set may still be bound by frames in flight, so it cannot be rewritten
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+    poolSize.descriptorCount = GBUFFER_IMAGE_COUNT;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkResult result = vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &descriptorPool);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create G-buffer descriptor pool! VkResult: ") + string_VkResult(result));
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_gBufferSetLayout;
+
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    result = vkAllocateDescriptorSets(m_device, &allocInfo, &descriptorSet);
+    if (result != VK_SUCCESS)
+    {
+        vkDestroyDescriptorPool(m_device, descriptorPool, nullptr);
+        throw std::runtime_error(std::string("Failed to allocate G-buffer descriptor set! VkResult: ") + string_VkResult(result));
+    }
+
+    VkDescriptorImageInfo imageInfos[GBUFFER_IMAGE_COUNT] = {};
+    VkWriteDescriptorSet descriptorWrites[GBUFFER_IMAGE_COUNT] = {};
+    for (uint32_t i = 0; i < GBUFFER_IMAGE_COUNT; i++)
+    {
+        imageInfos[i].imageView = graph.getImageView(GBUFFER_IMAGES[i].m_name);
+        imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; // The layout of readInput in the lighting subpass
+
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = descriptorSet;
+        descriptorWrites[i].dstBinding = i;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+        descriptorWrites[i].pImageInfo = &imageInfos[i];
+    }
+    vkUpdateDescriptorSets(m_device, GBUFFER_IMAGE_COUNT, descriptorWrites, 0, nullptr);
+
+    const VkDescriptorPool retiredPool = m_descriptorPool;
+    m_descriptorPool = descriptorPool;
+    m_descriptorSet = descriptorSet;
+    return retiredPool;
+}
+
+void LightingBenchmark::destroyRetiredPool(VkDescriptorPool descriptorPool) const
+{
+    if (descriptorPool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(m_device, descriptorPool, nullptr);
+    }
+}
+
+// Forward shading, or the G-buffer subpass: the first pass of the frame, which advances the lights
+void LightingBenchmark::recordScene(VkCommandBuffer commandBuffer, const VulkanRenderGraphPassContext &context)
+{
+    m_time = static_cast<float>(m_frameCount++) * TIME_STEP;
+
+    PushConstants pushConstants{};
+    pushConstants.m_aspectRatio = static_cast<float>(context.m_extent.width) / static_cast<float>(context.m_extent.height);
+    pushConstants.m_time = m_time;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_scenePipeline.getPipeline());
+    setViewportAndScissor(commandBuffer, context.m_extent);
+    vkCmdPushConstants(commandBuffer, m_scenePipeline.getPipelineLayout(), m_scenePushConstantStages, 0, sizeof(PushConstants), &pushConstants);
+    vkCmdDraw(commandBuffer, CUBE_VERTEX_COUNT, CUBE_COUNT, 0, 0);
+}
+
+// The second subpass of the G-buffer pass's render pass: one fullscreen triangle
+void LightingBenchmark::recordLighting(VkCommandBuffer commandBuffer, const VulkanRenderGraphPassContext &context)
+{
+    PushConstants pushConstants{};
+    pushConstants.m_aspectRatio = static_cast<float>(context.m_extent.width) / static_cast<float>(context.m_extent.height);
+    pushConstants.m_time = m_time;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_lightingPipeline.getPipeline());
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_lightingPipeline.getPipelineLayout(), 0, 1, &m_descriptorSet, 0, nullptr);
+    setViewportAndScissor(commandBuffer, context.m_extent);
+    vkCmdPushConstants(commandBuffer, m_lightingPipeline.getPipelineLayout(), m_lightingPushConstantStages, 0, sizeof(PushConstants), &pushConstants);
+    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+}
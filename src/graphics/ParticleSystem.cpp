@@ -0,0 +1,187 @@
+#include "graphics/ParticleSystem.hpp"
+
+#include "core/renderer/VulkanDevice.hpp"
+#include "graphics/Shader.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    constexpr uint32_t WORKGROUP_SIZE = 64;   // local_size_x of particles.comp, set through specialization constant 0
+    constexpr VkDeviceSize PARTICLE_SIZE = 32; // Two vec4 (std430)
+}
+
+ParticleSystem::ParticleSystem()
+    : m_device(VK_NULL_HANDLE), m_memoryAllocator(nullptr), m_particleCount(0), m_stepCount(0), m_particleBuffer(VK_NULL_HANDLE),
+      m_descriptorSetLayout(VK_NULL_HANDLE), m_descriptorPool(VK_NULL_HANDLE), m_descriptorSet(VK_NULL_HANDLE) {}
+
+ParticleSystem::~ParticleSystem() {}
+
+void ParticleSystem::create(VulkanDevice &vulkanDevice, const uint32_t particleCount, const VkPipelineCache pipelineCache)
+{
+    m_device = vulkanDevice.getDevice();
+    m_memoryAllocator = &vulkanDevice.getMemoryAllocator();
+    m_particleCount = particleCount;
+    m_stepCount = 0;
+
+    // The descriptor set layout and push constant range are reflected from the shader
+    Shader shader(vulkanDevice.getShaderModuleCache(), "assets/shaders/compute/particles.comp.spv");
+    const VulkanPipelineLayout &layout = vulkanDevice.getPipelineLayoutCache().getPipelineLayout(shader.getReflection());
+    if (layout.m_setLayouts.size() != 1 || !layout.m_pushConstantRange.has_value() || layout.m_pushConstantRange->size != sizeof(PushConstants))
+    {
+        throw std::runtime_error("particles.comp does not match ParticleSystem: expected one descriptor set and " +
+                                 std::to_string(sizeof(PushConstants)) + " bytes of push constants");
+    }
+    m_descriptorSetLayout = layout.m_setLayouts[0];
+    // The workgroup size is a specialization constant: the dispatch below and the shader agree by construction
+    shader.setSpecialization(ShaderSpecialization().set(0, WORKGROUP_SIZE));
+
+    createParticleBuffer();
+    createDescriptorSet();
+
+    m_computePipeline.createPipeline(m_device, shader, layout.m_pipelineLayout, pipelineCache);
+}
+
+void ParticleSystem::createParticleBuffer()
+{
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = PARTICLE_SIZE * m_particleCount;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // Only used by the compute queue
+
+    VkResult result = vkCreateBuffer(m_device, &bufferInfo, nullptr, &m_particleBuffer);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create particle buffer! VkResult: ") + string_VkResult(result));
+    }
+
+    // Host visible for verify(). DEVICE_LOCAL is preferred so the simulation itself does not go over PCIe where possible
+    m_particleAllocation = m_memoryAllocator->allocateForBuffer(m_particleBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+void ParticleSystem::createDescriptorSet()
+{
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    VkResult result = vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_descriptorPool);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to create particle descriptor pool! VkResult: ") + string_VkResult(result));
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_descriptorSetLayout;
+
+    result = vkAllocateDescriptorSets(m_device, &allocInfo, &m_descriptorSet);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(std::string("Failed to allocate particle descriptor set! VkResult: ") + string_VkResult(result));
+    }
+
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = m_particleBuffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_descriptorSet;
+    descriptorWrite.dstBinding = 0;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+}
+
+void ParticleSystem::recordUpdate(VkCommandBuffer commandBuffer)
+{
+    // Steps of consecutive frames run on the same queue but are not ordered without a barrier: the previous step's writes
+    // must be visible before this step reads the particles
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = m_particleBuffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    PushConstants pushConstants{};
+    pushConstants.m_deltaTime = DELTA_TIME;
+    pushConstants.m_particleCount = m_particleCount;
+    pushConstants.m_initialize = (m_stepCount == 0) ? 1u : 0u;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline.getPipeline());
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline.getPipelineLayout(), 0, 1, &m_descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_computePipeline.getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+    vkCmdDispatch(commandBuffer, (m_particleCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    // Make the result available to the host for verify()
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    m_stepCount++;
+}
+
+bool ParticleSystem::verify() const
+{
+    m_memoryAllocator->invalidate(m_particleAllocation);
+
+    for (uint32_t i = 0; i < m_particleCount; i++)
+    {
+        float positionX = 0.0f;
+        std::memcpy(&positionX, m_particleAllocation.m_mapped + i * PARTICLE_SIZE, sizeof(float));
+
+        const double expected = static_cast<double>(i) + static_cast<double>(i % 7 + 1) * DELTA_TIME * static_cast<double>(m_stepCount);
+        if (std::abs(positionX - expected) > 1.0e-3 * (1.0 + expected))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The device must be idle
+void ParticleSystem::cleanUp()
+{
+    m_computePipeline.cleanUp();
+
+    // Descriptor sets are freed together with their pool
+    if (m_descriptorPool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+        m_descriptorPool = VK_NULL_HANDLE;
+        m_descriptorSet = VK_NULL_HANDLE;
+    }
+    m_descriptorSetLayout = VK_NULL_HANDLE; // Owned by the pipeline layout cache
+    if (m_particleBuffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(m_device, m_particleBuffer, nullptr);
+        m_particleBuffer = VK_NULL_HANDLE;
+    }
+    if (m_memoryAllocator != nullptr)
+    {
+        m_memoryAllocator->free(m_particleAllocation);
+    }
+}
@@ -1,105 +1,131 @@
 #include "graphics/Shader.hpp"
-#include <fstream>
-#include <stdexcept>
-#include <vector>
-#include <iostream>
-#include <vulkan/vk_enum_string_helper.h>
-
-// Constructor: Load and create shader modules
-Shader::Shader(VkDevice device, const std::string &vertFilePath, const std::string &fragFilePath)
-    : m_device(device), m_vertexShaderModule(VK_NULL_HANDLE), m_fragmentShaderModule(VK_NULL_HANDLE)
-{
 
-    auto vertShaderCode = readFile(vertFilePath);
-    auto fragShaderCode = readFile(fragFilePath);
+#include "core/renderer/VulkanShaderModuleCache.hpp"
 
-    m_vertexShaderModule = createShaderModule(vertShaderCode);
-    m_fragmentShaderModule = createShaderModule(fragShaderCode);
-}
+#include <vulkan/vk_enum_string_helper.h>
 
-// Destructor: Clean up shader modules
-Shader::~Shader()
-{
-    cleanUp();
-}
+#include <algorithm>
+#include <stdexcept>
 
-// Load a file and return its contents as a byte array
-std::vector<char> Shader::readFile(const std::string &filePath)
+namespace
 {
-    // "ate": Start reading at the end of the file
-    // Read the file as binary file (avoid text transformations)
-    std::ifstream file(filePath, std::ios::ate | std::ios::binary);
-    if (!file.is_open())
+    // Order of the stages in a pipeline
+    constexpr VkShaderStageFlagBits STAGE_ORDER[] = {
+        VK_SHADER_STAGE_TASK_BIT_EXT,
+        VK_SHADER_STAGE_MESH_BIT_EXT,
+        VK_SHADER_STAGE_VERTEX_BIT,
+        VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+        VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
+        VK_SHADER_STAGE_GEOMETRY_BIT,
+        VK_SHADER_STAGE_FRAGMENT_BIT,
+        VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    size_t stageOrder(const VkShaderStageFlagBits stage)
     {
-        throw std::runtime_error("Failed to open file: " + filePath + "\n" +
-                                 "Current working directory: " + std::filesystem::current_path().c_str());
+        return static_cast<size_t>(std::find(std::begin(STAGE_ORDER), std::end(STAGE_ORDER), stage) - std::begin(STAGE_ORDER));
     }
-
-    size_t fileSize = static_cast<size_t>(file.tellg());
-    std::vector<char> buffer(fileSize);
-
-    // Seek back to the beginning of the file and read all of the bytes at once.
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-
-    file.close();
-    return buffer;
 }
 
-// Create a Vulkan shader module from bytecode
-VkShaderModule Shader::createShaderModule(const std::vector<char> &code)
+// Constructor: Load (or reuse) the shader module of every stage
+Shader::Shader(VulkanShaderModuleCache &shaderModuleCache, const std::vector<ShaderStageSource> &stages)
+    : m_stageFlags(0), m_specializationInfo{}
 {
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
-
-    VkShaderModule shaderModule;
-    VkResult result = vkCreateShaderModule(m_device, &createInfo, nullptr, &shaderModule);
-    if (result != VK_SUCCESS)
+    for (const ShaderStageSource &source : stages)
     {
-        throw std::runtime_error(std::string("Failed to create shader module! VkResult: ") + string_VkResult(result));
+        if (stageOrder(source.m_stage) == std::size(STAGE_ORDER))
+        {
+            throw std::runtime_error(std::string("Failed to create shader: unsupported stage ") + string_VkShaderStageFlagBits(source.m_stage));
+        }
+        if ((m_stageFlags & source.m_stage) != 0)
+        {
+            throw std::runtime_error(std::string("Failed to create shader: stage ") + string_VkShaderStageFlagBits(source.m_stage) + " given twice");
+        }
+
+        const VulkanShaderModule &shaderModule = shaderModuleCache.getShaderModule(source.m_filePath);
+        if ((shaderModule.m_reflection.m_stageFlags & source.m_stage) == 0)
+        {
+            throw std::runtime_error("Failed to create shader: " + source.m_filePath + " has no " + string_VkShaderStageFlagBits(source.m_stage) +
+                                     " entry point");
+        }
+
+        m_stages.push_back(Stage{source.m_stage, shaderModule.m_module, source.m_entryPoint});
+        m_stageFlags |= source.m_stage;
+        if (m_stages.size() == 1)
+        {
+            m_reflection = shaderModule.m_reflection;
+        }
+        else
+        {
+            m_reflection.merge(shaderModule.m_reflection);
+        }
     }
 
-    return shaderModule;
+    std::sort(m_stages.begin(), m_stages.end(), [](const Stage &a, const Stage &b)
+              { return stageOrder(a.m_stage) < stageOrder(b.m_stage); });
 }
 
-// Get Vulkan shader stage info for the vertex shader
-VkPipelineShaderStageCreateInfo Shader::getVertexShaderStageInfo() const
+Shader::Shader(VulkanShaderModuleCache &shaderModuleCache, const std::string &vertFilePath, const std::string &fragFilePath)
+    : Shader(shaderModuleCache, {ShaderStageSource{VK_SHADER_STAGE_VERTEX_BIT, vertFilePath}, ShaderStageSource{VK_SHADER_STAGE_FRAGMENT_BIT, fragFilePath}})
 {
-    VkPipelineShaderStageCreateInfo vertexShaderStageInfo{};
-    vertexShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertexShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertexShaderStageInfo.module = m_vertexShaderModule;
-    vertexShaderStageInfo.pName = "main";
+}
 
-    return vertexShaderStageInfo;
+Shader::Shader(VulkanShaderModuleCache &shaderModuleCache, const std::string &compFilePath)
+    : Shader(shaderModuleCache, {ShaderStageSource{VK_SHADER_STAGE_COMPUTE_BIT, compFilePath}})
+{
 }
 
-// Get Vulkan shader stage info for the fragment shader
-VkPipelineShaderStageCreateInfo Shader::getFragmentShaderStageInfo() const
+// Destructor: Release the shader modules
+Shader::~Shader()
 {
-    VkPipelineShaderStageCreateInfo fragmentShaderStageInfo{};
-    fragmentShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragmentShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragmentShaderStageInfo.module = m_fragmentShaderModule;
-    fragmentShaderStageInfo.pName = "main";
+    cleanUp();
+}
 
-    return fragmentShaderStageInfo;
+void Shader::setSpecialization(const ShaderSpecialization &specialization)
+{
+    specialization.validate(m_reflection);
+    m_specialization = specialization;
+    m_specializationInfo = m_specialization.getInfo();
 }
 
-// Clean up the shader modules
-void Shader::cleanUp()
+std::vector<VkPipelineShaderStageCreateInfo> Shader::getStageInfos() const
 {
-    if (m_vertexShaderModule != VK_NULL_HANDLE)
+    std::vector<VkPipelineShaderStageCreateInfo> stageInfos;
+    stageInfos.reserve(m_stages.size());
+    for (const Stage &stage : m_stages)
     {
-        vkDestroyShaderModule(m_device, m_vertexShaderModule, nullptr);
-        m_vertexShaderModule = VK_NULL_HANDLE;
+        stageInfos.push_back(makeStageInfo(stage));
     }
+    return stageInfos;
+}
 
-    if (m_fragmentShaderModule != VK_NULL_HANDLE)
+VkPipelineShaderStageCreateInfo Shader::getStageInfo(const VkShaderStageFlagBits stage) const
+{
+    auto it = std::find_if(m_stages.begin(), m_stages.end(), [stage](const Stage &existing)
+                           { return existing.m_stage == stage; });
+    if (it == m_stages.end())
     {
-        vkDestroyShaderModule(m_device, m_fragmentShaderModule, nullptr);
-        m_fragmentShaderModule = VK_NULL_HANDLE;
+        throw std::runtime_error(std::string("Shader has no ") + string_VkShaderStageFlagBits(stage) + " stage");
     }
+    return makeStageInfo(*it);
+}
+
+VkPipelineShaderStageCreateInfo Shader::makeStageInfo(const Stage &stage) const
+{
+    VkPipelineShaderStageCreateInfo shaderStageInfo{};
+    shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStageInfo.stage = stage.m_stage;
+    shaderStageInfo.module = stage.m_module;
+    shaderStageInfo.pName = stage.m_entryPoint.c_str(); // Points into the Shader, like the specialization
+    // Without a specialization every constant keeps the default value written in the shader
+    shaderStageInfo.pSpecializationInfo = m_specialization.isEmpty() ? nullptr : &m_specializationInfo;
+
+    return shaderStageInfo;
+}
+
+// Release the shader modules. The cache owns them: they stay valid for the other shaders using them
+void Shader::cleanUp()
+{
+    m_stages.clear();
+    m_stageFlags = 0;
 }
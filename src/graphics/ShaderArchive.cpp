@@ -0,0 +1,214 @@
+#include "graphics/ShaderArchive.hpp"
+
+#include "utilities/io/Checksum.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    uint64_t hashName(const std::string_view name)
+    {
+        return fnv1a64(reinterpret_cast<const std::byte *>(name.data()), name.size());
+    }
+
+    size_t alignUp(const size_t value, const size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+ShaderArchive::ShaderArchive() : m_index(nullptr), m_names(nullptr), m_entryCount(0) {}
+
+ShaderArchive::~ShaderArchive()
+{
+    cleanUp();
+}
+
+bool ShaderArchive::open(const std::string &filePath)
+{
+    cleanUp();
+    m_filePath = filePath;
+    m_rejectReason.clear();
+
+    std::error_code error;
+    if (m_filePath.empty() || !std::filesystem::exists(m_filePath, error))
+    {
+        return false; // No archive: the shaders are loaded from their own files
+    }
+
+    try
+    {
+        m_file = std::make_unique<MappedFile>(m_filePath);
+    }
+    catch (const std::exception &exception)
+    {
+        m_rejectReason = exception.what();
+        return false;
+    }
+
+    if (!validate())
+    {
+        cleanUp();
+        return false;
+    }
+    return true;
+}
+
+// Checks everything find() relies on once, so lookups can trust the index
+bool ShaderArchive::validate()
+{
+    const std::byte *data = m_file->getData();
+    const size_t fileSize = m_file->getSize();
+    if (fileSize < sizeof(FileHeader))
+    {
+        m_rejectReason = "file too small";
+        return false;
+    }
+
+    const FileHeader &header = *reinterpret_cast<const FileHeader *>(data);
+    if (header.m_magic != FILE_MAGIC || header.m_version != FILE_VERSION || header.m_payloadAlignment != PAYLOAD_ALIGNMENT)
+    {
+        m_rejectReason = "unknown file format";
+        return false;
+    }
+    if (header.m_fileSize != fileSize)
+    {
+        m_rejectReason = "truncated file";
+        return false;
+    }
+    if (header.m_namesOffset != sizeof(FileHeader) + static_cast<uint64_t>(header.m_entryCount) * sizeof(IndexEntry) ||
+        header.m_namesOffset + header.m_namesSize > fileSize)
+    {
+        m_rejectReason = "damaged index";
+        return false;
+    }
+    if (fnv1a64(data + sizeof(FileHeader), header.m_namesOffset + header.m_namesSize - sizeof(FileHeader)) != header.m_indexChecksum)
+    {
+        m_rejectReason = "checksum mismatch";
+        return false;
+    }
+
+    m_index = reinterpret_cast<const IndexEntry *>(data + sizeof(FileHeader));
+    m_names = reinterpret_cast<const char *>(data + header.m_namesOffset);
+    m_entryCount = header.m_entryCount;
+    for (uint32_t i = 0; i < m_entryCount; i++)
+    {
+        const IndexEntry &entry = m_index[i];
+        if (static_cast<uint64_t>(entry.m_nameOffset) + entry.m_nameSize > header.m_namesSize ||
+            entry.m_dataOffset % PAYLOAD_ALIGNMENT != 0 || entry.m_dataOffset + entry.m_dataSize > fileSize ||
+            (i > 0 && std::pair(m_index[i - 1].m_nameHash, getName(m_index[i - 1])) >= std::pair(entry.m_nameHash, getName(entry))))
+        {
+            m_rejectReason = "damaged index";
+            return false;
+        }
+        if (entry.m_compression != COMPRESSION_NONE)
+        {
+            m_rejectReason = "unsupported compression";
+            return false;
+        }
+    }
+    return true;
+}
+
+void ShaderArchive::cleanUp()
+{
+    m_file.reset();
+    m_index = nullptr;
+    m_names = nullptr;
+    m_entryCount = 0;
+}
+
+std::optional<ShaderArchiveEntry> ShaderArchive::find(const std::string_view name) const
+{
+    const std::pair key(hashName(name), name);
+    const IndexEntry *end = m_index + m_entryCount;
+    const IndexEntry *entry = std::lower_bound(m_index, end, key, [this](const IndexEntry &candidate, const auto &value)
+                                               { return std::pair(candidate.m_nameHash, getName(candidate)) < value; });
+    if (entry == end || entry->m_nameHash != key.first || getName(*entry) != name)
+    {
+        return std::nullopt;
+    }
+
+    ShaderArchiveEntry result{};
+    result.m_name = getName(*entry);
+    result.m_data = m_file->getData() + entry->m_dataOffset;
+    result.m_size = static_cast<size_t>(entry->m_dataSize);
+    result.m_contentHash = entry->m_contentHash;
+    return result;
+}
+
+void ShaderArchive::write(const std::string &filePath, const std::vector<Source> &sources)
+{
+    // Sorted the way find() searches
+    std::vector<std::pair<uint64_t, const Source *>> order;
+    for (const Source &source : sources)
+    {
+        order.emplace_back(hashName(source.m_name), &source);
+    }
+    std::sort(order.begin(), order.end(), [](const auto &a, const auto &b)
+              { return std::pair(a.first, std::string_view(a.second->m_name)) < std::pair(b.first, std::string_view(b.second->m_name)); });
+
+    FileHeader header{};
+    header.m_magic = FILE_MAGIC;
+    header.m_version = FILE_VERSION;
+    header.m_entryCount = static_cast<uint32_t>(order.size());
+    header.m_payloadAlignment = PAYLOAD_ALIGNMENT;
+    header.m_namesOffset = sizeof(FileHeader) + order.size() * sizeof(IndexEntry);
+
+    std::vector<IndexEntry> index(order.size());
+    std::string names;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const Source &source = *order[i].second;
+        if (i > 0 && order[i - 1].first == order[i].first && order[i - 1].second->m_name == source.m_name)
+        {
+            throw std::runtime_error("Failed to write shader archive: " + source.m_name + " is packed twice");
+        }
+        index[i].m_nameHash = order[i].first;
+        index[i].m_nameOffset = static_cast<uint32_t>(names.size());
+        index[i].m_nameSize = static_cast<uint32_t>(source.m_name.size());
+        names.append(source.m_name);
+    }
+    header.m_namesSize = names.size();
+
+    size_t offset = alignUp(header.m_namesOffset + header.m_namesSize, PAYLOAD_ALIGNMENT);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const std::vector<std::byte> &data = order[i].second->m_data;
+        index[i].m_dataOffset = offset;
+        index[i].m_dataSize = data.size();
+        index[i].m_contentHash = fnv1a64(data.data(), data.size());
+        index[i].m_compression = COMPRESSION_NONE;
+        offset = alignUp(offset + data.size(), PAYLOAD_ALIGNMENT);
+    }
+    header.m_fileSize = offset;
+
+    std::vector<std::byte> file(header.m_fileSize);
+    std::memcpy(file.data() + sizeof(FileHeader), index.data(), index.size() * sizeof(IndexEntry));
+    std::memcpy(file.data() + header.m_namesOffset, names.data(), names.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const std::vector<std::byte> &data = order[i].second->m_data;
+        std::memcpy(file.data() + index[i].m_dataOffset, data.data(), data.size());
+    }
+    header.m_indexChecksum = fnv1a64(file.data() + sizeof(FileHeader), header.m_namesOffset + header.m_namesSize - sizeof(FileHeader));
+    std::memcpy(file.data(), &header, sizeof(FileHeader));
+
+    // Written next to the archive and renamed, so a running application never maps a half written file
+    const std::string temporaryPath = filePath + ".tmp";
+    {
+        std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char *>(file.data()), static_cast<std::streamsize>(file.size()));
+        output.flush();
+        if (!output)
+        {
+            throw std::runtime_error("Failed to write shader archive: " + temporaryPath);
+        }
+    }
+    std::filesystem::rename(temporaryPath, filePath);
+}
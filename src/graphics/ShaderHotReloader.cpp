@@ -0,0 +1,264 @@
+#include "graphics/ShaderHotReloader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace
+{
+    // Extensions glslc infers the stage from
+    constexpr const char *SHADER_EXTENSIONS[] = {".vert", ".tesc", ".tese", ".geom", ".frag", ".comp", ".task", ".mesh"};
+
+    constexpr const char *DEPFILE_EXTENSION = ".d"; // Next to the binary, as the build writes it
+
+    constexpr int WATCH_TIMEOUT_MS = 100; // How long stop() may wait for the thread
+
+    bool isShaderSource(const std::filesystem::path &path)
+    {
+        const std::string extension = path.extension().string();
+        return std::find_if(std::begin(SHADER_EXTENSIONS), std::end(SHADER_EXTENSIONS), [&extension](const char *shaderExtension)
+                            { return extension == shaderExtension; }) != std::end(SHADER_EXTENSIONS);
+    }
+
+    // Task and mesh shaders need SPIR-V 1.4, as in the build
+    bool needsSpirv14(const std::filesystem::path &path)
+    {
+        const std::string extension = path.extension().string();
+        return extension == ".task" || extension == ".mesh";
+    }
+
+    std::string quote(const std::string &argument)
+    {
+        return "\"" + argument + "\"";
+    }
+
+    // The form the watched paths and the depfile paths are compared in ("fragment/../include/x.glsl" is "include/x.glsl")
+    std::string normalizePath(const std::filesystem::path &path)
+    {
+        std::error_code error;
+        const std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, error);
+        return (error ? path : canonicalPath).generic_string();
+    }
+
+    // The prerequisites of the make rule glslc writes ("target: source include..."). A line continues after a backslash, and a
+    // space inside a path is escaped with one
+    std::vector<std::string> readDepfile(const std::string &depfilePath)
+    {
+        std::ifstream file(depfilePath);
+        const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        std::vector<std::string> prerequisites;
+        const size_t separator = content.find(": ");
+        if (separator == std::string::npos)
+        {
+            return prerequisites;
+        }
+
+        std::string path;
+        for (size_t i = separator + 1; i < content.size(); i++)
+        {
+            const char character = content[i];
+            const char next = i + 1 < content.size() ? content[i + 1] : '\0';
+            if (character == '\\' && next == ' ')
+            {
+                path += ' ';
+                i++;
+            }
+            else if (character == '\\' && (next == '\n' || next == '\r'))
+            {
+                continue; // The line break is a separator
+            }
+            else if (character == ' ' || character == '\t' || character == '\n' || character == '\r')
+            {
+                if (!path.empty())
+                {
+                    prerequisites.push_back(path);
+                    path.clear();
+                }
+            }
+            else
+            {
+                path += character;
+            }
+        }
+        if (!path.empty())
+        {
+            prerequisites.push_back(path);
+        }
+        return prerequisites;
+    }
+}
+
+ShaderHotReloader::ShaderHotReloader() : m_isStopping(false) {}
+
+ShaderHotReloader::~ShaderHotReloader()
+{
+    stop();
+}
+
+void ShaderHotReloader::start(const std::string &sourceDirectory, const std::string &outputDirectory, const std::string &compilerPath)
+{
+    stop();
+    m_sourceDirectory = sourceDirectory;
+    m_outputDirectory = outputDirectory;
+    m_compilerPath = compilerPath;
+
+    m_fileWatcher.watch(m_sourceDirectory);
+    m_isStopping = false;
+    m_thread = std::thread(&ShaderHotReloader::watchLoop, this);
+}
+
+void ShaderHotReloader::stop()
+{
+    if (m_thread.joinable())
+    {
+        m_isStopping = true;
+        m_thread.join();
+    }
+    m_fileWatcher.cleanUp();
+}
+
+std::vector<std::string> ShaderHotReloader::takeCompiledShaders()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> compiledShaders;
+    compiledShaders.swap(m_compiledShaders);
+    return compiledShaders;
+}
+
+ShaderHotReloadStats ShaderHotReloader::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void ShaderHotReloader::watchLoop()
+{
+    loadDependencies();
+    while (!m_isStopping)
+    {
+        // A set: a shader saved with an include it uses compiles once
+        std::set<std::string> sourcePaths;
+        for (const std::string &path : m_fileWatcher.waitForChanges(WATCH_TIMEOUT_MS))
+        {
+            const std::string normalizedPath = normalizePath(path);
+            if (isShaderSource(normalizedPath))
+            {
+                sourcePaths.insert(normalizedPath);
+            }
+            else if (const auto including = m_includingShaders.find(normalizedPath); including != m_includingShaders.end())
+            {
+                sourcePaths.insert(including->second.begin(), including->second.end());
+            }
+        }
+
+        for (const std::string &sourcePath : sourcePaths)
+        {
+            compile(sourcePath);
+        }
+    }
+}
+
+// The build wrote a depfile next to every binary: the includes are known before any shader is recompiled here
+void ShaderHotReloader::loadDependencies()
+{
+    m_includingShaders.clear();
+    std::error_code error;
+    for (auto iterator = std::filesystem::recursive_directory_iterator(m_outputDirectory, error);
+         !error && iterator != std::filesystem::recursive_directory_iterator(); iterator.increment(error))
+    {
+        const std::filesystem::path &depfilePath = iterator->path();
+        if (depfilePath.extension() != DEPFILE_EXTENSION)
+        {
+            continue;
+        }
+
+        // "<output>/fragment/x.frag.d" lists the dependencies of "<source>/fragment/x.frag"
+        std::error_code relativeError;
+        std::filesystem::path relativePath = std::filesystem::relative(depfilePath, m_outputDirectory, relativeError);
+        relativePath.replace_extension();
+        if (!relativeError && isShaderSource(relativePath))
+        {
+            updateDependencies(normalizePath(std::filesystem::path(m_sourceDirectory) / relativePath), depfilePath.string());
+        }
+    }
+}
+
+void ShaderHotReloader::updateDependencies(const std::string &sourcePath, const std::string &depfilePath)
+{
+    for (auto &[includePath, sourcePaths] : m_includingShaders)
+    {
+        sourcePaths.erase(sourcePath);
+    }
+    for (const std::string &prerequisite : readDepfile(depfilePath))
+    {
+        const std::string includePath = normalizePath(prerequisite);
+        if (includePath != sourcePath)
+        {
+            m_includingShaders[includePath].insert(sourcePath);
+        }
+    }
+}
+
+// Compiles into a temporary file renamed over the binary: a shader loaded meanwhile reads the old or the new one, never half
+void ShaderHotReloader::compile(const std::string &sourcePath)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::error_code error;
+    const std::filesystem::path relativePath = std::filesystem::relative(sourcePath, m_sourceDirectory, error);
+    const std::string outputPath = (std::filesystem::path(m_outputDirectory) / relativePath).generic_string() + ".spv";
+    const std::string temporaryPath = outputPath + ".tmp";
+    const std::string depfilePath = outputPath + DEPFILE_EXTENSION;
+    std::filesystem::create_directories(std::filesystem::path(outputPath).parent_path(), error);
+
+    // The compiler's messages are captured to report why a shader failed. The binary is left unoptimized with its debug
+    // info, as in a debug build: faster to compile while iterating, and readable in a graphics debugger. The depfile replaces
+    // the build's, so the includes stay tracked as they are added and removed
+    const std::string targetEnvironment = needsSpirv14(sourcePath) ? " --target-env=vulkan1.2" : "";
+    const std::string command = quote(m_compilerPath) + targetEnvironment + " -g -MD -MF " + quote(depfilePath) + " -MT " + quote(outputPath) +
+                                " -o " + quote(temporaryPath) + " " + quote(sourcePath) + " 2>&1";
+    std::string output;
+    int status = -1;
+    if (FILE *pipe = popen(command.c_str(), "r"))
+    {
+        std::array<char, 256> buffer{};
+        while (fgets(buffer.data(), static_cast<int>(buffer.size()), pipe) != nullptr)
+        {
+            output += buffer.data();
+        }
+        status = pclose(pipe);
+    }
+
+    bool succeeded = (status == 0);
+    if (succeeded)
+    {
+        std::filesystem::rename(temporaryPath, outputPath, error);
+        succeeded = !error;
+        updateDependencies(sourcePath, depfilePath);
+    }
+    if (!succeeded)
+    {
+        std::filesystem::remove(temporaryPath, error);
+        std::cerr << "Shader hot reload: failed to compile " << sourcePath << ", keeping the previous binary\n" << output << std::endl;
+    }
+
+    const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.m_compileMs += elapsedMs;
+    (succeeded ? m_stats.m_compiledCount : m_stats.m_failedCount)++;
+    if (succeeded && std::find(m_compiledShaders.begin(), m_compiledShaders.end(), outputPath) == m_compiledShaders.end())
+    {
+        m_compiledShaders.push_back(outputPath);
+    }
+}
@@ -0,0 +1,560 @@
+#include "graphics/ShaderReflection.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+    constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+    constexpr size_t SPIRV_HEADER_WORDS = 5;
+
+    // The few SPIR-V enumerants needed (see the SPIR-V specification, section 3)
+    enum Op : uint32_t
+    {
+        OP_ENTRY_POINT = 15,
+        OP_TYPE_BOOL = 20,
+        OP_TYPE_INT = 21,
+        OP_TYPE_FLOAT = 22,
+        OP_TYPE_VECTOR = 23,
+        OP_TYPE_MATRIX = 24,
+        OP_TYPE_IMAGE = 25,
+        OP_TYPE_SAMPLER = 26,
+        OP_TYPE_SAMPLED_IMAGE = 27,
+        OP_TYPE_ARRAY = 28,
+        OP_TYPE_RUNTIME_ARRAY = 29,
+        OP_TYPE_STRUCT = 30,
+        OP_TYPE_POINTER = 32,
+        OP_CONSTANT = 43,
+        OP_SPEC_CONSTANT_TRUE = 48,
+        OP_SPEC_CONSTANT_FALSE = 49,
+        OP_SPEC_CONSTANT = 50,
+        OP_VARIABLE = 59,
+        OP_DECORATE = 71,
+        OP_MEMBER_DECORATE = 72,
+        OP_TYPE_ACCELERATION_STRUCTURE = 5341,
+    };
+
+    enum Decoration : uint32_t
+    {
+        DECORATION_SPEC_ID = 1,
+        DECORATION_BUFFER_BLOCK = 3,
+        DECORATION_ARRAY_STRIDE = 6,
+        DECORATION_MATRIX_STRIDE = 7,
+        DECORATION_BUILT_IN = 11,
+        DECORATION_LOCATION = 30,
+        DECORATION_BINDING = 33,
+        DECORATION_DESCRIPTOR_SET = 34,
+        DECORATION_OFFSET = 35,
+    };
+
+    enum StorageClass : uint32_t
+    {
+        STORAGE_UNIFORM_CONSTANT = 0,
+        STORAGE_INPUT = 1,
+        STORAGE_UNIFORM = 2,
+        STORAGE_PUSH_CONSTANT = 9,
+        STORAGE_STORAGE_BUFFER = 12,
+    };
+
+    enum Dim : uint32_t
+    {
+        DIM_BUFFER = 5,
+        DIM_SUBPASS_DATA = 6,
+    };
+
+    VkShaderStageFlags toStageFlags(const uint32_t executionModel)
+    {
+        switch (executionModel)
+        {
+        case 0:
+            return VK_SHADER_STAGE_VERTEX_BIT;
+        case 1:
+            return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        case 2:
+            return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+        case 3:
+            return VK_SHADER_STAGE_GEOMETRY_BIT;
+        case 4:
+            return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case 5:
+            return VK_SHADER_STAGE_COMPUTE_BIT;
+        case 5364:
+            return VK_SHADER_STAGE_TASK_BIT_EXT;
+        case 5365:
+            return VK_SHADER_STAGE_MESH_BIT_EXT;
+        default:
+            return 0; // Kernels, ray tracing and the NV mesh stages are not used by the renderer
+        }
+    }
+
+    struct Type
+    {
+        uint32_t m_opcode = 0;
+        std::vector<uint32_t> m_operands; // Following the result id
+    };
+
+    struct Decorations
+    {
+        std::optional<uint32_t> m_set;
+        std::optional<uint32_t> m_binding;
+        std::optional<uint32_t> m_location;
+        std::optional<uint32_t> m_specId;
+        uint32_t m_arrayStride = 0;
+        bool m_isBufferBlock = false;
+        bool m_isBuiltIn = false;
+    };
+
+    struct Variable
+    {
+        uint32_t m_id;
+        uint32_t m_pointerType;
+        uint32_t m_storageClass;
+    };
+
+    uint64_t memberKey(const uint32_t structId, const uint32_t member)
+    {
+        return (static_cast<uint64_t>(structId) << 32) | member;
+    }
+
+    // The module's declarations, indexed by result id
+    class Module
+    {
+    public:
+        Module(const uint32_t *code, const size_t wordCount)
+        {
+            if (wordCount < SPIRV_HEADER_WORDS || code[0] != SPIRV_MAGIC)
+            {
+                throw std::runtime_error("Failed to reflect shader: not a SPIR-V binary");
+            }
+
+            size_t offset = SPIRV_HEADER_WORDS;
+            while (offset < wordCount)
+            {
+                const uint32_t instructionWordCount = code[offset] >> 16;
+                const uint32_t opcode = code[offset] & 0xFFFF;
+                if (instructionWordCount == 0 || offset + instructionWordCount > wordCount)
+                {
+                    throw std::runtime_error("Failed to reflect shader: malformed instruction at word " + std::to_string(offset));
+                }
+                parseInstruction(opcode, code + offset + 1, instructionWordCount - 1);
+                offset += instructionWordCount;
+            }
+        }
+
+        VkShaderStageFlags m_stageFlags = 0;
+        std::unordered_map<uint32_t, Type> m_types;
+        std::unordered_map<uint32_t, uint32_t> m_constants; // First word of integer constants (array lengths)
+        std::unordered_map<uint32_t, Decorations> m_decorations;
+        std::unordered_map<uint64_t, uint32_t> m_memberOffsets;
+        std::unordered_map<uint64_t, uint32_t> m_memberMatrixStrides;
+        std::vector<Variable> m_variables;
+        std::vector<std::pair<uint32_t, uint32_t>> m_specConstants; // Result id, type id
+
+        const Type &getType(const uint32_t id) const
+        {
+            auto it = m_types.find(id);
+            if (it == m_types.end())
+            {
+                throw std::runtime_error("Failed to reflect shader: undefined type %" + std::to_string(id));
+            }
+            return it->second;
+        }
+
+        const Decorations &getDecorations(const uint32_t id) const
+        {
+            static const Decorations none{};
+            auto it = m_decorations.find(id);
+            return it != m_decorations.end() ? it->second : none;
+        }
+
+        uint32_t getConstant(const uint32_t id) const
+        {
+            auto it = m_constants.find(id);
+            return it != m_constants.end() ? it->second : 1;
+        }
+
+        // Size in bytes of a value of the type, with the explicit layout of its decorations (std140/std430 blocks)
+        uint32_t getSize(const uint32_t typeId) const
+        {
+            const Type &type = getType(typeId);
+            const std::vector<uint32_t> &operands = type.m_operands;
+            switch (type.m_opcode)
+            {
+            case OP_TYPE_BOOL:
+                return sizeof(VkBool32);
+            case OP_TYPE_INT:
+            case OP_TYPE_FLOAT:
+                return operands.at(0) / 8;
+            case OP_TYPE_VECTOR:
+            case OP_TYPE_MATRIX:
+                return operands.at(1) * getSize(operands.at(0));
+            case OP_TYPE_ARRAY:
+            {
+                const uint32_t stride = getDecorations(typeId).m_arrayStride;
+                return getConstant(operands.at(1)) * (stride != 0 ? stride : getSize(operands.at(0)));
+            }
+            case OP_TYPE_STRUCT:
+            {
+                uint32_t size = 0;
+                for (uint32_t member = 0; member < operands.size(); member++)
+                {
+                    size = std::max(size, getMemberOffset(typeId, member) + getMemberSize(typeId, member));
+                }
+                return size;
+            }
+            default:
+                return 0; // Runtime arrays, opaque types
+            }
+        }
+
+        uint32_t getMemberOffset(const uint32_t structId, const uint32_t member) const
+        {
+            auto it = m_memberOffsets.find(memberKey(structId, member));
+            return it != m_memberOffsets.end() ? it->second : 0;
+        }
+
+        uint32_t getMemberSize(const uint32_t structId, const uint32_t member) const
+        {
+            const uint32_t memberType = getType(structId).m_operands.at(member);
+            auto stride = m_memberMatrixStrides.find(memberKey(structId, member));
+            if (stride != m_memberMatrixStrides.end() && getType(memberType).m_opcode == OP_TYPE_MATRIX)
+            {
+                return getType(memberType).m_operands.at(1) * stride->second; // Columns are padded to the matrix stride
+            }
+            return getSize(memberType);
+        }
+
+    private:
+        void parseInstruction(const uint32_t opcode, const uint32_t *operands, const uint32_t operandCount)
+        {
+            auto require = [operandCount](const uint32_t count)
+            {
+                if (operandCount < count)
+                {
+                    throw std::runtime_error("Failed to reflect shader: truncated instruction");
+                }
+            };
+
+            switch (opcode)
+            {
+            case OP_ENTRY_POINT:
+                require(1);
+                m_stageFlags |= toStageFlags(operands[0]);
+                break;
+            case OP_TYPE_BOOL:
+            case OP_TYPE_INT:
+            case OP_TYPE_FLOAT:
+            case OP_TYPE_VECTOR:
+            case OP_TYPE_MATRIX:
+            case OP_TYPE_IMAGE:
+            case OP_TYPE_SAMPLER:
+            case OP_TYPE_SAMPLED_IMAGE:
+            case OP_TYPE_ARRAY:
+            case OP_TYPE_RUNTIME_ARRAY:
+            case OP_TYPE_STRUCT:
+            case OP_TYPE_POINTER:
+            case OP_TYPE_ACCELERATION_STRUCTURE:
+                require(1);
+                m_types[operands[0]] = Type{opcode, std::vector<uint32_t>(operands + 1, operands + operandCount)};
+                break;
+            case OP_CONSTANT:
+                require(3);
+                m_constants[operands[1]] = operands[2];
+                break;
+            case OP_SPEC_CONSTANT:
+                require(3);
+                m_constants[operands[1]] = operands[2]; // The default value, for arrays sized by a specialization constant
+                m_specConstants.emplace_back(operands[1], operands[0]);
+                break;
+            case OP_SPEC_CONSTANT_TRUE:
+            case OP_SPEC_CONSTANT_FALSE:
+                require(2);
+                m_specConstants.emplace_back(operands[1], operands[0]);
+                break;
+            case OP_VARIABLE:
+                require(3);
+                m_variables.push_back(Variable{operands[1], operands[0], operands[2]});
+                break;
+            case OP_DECORATE:
+                require(2);
+                decorate(m_decorations[operands[0]], operands[1], operandCount > 2 ? operands[2] : 0);
+                break;
+            case OP_MEMBER_DECORATE:
+                require(3);
+                if (operands[2] == DECORATION_OFFSET && operandCount > 3)
+                {
+                    m_memberOffsets[memberKey(operands[0], operands[1])] = operands[3];
+                }
+                else if (operands[2] == DECORATION_MATRIX_STRIDE && operandCount > 3)
+                {
+                    m_memberMatrixStrides[memberKey(operands[0], operands[1])] = operands[3];
+                }
+                else if (operands[2] == DECORATION_BUILT_IN)
+                {
+                    m_decorations[operands[0]].m_isBuiltIn = true; // Block of built-ins (gl_PerVertex)
+                }
+                break;
+            default:
+                break; // Function bodies, debug information... do not affect the interface
+            }
+        }
+
+        static void decorate(Decorations &decorations, const uint32_t decoration, const uint32_t literal)
+        {
+            switch (decoration)
+            {
+            case DECORATION_SPEC_ID:
+                decorations.m_specId = literal;
+                break;
+            case DECORATION_BUFFER_BLOCK:
+                decorations.m_isBufferBlock = true;
+                break;
+            case DECORATION_ARRAY_STRIDE:
+                decorations.m_arrayStride = literal;
+                break;
+            case DECORATION_BUILT_IN:
+                decorations.m_isBuiltIn = true;
+                break;
+            case DECORATION_LOCATION:
+                decorations.m_location = literal;
+                break;
+            case DECORATION_BINDING:
+                decorations.m_binding = literal;
+                break;
+            case DECORATION_DESCRIPTOR_SET:
+                decorations.m_set = literal;
+                break;
+            default:
+                break;
+            }
+        }
+    };
+
+    // Descriptor type of a resource variable, and its array size (0: runtime array)
+    std::optional<std::pair<VkDescriptorType, uint32_t>> getDescriptorType(const Module &module, const Variable &variable)
+    {
+        uint32_t typeId = module.getType(variable.m_pointerType).m_operands.at(1);
+        uint32_t count = 1;
+        while (true)
+        {
+            const Type &type = module.getType(typeId);
+            if (type.m_opcode == OP_TYPE_ARRAY)
+            {
+                count *= module.getConstant(type.m_operands.at(1));
+            }
+            else if (type.m_opcode == OP_TYPE_RUNTIME_ARRAY)
+            {
+                count = 0;
+            }
+            else
+            {
+                break;
+            }
+            typeId = type.m_operands.at(0);
+        }
+
+        const Type &type = module.getType(typeId);
+        switch (type.m_opcode)
+        {
+        case OP_TYPE_STRUCT:
+            if (variable.m_storageClass == STORAGE_STORAGE_BUFFER || module.getDecorations(typeId).m_isBufferBlock)
+            {
+                return std::pair(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, count);
+            }
+            return std::pair(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, count);
+        case OP_TYPE_IMAGE:
+        {
+            // Operands: sampled type, dim, depth, arrayed, multisampled, sampled (1: with a sampler, 2: storage), format
+            const uint32_t dim = type.m_operands.at(1);
+            const bool isStorage = type.m_operands.at(5) == 2;
+            if (dim == DIM_BUFFER)
+            {
+                return std::pair(isStorage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, count);
+            }
+            if (dim == DIM_SUBPASS_DATA)
+            {
+                return std::pair(VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, count);
+            }
+            return std::pair(isStorage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, count);
+        }
+        case OP_TYPE_SAMPLER:
+            return std::pair(VK_DESCRIPTOR_TYPE_SAMPLER, count);
+        case OP_TYPE_SAMPLED_IMAGE:
+            return std::pair(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, count);
+        case OP_TYPE_ACCELERATION_STRUCTURE:
+            return std::pair(VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, count);
+        default:
+            return std::nullopt;
+        }
+    }
+
+    VkFormat getVertexFormat(const Module &module, const uint32_t typeId)
+    {
+        const Type *type = &module.getType(typeId);
+        uint32_t componentCount = 1;
+        if (type->m_opcode == OP_TYPE_VECTOR)
+        {
+            componentCount = type->m_operands.at(1);
+            type = &module.getType(type->m_operands.at(0));
+        }
+        if ((type->m_opcode != OP_TYPE_FLOAT && type->m_opcode != OP_TYPE_INT) || type->m_operands.at(0) != 32 || componentCount > 4)
+        {
+            return VK_FORMAT_UNDEFINED;
+        }
+
+        static constexpr VkFormat FLOAT_FORMATS[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+        static constexpr VkFormat SINT_FORMATS[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+        static constexpr VkFormat UINT_FORMATS[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+        if (type->m_opcode == OP_TYPE_FLOAT)
+        {
+            return FLOAT_FORMATS[componentCount - 1];
+        }
+        return (type->m_operands.at(1) != 0 ? SINT_FORMATS : UINT_FORMATS)[componentCount - 1];
+    }
+
+    void mergePushConstantRange(std::optional<VkPushConstantRange> &range, const VkPushConstantRange &other)
+    {
+        if (!range.has_value())
+        {
+            range = other;
+            return;
+        }
+        const uint32_t end = std::max(range->offset + range->size, other.offset + other.size);
+        range->offset = std::min(range->offset, other.offset);
+        range->size = end - range->offset;
+        range->stageFlags |= other.stageFlags;
+    }
+}
+
+ShaderReflection ShaderReflection::reflect(const uint32_t *code, const size_t wordCount)
+{
+    const Module module(code, wordCount);
+
+    ShaderReflection reflection{};
+    reflection.m_stageFlags = module.m_stageFlags;
+
+    for (const Variable &variable : module.m_variables)
+    {
+        const Decorations &decorations = module.getDecorations(variable.m_id);
+        const uint32_t pointeeType = module.getType(variable.m_pointerType).m_operands.at(1);
+        switch (variable.m_storageClass)
+        {
+        case STORAGE_UNIFORM_CONSTANT:
+        case STORAGE_UNIFORM:
+        case STORAGE_STORAGE_BUFFER:
+        {
+            const std::optional<std::pair<VkDescriptorType, uint32_t>> descriptor = getDescriptorType(module, variable);
+            if (!decorations.m_binding.has_value() || !descriptor.has_value())
+            {
+                break;
+            }
+            ShaderResourceBinding binding{};
+            binding.m_set = decorations.m_set.value_or(0);
+            binding.m_binding = *decorations.m_binding;
+            binding.m_descriptorType = descriptor->first;
+            binding.m_descriptorCount = descriptor->second;
+            binding.m_stageFlags = module.m_stageFlags;
+            reflection.m_bindings.push_back(binding);
+            break;
+        }
+        case STORAGE_PUSH_CONSTANT:
+        {
+            const std::vector<uint32_t> &members = module.getType(pointeeType).m_operands;
+            uint32_t offset = UINT32_MAX;
+            for (uint32_t member = 0; member < members.size(); member++)
+            {
+                offset = std::min(offset, module.getMemberOffset(pointeeType, member));
+            }
+            VkPushConstantRange range{};
+            range.stageFlags = module.m_stageFlags;
+            range.offset = members.empty() ? 0 : offset;
+            range.size = (module.getSize(pointeeType) - range.offset + 3) & ~3u; // Multiple of 4, as Vulkan requires
+            mergePushConstantRange(reflection.m_pushConstantRange, range);
+            break;
+        }
+        case STORAGE_INPUT:
+            if (module.m_stageFlags == VK_SHADER_STAGE_VERTEX_BIT && decorations.m_location.has_value() && !decorations.m_isBuiltIn &&
+                !module.getDecorations(pointeeType).m_isBuiltIn)
+            {
+                reflection.m_vertexInputs.push_back(ShaderVertexInput{*decorations.m_location, getVertexFormat(module, pointeeType)});
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    for (const auto &[id, typeId] : module.m_specConstants)
+    {
+        const Decorations &decorations = module.getDecorations(id);
+        if (decorations.m_specId.has_value())
+        {
+            reflection.m_specializationConstants.push_back(ShaderSpecializationConstant{*decorations.m_specId, module.getSize(typeId), module.m_stageFlags});
+        }
+    }
+
+    std::sort(reflection.m_bindings.begin(), reflection.m_bindings.end(), [](const ShaderResourceBinding &a, const ShaderResourceBinding &b)
+              { return std::pair(a.m_set, a.m_binding) < std::pair(b.m_set, b.m_binding); });
+    std::sort(reflection.m_vertexInputs.begin(), reflection.m_vertexInputs.end(), [](const ShaderVertexInput &a, const ShaderVertexInput &b)
+              { return a.m_location < b.m_location; });
+    std::sort(reflection.m_specializationConstants.begin(), reflection.m_specializationConstants.end(),
+              [](const ShaderSpecializationConstant &a, const ShaderSpecializationConstant &b)
+              { return a.m_constantId < b.m_constantId; });
+    return reflection;
+}
+
+void ShaderReflection::merge(const ShaderReflection &other)
+{
+    m_stageFlags |= other.m_stageFlags;
+
+    for (const ShaderResourceBinding &binding : other.m_bindings)
+    {
+        auto it = std::find_if(m_bindings.begin(), m_bindings.end(), [&binding](const ShaderResourceBinding &existing)
+                               { return existing.m_set == binding.m_set && existing.m_binding == binding.m_binding; });
+        if (it == m_bindings.end())
+        {
+            m_bindings.push_back(binding);
+            continue;
+        }
+        if (it->m_descriptorType != binding.m_descriptorType || it->m_descriptorCount != binding.m_descriptorCount)
+        {
+            throw std::runtime_error("Failed to merge shader stages: set " + std::to_string(binding.m_set) + " binding " +
+                                     std::to_string(binding.m_binding) + " is declared differently by two stages");
+        }
+        it->m_stageFlags |= binding.m_stageFlags;
+    }
+    std::sort(m_bindings.begin(), m_bindings.end(), [](const ShaderResourceBinding &a, const ShaderResourceBinding &b)
+              { return std::pair(a.m_set, a.m_binding) < std::pair(b.m_set, b.m_binding); });
+
+    if (other.m_pushConstantRange.has_value())
+    {
+        mergePushConstantRange(m_pushConstantRange, *other.m_pushConstantRange);
+    }
+
+    if (!other.m_vertexInputs.empty())
+    {
+        m_vertexInputs = other.m_vertexInputs; // Only the vertex stage has any
+    }
+
+    for (const ShaderSpecializationConstant &constant : other.m_specializationConstants)
+    {
+        auto it = std::find_if(m_specializationConstants.begin(), m_specializationConstants.end(), [&constant](const ShaderSpecializationConstant &existing)
+                               { return existing.m_constantId == constant.m_constantId; });
+        if (it == m_specializationConstants.end())
+        {
+            m_specializationConstants.push_back(constant);
+            continue;
+        }
+        if (it->m_size != constant.m_size)
+        {
+            throw std::runtime_error("Failed to merge shader stages: specialization constant " + std::to_string(constant.m_constantId) +
+                                     " has a different type in two stages");
+        }
+        it->m_stageFlags |= constant.m_stageFlags;
+    }
+    std::sort(m_specializationConstants.begin(), m_specializationConstants.end(),
+              [](const ShaderSpecializationConstant &a, const ShaderSpecializationConstant &b)
+              { return a.m_constantId < b.m_constantId; });
+}
@@ -0,0 +1,91 @@
+#include "graphics/ShaderSpecialization.hpp"
+
+#include "graphics/ShaderReflection.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <stdexcept>
+
+ShaderSpecialization &ShaderSpecialization::set(const uint32_t constantId, const uint32_t value)
+{
+    auto it = std::lower_bound(m_constantIds.begin(), m_constantIds.end(), constantId);
+    const size_t index = static_cast<size_t>(it - m_constantIds.begin());
+    if (it != m_constantIds.end() && *it == constantId)
+    {
+        m_data[index] = value;
+        return *this;
+    }
+
+    m_constantIds.insert(it, constantId);
+    m_data.insert(m_data.begin() + static_cast<std::ptrdiff_t>(index), value);
+
+    // Value i lives at byte 4 * i of the data: the map entries only depend on the ids
+    m_mapEntries.resize(m_constantIds.size());
+    for (size_t i = 0; i < m_constantIds.size(); i++)
+    {
+        m_mapEntries[i].constantID = m_constantIds[i];
+        m_mapEntries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+        m_mapEntries[i].size = sizeof(uint32_t);
+    }
+    return *this;
+}
+
+ShaderSpecialization &ShaderSpecialization::set(const uint32_t constantId, const int32_t value)
+{
+    return set(constantId, std::bit_cast<uint32_t>(value));
+}
+
+ShaderSpecialization &ShaderSpecialization::set(const uint32_t constantId, const float value)
+{
+    return set(constantId, std::bit_cast<uint32_t>(value));
+}
+
+ShaderSpecialization &ShaderSpecialization::set(const uint32_t constantId, const bool value)
+{
+    return set(constantId, static_cast<uint32_t>(value ? VK_TRUE : VK_FALSE));
+}
+
+void ShaderSpecialization::validate(const ShaderReflection &reflection) const
+{
+    for (const uint32_t constantId : m_constantIds)
+    {
+        auto it = std::find_if(reflection.m_specializationConstants.begin(), reflection.m_specializationConstants.end(),
+                               [constantId](const ShaderSpecializationConstant &constant)
+                               { return constant.m_constantId == constantId; });
+        if (it == reflection.m_specializationConstants.end())
+        {
+            throw std::runtime_error("Failed to specialize shader: no stage declares specialization constant " + std::to_string(constantId));
+        }
+        if (it->m_size != sizeof(uint32_t))
+        {
+            throw std::runtime_error("Failed to specialize shader: specialization constant " + std::to_string(constantId) + " is " +
+                                     std::to_string(it->m_size) + " bytes, only 32-bit constants are supported");
+        }
+    }
+}
+
+VkSpecializationInfo ShaderSpecialization::getInfo() const
+{
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(m_mapEntries.size());
+    specializationInfo.pMapEntries = m_mapEntries.data();
+    specializationInfo.dataSize = m_data.size() * sizeof(uint32_t);
+    specializationInfo.pData = m_data.data();
+    return specializationInfo;
+}
+
+void ShaderSpecialization::serialize(std::string &out) const
+{
+    const auto append = [&out](const uint32_t value)
+    {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+
+    append(static_cast<uint32_t>(m_constantIds.size()));
+    for (size_t i = 0; i < m_constantIds.size(); i++)
+    {
+        append(m_constantIds[i]);
+        append(m_data[i]);
+    }
+}
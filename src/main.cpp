@@ -1,13 +1,174 @@
 // main.cpp: The entry point for your application that starts the Application class.
 
 #include "app/App.hpp"
+#include "utilities/renderer/VulkanPipelinePresets.hpp"
 #include <iostream>
+#include <cstring>
+#include <string>
+#include <utility>
 
-int main()
+static VulkanPresentPolicy parsePresentPolicy(const std::string &name)
+{
+    for (const VulkanPresentPolicy policy : {VulkanPresentPolicy::LOW_LATENCY, VulkanPresentPolicy::THROUGHPUT,
+                                             VulkanPresentPolicy::POWER_SAVING, VulkanPresentPolicy::UNCAPPED})
+    {
+        if (name == presentPolicyToString(policy))
+        {
+            return policy;
+        }
+    }
+    throw std::invalid_argument("Unknown present policy: " + name + " (low-latency, throughput, power-saving or uncapped)");
+}
+
+static LightingPath parseLightingPath(const std::string &name)
+{
+    for (const LightingPath path : {LightingPath::FORWARD, LightingPath::DEFERRED})
+    {
+        if (name == lightingPathToString(path))
+        {
+            return path;
+        }
+    }
+    throw std::invalid_argument("Unknown lighting path: " + name + " (forward or deferred)");
+}
+
+// Presets valid with the renderer's single-sample render pass (wireframe needs the fillModeNonSolid feature)
+static VulkanPipelineState parsePipelinePreset(const std::string &name)
+{
+    const std::pair<const char *, VulkanPipelineState> presets[] = {
+        {"basic", VulkanPipelinePresets::BASIC},
+        {"alpha-blending", VulkanPipelinePresets::ALPHA_BLENDING},
+        {"wireframe", VulkanPipelinePresets::WIREFRAME},
+        {"post-processing", VulkanPipelinePresets::POST_PROCESSING},
+        {"shadow-mapping", VulkanPipelinePresets::SHADOW_MAPPING},
+        {"hdr", VulkanPipelinePresets::HDR},
+        {"depth-pre-pass", VulkanPipelinePresets::DEPTH_PRE_PASS},
+    };
+    for (const auto &[presetName, state] : presets)
+    {
+        if (name == presetName)
+        {
+            return state;
+        }
+    }
+    throw std::invalid_argument("Unknown pipeline preset: " + name +
+                                " (basic, alpha-blending, wireframe, post-processing, shadow-mapping, hdr or depth-pre-pass)");
+}
+
+// Usage: VulkanTutorial [--headless] [--capture] [--frames N] [--width W] [--height H] [--present POLICY] [--pacing] [--particles N]
+//                      [--lights N] [--lighting forward|deferred]
+//                      [--pipeline-cache PATH | --no-pipeline-cache] [--pipeline-workers N] [--pipeline-presets]
+//                      [--no-extended-dynamic-state] [--no-dynamic-rendering] [--pipeline-manifest PATH | --no-pipeline-manifest] [--draw-preset NAME]
+//                      [--shader-archive PATH | --no-shader-archive] [--shader-hot-reload]
+static EngineConfig parseCommandLine(int argc, char *argv[])
+{
+    EngineConfig config{};
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--headless") == 0)
+        {
+            config.m_headless = true;
+        }
+        else if (strcmp(argv[i], "--capture") == 0)
+        {
+            config.m_captureFrames = true;
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+        {
+            config.m_headlessFrameCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--width") == 0 && hasValue)
+        {
+            config.m_width = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--height") == 0 && hasValue)
+        {
+            config.m_height = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--present") == 0 && hasValue)
+        {
+            config.m_presentPolicy = parsePresentPolicy(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--pacing") == 0)
+        {
+            config.m_framePacing = true;
+        }
+        else if (strcmp(argv[i], "--particles") == 0 && hasValue)
+        {
+            config.m_particleCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--lights") == 0 && hasValue)
+        {
+            config.m_benchmarkLightCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--lighting") == 0 && hasValue)
+        {
+            config.m_benchmarkLightingPath = parseLightingPath(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--pipeline-cache") == 0 && hasValue)
+        {
+            config.m_pipelineCachePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--no-pipeline-cache") == 0)
+        {
+            config.m_pipelineCachePath.clear();
+        }
+        else if (strcmp(argv[i], "--pipeline-workers") == 0 && hasValue)
+        {
+            config.m_pipelineWorkerCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--pipeline-presets") == 0)
+        {
+            config.m_compilePipelinePresets = true;
+        }
+        else if (strcmp(argv[i], "--no-extended-dynamic-state") == 0)
+        {
+            config.m_extendedDynamicState = false;
+        }
+        else if (strcmp(argv[i], "--no-dynamic-rendering") == 0)
+        {
+            config.m_dynamicRendering = false;
+        }
+        else if (strcmp(argv[i], "--pipeline-manifest") == 0 && hasValue)
+        {
+            config.m_pipelineManifestPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--no-pipeline-manifest") == 0)
+        {
+            config.m_pipelineManifestPath.clear();
+        }
+        else if (strcmp(argv[i], "--draw-preset") == 0 && hasValue)
+        {
+            config.m_drawPipelineState = parsePipelinePreset(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--shader-archive") == 0 && hasValue)
+        {
+            config.m_shaderArchivePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--no-shader-archive") == 0)
+        {
+            config.m_shaderArchivePath.clear();
+        }
+        else if (strcmp(argv[i], "--shader-hot-reload") == 0)
+        {
+            config.m_shaderHotReload = true;
+        }
+        else
+        {
+            throw std::invalid_argument(std::string("Unknown command line argument: ") + argv[i]);
+        }
+    }
+
+    return config;
+}
+
+int main(int argc, char *argv[])
 {
     try
     {
-        App app;
+        App app(parseCommandLine(argc, argv));
         app.run();
     }
     catch (const std::exception &e)
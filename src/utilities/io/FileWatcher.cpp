@@ -0,0 +1,176 @@
+#include "utilities/io/FileWatcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define FILE_WATCHER_HAS_INOTIFY 1
+#endif
+
+FileWatcher::FileWatcher() : m_inotifyDescriptor(-1) {}
+
+FileWatcher::~FileWatcher()
+{
+    cleanUp();
+}
+
+void FileWatcher::watch(const std::string &directory)
+{
+    cleanUp();
+    m_directory = directory;
+
+    std::error_code error;
+    if (!std::filesystem::is_directory(m_directory, error))
+    {
+        throw std::runtime_error("Failed to watch " + m_directory + ": not a directory");
+    }
+
+#ifdef FILE_WATCHER_HAS_INOTIFY
+    m_inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyDescriptor < 0)
+    {
+        throw std::runtime_error("Failed to watch " + m_directory + ": inotify_init1 failed");
+    }
+    if (!addDirectory(m_directory))
+    {
+        throw std::runtime_error("Failed to watch " + m_directory + ": inotify_add_watch failed");
+    }
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(m_directory, error))
+    {
+        if (entry.is_directory(error) && !addDirectory(entry.path().generic_string()))
+        {
+            throw std::runtime_error("Failed to watch " + entry.path().generic_string() + ": inotify_add_watch failed");
+        }
+    }
+#else
+    // First scan: the files present now are the reference, not changes
+    pollWriteTimes(0, false);
+#endif
+}
+
+void FileWatcher::cleanUp()
+{
+#ifdef FILE_WATCHER_HAS_INOTIFY
+    if (m_inotifyDescriptor >= 0)
+    {
+        close(m_inotifyDescriptor); // Removes every watch
+        m_inotifyDescriptor = -1;
+    }
+#endif
+    m_watchedDirectories.clear();
+    m_writeTimes.clear();
+}
+
+std::vector<std::string> FileWatcher::waitForChanges(const int timeoutMs)
+{
+#ifdef FILE_WATCHER_HAS_INOTIFY
+    std::vector<std::string> changedPaths = readEvents(timeoutMs);
+#else
+    std::vector<std::string> changedPaths = pollWriteTimes(timeoutMs, true);
+#endif
+    // A save may write the same file several times
+    std::sort(changedPaths.begin(), changedPaths.end());
+    changedPaths.erase(std::unique(changedPaths.begin(), changedPaths.end()), changedPaths.end());
+    return changedPaths;
+}
+
+bool FileWatcher::addDirectory(const std::string &directory)
+{
+#ifdef FILE_WATCHER_HAS_INOTIFY
+    const int watchDescriptor = inotify_add_watch(m_inotifyDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (watchDescriptor < 0)
+    {
+        return false;
+    }
+    m_watchedDirectories[watchDescriptor] = directory;
+#else
+    (void)directory;
+#endif
+    return true;
+}
+
+std::vector<std::string> FileWatcher::readEvents(const int timeoutMs)
+{
+    std::vector<std::string> changedPaths;
+#ifdef FILE_WATCHER_HAS_INOTIFY
+    pollfd pollDescriptor{};
+    pollDescriptor.fd = m_inotifyDescriptor;
+    pollDescriptor.events = POLLIN;
+    if (poll(&pollDescriptor, 1, timeoutMs) <= 0)
+    {
+        return changedPaths; // Timeout (or interrupted): nothing written
+    }
+
+    // Events are variable sized (the name follows the header): read them in batches
+    alignas(inotify_event) char buffer[4096];
+    while (true)
+    {
+        const ssize_t length = read(m_inotifyDescriptor, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            break; // EAGAIN: every pending event has been read
+        }
+
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            auto it = m_watchedDirectories.find(event->wd);
+            if (it == m_watchedDirectories.end() || event->len == 0)
+            {
+                continue;
+            }
+            const std::string path = it->second + "/" + event->name;
+            if (event->mask & IN_ISDIR)
+            {
+                // Files written in it from now on are reported. It may already be gone: waiting must not fail because of it
+                if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && !addDirectory(path))
+                {
+                    std::cerr << "File watcher: failed to watch new directory " << path << ", skipping it" << std::endl;
+                }
+            }
+            else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+            {
+                changedPaths.push_back(path);
+            }
+        }
+    }
+#else
+    (void)timeoutMs;
+#endif
+    return changedPaths;
+}
+
+std::vector<std::string> FileWatcher::pollWriteTimes(const int timeoutMs, const bool reportNewFiles)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+
+    std::vector<std::string> changedPaths;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(m_directory, error))
+    {
+        if (!entry.is_regular_file(error))
+        {
+            continue;
+        }
+        const std::filesystem::file_time_type writeTime = entry.last_write_time(error);
+        auto [it, isNew] = m_writeTimes.try_emplace(entry.path().generic_string(), writeTime);
+        if (!isNew && it->second != writeTime)
+        {
+            it->second = writeTime;
+            changedPaths.push_back(it->first);
+        }
+        else if (isNew && reportNewFiles)
+        {
+            changedPaths.push_back(it->first); // Created since the previous scan
+        }
+    }
+    return changedPaths;
+}
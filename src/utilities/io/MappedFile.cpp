@@ -0,0 +1,86 @@
+#include "utilities/io/MappedFile.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_HAS_MMAP 1
+#endif
+
+MappedFile::MappedFile(const std::string &filePath) : m_data(nullptr), m_size(0), m_isMapped(false)
+{
+    if (!map(filePath))
+    {
+        read(filePath);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef MAPPED_FILE_HAS_MMAP
+    if (m_isMapped)
+    {
+        munmap(const_cast<std::byte *>(m_data), m_size);
+    }
+#endif
+}
+
+bool MappedFile::map(const std::string &filePath)
+{
+#ifdef MAPPED_FILE_HAS_MMAP
+    const int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        return false; // read() reports the error
+    }
+
+    struct stat fileStatus{};
+    void *address = MAP_FAILED;
+    // Empty files cannot be mapped
+    if (fstat(fileDescriptor, &fileStatus) == 0 && fileStatus.st_size > 0)
+    {
+        address = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    }
+    // The mapping keeps its own reference to the file
+    close(fileDescriptor);
+    if (address == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // The whole file is about to be read: let the OS fetch it in one go rather than page fault by page fault
+    madvise(address, static_cast<size_t>(fileStatus.st_size), MADV_WILLNEED);
+
+    m_data = static_cast<const std::byte *>(address);
+    m_size = static_cast<size_t>(fileStatus.st_size);
+    m_isMapped = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MappedFile::read(const std::string &filePath)
+{
+    // "ate": Start reading at the end of the file
+    // Read the file as binary file (avoid text transformations)
+    std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open file: " + filePath + "\n" +
+                                 "Current working directory: " + std::filesystem::current_path().string());
+    }
+
+    m_size = static_cast<size_t>(file.tellg());
+    m_buffer.resize((m_size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+    // Seek back to the beginning of the file and read all of the bytes at once.
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(m_buffer.data()), static_cast<std::streamsize>(m_size));
+    m_data = reinterpret_cast<const std::byte *>(m_buffer.data());
+}
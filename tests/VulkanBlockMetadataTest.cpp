@@ -0,0 +1,274 @@
+// CPU-only tests of VulkanBlockMetadata: no Vulkan call is made, so no GPU or driver is needed.
+// Every operation is followed by validate(), and the live allocations are checked against each other: no overlap, and no
+// conflicting allocation types sharing a bufferImageGranularity page.
+
+#include "core/renderer/VulkanBlockMetadata.hpp"
+
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#define CHECK(condition)                                                                      \
+    do                                                                                        \
+    {                                                                                         \
+        if (!(condition))                                                                     \
+        {                                                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            g_failureCount++;                                                                 \
+        }                                                                                     \
+    } while (false)
+
+namespace
+{
+    int g_failureCount = 0;
+
+    struct Allocation
+    {
+        VkDeviceSize m_offset;
+        VkDeviceSize m_size;
+        VulkanAllocationType m_type;
+    };
+
+    bool typesConflict(const VulkanAllocationType first, const VulkanAllocationType second)
+    {
+        return first == VulkanAllocationType::UNKNOWN || second == VulkanAllocationType::UNKNOWN || first != second;
+    }
+
+    // The metadata under test, with the allocations it handed out
+    class Block
+    {
+    public:
+        Block(const VkDeviceSize size, const VkDeviceSize granularity = 1) : m_metadata(size, granularity), m_granularity(granularity)
+        {
+            CHECK(m_metadata.validate());
+        }
+
+        std::optional<VkDeviceSize> allocate(const VkDeviceSize size, const VkDeviceSize alignment, const VulkanAllocationType type)
+        {
+            const std::optional<VkDeviceSize> offset = m_metadata.allocate(size, alignment, type);
+            CHECK(m_metadata.validate());
+            if (offset.has_value())
+            {
+                CHECK(offset.value() % alignment == 0);
+                CHECK(offset.value() + size <= m_metadata.getSize());
+                m_allocations.push_back({offset.value(), size, type});
+                checkAllocations();
+            }
+            return offset;
+        }
+
+        void free(const VkDeviceSize offset)
+        {
+            m_metadata.free(offset);
+            CHECK(m_metadata.validate());
+            std::erase_if(m_allocations, [offset](const Allocation &allocation) { return allocation.m_offset == offset; });
+            checkAllocations();
+        }
+
+        void freeAll()
+        {
+            while (!m_allocations.empty())
+            {
+                free(m_allocations.back().m_offset);
+            }
+            CHECK(m_metadata.isEmpty());
+            CHECK(m_metadata.getFreeRangeCount() == 1);
+            CHECK(m_metadata.getLargestFreeRange() == m_metadata.getSize());
+        }
+
+        const VulkanBlockMetadata &metadata() const { return m_metadata; }
+        const std::vector<Allocation> &allocations() const { return m_allocations; }
+
+    private:
+        VulkanBlockMetadata m_metadata;
+        VkDeviceSize m_granularity;
+        std::vector<Allocation> m_allocations;
+
+        void checkAllocations() const
+        {
+            VkDeviceSize usedBytes = 0;
+            for (size_t i = 0; i < m_allocations.size(); i++)
+            {
+                const Allocation &first = m_allocations[i];
+                usedBytes += first.m_size;
+                for (size_t j = i + 1; j < m_allocations.size(); j++)
+                {
+                    const Allocation &second = m_allocations[j];
+                    CHECK(first.m_offset + first.m_size <= second.m_offset || second.m_offset + second.m_size <= first.m_offset);
+
+                    if (typesConflict(first.m_type, second.m_type))
+                    {
+                        const Allocation &lower = first.m_offset < second.m_offset ? first : second;
+                        const Allocation &upper = first.m_offset < second.m_offset ? second : first;
+                        CHECK((lower.m_offset + lower.m_size - 1) / m_granularity != upper.m_offset / m_granularity);
+                    }
+                }
+            }
+            CHECK(m_metadata.getUsedBytes() == usedBytes);
+            CHECK(m_metadata.getAllocationCount() == m_allocations.size());
+        }
+    };
+
+    void testAllocateFreeMerge()
+    {
+        Block block(1024 * 1024);
+        std::vector<VkDeviceSize> offsets;
+        for (const VkDeviceSize size : {256, 1000, 4096, 64, 70000, 3})
+        {
+            const std::optional<VkDeviceSize> offset = block.allocate(size, 1, VulkanAllocationType::LINEAR);
+            CHECK(offset.has_value());
+            offsets.push_back(offset.value_or(0));
+        }
+
+        // Middle ones first, so ranges merge with free neighbours on one side, then on both
+        block.free(offsets[1]);
+        block.free(offsets[3]);
+        block.free(offsets[2]);
+        block.free(offsets[0]);
+        block.free(offsets[5]);
+        block.free(offsets[4]);
+        CHECK(block.metadata().isEmpty());
+        CHECK(block.metadata().getFreeRangeCount() == 1);
+        CHECK(block.metadata().getLargestFreeRange() == 1024 * 1024);
+
+        // Freeing an offset that is not allocated is an error
+        bool threw = false;
+        try
+        {
+            block.free(12);
+        }
+        catch (const std::runtime_error &)
+        {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+
+    void testAlignment()
+    {
+        Block block(64 * 1024);
+        CHECK(block.allocate(100, 1, VulkanAllocationType::LINEAR) == VkDeviceSize(0));
+
+        const std::optional<VkDeviceSize> aligned = block.allocate(64, 256, VulkanAllocationType::LINEAR);
+        CHECK(aligned.has_value() && aligned.value() % 256 == 0 && aligned.value() >= 100);
+
+        for (const VkDeviceSize alignment : {2, 16, 512, 4096})
+        {
+            CHECK(block.allocate(33, alignment, VulkanAllocationType::LINEAR).has_value());
+        }
+        block.freeAll();
+    }
+
+    void testBufferImageGranularity()
+    {
+        constexpr VkDeviceSize granularity = 1024;
+
+        // Same type: may share a page. Different types, or unknown: the next allocation starts on a new page
+        {
+            Block block(16 * granularity, granularity);
+            CHECK(block.allocate(100, 1, VulkanAllocationType::LINEAR) == VkDeviceSize(0));
+            CHECK(block.allocate(100, 1, VulkanAllocationType::LINEAR) == VkDeviceSize(100));
+            CHECK(block.allocate(100, 1, VulkanAllocationType::OPTIMAL) == granularity);
+            CHECK(block.allocate(100, 1, VulkanAllocationType::OPTIMAL) == granularity + 100);
+            CHECK(block.allocate(100, 1, VulkanAllocationType::UNKNOWN) == 2 * granularity);
+            CHECK(block.allocate(100, 1, VulkanAllocationType::UNKNOWN) == 3 * granularity);
+            block.freeAll();
+        }
+
+        // The allocation after a free range conflicts: the range is skipped if the allocation would reach its page
+        {
+            Block block(8 * granularity, granularity);
+            const std::optional<VkDeviceSize> first = block.allocate(1536, 1, VulkanAllocationType::OPTIMAL);
+            const std::optional<VkDeviceSize> second = block.allocate(512, 1, VulkanAllocationType::OPTIMAL);
+            CHECK(first == VkDeviceSize(0));
+            CHECK(second == VkDeviceSize(1536));
+            block.free(0);
+
+            const std::optional<VkDeviceSize> linear = block.allocate(1200, 1, VulkanAllocationType::LINEAR);
+            CHECK(linear.has_value() && linear.value() >= 2 * granularity);
+
+            // Small enough to stay below the optimal allocation's page
+            CHECK(block.allocate(1000, 1, VulkanAllocationType::LINEAR) == VkDeviceSize(0));
+            block.freeAll();
+        }
+    }
+
+    void testExactFitAndFullBlock()
+    {
+        // One allocation the size of the block
+        {
+            Block block(4096);
+            CHECK(block.allocate(4096, 1, VulkanAllocationType::OPTIMAL) == VkDeviceSize(0));
+            CHECK(block.metadata().getFreeBytes() == 0);
+            CHECK(block.metadata().getFreeRangeCount() == 0);
+            CHECK(block.metadata().getLargestFreeRange() == 0);
+            CHECK(!block.allocate(1, 1, VulkanAllocationType::OPTIMAL).has_value());
+            block.freeAll();
+        }
+
+        // A hole of exactly the requested size is reused, and fills the block again
+        {
+            Block block(3 * 1024);
+            CHECK(block.allocate(1024, 1024, VulkanAllocationType::LINEAR) == VkDeviceSize(0));
+            CHECK(block.allocate(1024, 1024, VulkanAllocationType::LINEAR) == VkDeviceSize(1024));
+            CHECK(block.allocate(1024, 1024, VulkanAllocationType::LINEAR) == VkDeviceSize(2048));
+            block.free(1024);
+            CHECK(block.metadata().getLargestFreeRange() == 1024);
+            CHECK(block.allocate(1024, 1024, VulkanAllocationType::LINEAR) == VkDeviceSize(1024));
+            CHECK(block.metadata().getFreeBytes() == 0);
+            block.freeAll();
+        }
+
+        // Requests that can never fit
+        {
+            Block block(4096);
+            CHECK(!block.allocate(4097, 1, VulkanAllocationType::LINEAR).has_value());
+            CHECK(!block.allocate(0, 1, VulkanAllocationType::LINEAR).has_value());
+            CHECK(block.allocate(1, 1, VulkanAllocationType::LINEAR) == VkDeviceSize(0));
+            CHECK(!block.allocate(2048, 4096, VulkanAllocationType::LINEAR).has_value()); // The next aligned offset is the end of the block
+            block.freeAll();
+        }
+    }
+
+    // Random allocations and frees of every type, with a fixed seed so failures reproduce
+    void testRandomChurn()
+    {
+        std::mt19937 random(1234);
+        Block block(4 * 1024 * 1024, 256);
+        const VulkanAllocationType types[] = {VulkanAllocationType::LINEAR, VulkanAllocationType::OPTIMAL, VulkanAllocationType::UNKNOWN};
+
+        for (uint32_t i = 0; i < 5000; i++)
+        {
+            if (block.allocations().empty() || random() % 3 != 0)
+            {
+                const VkDeviceSize size = 1 + random() % (random() % 4 == 0 ? 256 * 1024 : 4096);
+                const VkDeviceSize alignment = VkDeviceSize(1) << (random() % 13);
+                block.allocate(size, alignment, types[random() % 3]);
+            }
+            else
+            {
+                block.free(block.allocations()[random() % block.allocations().size()].m_offset);
+            }
+        }
+        block.freeAll();
+    }
+}
+
+int main()
+{
+    testAllocateFreeMerge();
+    testAlignment();
+    testBufferImageGranularity();
+    testExactFitAndFullBlock();
+    testRandomChurn();
+
+    if (g_failureCount > 0)
+    {
+        std::fprintf(stderr, "VulkanBlockMetadata: %d checks failed\n", g_failureCount);
+        return 1;
+    }
+    std::printf("VulkanBlockMetadata: all checks passed\n");
+    return 0;
+}
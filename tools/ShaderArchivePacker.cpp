@@ -0,0 +1,46 @@
+#include "graphics/ShaderArchive.hpp"
+#include "utilities/io/MappedFile.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+// Build step packing the compiled shaders into one archive (see ShaderArchive).
+// Usage: ShaderArchivePacker OUTPUT ROOT FILE...
+// Each FILE is named after its path relative to ROOT, the directory the application runs from, so the names match the paths
+// the renderer loads the loose files with.
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: ShaderArchivePacker OUTPUT ROOT FILE..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const std::filesystem::path root = std::filesystem::absolute(argv[2]);
+        std::vector<ShaderArchive::Source> sources;
+        size_t totalSize = 0;
+        for (int i = 3; i < argc; i++)
+        {
+            const MappedFile file(argv[i]);
+            ShaderArchive::Source source;
+            source.m_name = std::filesystem::absolute(argv[i]).lexically_relative(root).generic_string();
+            source.m_data.assign(file.getData(), file.getData() + file.getSize());
+            totalSize += file.getSize();
+            sources.push_back(std::move(source));
+        }
+
+        ShaderArchive::write(argv[1], sources);
+        std::cout << "Packed " << sources.size() << " shaders (" << totalSize << " bytes) into " << argv[1] << std::endl;
+    }
+    catch (const std::exception &exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}